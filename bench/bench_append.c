@@ -0,0 +1,67 @@
+// bench/bench_append.c
+// Insert cost of ascending keys, which take the append path, against
+// ascending keys with occasional stragglers and against random keys
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bplus/tree.h"
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// ascending: 2i; stragglers: every 100th key is an odd one from the past;
+// random: the ascending keys shuffled
+static void make_keys(int* keys, int n, int workload) {
+    unsigned seed = 12345u;
+    for (int i = 0; i < n; i++) {
+        keys[i] = i * 2;
+        seed = seed * 1103515245u + 12345u;
+        if (workload == 1 && i % 100 == 99) {
+            keys[i] = (int)((seed >> 2) % (unsigned)i) * 2 + 1;
+        }
+    }
+    for (int i = n - 1; workload == 2 && i > 0; i--) {
+        seed = seed * 1103515245u + 12345u;
+        int j = (int)((seed >> 2) % (unsigned)(i + 1));
+        int t = keys[i];
+        keys[i] = keys[j];
+        keys[j] = t;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 10000000;
+    if (n < 1) {
+        fprintf(stderr, "Usage: %s [keys]\n", argv[0]);
+        return 1;
+    }
+
+    const char* workloads[] = { "ascending", "stragglers", "random" };
+    int orders[] = { 16, 64, 256 };
+    int* keys = malloc(sizeof(int) * n);
+
+    printf("keys,order,split,workload,insert_ns\n");
+    for (int w = 0; w < 3; w++) {
+        make_keys(keys, n, w);
+        for (int o = 0; o < 3; o++) {
+            for (int split = 0; split < 2; split++) {
+                BPlusTreeOptions options = { .order = orders[o], .split = (BPlusSplitPolicy)split };
+                BPlusTree* tree = bplus_tree_create_with_options(&options);
+                double start = now_seconds();
+                for (int i = 0; i < n; i++) {
+                    bplus_tree_insert(tree, keys[i]);
+                }
+                double elapsed = now_seconds() - start;
+                printf("%d,%d,%s,%s,%.1f\n", n, orders[o], split ? "sequential" : "even",
+                       workloads[w], elapsed * 1e9 / n);
+                bplus_tree_destroy(tree);
+            }
+        }
+    }
+
+    free(keys);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// bench/bench_concurrent.c
+// Throughput of a concurrent tree for 1..N threads on a read-mostly mix
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bplus/tree.h"
+#include "bplus/concurrent.h"
+
+#define KEY_SPACE 1000000
+#define PRELOAD 500000
+
+typedef struct {
+    BPlusTree* tree;
+    unsigned seed;
+    int ops;
+    int write_percent;
+} Worker;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void* run_worker(void* arg) {
+    Worker* w = arg;
+    unsigned seed = w->seed;
+    for (int i = 0; i < w->ops; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int key = (int)((seed >> 4) % KEY_SPACE);
+        int dice = (int)((seed >> 24) % 100);
+        if (dice < w->write_percent / 2) {
+            bplus_tree_insert(w->tree, key);
+        } else if (dice < w->write_percent) {
+            bplus_tree_delete(w->tree, key);
+        } else {
+            bplus_tree_search(w->tree, key);
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : 8;
+    int ops = argc > 2 ? atoi(argv[2]) : 1000000;
+    int write_percent = argc > 3 ? atoi(argv[3]) : 10;
+    int order = argc > 4 ? atoi(argv[4]) : 64;
+    if (max_threads < 1 || max_threads > BPLUS_MAX_THREADS || ops < 1 || order < 3) {
+        fprintf(stderr, "Usage: %s [max_threads] [ops_per_thread] [write_percent] [order]\n", argv[0]);
+        return 1;
+    }
+
+    printf("threads,ops,seconds,mops_per_sec,speedup\n");
+    double base = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        BPlusTree* tree = bplus_tree_create_concurrent(order);
+        for (int i = 0; i < PRELOAD; i++) {
+            bplus_tree_insert(tree, (int)(((unsigned)i * 2654435761u) % KEY_SPACE));
+        }
+
+        pthread_t* ids = malloc(sizeof(pthread_t) * threads);
+        Worker* workers = malloc(sizeof(Worker) * threads);
+        double start = now_seconds();
+        for (int t = 0; t < threads; t++) {
+            workers[t] = (Worker){ tree, 17u * (unsigned)(t + 1), ops, write_percent };
+            pthread_create(&ids[t], NULL, run_worker, &workers[t]);
+        }
+        for (int t = 0; t < threads; t++) {
+            pthread_join(ids[t], NULL);
+        }
+        double elapsed = now_seconds() - start;
+
+        double mops = (double)ops * threads / elapsed / 1e6;
+        if (threads == 1) base = mops;
+        printf("%d,%d,%.3f,%.2f,%.2f\n", threads, ops * threads, elapsed, mops, mops / base);
+
+        free(ids);
+        free(workers);
+        bplus_tree_destroy(tree);
+        if (threads < max_threads && threads * 2 > max_threads) threads = max_threads / 2;
+    }
+    return 0;
+}
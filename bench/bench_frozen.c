@@ -0,0 +1,76 @@
+// bench/bench_frozen.c
+// Lookup cost of a frozen tree against the pointer tree it was built from
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bplus/frozen.h"
+#include "bplus/tree.h"
+
+#define LOOKUPS 2000000
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Keys are the even numbers below 2n, so half of the probes miss
+static void make_probes(int* probes, int n) {
+    unsigned seed = 12345u;
+    for (int i = 0; i < LOOKUPS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        probes[i] = (int)((seed >> 2) % (2u * (unsigned)n));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    int max_keys = argc > 1 ? atoi(argv[1]) : 10000000;
+    if (max_keys < 1) {
+        fprintf(stderr, "Usage: %s [max_keys]\n", argv[0]);
+        return 1;
+    }
+
+    int* probes = malloc(sizeof(int) * LOOKUPS);
+    int orders[] = { 16, 64, 256 };
+
+    printf("keys,structure,bytes_per_key,lookup_ns\n");
+    for (int n = 100000; n <= max_keys; n *= 10) {
+        make_probes(probes, n);
+        for (int o = 0; o < 3; o++) {
+            int* sorted = malloc(sizeof(int) * n);
+            for (int i = 0; i < n; i++) {
+                sorted[i] = i * 2;
+            }
+            BPlusTree* tree = bplus_tree_bulk_load(orders[o], sorted, (size_t)n, 0.7);
+            free(sorted);
+
+            size_t found = 0;
+            double start = now_seconds();
+            for (int i = 0; i < LOOKUPS; i++) {
+                found += bplus_tree_search(tree, probes[i]);
+            }
+            double elapsed = now_seconds() - start;
+            printf("%d,tree_order_%d,%.2f,%.1f\n", n, orders[o],
+                   (double)bplus_tree_memory_usage(tree) / n, elapsed * 1e9 / LOOKUPS);
+
+            // The frozen copy is the same whichever order it came from
+            if (o == 0) {
+                BPlusFrozenTree* frozen = bplus_tree_freeze(tree);
+                size_t frozen_found = 0;
+                start = now_seconds();
+                for (int i = 0; i < LOOKUPS; i++) {
+                    frozen_found += bplus_frozen_tree_search(frozen, probes[i]);
+                }
+                elapsed = now_seconds() - start;
+                if (frozen_found != found) fprintf(stderr, "frozen and pointer tree disagree\n");
+                printf("%d,frozen,%.2f,%.1f\n", n,
+                       (double)bplus_frozen_tree_memory_usage(frozen) / n, elapsed * 1e9 / LOOKUPS);
+                bplus_frozen_tree_destroy(frozen);
+            }
+            bplus_tree_destroy(tree);
+        }
+    }
+
+    free(probes);
+    return 0;
+}
@@ -0,0 +1,58 @@
+// bench/bench_lazy_delete.c
+// A burst of deletes with immediate repairs against lazy deletes, and the
+// cost of the rebalancing those leave behind
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bplus/tree.h"
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 4000000;
+    if (n < 1) {
+        fprintf(stderr, "Usage: %s [keys]\n", argv[0]);
+        return 1;
+    }
+
+    // Keys in a scattered order; the burst deletes the first 90% of them
+    int* keys = malloc(sizeof(int) * n);
+    for (int i = 0; i < n; i++) {
+        keys[i] = (int)(((long long)i * 7919) % n);
+    }
+    int burst = n / 10 * 9;
+    int orders[] = { 8, 32, 128 };
+
+    printf("keys,order,mode,delete_ns,rebalance_ns,bytes_after\n");
+    for (int o = 0; o < 3; o++) {
+        for (int lazy = 0; lazy < 2; lazy++) {
+            BPlusTreeOptions options = { .order = orders[o], .flags = lazy ? BPLUS_TREE_LAZY_DELETE : 0 };
+            BPlusTree* tree = bplus_tree_create_with_options(&options);
+            for (int i = 0; i < n; i++) {
+                bplus_tree_insert(tree, keys[i]);
+            }
+
+            double start = now_seconds();
+            for (int i = 0; i < burst; i++) {
+                bplus_tree_delete(tree, keys[i]);
+            }
+            double deleting = now_seconds() - start;
+            start = now_seconds();
+            while (bplus_tree_rebalance(tree, 1024) == 1024) {
+            }
+            double rebalancing = now_seconds() - start;
+
+            printf("%d,%d,%s,%.1f,%.1f,%zu\n", n, orders[o], lazy ? "lazy" : "eager",
+                   deleting * 1e9 / burst, rebalancing * 1e9 / burst,
+                   bplus_tree_memory_usage(tree));
+            bplus_tree_destroy(tree);
+        }
+    }
+
+    free(keys);
+    return 0;
+}
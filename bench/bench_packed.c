@@ -0,0 +1,83 @@
+// bench/bench_packed.c
+// Memory per key and lookup cost of packed leaves next to plain ones, for
+// a few key distributions and orders
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bplus/tree.h"
+
+typedef enum { SEQUENTIAL, SHUFFLED, SPARSE } Pattern;
+
+static const char* pattern_names[] = { "sequential", "shuffled", "sparse" };
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void make_keys(int* keys, int n, Pattern pattern) {
+    unsigned seed = 12345u;
+    for (int i = 0; i < n; i++) {
+        keys[i] = pattern == SPARSE ? (int)((unsigned)i * 2654435761u) : i;
+    }
+    if (pattern == SEQUENTIAL) return;
+    for (int i = n - 1; i > 0; i--) {
+        seed = seed * 1103515245u + 12345u;
+        int j = (int)((seed >> 4) % (unsigned)(i + 1));
+        int t = keys[i];
+        keys[i] = keys[j];
+        keys[j] = t;
+    }
+}
+
+// One line: build the tree, then time lookups of every key in shuffled order
+static void run(const int* keys, const int* probes, int n, Pattern pattern, int order, unsigned flags) {
+    BPlusTreeOptions options = { .order = order, .flags = flags };
+    BPlusTree* tree = bplus_tree_create_with_options(&options);
+
+    double start = now_seconds();
+    for (int i = 0; i < n; i++) {
+        bplus_tree_insert(tree, keys[i]);
+    }
+    double insert_ns = (now_seconds() - start) * 1e9 / n;
+
+    size_t found = 0;
+    start = now_seconds();
+    for (int i = 0; i < n; i++) {
+        found += bplus_tree_search(tree, probes[i]);
+    }
+    double lookup_ns = (now_seconds() - start) * 1e9 / n;
+    if (found != (size_t)n) fprintf(stderr, "lost keys: %zu of %d found\n", found, n);
+
+    printf("%s,%d,%s,%.2f,%.1f,%.1f\n", pattern_names[pattern], order,
+           flags & BPLUS_TREE_PACKED_LEAVES ? "packed" : "plain",
+           (double)bplus_tree_memory_usage(tree) / n, insert_ns, lookup_ns);
+    bplus_tree_destroy(tree);
+}
+
+int main(int argc, char* argv[]) {
+    int n = argc > 1 ? atoi(argv[1]) : 1000000;
+    if (n < 1) {
+        fprintf(stderr, "Usage: %s [keys]\n", argv[0]);
+        return 1;
+    }
+
+    int* keys = malloc(sizeof(int) * n);
+    int* probes = malloc(sizeof(int) * n);
+    int orders[] = { 16, 64, 256 };
+
+    printf("pattern,order,layout,bytes_per_key,insert_ns,lookup_ns\n");
+    for (Pattern pattern = SEQUENTIAL; pattern <= SPARSE; pattern++) {
+        make_keys(keys, n, pattern);
+        make_keys(probes, n, pattern == SPARSE ? SPARSE : SHUFFLED);
+        for (int o = 0; o < 3; o++) {
+            run(keys, probes, n, pattern, orders[o], 0);
+            run(keys, probes, n, pattern, orders[o], BPLUS_TREE_PACKED_LEAVES);
+        }
+    }
+
+    free(keys);
+    free(probes);
+    return 0;
+}
@@ -0,0 +1,67 @@
+// bench/bench_search_batch.c
+// Batched lookups against a loop of single searches, on trees from
+// cache-resident to several times the size of the last-level cache
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bplus/tree.h"
+
+#define LOOKUPS (1 << 22)
+#define BATCH 1024
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char* argv[]) {
+    int max_keys = argc > 1 ? atoi(argv[1]) : 32000000;
+    int order = argc > 2 ? atoi(argv[2]) : 64;
+    if (max_keys < 1 || order < 3) {
+        fprintf(stderr, "Usage: %s [max_keys] [order]\n", argv[0]);
+        return 1;
+    }
+
+    int* probes = malloc(sizeof(int) * LOOKUPS);
+    bool* found = malloc(sizeof(bool) * BATCH);
+
+    printf("keys,tree_mb,single_ns,batch_ns,speedup\n");
+    for (int n = 250000; n <= max_keys; n *= 4) {
+        int* sorted = malloc(sizeof(int) * n);
+        for (int i = 0; i < n; i++) {
+            sorted[i] = i * 2;
+        }
+        BPlusTree* tree = bplus_tree_bulk_load(order, sorted, (size_t)n, 0.7);
+        free(sorted);
+
+        unsigned seed = 12345u;
+        for (int i = 0; i < LOOKUPS; i++) {
+            seed = seed * 1103515245u + 12345u;
+            probes[i] = (int)((seed >> 2) % (2u * (unsigned)n));
+        }
+
+        size_t single_hits = 0;
+        double start = now_seconds();
+        for (int i = 0; i < LOOKUPS; i++) {
+            single_hits += bplus_tree_search(tree, probes[i]);
+        }
+        double single = (now_seconds() - start) * 1e9 / LOOKUPS;
+
+        size_t batch_hits = 0;
+        start = now_seconds();
+        for (int i = 0; i < LOOKUPS; i += BATCH) {
+            batch_hits += bplus_tree_search_batch(tree, &probes[i], BATCH, found);
+        }
+        double batch = (now_seconds() - start) * 1e9 / LOOKUPS;
+        if (batch_hits != single_hits) fprintf(stderr, "batch and single searches disagree\n");
+
+        printf("%d,%.1f,%.1f,%.1f,%.2f\n", n, bplus_tree_memory_usage(tree) / 1e6, single, batch,
+               single / batch);
+        bplus_tree_destroy(tree);
+    }
+
+    free(probes);
+    free(found);
+    return 0;
+}
@@ -0,0 +1,603 @@
+// bench/bplus_bench.c
+// Workload suite: loads a tree, then runs YCSB-style mixes of reads,
+// inserts, deletes and short scans against it, for each tree kind and
+// order requested. Every operation is timed on its own, so throughput
+// includes two clock reads per operation. Reports throughput, latency
+// percentiles and the peak bytes held by the tree's nodes (sampled every
+// MEMORY_SAMPLE operations); the process's peak RSS is reported alongside.
+#include <getopt.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "bplus/cursor.h"
+#include "bplus/tree.h"
+#include "bplus/tree_template.h"
+
+#define MAX_SCAN 100
+#define MEMORY_SAMPLE 256
+#define MAX_ORDERS 16
+#define MAX_WORKLOADS 16
+
+BPLUS_DEFINE_TREE(bench_t16, int, 16)
+BPLUS_DEFINE_TREE(bench_t64, int, 64)
+BPLUS_DEFINE_TREE(bench_t256, int, 256)
+
+// ---------------------------------------------------------------------------
+// Trees under test, behind one set of entry points
+
+typedef struct {
+    const char* name;
+    int order;               // 0: any order
+    void* (*create)(int order);
+    void (*destroy)(void* tree);
+    bool (*insert)(void* tree, int key);
+    bool (*remove)(void* tree, int key);
+    bool (*search)(void* tree, int key);
+    size_t (*scan)(void* tree, int key, int* out, size_t n);
+    size_t (*memory)(void* tree);
+} Target;
+
+static void* generic_create(int order) {
+    BPlusTreeOptions options = { .order = order };
+    return bplus_tree_create_with_options(&options);
+}
+
+static void* packed_create(int order) {
+    BPlusTreeOptions options = { .order = order, .flags = BPLUS_TREE_PACKED_LEAVES };
+    return bplus_tree_create_with_options(&options);
+}
+
+static void generic_destroy(void* tree) { bplus_tree_destroy(tree); }
+static bool generic_insert(void* tree, int key) { return bplus_tree_insert(tree, key); }
+static bool generic_remove(void* tree, int key) { return bplus_tree_delete(tree, key); }
+static bool generic_search(void* tree, int key) { return bplus_tree_search(tree, key); }
+static size_t generic_memory(void* tree) { return bplus_tree_memory_usage(tree); }
+
+static size_t generic_scan(void* tree, int key, int* out, size_t n) {
+    BPlusCursor cursor;
+    bplus_cursor_seek(&cursor, tree, key);
+    return bplus_cursor_next_batch(&cursor, out, n);
+}
+
+// The template trees have no cursor; scans descend and follow the leaf chain
+#define BENCH_TEMPLATE(name)                                                                \
+static void* name##_bench_create(int order) { (void)order; return name##_create(); }        \
+static void name##_bench_destroy(void* tree) { name##_destroy(tree); }                      \
+static bool name##_bench_insert(void* tree, int key) { return name##_insert(tree, key); }    \
+static bool name##_bench_remove(void* tree, int key) { return name##_delete(tree, key); }    \
+static bool name##_bench_search(void* tree, int key) { return name##_search(tree, key); }    \
+static size_t name##_bench_scan(void* tree, int key, int* out, size_t n) {                  \
+    const name##_node* node = ((name##_tree*)tree)->root;                                   \
+    while (!node->is_leaf) {                                                                \
+        node = node->children[name##_bound(node, key, true)];                               \
+    }                                                                                       \
+    size_t copied = 0;                                                                      \
+    for (int i = name##_bound(node, key, false); node && copied < n; node = node->next, i = 0) { \
+        for (; i < node->num_keys && copied < n; i++) {                                     \
+            out[copied++] = node->keys[i];                                                  \
+        }                                                                                   \
+    }                                                                                       \
+    return copied;                                                                          \
+}                                                                                           \
+static size_t name##_bench_memory(void* tree) {                                             \
+    name##_tree* t = tree;                                                                  \
+    return t->leaf_pool.in_use * t->leaf_pool.block_size +                                  \
+           t->internal_pool.in_use * t->internal_pool.block_size;                           \
+}
+
+BENCH_TEMPLATE(bench_t16)
+BENCH_TEMPLATE(bench_t64)
+BENCH_TEMPLATE(bench_t256)
+
+#define TEMPLATE_TARGET(name, order)                                                        \
+    { "template", order, name##_bench_create, name##_bench_destroy, name##_bench_insert,     \
+      name##_bench_remove, name##_bench_search, name##_bench_scan, name##_bench_memory }
+
+static const Target targets[] = {
+    { "generic", 0, generic_create, generic_destroy, generic_insert, generic_remove,
+      generic_search, generic_scan, generic_memory },
+    { "packed", 0, packed_create, generic_destroy, generic_insert, generic_remove,
+      generic_search, generic_scan, generic_memory },
+    TEMPLATE_TARGET(bench_t16, 16),
+    TEMPLATE_TARGET(bench_t64, 64),
+    TEMPLATE_TARGET(bench_t256, 256),
+};
+
+static const Target* find_target(const char* name, int order) {
+    for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+        if (strcmp(targets[i].name, name) == 0 && (targets[i].order == 0 || targets[i].order == order)) {
+            return &targets[i];
+        }
+    }
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+// Key distributions
+
+typedef enum { DIST_UNIFORM, DIST_ZIPFIAN, DIST_SEQUENTIAL, DIST_REVERSE } Distribution;
+
+static const char* dist_names[] = { "uniform", "zipfian", "sequential", "reverse" };
+
+static uint64_t next_random(uint64_t* state) {
+    // xorshift64*
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ull;
+}
+
+static double next_unit(uint64_t* state) {
+    return (double)(next_random(state) >> 11) / (double)(1ull << 53);
+}
+
+// Ranks 0..n-1 with rank r drawn in proportion to 1 / (r + 1)^theta, using
+// the method of Gray et al., "Quickly generating billion-record synthetic
+// databases" (as YCSB does)
+typedef struct {
+    uint64_t n;
+    double theta;
+    double alpha;
+    double zetan;
+    double eta;
+} Zipfian;
+
+static void zipfian_init(Zipfian* z, uint64_t n, double theta) {
+    double zeta2 = 1.0 + pow(0.5, theta);
+    z->n = n;
+    z->theta = theta;
+    z->alpha = 1.0 / (1.0 - theta);
+    z->zetan = 0;
+    for (uint64_t i = 1; i <= n; i++) {
+        z->zetan += 1.0 / pow((double)i, theta);
+    }
+    z->eta = (1.0 - pow(2.0 / (double)n, 1.0 - theta)) / (1.0 - zeta2 / z->zetan);
+}
+
+static uint64_t zipfian_next(const Zipfian* z, uint64_t* state) {
+    double u = next_unit(state);
+    double uz = u * z->zetan;
+    if (uz < 1.0) return 0;
+    if (uz < 1.0 + pow(0.5, z->theta)) return 1;
+    uint64_t rank = (uint64_t)((double)z->n * pow(z->eta * u - z->eta + 1.0, z->alpha));
+    return rank < z->n ? rank : z->n - 1;
+}
+
+// Spreads the popular ranks over the key space (FNV-1a)
+static uint64_t scramble(uint64_t rank) {
+    uint64_t hash = 14695981039346656037ull;
+    for (int i = 0; i < 8; i++) {
+        hash ^= (rank >> (i * 8)) & 0xff;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// The tree holds even keys. Between `low` and `high` (exclusive) lies the
+// range the load filled; sequential and reverse writes move its ends, the
+// other distributions draw from it, so about half their keys are present.
+typedef struct {
+    Distribution dist;
+    const Zipfian* zipfian;
+    uint64_t state;
+    long long low;
+    long long high;
+    long long cursor;        // sequential and reverse reads
+} KeySource;
+
+static int draw_key(KeySource* src) {
+    long long span = src->high - src->low;
+    if (span <= 0) return (int)src->low;
+    if (src->dist == DIST_ZIPFIAN) {
+        return (int)(src->low + (long long)(scramble(zipfian_next(src->zipfian, &src->state)) % (uint64_t)span));
+    }
+    if (src->dist == DIST_SEQUENTIAL) {
+        if (src->cursor < src->low || src->cursor >= src->high) src->cursor = src->low;
+        src->cursor += 2;
+        return (int)(src->cursor - 2);
+    }
+    if (src->dist == DIST_REVERSE) {
+        if (src->cursor <= src->low || src->cursor > src->high) src->cursor = src->high;
+        src->cursor -= 2;
+        return (int)src->cursor;
+    }
+    return (int)(src->low + (long long)(next_random(&src->state) % (uint64_t)span));
+}
+
+// Sequential writes insert past the largest key and delete the smallest,
+// like a queue; reverse writes do the opposite
+static int insert_key(KeySource* src) {
+    if (src->dist == DIST_SEQUENTIAL) return (int)((src->high += 2) - 2);
+    if (src->dist == DIST_REVERSE) return (int)(src->low -= 2);
+    return draw_key(src);
+}
+
+static int delete_key(KeySource* src) {
+    if (src->dist == DIST_SEQUENTIAL) return (int)((src->low += 2) - 2);
+    if (src->dist == DIST_REVERSE) return (int)(src->high -= 2);
+    return draw_key(src);
+}
+
+// ---------------------------------------------------------------------------
+// Workloads
+
+typedef struct {
+    char name[32];
+    int read;                // percentages of the operations
+    int insert;
+    int remove;
+    int scan;
+    bool latest;             // inserts append and reads favour the newest keys
+} Workload;
+
+// A key-only tree has no update, so YCSB's updates become an insert and a
+// delete, which also keeps the tree's size steady
+static const Workload named_workloads[] = {
+    { "a", 50, 25, 25, 0, false },    // update heavy
+    { "b", 95, 3, 2, 0, false },      // read mostly
+    { "c", 100, 0, 0, 0, false },     // read only
+    { "d", 95, 5, 0, 0, true },       // read latest
+    { "e", 0, 5, 0, 95, false },      // short ranges
+    { "w", 0, 50, 50, 0, false },     // write only
+};
+
+static bool parse_workload(const char* text, Workload* out) {
+    for (size_t i = 0; i < sizeof(named_workloads) / sizeof(named_workloads[0]); i++) {
+        if (strcmp(named_workloads[i].name, text) == 0) {
+            *out = named_workloads[i];
+            return true;
+        }
+    }
+    // read:insert:delete:scan
+    Workload w = { .latest = false };
+    if (sscanf(text, "%d:%d:%d:%d", &w.read, &w.insert, &w.remove, &w.scan) != 4 ||
+        w.read < 0 || w.insert < 0 || w.remove < 0 || w.scan < 0 ||
+        w.read + w.insert + w.remove + w.scan != 100) {
+        return false;
+    }
+    snprintf(w.name, sizeof(w.name), "%s", text);
+    *out = w;
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Measurement
+
+typedef struct {
+    const char* tree;
+    int order;
+    const char* dist;
+    const char* workload;
+    size_t ops;
+    double seconds;
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;
+    uint64_t max;
+    size_t peak_bytes;
+    long peak_rss_kb;
+} Result;
+
+typedef enum { FORMAT_TEXT, FORMAT_CSV, FORMAT_JSON } Format;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int compare_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Nearest-rank percentile of sorted samples
+static uint64_t percentile(const uint32_t* sorted, size_t n, double q) {
+    size_t rank = (size_t)ceil(q * (double)n);
+    return sorted[rank ? rank - 1 : 0];
+}
+
+static void finish_result(Result* result, uint32_t* latencies, size_t n, uint64_t elapsed) {
+    qsort(latencies, n, sizeof(uint32_t), compare_u32);
+    result->ops = n;
+    result->seconds = (double)elapsed / 1e9;
+    result->p50 = percentile(latencies, n, 0.50);
+    result->p99 = percentile(latencies, n, 0.99);
+    result->p999 = percentile(latencies, n, 0.999);
+    result->max = latencies[n - 1];
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    result->peak_rss_kb = usage.ru_maxrss;
+}
+
+static uint32_t clamp_ns(uint64_t ns) {
+    return ns > UINT32_MAX ? UINT32_MAX : (uint32_t)ns;
+}
+
+// Inserts the keys 0, 2, ..., 2(n-1) in the distribution's order: shuffled
+// unless sequential or reverse
+static void run_load(const Target* target, void* tree, KeySource* src, size_t n,
+                     int* keys, uint32_t* latencies, Result* result) {
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = (int)(src->dist == DIST_REVERSE ? (n - 1 - i) * 2 : i * 2);
+    }
+    if (src->dist == DIST_UNIFORM || src->dist == DIST_ZIPFIAN) {
+        for (size_t i = n - 1; i > 0; i--) {
+            size_t j = (size_t)(next_random(&src->state) % (i + 1));
+            int t = keys[i];
+            keys[i] = keys[j];
+            keys[j] = t;
+        }
+    }
+
+    size_t peak = 0;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < n; i++) {
+        uint64_t before = now_ns();
+        target->insert(tree, keys[i]);
+        latencies[i] = clamp_ns(now_ns() - before);
+        if (i % MEMORY_SAMPLE == 0) {
+            size_t bytes = target->memory(tree);
+            if (bytes > peak) peak = bytes;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    size_t bytes = target->memory(tree);
+    result->peak_bytes = bytes > peak ? bytes : peak;
+    src->low = 0;
+    src->high = (long long)n * 2;
+    finish_result(result, latencies, n, elapsed);
+}
+
+static long long sink;
+
+static void run_workload(const Target* target, void* tree, KeySource* src, const Workload* w,
+                         size_t ops, uint32_t* latencies, Result* result) {
+    int buffer[MAX_SCAN];
+    size_t peak = 0;
+    uint64_t start = now_ns();
+    for (size_t i = 0; i < ops; i++) {
+        int dice = (int)(next_random(&src->state) % 100);
+        uint64_t before;
+        if (dice < w->read) {
+            int key;
+            if (w->latest) {
+                uint64_t back = zipfian_next(src->zipfian, &src->state);
+                key = (int)(src->high - 2 - 2 * (long long)back);
+            } else {
+                key = draw_key(src);
+            }
+            before = now_ns();
+            sink += target->search(tree, key);
+        } else if (dice < w->read + w->insert) {
+            int key = w->latest ? (int)((src->high += 2) - 2) : insert_key(src);
+            before = now_ns();
+            sink += target->insert(tree, key);
+        } else if (dice < w->read + w->insert + w->remove) {
+            int key = delete_key(src);
+            before = now_ns();
+            sink += target->remove(tree, key);
+        } else {
+            int key = draw_key(src);
+            size_t length = 1 + (size_t)(next_random(&src->state) % MAX_SCAN);
+            before = now_ns();
+            sink += (long long)target->scan(tree, key, buffer, length);
+        }
+        latencies[i] = clamp_ns(now_ns() - before);
+        if (i % MEMORY_SAMPLE == 0) {
+            size_t bytes = target->memory(tree);
+            if (bytes > peak) peak = bytes;
+        }
+    }
+    uint64_t elapsed = now_ns() - start;
+    size_t bytes = target->memory(tree);
+    result->peak_bytes = bytes > peak ? bytes : peak;
+    finish_result(result, latencies, ops, elapsed);
+}
+
+// ---------------------------------------------------------------------------
+// Reporting
+
+static void print_header(Format format) {
+    if (format == FORMAT_CSV) {
+        printf("tree,order,dist,workload,ops,seconds,ops_per_sec,p50_ns,p99_ns,p999_ns,max_ns,"
+               "peak_tree_bytes,peak_rss_kb\n");
+    } else if (format == FORMAT_JSON) {
+        printf("[");
+    } else {
+        printf("%-9s %5s %-10s %-12s %10s %9s %8s %8s %8s %10s %10s\n", "tree", "order", "dist",
+               "workload", "ops", "Mops/s", "p50 ns", "p99 ns", "p999 ns", "tree MiB", "RSS MiB");
+    }
+}
+
+static void print_result(Format format, const Result* r, bool first) {
+    double rate = r->seconds > 0 ? (double)r->ops / r->seconds : 0;
+    if (format == FORMAT_CSV) {
+        printf("%s,%d,%s,%s,%zu,%.6f,%.0f,%llu,%llu,%llu,%llu,%zu,%ld\n", r->tree, r->order, r->dist,
+               r->workload, r->ops, r->seconds, rate, (unsigned long long)r->p50,
+               (unsigned long long)r->p99, (unsigned long long)r->p999, (unsigned long long)r->max,
+               r->peak_bytes, r->peak_rss_kb);
+    } else if (format == FORMAT_JSON) {
+        printf("%s\n  {\"tree\": \"%s\", \"order\": %d, \"dist\": \"%s\", \"workload\": \"%s\", "
+               "\"ops\": %zu, \"seconds\": %.6f, \"ops_per_sec\": %.0f, \"p50_ns\": %llu, "
+               "\"p99_ns\": %llu, \"p999_ns\": %llu, \"max_ns\": %llu, \"peak_tree_bytes\": %zu, "
+               "\"peak_rss_kb\": %ld}",
+               first ? "" : ",", r->tree, r->order, r->dist, r->workload, r->ops, r->seconds, rate,
+               (unsigned long long)r->p50, (unsigned long long)r->p99, (unsigned long long)r->p999,
+               (unsigned long long)r->max, r->peak_bytes, r->peak_rss_kb);
+    } else {
+        printf("%-9s %5d %-10s %-12s %10zu %9.2f %8llu %8llu %8llu %10.1f %10.1f\n", r->tree,
+               r->order, r->dist, r->workload, r->ops, rate / 1e6, (unsigned long long)r->p50,
+               (unsigned long long)r->p99, (unsigned long long)r->p999,
+               r->peak_bytes / 1048576.0, r->peak_rss_kb / 1024.0);
+    }
+    fflush(stdout);
+}
+
+static void print_footer(Format format, bool empty) {
+    if (format == FORMAT_JSON) {
+        printf(empty ? "]\n" : "\n]\n");
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+static void usage(const char* program) {
+    fprintf(stderr,
+            "Usage: %s [options]\n"
+            "  -n, --keys N          keys loaded before the workloads (default 1000000)\n"
+            "  -o, --ops N           operations per workload (default 1000000)\n"
+            "  -O, --order LIST      comma-separated orders (default 64)\n"
+            "      --sweep           orders 8,16,32,64,128,256\n"
+            "  -t, --tree LIST       generic, packed, template (default generic);\n"
+            "                        template trees exist for orders 16, 64 and 256\n"
+            "  -d, --dist NAME       uniform, zipfian, sequential or reverse (default uniform)\n"
+            "      --theta X         Zipfian skew, between 0 and 1 (default 0.99)\n"
+            "  -w, --workload LIST   workloads run after the load (default a,b,c,d,e):\n"
+            "                        a 50%% read, 25%% insert, 25%% delete\n"
+            "                        b 95%% read, 3%% insert, 2%% delete\n"
+            "                        c reads only\n"
+            "                        d 95%% read of recent keys, 5%% appends\n"
+            "                        e 95%% scans of 1-%d keys, 5%% insert\n"
+            "                        w 50%% insert, 50%% delete\n"
+            "                        R:I:D:S read, insert, delete and scan percentages\n"
+            "  -f, --format NAME     text, csv or json (default text)\n"
+            "  -s, --seed N          random seed (default 42)\n",
+            program, MAX_SCAN);
+}
+
+static int parse_orders(const char* text, int* orders) {
+    int count = 0;
+    while (*text && count < MAX_ORDERS) {
+        char* end;
+        long order = strtol(text, &end, 10);
+        if (end == text || order < 3 || order > 4096) return 0;
+        orders[count++] = (int)order;
+        if (*end != ',' && *end != '\0') return 0;
+        text = *end ? end + 1 : end;
+    }
+    return count;
+}
+
+int main(int argc, char* argv[]) {
+    size_t keys = 1000000;
+    size_t ops = 1000000;
+    int orders[MAX_ORDERS] = { 64 };
+    int order_count = 1;
+    char trees[256] = "generic";
+    Distribution dist = DIST_UNIFORM;
+    double theta = 0.99;
+    char workload_list[256] = "a,b,c,d,e";
+    Format format = FORMAT_TEXT;
+    uint64_t seed = 42;
+
+    static const struct option long_options[] = {
+        { "keys", required_argument, NULL, 'n' },
+        { "ops", required_argument, NULL, 'o' },
+        { "order", required_argument, NULL, 'O' },
+        { "sweep", no_argument, NULL, 'S' },
+        { "tree", required_argument, NULL, 't' },
+        { "dist", required_argument, NULL, 'd' },
+        { "theta", required_argument, NULL, 'z' },
+        { "workload", required_argument, NULL, 'w' },
+        { "format", required_argument, NULL, 'f' },
+        { "seed", required_argument, NULL, 's' },
+        { "help", no_argument, NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:o:O:t:d:w:f:s:h", long_options, NULL)) != -1) {
+        bool ok = true;
+        switch (opt) {
+        case 'n': keys = strtoull(optarg, NULL, 10); ok = keys > 0 && keys < INT32_MAX / 4; break;
+        case 'o': ops = strtoull(optarg, NULL, 10); ok = ops > 0 && ops < INT32_MAX / 4; break;
+        case 'O': order_count = parse_orders(optarg, orders); ok = order_count > 0; break;
+        case 'S': order_count = parse_orders("8,16,32,64,128,256", orders); break;
+        case 't': ok = strlen(optarg) < sizeof(trees); if (ok) strcpy(trees, optarg); break;
+        case 'z': theta = strtod(optarg, NULL); ok = theta > 0 && theta < 1; break;
+        case 'w': ok = strlen(optarg) < sizeof(workload_list); if (ok) strcpy(workload_list, optarg); break;
+        case 's': seed = strtoull(optarg, NULL, 10); break;
+        case 'd':
+            ok = false;
+            for (int i = 0; i < 4; i++) {
+                if (strcmp(optarg, dist_names[i]) == 0) {
+                    dist = (Distribution)i;
+                    ok = true;
+                }
+            }
+            break;
+        case 'f':
+            ok = true;
+            if (strcmp(optarg, "csv") == 0) format = FORMAT_CSV;
+            else if (strcmp(optarg, "json") == 0) format = FORMAT_JSON;
+            else if (strcmp(optarg, "text") == 0) format = FORMAT_TEXT;
+            else ok = false;
+            break;
+        default: ok = false; break;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    Workload workloads[MAX_WORKLOADS];
+    int workload_count = 0;
+    for (char* name = strtok(workload_list, ","); name; name = strtok(NULL, ",")) {
+        if (workload_count == MAX_WORKLOADS || !parse_workload(name, &workloads[workload_count++])) {
+            fprintf(stderr, "Unknown workload: %s\n", name);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Ranks for Zipfian keys span the loaded range; for read-latest they
+    // count back from the newest key
+    Zipfian zipfian;
+    zipfian_init(&zipfian, keys * 2, theta);
+
+    size_t samples = keys > ops ? keys : ops;
+    int* load_keys = malloc(sizeof(int) * keys);
+    uint32_t* latencies = malloc(sizeof(uint32_t) * samples);
+    if (!load_keys || !latencies) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    print_header(format);
+    bool first = true;
+    for (char* tree_name = strtok(trees, ","); tree_name; tree_name = strtok(NULL, ",")) {
+        for (int o = 0; o < order_count; o++) {
+            const Target* target = find_target(tree_name, orders[o]);
+            if (!target) {
+                fprintf(stderr, "No %s tree of order %d; skipped\n", tree_name, orders[o]);
+                continue;
+            }
+            void* tree = target->create(orders[o]);
+            KeySource src = { dist, &zipfian, seed * 2654435761ull + 1, 0, 0, 0 };
+
+            Result result = { .tree = tree_name, .order = orders[o], .dist = dist_names[dist], .workload = "load" };
+            run_load(target, tree, &src, keys, load_keys, latencies, &result);
+            print_result(format, &result, first);
+            first = false;
+
+            for (int w = 0; w < workload_count; w++) {
+                result = (Result){ .tree = tree_name, .order = orders[o], .dist = dist_names[dist],
+                                   .workload = workloads[w].name };
+                run_workload(target, tree, &src, &workloads[w], ops, latencies, &result);
+                print_result(format, &result, false);
+            }
+            target->destroy(tree);
+        }
+    }
+    print_footer(format, first);
+
+    free(load_keys);
+    free(latencies);
+    return sink == -1;
+}
@@ -0,0 +1,9 @@
+// examples/web_usage.c
+// Serves a tree and the visualization in web/static; run it from the
+// repository root and open http://localhost:8080/
+#include "bplus/web.h"
+
+int main(int argc, char* argv[]) {
+    start_web_server(argc > 1 ? argv[1] : "8080");
+    return 1;
+}
@@ -0,0 +1,71 @@
+// include/bplus/buffer_pool.h
+#ifndef BPLUS_BUFFER_POOL_H
+#define BPLUS_BUFFER_POOL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pager.h"
+
+// Usage count ceiling for the CLOCK sweep
+#define BPLUS_CLOCK_MAX_USAGE 5
+
+// CLOCK sweeps over usage counts: each pin raises a frame's count up to
+// BPLUS_CLOCK_MAX_USAGE, and the hand lowers counts until it finds an
+// unpinned frame at zero. It is cheap but only protects pages touched
+// more often than the hand comes round.
+//
+// LRU-2 evicts the page whose second most recent pin is oldest, and pages
+// pinned only once before all others. A tree's upper levels are pinned
+// again long before any leaf is, so they stay resident even when each of
+// their pages is touched only every few dozen operations.
+typedef enum {
+    BPLUS_EVICT_CLOCK,
+    BPLUS_EVICT_LRU2
+} BPlusEvictionPolicy;
+
+typedef struct {
+    BPlusPageId page_id;     // BPLUS_NO_PAGE while the frame is empty
+    uint8_t* data;
+    int pin_count;
+    int usage;               // CLOCK: bumped on every pin, decayed by the sweep
+    uint64_t history[2];     // LRU-2: last and previous pin times, 0 if none
+    bool dirty;
+} BPlusFrame;
+
+// A fixed set of page frames in front of a pager. Pages are pinned while
+// in use and written back when a dirty frame is evicted or flushed.
+typedef struct {
+    BPlusPager* pager;
+    BPlusEvictionPolicy policy;
+    BPlusFrame* frames;
+    size_t frame_count;
+    uint8_t* memory;
+    int32_t* table;          // page id -> frame, open addressing
+    size_t table_mask;
+    size_t clock_hand;
+    uint64_t tick;           // pin counter that timestamps LRU-2 history
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t write_backs;
+} BPlusBufferPool;
+
+BPlusBufferPool* bplus_buffer_pool_create(BPlusPager* pager, size_t frame_count,
+                                          BPlusEvictionPolicy policy);
+// Flushes dirty pages, then frees the pool; the pager stays open
+bool bplus_buffer_pool_destroy(BPlusBufferPool* pool);
+
+// Returns the page's data, reading it on a miss. Returns NULL if every
+// frame is pinned or the read fails.
+uint8_t* bplus_buffer_pool_pin(BPlusBufferPool* pool, BPlusPageId id);
+// Like pin, for a freshly allocated page: the frame is zeroed, not read
+uint8_t* bplus_buffer_pool_pin_new(BPlusBufferPool* pool, BPlusPageId id);
+void bplus_buffer_pool_unpin(BPlusBufferPool* pool, BPlusPageId id, bool dirty);
+
+// Drops a page without writing it back, for pages being freed
+void bplus_buffer_pool_discard(BPlusBufferPool* pool, BPlusPageId id);
+// Writes every dirty page; frames stay cached
+bool bplus_buffer_pool_flush(BPlusBufferPool* pool);
+
+#endif // BPLUS_BUFFER_POOL_H
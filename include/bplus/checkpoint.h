@@ -0,0 +1,36 @@
+// include/bplus/checkpoint.h
+#ifndef BPLUS_CHECKPOINT_H
+#define BPLUS_CHECKPOINT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tree.h"
+
+// Incremental checkpoints. A checkpoint file holds a full image of the
+// tree followed by a chain of deltas. A delta appends only the nodes
+// changed since the previous checkpoint, then a root record that commits
+// it. Nodes keep their ids from one checkpoint to the next, so unchanged
+// nodes are never written again. Loading keeps the newest image of each
+// node up to the last root record and drops a torn delta after it.
+typedef struct {
+    uint32_t deltas;         // deltas chained after the full image
+    uint64_t nodes_written;
+    uint64_t file_bytes;
+} BPlusCheckpointStats;
+
+// The first checkpoint of a tree to a path writes a full image through a
+// temporary file and a rename; later ones append a delta. Concurrent trees
+// are not supported. `stats` may be NULL.
+bool bplus_tree_checkpoint(BPlusTree* tree, const char* path, BPlusCheckpointStats* stats);
+
+// Loads the newest committed tree. Checkpoints of the loaded tree to the
+// same path append to its chain. Returns NULL if the file is missing or
+// holds no committed tree.
+BPlusTree* bplus_checkpoint_load(const char* path);
+
+// Folds the chain into a full image of its newest tree. This works on the
+// file alone, so it can run on another thread while the tree is in use;
+// a checkpoint that overlaps it waits for it under a file lock.
+bool bplus_checkpoint_compact(const char* path, BPlusCheckpointStats* stats);
+
+#endif // BPLUS_CHECKPOINT_H
@@ -0,0 +1,13 @@
+// include/bplus/checksum.h
+#ifndef BPLUS_CHECKSUM_H
+#define BPLUS_CHECKSUM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32C (Castagnoli). Pass 0 to start a new checksum, or a previous
+// result to extend it over more data. Uses the SSE4.2 crc32 instruction
+// when the CPU has it and a table-driven loop otherwise.
+uint32_t bplus_crc32c(uint32_t crc, const void* data, size_t len);
+
+#endif // BPLUS_CHECKSUM_H
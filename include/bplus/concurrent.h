@@ -0,0 +1,27 @@
+// include/bplus/concurrent.h
+#ifndef BPLUS_CONCURRENT_H
+#define BPLUS_CONCURRENT_H
+
+#include <stddef.h>
+#include "tree.h"
+
+// Threads that may be inside one concurrent tree at the same time
+#define BPLUS_MAX_THREADS 128
+
+// Creates a tree whose bplus_tree_search, bplus_tree_insert and
+// bplus_tree_delete may be called from many threads at once. Readers
+// traverse optimistically and restart when a node's version changes under
+// them; writers lock only the nodes they modify. Nodes freed by merges are
+// reclaimed once every thread that could still see them has left the tree.
+//
+// In this mode inserts reject duplicate keys, and deletes rebalance leaves
+// with their siblings but never merge internal nodes, which may therefore
+// drop below minimum occupancy. All other operations (cursors, batches,
+// printing, persistence) still require exclusive access.
+BPlusTree* bplus_tree_create_concurrent(int order);
+
+// Frees retired nodes that no thread can reach any more; returns how many.
+// Nodes are also reclaimed automatically as they accumulate.
+size_t bplus_tree_reclaim(BPlusTree* tree);
+
+#endif // BPLUS_CONCURRENT_H
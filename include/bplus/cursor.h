@@ -0,0 +1,31 @@
+// include/bplus/cursor.h
+#ifndef BPLUS_CURSOR_H
+#define BPLUS_CURSOR_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "tree.h"
+
+// A cursor sits between two keys of the leaf chain. next() returns the key
+// after the position and moves past it; prev() moves back over the key
+// before the position and returns it. Cursors allocate nothing and are
+// invalidated by any modification of the tree.
+typedef struct {
+    BPlusNode* leaf;
+    int index;
+} BPlusCursor;
+
+// Position before the smallest key >= key
+void bplus_cursor_seek(BPlusCursor* cursor, BPlusTree* tree, int key);
+// Position after the largest key <= key
+void bplus_cursor_seek_upper(BPlusCursor* cursor, BPlusTree* tree, int key);
+// Position before the first key / after the last key
+void bplus_cursor_first(BPlusCursor* cursor, BPlusTree* tree);
+void bplus_cursor_last(BPlusCursor* cursor, BPlusTree* tree);
+
+bool bplus_cursor_next(BPlusCursor* cursor, int* key);
+bool bplus_cursor_prev(BPlusCursor* cursor, int* key);
+// Copies up to n keys forward into buf; returns how many were copied
+size_t bplus_cursor_next_batch(BPlusCursor* cursor, int* buf, size_t n);
+
+#endif // BPLUS_CURSOR_H
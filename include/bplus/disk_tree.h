@@ -0,0 +1,55 @@
+// include/bplus/disk_tree.h
+#ifndef BPLUS_DISK_TREE_H
+#define BPLUS_DISK_TREE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "buffer_pool.h"
+#include "pager.h"
+
+// Deepest tree a root-to-leaf path may span
+#define BPLUS_DISK_MAX_HEIGHT 16
+// Page frames cached when the caller does not choose
+#define BPLUS_DISK_DEFAULT_FRAMES 256
+
+// A disk-resident B+ tree: every node is one page of a page file and
+// children are page ids. Fan-out follows from the page size, separately
+// for leaves (keys only) and internal pages (keys and child ids). Lookups,
+// inserts and deletes touch only the pages on the root-to-leaf path, plus
+// the pages a split creates. Pages are cached in a buffer pool and written
+// back on eviction or sync. Leaves are chained left to right.
+//
+// Deletes do not rebalance: pages may run below half full, and a leaf that
+// empties is unlinked and returned to the free list.
+typedef struct {
+    BPlusPager* pager;
+    BPlusBufferPool* pool;
+    int leaf_capacity;       // keys per leaf page
+    int internal_capacity;   // keys per internal page
+    uint8_t* scratch;        // split buffer
+} BPlusDiskTree;
+
+typedef bool (*BPlusDiskVisitor)(int key, void* ctx);
+
+// Opens or creates a tree file; page_size is used only when creating it
+// (0 picks BPLUS_PAGE_SIZE). cache_frames bounds the buffer pool (0 picks
+// BPLUS_DISK_DEFAULT_FRAMES); it is raised to what one operation may pin.
+BPlusDiskTree* bplus_disk_tree_open(const char* path, uint32_t page_size, size_t cache_frames);
+bool bplus_disk_tree_close(BPlusDiskTree* tree);
+// Writes dirty pages and the file header so the file is consistent on disk
+bool bplus_disk_tree_sync(BPlusDiskTree* tree);
+
+bool bplus_disk_tree_insert(BPlusDiskTree* tree, int key);
+bool bplus_disk_tree_delete(BPlusDiskTree* tree, int key);
+bool bplus_disk_tree_search(BPlusDiskTree* tree, int key);
+// Calls visit for each key in [start_key, end_key] in ascending order until
+// it returns false; returns the number of keys visited
+size_t bplus_disk_tree_scan(BPlusDiskTree* tree, int start_key, int end_key,
+                            BPlusDiskVisitor visit, void* ctx);
+
+uint64_t bplus_disk_tree_count(const BPlusDiskTree* tree);
+// Checks key order, separator bounds and the leaf chain
+bool bplus_disk_tree_validate(BPlusDiskTree* tree);
+
+#endif // BPLUS_DISK_TREE_H
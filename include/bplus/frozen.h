@@ -0,0 +1,42 @@
+// include/bplus/frozen.h
+#ifndef BPLUS_FROZEN_H
+#define BPLUS_FROZEN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "tree.h"
+
+// Read-only, pointer-free copy of a tree for data that is loaded once and
+// then only searched. All keys sit in one sorted array, cut into blocks of
+// BPLUS_FROZEN_NODE_KEYS keys (one cache line each). Above them is a
+// CSS-tree: every internal node is one cache line of separators with
+// BPLUS_FROZEN_NODE_KEYS + 1 implicit children, and each level is stored
+// contiguously after the one above it in a single array. The children of
+// node k are nodes 17k .. 17k + 16 of the next level, so a lookup computes
+// every address instead of loading a pointer, and touches one line per
+// level.
+#define BPLUS_FROZEN_NODE_KEYS 16
+#define BPLUS_FROZEN_MAX_LEVELS 16
+
+typedef struct {
+    int* keys;               // sorted, padded with INT_MAX to a whole block
+    size_t count;            // keys without the padding
+    int* index;              // internal nodes, root level first
+    int levels;              // internal levels; 0 when there is one block
+    size_t level_start[BPLUS_FROZEN_MAX_LEVELS];  // first node of each level
+    size_t level_nodes[BPLUS_FROZEN_MAX_LEVELS + 1];  // the last entry counts leaf blocks
+} BPlusFrozenTree;
+
+// Copies the keys of `tree` into a frozen layout; the tree is not changed
+// and can be destroyed afterwards. Returns NULL on allocation failure.
+BPlusFrozenTree* bplus_tree_freeze(BPlusTree* tree);
+void bplus_frozen_tree_destroy(BPlusFrozenTree* frozen);
+
+bool bplus_frozen_tree_search(const BPlusFrozenTree* frozen, int key);
+// Number of keys < key, which is also the index in `keys` of the first
+// key >= key; range queries are two ranks and a walk over `keys`
+size_t bplus_frozen_tree_rank(const BPlusFrozenTree* frozen, int key);
+// Bytes held by the keys and the index
+size_t bplus_frozen_tree_memory_usage(const BPlusFrozenTree* frozen);
+
+#endif // BPLUS_FROZEN_H
@@ -0,0 +1,56 @@
+// include/bplus/journal.h
+#ifndef BPLUS_JOURNAL_H
+#define BPLUS_JOURNAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "tree.h"
+
+// A record of which nodes the tree's writes touch, for keeping a copy of
+// the tree's shape (a visualization, say) up to date without fetching it
+// again. While a journal is kept every node has an id, which stays the
+// same for as long as the node is in the tree, including across the
+// copies snapshots make of it, and is never handed out again. Each change
+// gets the next version; only the node is recorded, so a reader takes the
+// current contents of the nodes named since its last version and drops
+// those that were removed.
+//
+// One write records several changes: a split, for instance, records the
+// node split, the new node and the parent gaining a key. The journal holds
+// the latest `capacity` changes. Trees in concurrent mode cannot keep one.
+typedef enum {
+    BPLUS_CHANGE_CREATED,
+    BPLUS_CHANGE_KEYS,       // keys or children changed
+    BPLUS_CHANGE_SPLIT,      // gave its upper half to a new node
+    BPLUS_CHANGE_MERGED,     // took in the keys of a neighbour being removed
+    BPLUS_CHANGE_REMOVED
+} BPlusChangeKind;
+
+typedef struct {
+    uint64_t version;
+    uint32_t node;
+    BPlusChangeKind kind;
+} BPlusChange;
+
+// Starts a journal, giving ids to the nodes already in the tree; false if
+// one is kept already, capacity is 0 or the tree is concurrent
+bool bplus_tree_journal_start(BPlusTree* tree, size_t capacity);
+void bplus_tree_journal_stop(BPlusTree* tree);
+
+// The version of the latest change, 0 before the first
+uint64_t bplus_tree_journal_version(const BPlusTree* tree);
+// The oldest version still held; every change after `since` is held if
+// since + 1 >= oldest
+uint64_t bplus_tree_journal_oldest(const BPlusTree* tree);
+// False unless `version` is held
+bool bplus_tree_journal_get(const BPlusTree* tree, uint64_t version, BPlusChange* out);
+
+// A node's id, 0 without a journal; and the node in the tree with an id,
+// NULL if it was removed
+uint32_t bplus_tree_node_id(const BPlusTree* tree, const BPlusNode* node);
+BPlusNode* bplus_tree_node_by_id(const BPlusTree* tree, uint32_t id);
+
+const char* bplus_change_kind_name(BPlusChangeKind kind);
+
+#endif // BPLUS_JOURNAL_H
@@ -0,0 +1,62 @@
+// include/bplus/json.h
+#ifndef BPLUS_JSON_H
+#define BPLUS_JSON_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "snapshot.h"
+#include "tree.h"
+
+// Serializes a tree as JSON a buffer at a time. The writer walks the
+// nodes with an explicit stack and keeps only the token it is part way
+// through, so a dump of any size needs a fixed amount of memory and can be
+// sent as it is produced:
+//
+//   {"order":4,"leaf_order":4,"height":2,
+//    "root":{"leaf":false,"keys":[5],"children":[
+//      {"leaf":true,"keys":[1,3]},{"leaf":true,"keys":[5,7,9]}]},
+//    "nodes":3,"truncated":false}
+//
+// Subtrees beyond the limits are written as null and set "truncated".
+// A writer over a live tree needs the tree left unmodified until it is
+// done; one over a snapshot does not (snapshot.h).
+#define BPLUS_JSON_MAX_HEIGHT 64
+
+typedef struct {
+    int max_depth;           // levels written, 0 for all
+    size_t max_nodes;        // nodes written, 0 for all
+} BPlusJsonLimits;
+
+// Everything below is private to json.c
+typedef struct {
+    const BPlusNode* node;
+    int index;
+    int phase;
+    bool first;
+} BPlusJsonFrame;
+
+typedef struct {
+    const BPlusTree* tree;
+    const BPlusNode* root;
+    BPlusJsonLimits limits;
+    BPlusJsonFrame stack[BPLUS_JSON_MAX_HEIGHT];
+    int depth;
+    int stage;
+    size_t nodes;            // nodes written so far
+    bool truncated;
+    char pending[128];       // the token being copied out
+    size_t pending_len;
+    size_t pending_pos;
+} BPlusJsonWriter;
+
+// limits may be NULL for none
+void bplus_json_writer_init(BPlusJsonWriter* writer, const BPlusTree* tree,
+                            const BPlusJsonLimits* limits);
+void bplus_json_writer_init_snapshot(BPlusJsonWriter* writer, const BPlusSnapshot* snapshot,
+                                     const BPlusJsonLimits* limits);
+
+// Fills buf with up to cap bytes of the document, not NUL-terminated;
+// returns how many, which is 0 once the document is complete
+size_t bplus_json_writer_read(BPlusJsonWriter* writer, char* buf, size_t cap);
+
+#endif // BPLUS_JSON_H
@@ -0,0 +1,63 @@
+// include/bplus/mapped.h
+#ifndef BPLUS_MAPPED_H
+#define BPLUS_MAPPED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "tree.h"
+
+// Read-only tree image served straight from a memory mapping. Nodes are
+// addressed by byte offsets from the start of the file, so the image is
+// position-independent and nothing is deserialized on open. Internal
+// nodes come first in breadth-first order, which packs the levels every
+// lookup touches into a few pages at the front. Leaves follow in key
+// order, so a range scan reads the file sequentially.
+//
+// Node record: int32 num_keys, uint32 is_leaf, the keys, then for
+// internal nodes padding to 8 bytes and num_keys + 1 uint64 child offsets.
+typedef struct {
+    char magic[8];
+    uint32_t format;
+    uint32_t header_crc;     // CRC-32C of this header with header_crc zero
+    uint32_t body_crc;       // CRC-32C of everything after the header
+    uint32_t height;         // levels below the root; 0 when it is a leaf
+    int32_t order;
+    int32_t leaf_order;      // 0 in images of trees with a single order
+    uint64_t file_size;
+    uint64_t key_count;
+    uint64_t root;           // offset of the root node
+    uint64_t first_leaf;     // offset of the leftmost leaf
+} BPlusMappedHeader;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    const BPlusMappedHeader* header;
+} BPlusMappedTree;
+
+typedef bool (*BPlusMappedVisitor)(int key, void* ctx);
+
+// Writes the tree as a mapped image through a synced temporary file and
+// an atomic rename
+bool bplus_mapped_tree_write(BPlusTree* tree, const char* path);
+
+// Maps an image. Only the header and its checksum are checked here, so
+// opening takes the same time for any size; every offset is bounds-checked
+// as it is followed, so a damaged body cannot make a lookup read outside
+// the mapping. Returns NULL if the file is missing, not an image, or not
+// as long as its header says.
+BPlusMappedTree* bplus_mapped_tree_open(const char* path);
+void bplus_mapped_tree_close(BPlusMappedTree* tree);
+// Checks the body checksum, which reads the whole file. This can run on
+// another thread while the image is already serving lookups.
+bool bplus_mapped_tree_verify(const BPlusMappedTree* tree);
+
+bool bplus_mapped_tree_search(const BPlusMappedTree* tree, int key);
+// Calls visit for each key in [start_key, end_key] in ascending order until
+// it returns false; returns the number of keys visited
+size_t bplus_mapped_tree_scan(const BPlusMappedTree* tree, int start_key, int end_key,
+                              BPlusMappedVisitor visit, void* ctx);
+uint64_t bplus_mapped_tree_count(const BPlusMappedTree* tree);
+
+#endif // BPLUS_MAPPED_H
@@ -0,0 +1,56 @@
+// include/bplus/pager.h
+#ifndef BPLUS_PAGER_H
+#define BPLUS_PAGER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define BPLUS_PAGE_SIZE 4096
+#define BPLUS_MIN_PAGE_SIZE 128
+#define BPLUS_MAX_PAGE_SIZE 65536
+
+typedef uint32_t BPlusPageId;
+
+// Page 0 holds the file header, so no other page ever has id 0
+#define BPLUS_NO_PAGE 0
+
+// Contents of page 0. The pager owns the page accounting; `root`,
+// `height` and `key_count` belong to the tree stored in the file.
+typedef struct {
+    char magic[8];
+    uint32_t format;
+    uint32_t page_size;
+    uint32_t page_count;     // pages in the file, header page included
+    BPlusPageId free_head;   // first page of the free list
+    BPlusPageId root;
+    uint32_t height;         // levels below the root; 0 when it is a leaf
+    uint64_t key_count;
+} BPlusFileHeader;
+
+// A file of fixed-size pages. Freed pages are chained through their first
+// bytes and handed out again before the file grows.
+typedef struct {
+    int fd;
+    BPlusFileHeader header;
+    bool header_dirty;
+    uint64_t reads;
+    uint64_t writes;
+} BPlusPager;
+
+// Opens an existing page file, or creates one with the given page size
+// (0 picks BPLUS_PAGE_SIZE). Returns NULL on I/O errors, on a file that is
+// not a page file, or on a page size that is not a power of two in
+// [BPLUS_MIN_PAGE_SIZE, BPLUS_MAX_PAGE_SIZE].
+BPlusPager* bplus_pager_open(const char* path, uint32_t page_size);
+// Writes the header if it changed and closes the file
+bool bplus_pager_close(BPlusPager* pager);
+bool bplus_pager_sync(BPlusPager* pager);
+
+bool bplus_pager_read(BPlusPager* pager, BPlusPageId id, void* buf);
+bool bplus_pager_write(BPlusPager* pager, BPlusPageId id, const void* buf);
+
+// Returns a page from the free list or grows the file; BPLUS_NO_PAGE on error
+BPlusPageId bplus_pager_alloc(BPlusPager* pager);
+bool bplus_pager_free(BPlusPager* pager, BPlusPageId id);
+
+#endif // BPLUS_PAGER_H
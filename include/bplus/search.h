@@ -0,0 +1,28 @@
+// include/bplus/search.h
+#ifndef BPLUS_SEARCH_H
+#define BPLUS_SEARCH_H
+
+#include <stdbool.h>
+
+// In-node key search kernels. Both functions take a sorted key array:
+// lower bound returns the number of keys < key, upper bound the number
+// of keys <= key.
+typedef enum {
+    BPLUS_SEARCH_SCALAR,
+    BPLUS_SEARCH_BRANCHLESS,
+    BPLUS_SEARCH_SSE2,
+    BPLUS_SEARCH_AVX2,
+    BPLUS_SEARCH_AUTO
+} BPlusSearchKernel;
+
+int bplus_lower_bound(const int* keys, int n, int key);
+int bplus_upper_bound(const int* keys, int n, int key);
+
+// Kernel selection. The default is the fastest kernel the CPU supports;
+// selecting an unsupported kernel fails and leaves the current one in place.
+bool bplus_search_set_kernel(BPlusSearchKernel kernel);
+BPlusSearchKernel bplus_search_get_kernel(void);
+bool bplus_search_kernel_supported(BPlusSearchKernel kernel);
+const char* bplus_search_kernel_name(BPlusSearchKernel kernel);
+
+#endif // BPLUS_SEARCH_H
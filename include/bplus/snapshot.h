@@ -0,0 +1,36 @@
+// include/bplus/snapshot.h
+#ifndef BPLUS_SNAPSHOT_H
+#define BPLUS_SNAPSHOT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "tree.h"
+
+// An immutable, reference-counted version of a tree. Taking one is O(1):
+// afterwards the tree's writes copy every node they would change, from the
+// leaf up to the root, so the snapshot keeps the nodes it saw. Snapshots
+// never block writers and may be read from any thread while the tree is
+// being modified. Nodes no snapshot can see any more are reclaimed a few
+// at a time by later writes.
+//
+// Snapshots are taken by the thread that writes the tree, and all of them
+// must be released before the tree is destroyed. Trees in concurrent mode
+// or with packed leaves do not support snapshots.
+typedef struct BPlusSnapshot BPlusSnapshot;
+
+// Returns a snapshot holding one reference, or NULL if unsupported
+BPlusSnapshot* bplus_tree_snapshot(BPlusTree* tree);
+BPlusSnapshot* bplus_snapshot_retain(BPlusSnapshot* snapshot);
+void bplus_snapshot_release(BPlusSnapshot* snapshot);
+
+bool bplus_snapshot_search(const BPlusSnapshot* snapshot, int key);
+
+// Calls visit for each key in [start_key, end_key] in ascending order until
+// it returns false; returns the number of keys visited
+typedef bool (*BPlusSnapshotVisitor)(int key, void* ctx);
+size_t bplus_snapshot_scan(const BPlusSnapshot* snapshot, int start_key, int end_key,
+                           BPlusSnapshotVisitor visit, void* ctx);
+
+void bplus_snapshot_print(const BPlusSnapshot* snapshot);
+
+#endif // BPLUS_SNAPSHOT_H
@@ -0,0 +1,37 @@
+// include/bplus/stats.h
+#ifndef BPLUS_STATS_H
+#define BPLUS_STATS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "tree.h"
+
+// Shape and activity of a tree. Everything here is kept up to date as the
+// tree changes, so taking it costs one descent rather than a walk: the key
+// count is tracked by the writes, node counts come from the pools and the
+// height from the leftmost path. Node counts and memory include nodes
+// still held for snapshots or concurrent readers.
+//
+// The counters cost one add per event. A library built with
+// BPLUS_NO_COUNTERS (cmake -DBPLUS_COUNTERS=OFF) leaves them at zero and
+// reports counters_enabled false. Lookups, which may share a tree under a
+// reader lock, and every operation of a concurrent tree are tallied per
+// thread slot, which this sums; like the other operations outside
+// concurrent.h it needs the tree to itself.
+typedef struct {
+    size_t keys;
+    int height;              // levels, 1 for a tree that is a single leaf
+    size_t leaves;
+    size_t internal_nodes;
+    double fill;             // keys over the capacity of the leaves
+    size_t memory_bytes;     // as bplus_tree_memory_usage
+    bool counters_enabled;
+    BPlusTreeCounters counters;
+} BPlusTreeStats;
+
+// Returns false if tree or out is NULL
+bool bplus_tree_stats(BPlusTree* tree, BPlusTreeStats* out);
+// Zeroes the counters; the structural figures are unaffected
+void bplus_tree_reset_counters(BPlusTree* tree);
+
+#endif // BPLUS_STATS_H
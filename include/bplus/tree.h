@@ -3,30 +3,205 @@
 #define BPLUS_TREE_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
+#define BPLUS_CACHE_LINE 64
+
+// A node is a single cache-line-aligned block: this header followed by the
+// keys array and, for internal nodes only, the children array. `keys` and
+// `children` point into that same block (`children` is NULL for leaves).
+// Leaves are doubly linked through `next` and `prev`. In concurrent mode
+// `version` is the optimistic lock word; otherwise `birth` is the tree
+// generation the node was allocated in, which tells writers whether a
+// snapshot may still share it. `dirty` is only kept up to date while the
+// tree has a checkpoint (see checkpoint.h), apart from BPLUS_DIRTY_SPARSE,
+// which lazy deletes maintain; it fits in header padding.
+//
+// In a tree created with BPLUS_TREE_PACKED_LEAVES a leaf block is only this
+// header: `keys` is NULL and `packed` (which leaves would otherwise leave
+// NULL as `children`) points to the keys frame-of-reference encoded and
+// bit-packed in a separate buffer sized to fit them. Code outside the core
+// reads leaf keys through bplus_node_keys().
 typedef struct BPlusNode {
     int* keys;
-    struct BPlusNode** children;
+    union {
+        struct BPlusNode** children;
+        struct BPlusPackedKeys* packed;
+    };
     struct BPlusNode* next;
+    struct BPlusNode* prev;
+    union {
+        uint64_t version;
+        uint64_t birth;
+    };
     bool is_leaf;
+    uint8_t dirty;           // BPLUS_DIRTY_* bits
     int num_keys;
 } BPlusNode;
 
+// Changed since the last checkpoint, and on the path to such a node
+#define BPLUS_DIRTY_SELF 1
+#define BPLUS_DIRTY_BELOW 2
+// Lazy deletes only: a node below may hold fewer than the minimum number
+// of keys, left for bplus_tree_rebalance
+#define BPLUS_DIRTY_SPARSE 4
+
+// Slab allocator for fixed-size node blocks. Blocks are carved out of large
+// slabs and recycled through an intrusive free list; all slabs are released
+// together when the pool is destroyed.
+typedef struct BPlusSlab {
+    struct BPlusSlab* next;
+} BPlusSlab;
+
+typedef struct {
+    size_t block_size;      // bytes per node, a multiple of BPLUS_CACHE_LINE
+    size_t blocks_per_slab;
+    BPlusSlab* slabs;       // most recently allocated slab first
+    size_t slab_used;       // blocks handed out from the newest slab
+    void* free_list;
+    size_t in_use;
+} BPlusNodePool;
+
+struct BPlusSync;
+struct BPlusVersions;
+struct BPlusCheckpoint;
+struct BPlusJournal;
+
+// Options for bplus_tree_create_with_options
+#define BPLUS_TREE_PACKED_LEAVES 1u   // compress leaf keys (see BPlusNode)
+// Deletes only remove the key from its leaf, which may drop below the
+// minimum occupancy or become empty; merges and borrowing wait for
+// bplus_tree_rebalance. Concurrent deletes are not affected. Files store
+// nodes as they are and not the flag, so a tree loaded from one only
+// validates if it was fully rebalanced before it was written.
+#define BPLUS_TREE_LAZY_DELETE 2u
+
+// Where a full node is cut when a key is added to it. Sequential loads
+// only ever add to the rightmost node of each level, so an even split
+// leaves every node behind them half empty. BPLUS_SPLIT_SEQUENTIAL instead
+// keeps 90% of the keys on the left when a key is appended past the end of
+// the rightmost node; that node may then hold fewer than the minimum
+// number of keys until later appends fill it. Other splits stay even.
+typedef enum {
+    BPLUS_SPLIT_EVEN,
+    BPLUS_SPLIT_SEQUENTIAL
+} BPlusSplitPolicy;
+
+// Node sizes in bytes for BPlusTreeOptions. Leaves have no children
+// array, so a leaf of a given size holds about three times the keys of an
+// internal node of that size.
+#define BPLUS_NODE_BYTES_AUTO ((size_t)-1)  // see bplus_node_bytes_auto
+
+typedef struct {
+    int order;               // of internal nodes, and of leaves by default
+    unsigned flags;          // BPLUS_TREE_* bits
+    BPlusSplitPolicy split;
+    int leaf_order;          // leaves hold up to leaf_order - 1 keys; 0: order
+    // When nonzero, replaces order and leaf_order: each kind of node gets
+    // the largest order whose block fits in node_bytes (bplus_order_for_bytes)
+    size_t node_bytes;
+} BPlusTreeOptions;
+
+// Operation counters, kept unless the library is built with
+// BPLUS_NO_COUNTERS (see stats.h)
+typedef struct {
+    uint64_t searches;
+    uint64_t inserts;
+    uint64_t deletes;
+    uint64_t node_visits;    // nodes read on the way down by the three above
+    uint64_t splits;
+    uint64_t merges;
+    uint64_t redistributions;
+} BPlusTreeCounters;
+
 typedef struct {
     BPlusNode* root;
-    int order;
+    int order;               // internal nodes have up to order children
+    int leaf_order;          // leaves have up to leaf_order - 1 keys
+    unsigned flags;
+    BPlusSplitPolicy split;
+    BPlusNodePool leaf_pool;
+    BPlusNodePool internal_pool;
+    struct BPlusSync* sync;  // NULL unless created in concurrent mode
+    struct BPlusVersions* versions;  // NULL until the first snapshot
+    struct BPlusCheckpoint* checkpoint;  // NULL until the first checkpoint
+    struct BPlusJournal* journal;  // NULL unless changes are recorded (journal.h)
+    int* scratch;            // packed leaves only: two leaf-order-sized decode buffers
+    size_t packed_bytes;     // packed leaves only: bytes held by their encodings
+    BPlusNode* tail;         // the rightmost leaf when last seen, or NULL
+    unsigned append_run;     // consecutive inserts past the largest key
+    size_t count;            // keys, apart from concurrent ones (see stats.h)
+    BPlusTreeCounters counters;
+    struct BPlusReadTally* reads;  // lookup counters, kept apart (see stats.h)
 } BPlusTree;
 
 // Node operations
+size_t bplus_node_size(int order, bool is_leaf);
+// The largest order whose node block fits in `bytes`, but at least 3
+int bplus_order_for_bytes(size_t bytes, bool is_leaf);
+// Sixteen cache lines, as detected at run time, or a page if that is
+// smaller: nodes this size take a handful of cache misses to search and
+// stay within a page
+size_t bplus_node_bytes_auto(void);
 BPlusNode* create_node(int order, bool is_leaf);
 void destroy_node(BPlusNode* node);
+// The keys of a node as a plain array: node->keys, or for a packed leaf
+// `buffer` (room for order - 1 keys) filled with its decoded keys
+const int* bplus_node_keys(const BPlusNode* node, int* buffer);
+
+// Node pool operations
+void node_pool_init(BPlusNodePool* pool, size_t block_size);
+void* node_pool_alloc(BPlusNodePool* pool);
+void node_pool_free(BPlusNodePool* pool, void* block);
+void node_pool_destroy(BPlusNodePool* pool);
+
+// Tree-owned nodes come from the tree's pools and must not be passed to
+// destroy_node.
+BPlusNode* bplus_tree_alloc_node(BPlusTree* tree, bool is_leaf);
+void bplus_tree_free_node(BPlusTree* tree, BPlusNode* node);
 
 // Tree operations
 BPlusTree* bplus_tree_create(int order);
+// Packed leaves cannot be combined with snapshots (bplus_tree_snapshot
+// returns NULL). Returns NULL for an order or leaf order below 3 (unless
+// node_bytes is set), unknown flags or an unknown split policy.
+BPlusTree* bplus_tree_create_with_options(const BPlusTreeOptions* options);
 void bplus_tree_destroy(BPlusTree* tree);
+// Keys form a set: inserting a key already present returns false. After a
+// few inserts in a row that each exceed every key in the tree (timestamps,
+// sequence numbers), further such keys are appended to the rightmost leaf
+// without descending from the root; other keys take the normal path.
 bool bplus_tree_insert(BPlusTree* tree, int key);
 bool bplus_tree_delete(BPlusTree* tree, int key);
+// Repairs nodes that lazy deletes left under the minimum occupancy, at most
+// `budget` merge or borrow steps per call, resuming where earlier calls
+// stopped. Only subtrees with such nodes are visited. Returns the number of
+// steps taken; fewer than `budget` means the tree is balanced again.
+size_t bplus_tree_rebalance(BPlusTree* tree, size_t budget);
 bool bplus_tree_search(BPlusTree* tree, int key);
 void bplus_tree_print(BPlusTree* tree);
+void bplus_tree_range_search(BPlusTree* tree, int start_key, int end_key);
+bool bplus_tree_validate(BPlusTree* tree);
+// Bytes held by the tree's live nodes, including packed leaf encodings but
+// not allocator overhead
+size_t bplus_tree_memory_usage(const BPlusTree* tree);
+
+// Bulk operations
+// Builds a tree bottom-up from strictly increasing keys in O(n). Nodes are
+// filled to about fill_factor (0, 1] of capacity, never below the minimum
+// occupancy. Returns NULL if the order is invalid or the input is unsorted.
+BPlusTree* bplus_tree_bulk_load(int order, const int* sorted, size_t n, double fill_factor);
+// The same for a tree created with `options`; NULL if they are invalid
+BPlusTree* bplus_tree_bulk_load_with_options(const BPlusTreeOptions* options, const int* sorted,
+                                             size_t n, double fill_factor);
+// Inserts a batch of keys in any order: the batch is sorted, each leaf
+// receives its whole run in one merge and splits as often as needed.
+// Keys already in the tree are skipped. Returns the number inserted.
+size_t bplus_tree_insert_batch(BPlusTree* tree, const int* keys, size_t n);
+// Looks up n keys, setting out_found[i] for keys[i]; returns how many were
+// found. Keys descend in groups, one level at a time, prefetching each
+// next node so the cache misses of a group overlap instead of queueing.
+size_t bplus_tree_search_batch(BPlusTree* tree, const int* keys, size_t n, bool* out_found);
 
-#endif // BPLUS_TREE_H
\ No newline at end of file
+#endif // BPLUS_TREE_H
@@ -0,0 +1,341 @@
+// include/bplus/tree_template.h
+#ifndef BPLUS_TREE_TEMPLATE_H
+#define BPLUS_TREE_TEMPLATE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include "tree.h"
+
+// Compile-time specialized B+ trees.
+//
+//     BPLUS_DEFINE_TREE(bplus_u64, uint64_t, 64)
+//
+// defines bplus_u64_tree with bplus_u64_create/destroy/insert/delete/search,
+// keyed by uint64_t, with the order fixed at 64. Keys and children live in
+// fixed-size arrays inside each node and leaves are allocated without the
+// children array. Nodes come from the same slab pools as BPlusTree. KEY may
+// be any integer type.
+//
+// The generic bplus_tree_* API remains the int / runtime-order instance.
+
+// Nodes with at most this many keys are searched with a fixed-length scan
+#ifndef BPLUS_TEMPLATE_LINEAR_MAX
+#define BPLUS_TEMPLATE_LINEAR_MAX 32
+#endif
+
+#define BPLUS_DEFINE_TREE(name, KEY, ORDER) \
+typedef struct name##_node {                                                                                  \
+    int num_keys;                                                                                             \
+    bool is_leaf;                                                                                             \
+    KEY keys[(ORDER) - 1];                                                                                    \
+    struct name##_node* next;                                                                                 \
+    struct name##_node* children[];                                                                           \
+} name##_node;                                                                                                \
+                                                                                                              \
+typedef struct {                                                                                              \
+    name##_node* root;                                                                                        \
+    size_t count;                                                                                             \
+    BPlusNodePool leaf_pool;                                                                                  \
+    BPlusNodePool internal_pool;                                                                              \
+} name##_tree;                                                                                                \
+                                                                                                              \
+static inline size_t name##_node_size(bool is_leaf) {                                                         \
+    size_t size = offsetof(name##_node, children);                                                            \
+    if (!is_leaf) size += sizeof(name##_node*) * (ORDER);                                                     \
+    return (size + BPLUS_CACHE_LINE - 1) & ~(size_t)(BPLUS_CACHE_LINE - 1);                                   \
+}                                                                                                             \
+                                                                                                              \
+static inline name##_node* name##_alloc_node(name##_tree* tree, bool is_leaf) {                               \
+    name##_node* node = (name##_node*)node_pool_alloc(is_leaf ? &tree->leaf_pool : &tree->internal_pool);     \
+    if (!node) return NULL;                                                                                   \
+    memset(node, 0, name##_node_size(is_leaf));                                                               \
+    node->is_leaf = is_leaf;                                                                                  \
+    return node;                                                                                              \
+}                                                                                                             \
+                                                                                                              \
+static inline void name##_free_node(name##_tree* tree, name##_node* node) {                                   \
+    node_pool_free(node->is_leaf ? &tree->leaf_pool : &tree->internal_pool, node);                            \
+}                                                                                                             \
+                                                                                                              \
+/* Small nodes scan every slot so the loop has a constant trip count and can                                  \
+   be unrolled and vectorized; large nodes use a branchless binary search. */                                 \
+static inline int name##_bound(const name##_node* node, KEY key, bool or_equal) {                             \
+    if ((ORDER) - 1 <= BPLUS_TEMPLATE_LINEAR_MAX) {                                                           \
+        int count = 0;                                                                                        \
+        for (int i = 0; i < (ORDER) - 1; i++) {                                                               \
+            count += (i < node->num_keys) & (or_equal ? node->keys[i] <= key : node->keys[i] < key);          \
+        }                                                                                                     \
+        return count;                                                                                         \
+    }                                                                                                         \
+    const KEY* base = node->keys;                                                                             \
+    int n = node->num_keys;                                                                                   \
+    if (n == 0) return 0;                                                                                     \
+    while (n > 1) {                                                                                           \
+        int half = n / 2;                                                                                     \
+        base = (or_equal ? base[half] <= key : base[half] < key) ? base + half : base;                        \
+        n -= half;                                                                                            \
+    }                                                                                                         \
+    return (int)(base - node->keys) + (or_equal ? *base <= key : *base < key);                                \
+}                                                                                                             \
+                                                                                                              \
+static inline name##_tree* name##_create(void) {                                                              \
+    name##_tree* tree = (name##_tree*)malloc(sizeof(name##_tree));                                            \
+    if (!tree) return NULL;                                                                                   \
+    node_pool_init(&tree->leaf_pool, name##_node_size(true));                                                 \
+    node_pool_init(&tree->internal_pool, name##_node_size(false));                                            \
+    tree->count = 0;                                                                                          \
+    tree->root = name##_alloc_node(tree, true);                                                               \
+    if (!tree->root) {                                                                                        \
+        node_pool_destroy(&tree->leaf_pool);                                                                  \
+        node_pool_destroy(&tree->internal_pool);                                                              \
+        free(tree);                                                                                           \
+        return NULL;                                                                                          \
+    }                                                                                                         \
+    return tree;                                                                                              \
+}                                                                                                             \
+                                                                                                              \
+static inline void name##_destroy(name##_tree* tree) {                                                        \
+    if (tree) {                                                                                               \
+        node_pool_destroy(&tree->leaf_pool);                                                                  \
+        node_pool_destroy(&tree->internal_pool);                                                              \
+        free(tree);                                                                                           \
+    }                                                                                                         \
+}                                                                                                             \
+                                                                                                              \
+static inline bool name##_search(const name##_tree* tree, KEY key) {                                          \
+    const name##_node* node = tree->root;                                                                     \
+    while (!node->is_leaf) {                                                                                  \
+        node = node->children[name##_bound(node, key, true)];                                                 \
+    }                                                                                                         \
+    int i = name##_bound(node, key, false);                                                                   \
+    return i < node->num_keys && node->keys[i] == key;                                                        \
+}                                                                                                             \
+                                                                                                              \
+/* Inserts below `node`. When `node` splits, the new right sibling and its                                    \
+   separator are returned through `split` and `separator`. `full_above`                                       \
+   counts the full nodes directly above `node`, with the root's missing                                       \
+   parent counted as full: a full leaf splits them all, and each needs a                                      \
+   new sibling, or for the root's parent a new root. The leaf allocates                                       \
+   those before anything changes and passes them up through `spares`, so                                      \
+   on false the tree is as it was and inserts that split nothing allocate                                     \
+   nothing. */                                                                                                \
+static inline bool name##_insert_into(name##_tree* tree, name##_node* node, KEY key, int full_above,          \
+                                      name##_node** spares, name##_node** split, KEY* separator) {            \
+    *split = NULL;                                                                                            \
+                                                                                                              \
+    if (node->is_leaf) {                                                                                      \
+        int pos = name##_bound(node, key, false);                                                             \
+        if (pos < node->num_keys && node->keys[pos] == key) return false;                                     \
+                                                                                                              \
+        if (node->num_keys < (ORDER) - 1) {                                                                   \
+            memmove(&node->keys[pos + 1], &node->keys[pos], sizeof(KEY) * (node->num_keys - pos));            \
+            node->keys[pos] = key;                                                                            \
+            node->num_keys++;                                                                                 \
+            return true;                                                                                      \
+        }                                                                                                     \
+                                                                                                              \
+        name##_node* right = name##_alloc_node(tree, true);                                                   \
+        if (!right) return false;                                                                             \
+        for (int i = 0; i < full_above; i++) {                                                                \
+            name##_node* spare = name##_alloc_node(tree, false);                                              \
+            if (!spare) {                                                                                     \
+                while (*spares) {                                                                             \
+                    name##_node* next = (*spares)->next;                                                      \
+                    name##_free_node(tree, *spares);                                                          \
+                    *spares = next;                                                                           \
+                }                                                                                             \
+                name##_free_node(tree, right);                                                                \
+                return false;                                                                                 \
+            }                                                                                                 \
+            spare->next = *spares;                                                                            \
+            *spares = spare;                                                                                  \
+        }                                                                                                     \
+                                                                                                              \
+        /* Full leaf: merge the new key in and move the upper half out */                                     \
+        KEY all[ORDER];                                                                                       \
+        memcpy(all, node->keys, sizeof(KEY) * pos);                                                           \
+        all[pos] = key;                                                                                       \
+        memcpy(&all[pos + 1], &node->keys[pos], sizeof(KEY) * (node->num_keys - pos));                        \
+                                                                                                              \
+        int left_keys = ((ORDER) + 1) / 2;                                                                    \
+        memcpy(node->keys, all, sizeof(KEY) * left_keys);                                                     \
+        memcpy(right->keys, &all[left_keys], sizeof(KEY) * ((ORDER) - left_keys));                            \
+        node->num_keys = left_keys;                                                                           \
+        right->num_keys = (ORDER) - left_keys;                                                                \
+        right->next = node->next;                                                                             \
+        node->next = right;                                                                                   \
+                                                                                                              \
+        *split = right;                                                                                       \
+        *separator = right->keys[0];                                                                          \
+        return true;                                                                                          \
+    }                                                                                                         \
+                                                                                                              \
+    bool full = node->num_keys == (ORDER) - 1;                                                                \
+    int index = name##_bound(node, key, true);                                                                \
+    name##_node* child_split;                                                                                 \
+    KEY child_separator;                                                                                      \
+    if (!name##_insert_into(tree, node->children[index], key, full ? full_above + 1 : 0, spares,              \
+                            &child_split, &child_separator)) {                                                \
+        return false;                                                                                         \
+    }                                                                                                         \
+    if (!child_split) return true;                                                                            \
+                                                                                                              \
+    if (!full) {                                                                                              \
+        memmove(&node->keys[index + 1], &node->keys[index], sizeof(KEY) * (node->num_keys - index));          \
+        memmove(&node->children[index + 2], &node->children[index + 1],                                       \
+                sizeof(name##_node*) * (node->num_keys - index));                                             \
+        node->keys[index] = child_separator;                                                                  \
+        node->children[index + 1] = child_split;                                                              \
+        node->num_keys++;                                                                                     \
+        return true;                                                                                          \
+    }                                                                                                         \
+                                                                                                              \
+    /* Full internal node: ORDER keys and ORDER + 1 children before the split */                              \
+    KEY keys[ORDER];                                                                                          \
+    name##_node* children[(ORDER) + 1];                                                                       \
+    memcpy(keys, node->keys, sizeof(KEY) * index);                                                            \
+    keys[index] = child_separator;                                                                            \
+    memcpy(&keys[index + 1], &node->keys[index], sizeof(KEY) * (node->num_keys - index));                     \
+    memcpy(children, node->children, sizeof(name##_node*) * (index + 1));                                     \
+    children[index + 1] = child_split;                                                                        \
+    memcpy(&children[index + 2], &node->children[index + 1],                                                  \
+           sizeof(name##_node*) * (node->num_keys - index));                                                  \
+                                                                                                              \
+    name##_node* right = *spares;                                                                             \
+    *spares = right->next;                                                                                    \
+    right->next = NULL;                                                                                       \
+    int mid = (ORDER) / 2;                                                                                    \
+    memcpy(node->keys, keys, sizeof(KEY) * mid);                                                              \
+    memcpy(node->children, children, sizeof(name##_node*) * (mid + 1));                                       \
+    node->num_keys = mid;                                                                                     \
+    memcpy(right->keys, &keys[mid + 1], sizeof(KEY) * ((ORDER) - mid - 1));                                   \
+    memcpy(right->children, &children[mid + 1], sizeof(name##_node*) * ((ORDER) - mid));                      \
+    right->num_keys = (ORDER) - mid - 1;                                                                      \
+                                                                                                              \
+    *split = right;                                                                                           \
+    *separator = keys[mid];                                                                                   \
+    return true;                                                                                              \
+}                                                                                                             \
+                                                                                                              \
+/* Returns false if the key is already present or a node cannot be                                            \
+   allocated */                                                                                               \
+static inline bool name##_insert(name##_tree* tree, KEY key) {                                                \
+    name##_node* spares = NULL;                                                                               \
+    name##_node* split;                                                                                       \
+    KEY separator;                                                                                            \
+    if (!name##_insert_into(tree, tree->root, key, 1, &spares, &split, &separator)) return false;             \
+                                                                                                              \
+    if (split) {                                                                                              \
+        /* The root split, so the leaf reserved a new root */                                                 \
+        name##_node* root = spares;                                                                           \
+        root->next = NULL;                                                                                    \
+        root->keys[0] = separator;                                                                            \
+        root->children[0] = tree->root;                                                                       \
+        root->children[1] = split;                                                                            \
+        root->num_keys = 1;                                                                                   \
+        tree->root = root;                                                                                    \
+    }                                                                                                         \
+    tree->count++;                                                                                            \
+    return true;                                                                                              \
+}                                                                                                             \
+                                                                                                              \
+/* Repairs parent->children[index] after it dropped below the minimum */                                      \
+static inline void name##_fix_underflow(name##_tree* tree, name##_node* parent, int index) {                  \
+    const int min_keys = ((ORDER) - 1) / 2;                                                                   \
+    name##_node* left = index > 0 ? parent->children[index - 1] : NULL;                                       \
+    name##_node* right = index < parent->num_keys ? parent->children[index + 1] : NULL;                       \
+    name##_node* child = parent->children[index];                                                             \
+                                                                                                              \
+    if (left && left->num_keys > min_keys) {                                                                  \
+        memmove(&child->keys[1], &child->keys[0], sizeof(KEY) * child->num_keys);                             \
+        if (child->is_leaf) {                                                                                 \
+            child->keys[0] = left->keys[left->num_keys - 1];                                                  \
+            parent->keys[index - 1] = child->keys[0];                                                         \
+        } else {                                                                                              \
+            memmove(&child->children[1], &child->children[0], sizeof(name##_node*) * (child->num_keys + 1));  \
+            child->keys[0] = parent->keys[index - 1];                                                         \
+            child->children[0] = left->children[left->num_keys];                                              \
+            parent->keys[index - 1] = left->keys[left->num_keys - 1];                                         \
+        }                                                                                                     \
+        child->num_keys++;                                                                                    \
+        left->num_keys--;                                                                                     \
+        return;                                                                                               \
+    }                                                                                                         \
+                                                                                                              \
+    if (right && right->num_keys > min_keys) {                                                                \
+        if (child->is_leaf) {                                                                                 \
+            child->keys[child->num_keys] = right->keys[0];                                                    \
+            memmove(&right->keys[0], &right->keys[1], sizeof(KEY) * (right->num_keys - 1));                   \
+            parent->keys[index] = right->keys[0];                                                             \
+        } else {                                                                                              \
+            child->keys[child->num_keys] = parent->keys[index];                                               \
+            child->children[child->num_keys + 1] = right->children[0];                                        \
+            parent->keys[index] = right->keys[0];                                                             \
+            memmove(&right->keys[0], &right->keys[1], sizeof(KEY) * (right->num_keys - 1));                   \
+            memmove(&right->children[0], &right->children[1], sizeof(name##_node*) * right->num_keys);        \
+        }                                                                                                     \
+        child->num_keys++;                                                                                    \
+        right->num_keys--;                                                                                    \
+        return;                                                                                               \
+    }                                                                                                         \
+                                                                                                              \
+    /* Merge with a sibling: `right` is folded into `left` */                                                 \
+    int separator = index;                                                                                    \
+    if (left) {                                                                                               \
+        right = child;                                                                                        \
+        separator = index - 1;                                                                                \
+    } else {                                                                                                  \
+        left = child;                                                                                         \
+    }                                                                                                         \
+    if (left->is_leaf) {                                                                                      \
+        memcpy(&left->keys[left->num_keys], right->keys, sizeof(KEY) * right->num_keys);                      \
+        left->num_keys += right->num_keys;                                                                    \
+        left->next = right->next;                                                                             \
+    } else {                                                                                                  \
+        left->keys[left->num_keys] = parent->keys[separator];                                                 \
+        memcpy(&left->keys[left->num_keys + 1], right->keys, sizeof(KEY) * right->num_keys);                  \
+        memcpy(&left->children[left->num_keys + 1], right->children,                                          \
+               sizeof(name##_node*) * (right->num_keys + 1));                                                 \
+        left->num_keys += right->num_keys + 1;                                                                \
+    }                                                                                                         \
+    memmove(&parent->keys[separator], &parent->keys[separator + 1],                                           \
+            sizeof(KEY) * (parent->num_keys - separator - 1));                                                \
+    memmove(&parent->children[separator + 1], &parent->children[separator + 2],                               \
+            sizeof(name##_node*) * (parent->num_keys - separator - 1));                                       \
+    parent->num_keys--;                                                                                       \
+    name##_free_node(tree, right);                                                                            \
+}                                                                                                             \
+                                                                                                              \
+static inline bool name##_delete_from(name##_tree* tree, name##_node* node, KEY key) {                        \
+    if (node->is_leaf) {                                                                                      \
+        int pos = name##_bound(node, key, false);                                                             \
+        if (pos >= node->num_keys || node->keys[pos] != key) return false;                                    \
+        memmove(&node->keys[pos], &node->keys[pos + 1], sizeof(KEY) * (node->num_keys - pos - 1));            \
+        node->num_keys--;                                                                                     \
+        return true;                                                                                          \
+    }                                                                                                         \
+                                                                                                              \
+    int index = name##_bound(node, key, true);                                                                \
+    name##_node* child = node->children[index];                                                               \
+    if (!name##_delete_from(tree, child, key)) return false;                                                  \
+    if (child->num_keys < ((ORDER) - 1) / 2) {                                                                \
+        name##_fix_underflow(tree, node, index);                                                              \
+    }                                                                                                         \
+    return true;                                                                                              \
+}                                                                                                             \
+                                                                                                              \
+static inline bool name##_delete(name##_tree* tree, KEY key) {                                                \
+    if (!name##_delete_from(tree, tree->root, key)) return false;                                             \
+                                                                                                              \
+    name##_node* root = tree->root;                                                                           \
+    if (!root->is_leaf && root->num_keys == 0) {                                                              \
+        tree->root = root->children[0];                                                                       \
+        name##_free_node(tree, root);                                                                         \
+    }                                                                                                         \
+    tree->count--;                                                                                            \
+    return true;                                                                                              \
+}
+
+#endif // BPLUS_TREE_TEMPLATE_H
@@ -2,11 +2,12 @@
 #ifndef BPLUS_UTILS_H
 #define BPLUS_UTILS_H
 
+#include <stdio.h>
 #include "tree.h"
 
 bool save_tree_state(BPlusTree* tree, const char* filename);
 BPlusTree* load_tree_state(const char* filename);
 void serialize_node(FILE* fp, BPlusNode* node);
-BPlusNode* deserialize_node(FILE* fp, int order);
+BPlusNode* deserialize_node(FILE* fp, BPlusTree* tree);
 
 #endif // BPLUS_UTILS_H
\ No newline at end of file
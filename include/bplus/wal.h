@@ -0,0 +1,97 @@
+// include/bplus/wal.h
+#ifndef BPLUS_WAL_H
+#define BPLUS_WAL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "tree.h"
+
+typedef enum {
+    BPLUS_WAL_INSERT = 1,
+    BPLUS_WAL_DELETE = 2
+} BPlusWalOp;
+
+// Group commit. Appended records are buffered and written with a single
+// fdatasync once `group_records` of them are pending, or once the oldest
+// pending record is `group_window_ms` old; a background thread enforces
+// the window when no further append arrives. With no window (0) a group
+// short of `group_records` waits for bplus_wal_sync or close. Records of
+// an unsynced group are lost on a crash, so the defaults (1 record, no
+// window) sync every append.
+typedef struct {
+    uint32_t group_records;
+    uint32_t group_window_ms;
+} BPlusWalOptions;
+
+// On-disk record. The CRC-32C covers everything after the crc field, and
+// LSNs are consecutive from the start LSN in the log header, so replay
+// stops at the first torn, corrupt or stale record.
+typedef struct {
+    uint32_t crc;
+    uint32_t op;
+    uint64_t lsn;
+    int32_t key;
+    uint32_t reserved;
+} BPlusWalRecord;
+
+// Append-only log of tree mutations, replayed on top of the last
+// checkpoint (see checkpoint.h) at startup
+typedef struct {
+    int fd;
+    BPlusWalOptions options;
+    pthread_mutex_t lock;
+    uint64_t size;           // bytes of intact, synced log
+    uint64_t next_lsn;
+    BPlusWalRecord* pending; // records waiting for their group commit
+    size_t pending_count;
+    size_t pending_capacity;
+    uint64_t pending_since;  // monotonic ns when the oldest pending record arrived
+    uint64_t appends;
+    uint64_t syncs;
+    // Syncs groups whose window has passed, when the window is set
+    pthread_t flusher;
+    pthread_cond_t flush_wake;
+    bool flusher_running;
+    bool closing;
+    // A group of accepted records failed to sync; see bplus_wal_append
+    bool failed;
+} BPlusWal;
+
+typedef void (*BPlusWalApply)(BPlusWalOp op, int key, void* ctx);
+
+// Opens or creates a log and cuts off any torn tail left by a crash, so
+// appends follow the last intact record. NULL options use the defaults.
+// Returns NULL on I/O errors or on a file that is not a log.
+BPlusWal* bplus_wal_open(const char* path, const BPlusWalOptions* options);
+// Syncs pending records and closes the log. Returns false if they could
+// not be synced, or if the log had failed.
+bool bplus_wal_close(BPlusWal* wal);
+
+// Calls `apply` for every synced record in order. Returns false on I/O
+// errors; `replayed` may be NULL.
+bool bplus_wal_replay(BPlusWal* wal, BPlusWalApply apply, void* ctx, uint64_t* replayed);
+
+// Appends a record, syncing its group if this append completes it. Safe
+// to call from several threads. Returns false if a write or sync fails,
+// and the record is then not logged: no later commit writes it. With
+// group_records above 1, true does not mean the record is durable: it is
+// once its group is synced, which bplus_wal_sync forces. If a group holding
+// records already accepted fails to sync, the log fails: every later
+// append and sync returns false until bplus_wal_checkpoint succeeds.
+bool bplus_wal_append(BPlusWal* wal, BPlusWalOp op, int key);
+// Writes and syncs every pending record now. Returns false if that fails,
+// which fails the log, or if the log had failed.
+bool bplus_wal_sync(BPlusWal* wal);
+
+// Replays the log into a tree. Insert and delete are applied as set
+// operations, so replaying records already in the tree is harmless.
+bool bplus_wal_recover(BPlusWal* wal, BPlusTree* tree);
+
+// Checkpoints the tree to `snapshot_path` with bplus_tree_checkpoint,
+// then truncates the log, which clears a failed log. The tree must not
+// change while it runs.
+bool bplus_wal_checkpoint(BPlusWal* wal, BPlusTree* tree, const char* snapshot_path);
+
+#endif // BPLUS_WAL_H
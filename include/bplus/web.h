@@ -1,6 +1,71 @@
+// include/bplus/web.h
 #ifndef BPLUS_WEB_H
 #define BPLUS_WEB_H
 
+#include "json.h"
+#include "tree.h"
+
+// An HTTP/1.1 server for one tree. One thread accepts connections and
+// watches the idle ones; each request that arrives goes to a pool of
+// worker threads. Reads never lock the tree: every write publishes a
+// snapshot of the result, and searches, scans and dumps run against the
+// latest one, so they proceed in parallel with each other and with the
+// writes, which are applied one at a time. A slow client ties up only the
+// worker answering it.
+//
+//   GET  /api/search?key=K        {"key":K,"found":true}
+//   GET  /api/range?from=A&to=B   {"keys":[...],"count":N,"truncated":false}
+//                                 with at most `limit` keys (default and
+//                                 maximum BPLUS_WEB_RANGE_MAX)
+//   GET  /api/tree                the tree, as json.h writes it
+//   GET  /api/changes?since=V     what changed after version V (below)
+//   POST /api/insert  value=K     {"changed":true,...} and the changes
+//   POST /api/delete  value=K     since `since`, as for /api/changes
+//   GET  anything else            a file under document_root
+//
+// The server keeps a journal (journal.h) of the tree. /api/changes answers
+//
+//   {"version":V,"root":R,"reset":false,
+//    "changes":[{"version":v,"node":id,"kind":"split"},...],
+//    "nodes":[{"id":id,"leaf":false,"keys":[...],"children":[ids]},...],
+//    "removed":[ids],"truncated":false}
+//
+// where "nodes" holds the current contents of each node changed after
+// `since` and "removed" the ids of those no longer in the tree. When
+// `since` is missing, newer than the tree, or older than the journal
+// still holds, "reset" is true, "changes" and "removed" are empty and
+// "nodes" lists the whole tree root first, level by level, up to
+// dump_limits.max_nodes of them.
+//
+// Parameters may come in the query string or a form-encoded body. The
+// tree must support snapshots (snapshot.h) and must not keep a journal of
+// its own. Linux only: connections are watched with epoll.
+#define BPLUS_WEB_DEFAULT_WORKERS 4
+#define BPLUS_WEB_RANGE_MAX 1000
+#define BPLUS_WEB_JOURNAL_CAPACITY 65536
+
+typedef struct {
+    const char* port;            // "0" for any free port
+    int workers;                 // 0 for BPLUS_WEB_DEFAULT_WORKERS
+    const char* document_root;   // NULL to serve no files
+    // Served and modified by the server until it stops, and not to be
+    // touched meanwhile; NULL for an empty tree of order 4 the server owns
+    BPlusTree* tree;
+    BPlusJsonLimits dump_limits;
+} BPlusWebOptions;
+
+typedef struct BPlusWebServer BPlusWebServer;
+
+// Listens and starts the threads; NULL if the port cannot be bound or the
+// tree does not support snapshots or a journal
+BPlusWebServer* bplus_web_server_start(const BPlusWebOptions* options);
+// The port listened on
+int bplus_web_server_port(const BPlusWebServer* server);
+// Closes every connection and joins the threads. A tree passed in the
+// options is left to the caller, with all writes made over HTTP.
+void bplus_web_server_stop(BPlusWebServer* server);
+
+// Serves web/static and an empty tree on `port` until the process exits
 void start_web_server(const char* port);
 
-#endif // BPLUS_WEB_H
\ No newline at end of file
+#endif // BPLUS_WEB_H
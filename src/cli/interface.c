@@ -1,35 +1,116 @@
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "bplus/tree.h"
 #include "bplus/cli.h"
+#include "bplus/checkpoint.h"
+#include "bplus/cursor.h"
+#include "bplus/stats.h"
+#include "bplus/wal.h"
 
 // Global tree instance for the CLI
 static BPlusTree* tree = NULL;
-static int tree_order = 4; // Default order
+static BPlusTreeOptions tree_options = { .order = 4 }; // Default order
+
+// With a database path the tree is loaded from its last checkpoint at
+// <path> and the log at <path>.wal, and every change is logged
+static const char* db_path = NULL;
+static BPlusWal* wal = NULL;
+
+static void open_database() {
+    tree = bplus_checkpoint_load(db_path);
+    if (!tree) {
+        tree = bplus_tree_create_with_options(&tree_options);
+    }
+    
+    size_t len = strlen(db_path);
+    char* wal_path = malloc(len + 5);
+    memcpy(wal_path, db_path, len);
+    memcpy(wal_path + len, ".wal", 5);
+    wal = bplus_wal_open(wal_path, NULL);
+    if (!wal || !bplus_wal_recover(wal, tree)) {
+        printf("Failed to open log %s; changes will not be saved\n", wal_path);
+        bplus_wal_close(wal);
+        wal = NULL;
+    }
+    free(wal_path);
+}
 
 void initialize_tree() {
     if (!tree) {
-        tree = bplus_tree_create(tree_order);
+        if (db_path) {
+            open_database();
+        } else {
+            tree = bplus_tree_create_with_options(&tree_options);
+        }
     }
 }
 
 void cleanup_tree() {
+    if (wal) {
+        bplus_wal_close(wal);
+        wal = NULL;
+    }
     if (tree) {
         bplus_tree_destroy(tree);
         tree = NULL;
     }
 }
 
+// A change is logged before it is applied, and only applied once its
+// log record is synced, so a checkpoint never holds a change the log
+// lost. Inserting a present key or deleting an absent one logs nothing.
+static bool log_change(BPlusWalOp op, int value) {
+    if (!wal || bplus_wal_append(wal, op, value)) return true;
+    printf("Failed to write log record for %d\n", value);
+    return false;
+}
+
 void handle_insert(int value) {
     initialize_tree();
-    if (bplus_tree_insert(tree, value)) {
+    if (!bplus_tree_search(tree, value) && log_change(BPLUS_WAL_INSERT, value) &&
+        bplus_tree_insert(tree, value)) {
         printf("Successfully inserted %d\n", value);
     } else {
         printf("Failed to insert %d\n", value);
     }
 }
 
+void handle_delete(int value) {
+    initialize_tree();
+    if (bplus_tree_search(tree, value) && log_change(BPLUS_WAL_DELETE, value) &&
+        bplus_tree_delete(tree, value)) {
+        printf("Successfully deleted %d\n", value);
+    } else {
+        printf("Value %d not found or deletion failed\n", value);
+    }
+}
+
+// Writes the tree's changes to the database file and empties the log
+void handle_checkpoint() {
+    initialize_tree();
+    if (!wal) {
+        printf("No database open; use db <path>\n");
+    } else if (bplus_wal_checkpoint(wal, tree, db_path)) {
+        printf("Checkpoint written to %s\n", db_path);
+    } else {
+        printf("Checkpoint to %s failed\n", db_path);
+    }
+}
+
+// Folds the database file's chain of checkpoint deltas into one image
+void handle_compact() {
+    BPlusCheckpointStats stats;
+    if (!db_path) {
+        printf("No database open; use db <path>\n");
+    } else if (bplus_checkpoint_compact(db_path, &stats)) {
+        printf("Compacted %s to %llu nodes\n", db_path, (unsigned long long)stats.nodes_written);
+    } else {
+        printf("Compaction of %s failed\n", db_path);
+    }
+}
+
 void handle_search(int value) {
     initialize_tree();
     if (bplus_tree_search(tree, value)) {
@@ -44,22 +125,173 @@ void handle_display() {
     bplus_tree_print(tree);
 }
 
+// Prints keys in [start, end] a buffer at a time
+void handle_range(int start, int end) {
+    initialize_tree();
+    
+    BPlusCursor cursor;
+    int keys[256];
+    size_t total = 0;
+    size_t count;
+    bool done = false;
+    
+    bplus_cursor_seek(&cursor, tree, start);
+    printf("Keys in [%d, %d]:", start, end);
+    while (!done && (count = bplus_cursor_next_batch(&cursor, keys, 256)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            if (keys[i] > end) {
+                done = true;
+                break;
+            }
+            printf(" %d", keys[i]);
+            total++;
+        }
+    }
+    printf("\n%zu key(s) found\n", total);
+}
+
+static double per_op(uint64_t count, uint64_t ops) {
+    return ops ? (double)count / (double)ops : 0;
+}
+
+// Shape of the tree and what its operations have cost since it was opened
+void handle_stats() {
+    initialize_tree();
+    BPlusTreeStats stats;
+    bplus_tree_stats(tree, &stats);
+    
+    printf("Keys:            %zu\n", stats.keys);
+    printf("Height:          %d\n", stats.height);
+    printf("Nodes:           %zu leaves, %zu internal\n", stats.leaves, stats.internal_nodes);
+    printf("Leaf fill:       %.1f%%\n", stats.fill * 100);
+    printf("Memory:          %zu bytes\n", stats.memory_bytes);
+    if (!stats.counters_enabled) {
+        printf("Counters:        compiled out\n");
+        return;
+    }
+    
+    const BPlusTreeCounters* c = &stats.counters;
+    uint64_t ops = c->searches + c->inserts + c->deletes;
+    printf("Operations:      %llu searches, %llu inserts, %llu deletes\n",
+           (unsigned long long)c->searches, (unsigned long long)c->inserts,
+           (unsigned long long)c->deletes);
+    printf("Node visits:     %llu (%.2f per operation)\n",
+           (unsigned long long)c->node_visits, per_op(c->node_visits, ops));
+    printf("Splits:          %llu (%.3f per insert)\n",
+           (unsigned long long)c->splits, per_op(c->splits, c->inserts));
+    printf("Merges:          %llu (%.3f per delete)\n",
+           (unsigned long long)c->merges, per_op(c->merges, c->deletes));
+    printf("Redistributions: %llu (%.3f per delete)\n",
+           (unsigned long long)c->redistributions, per_op(c->redistributions, c->deletes));
+}
+
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Replaces the tree with one bulk-loaded from whitespace-separated integers
+void handle_load(const char* filename) {
+    FILE* fp = fopen(filename, "r");
+    if (!fp) {
+        printf("Failed to open %s\n", filename);
+        return;
+    }
+    
+    size_t count = 0;
+    size_t capacity = 1024;
+    int* keys = malloc(sizeof(int) * capacity);
+    int value;
+    while (fscanf(fp, "%d", &value) == 1) {
+        if (count == capacity) {
+            capacity *= 2;
+            keys = realloc(keys, sizeof(int) * capacity);
+        }
+        keys[count++] = value;
+    }
+    fclose(fp);
+    
+    // Bulk loading needs sorted, duplicate-free input
+    qsort(keys, count, sizeof(int), compare_ints);
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique == 0 || keys[i] != keys[unique - 1]) {
+            keys[unique++] = keys[i];
+        }
+    }
+    
+    BPlusTree* loaded = bplus_tree_bulk_load_with_options(&tree_options, keys, unique, 1.0);
+    free(keys);
+    if (!loaded) {
+        printf("Failed to load %s\n", filename);
+        return;
+    }
+    
+    bplus_tree_destroy(tree);
+    tree = loaded;
+    printf("Loaded %zu keys from %s\n", unique, filename);
+    
+    // The log cannot describe a wholesale replacement, so checkpoint it
+    if (wal) {
+        handle_checkpoint();
+    }
+}
+
 void print_help() {
     printf("\nAvailable commands:\n");
     printf("  insert <value>  - Insert a value into the tree\n");
     printf("  search <value>  - Search for a value in the tree\n");
     printf("  delete <value>  - Delete a value from the tree\n");
+    printf("  range <a> <b>  - List the values between a and b\n");
     printf("  display        - Show the current tree structure\n");
+    printf("  load <file>    - Replace the tree with keys read from a file\n");
+    printf("  checkpoint     - Save the tree to the database and empty its log\n");
+    printf("  compact        - Fold the database's checkpoint deltas together\n");
+    printf("  stats          - Show the tree's shape and operation counts\n");
     printf("  help           - Show this help message\n");
     printf("  exit           - Exit the program\n\n");
 }
 
-void run_interactive_mode(int order) {
-    tree_order = order;
+// An order, a node size such as 256B or 4K from which leaves and internal
+// nodes each get their own order, or "auto" for a size that suits this
+// machine's cache lines and pages
+static bool parse_order(const char* text, BPlusTreeOptions* options) {
+    if (strcmp(text, "auto") == 0) {
+        *options = (BPlusTreeOptions){ .node_bytes = BPLUS_NODE_BYTES_AUTO };
+        return true;
+    }
+    
+    char* end;
+    long value = strtol(text, &end, 10);
+    if (end == text || value < 1) return false;
+    if (*end == '\0') {
+        if (value < 3 || value > INT_MAX) return false;
+        *options = (BPlusTreeOptions){ .order = (int)value };
+        return true;
+    }
+    
+    size_t unit;
+    if (strcmp(end, "B") == 0) {
+        unit = 1;
+    } else if (strcmp(end, "K") == 0 || strcmp(end, "KB") == 0 || strcmp(end, "KiB") == 0) {
+        unit = 1024;
+    } else {
+        return false;
+    }
+    *options = (BPlusTreeOptions){ .node_bytes = (size_t)value * unit };
+    return true;
+}
+
+static void interactive_loop() {
     initialize_tree();
     
     char command[256];
-    printf("\nB+ Tree Interactive Mode (Order: %d)\n", order);
+    if (tree->leaf_order != tree->order) {
+        printf("\nB+ Tree Interactive Mode (Order: %d, leaf order: %d)\n", tree->order, tree->leaf_order);
+    } else {
+        printf("\nB+ Tree Interactive Mode (Order: %d)\n", tree->order);
+    }
     print_help();
     
     while (1) {
@@ -95,17 +327,33 @@ void run_interactive_mode(int order) {
         } else if (strcmp(cmd, "delete") == 0) {
             char* val = strtok(NULL, " ");
             if (val) {
-                int value = atoi(val);
-                if (bplus_tree_delete(tree, value)) {
-                    printf("Successfully deleted %d\n", value);
-                } else {
-                    printf("Value %d not found or deletion failed\n", value);
-                }
+                handle_delete(atoi(val));
             } else {
                 printf("Usage: delete <value>\n");
             }
         } else if (strcmp(cmd, "display") == 0) {
             handle_display();
+        } else if (strcmp(cmd, "range") == 0) {
+            char* start = strtok(NULL, " ");
+            char* end = strtok(NULL, " ");
+            if (start && end) {
+                handle_range(atoi(start), atoi(end));
+            } else {
+                printf("Usage: range <start> <end>\n");
+            }
+        } else if (strcmp(cmd, "checkpoint") == 0) {
+            handle_checkpoint();
+        } else if (strcmp(cmd, "compact") == 0) {
+            handle_compact();
+        } else if (strcmp(cmd, "stats") == 0) {
+            handle_stats();
+        } else if (strcmp(cmd, "load") == 0) {
+            char* file = strtok(NULL, " ");
+            if (file) {
+                handle_load(file);
+            } else {
+                printf("Usage: load <file>\n");
+            }
         } else {
             printf("Unknown command: %s\n", cmd);
             printf("Type 'help' for available commands\n");
@@ -115,17 +363,32 @@ void run_interactive_mode(int order) {
     cleanup_tree();
 }
 
+void run_interactive_mode(int order) {
+    tree_options = (BPlusTreeOptions){ .order = order };
+    interactive_loop();
+}
+
 void run_cli(int argc, char* argv[]) {
-    // Check for order parameter
-    if (argc >= 3 && strcmp(argv[1], "order") == 0) {
-        tree_order = atoi(argv[2]);
+    // Check for order and database parameters
+    db_path = NULL;
+    while (argc >= 3) {
+        if (strcmp(argv[1], "order") == 0) {
+            if (!parse_order(argv[2], &tree_options)) {
+                printf("Invalid order: %s (expected an order of at least 3, a node size such as 256B or 4K, or auto)\n", argv[2]);
+                return;
+            }
+        } else if (strcmp(argv[1], "db") == 0) {
+            db_path = argv[2];
+        } else {
+            break;
+        }
         argc -= 2;
         argv += 2;
     }
     
     // If no more arguments, run interactive mode
     if (argc == 1) {
-        run_interactive_mode(tree_order);
+        interactive_loop();
         return;
     }
     
@@ -133,24 +396,29 @@ void run_cli(int argc, char* argv[]) {
     initialize_tree();
     
     if (strcmp(argv[1], "interactive") == 0) {
-        run_interactive_mode(tree_order);
+        interactive_loop();
     } else if (strcmp(argv[1], "insert") == 0 && argc == 3) {
         handle_insert(atoi(argv[2]));
     } else if (strcmp(argv[1], "search") == 0 && argc == 3) {
         handle_search(atoi(argv[2]));
     } else if (strcmp(argv[1], "delete") == 0 && argc == 3) {
-        int value = atoi(argv[2]);
-        if (bplus_tree_delete(tree, value)) {
-            printf("Successfully deleted %d\n", value);
-        } else {
-            printf("Value %d not found or deletion failed\n", value);
-        }
+        handle_delete(atoi(argv[2]));
+    } else if (strcmp(argv[1], "checkpoint") == 0) {
+        handle_checkpoint();
+    } else if (strcmp(argv[1], "compact") == 0) {
+        handle_compact();
     } else if (strcmp(argv[1], "display") == 0) {
         handle_display();
+    } else if (strcmp(argv[1], "stats") == 0) {
+        handle_stats();
+    } else if (strcmp(argv[1], "range") == 0 && argc == 4) {
+        handle_range(atoi(argv[2]), atoi(argv[3]));
+    } else if (strcmp(argv[1], "load") == 0 && argc == 3) {
+        handle_load(argv[2]);
     } else {
         printf("Invalid command or arguments\n");
-        printf("Usage: %s [order <value>] <command> [args]\n", argv[0]);
-        printf("Commands: insert <value>, search <value>, delete <value>, display, interactive\n");
+        printf("Usage: %s [order <value|bytes|auto>] [db <path>] <command> [args]\n", argv[0]);
+        printf("Commands: insert <value>, search <value>, delete <value>, range <start> <end>, display, stats, load <file>, checkpoint, compact, interactive\n");
     }
     
     cleanup_tree();
@@ -6,13 +6,21 @@
 
 int main(int argc, char* argv[]) {
     if (argc == 1) {
-        printf("Usage: b-plus-tree [order <value>] <command> [args]\n");
+        printf("Usage: b-plus-tree [order <value|bytes|auto>] [db <path>] <command> [args]\n");
         printf("Commands:\n");
         printf(" order <value> - Set the order of the B+ tree (optional, default: 4)\n");
+        printf(" order <bytes> - Size nodes in bytes instead, e.g. 256B or 4K; leaves and internal nodes get their own orders\n");
+        printf(" order auto - Size nodes from the cache line and page size\n");
+        printf(" db <path> - Keep the tree in <path> and log changes to <path>.wal (optional)\n");
         printf(" insert <value> - Insert a value into the tree\n");
         printf(" delete <value> - Delete a value from the tree\n");
         printf(" search <value> - Search for a value in the tree\n");
+        printf(" range <start> <end> - List the values in a range\n");
         printf(" display - Display the current tree\n");
+        printf(" load <file> - Bulk load keys from a file\n");
+        printf(" checkpoint - Save the tree to the database and empty its log\n");
+        printf(" compact - Fold the database's checkpoint deltas together\n");
+        printf(" stats - Show the tree's shape and operation counts\n");
         printf(" interactive - Enter interactive mode\n");
         return 1;
     }
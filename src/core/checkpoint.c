@@ -0,0 +1,707 @@
+// src/core/checkpoint.c
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "bplus/checkpoint.h"
+#include "bplus/checksum.h"
+#include "internal.h"
+
+#define CHECKPOINT_MAGIC "BPLUSCKP"
+#define CHECKPOINT_FORMAT 2
+// Format 1 headers end before leaf_order; those trees have a single order
+#define CHECKPOINT_FORMAT_SINGLE_ORDER 1
+#define RECORD_NODE 1
+#define RECORD_ROOT 2
+#define MAX_DEPTH 64
+#define FLUSH_BYTES (256 * 1024)
+// The dirty bits checkpoints own; BPLUS_DIRTY_SPARSE belongs to rebalancing
+#define CHECKPOINT_BITS (BPLUS_DIRTY_SELF | BPLUS_DIRTY_BELOW)
+
+typedef struct {
+    char magic[8];
+    uint32_t format;
+    int32_t order;
+    uint64_t lineage;        // shared by a full image and the deltas chained to it
+    int32_t leaf_order;
+    uint32_t reserved;
+} FileHeader;
+
+// A node record is followed by its keys and, for internal nodes, the ids
+// of its children. A root record has no payload and commits everything
+// written before it.
+typedef struct {
+    uint32_t crc;            // CRC-32C of the rest of the record
+    uint8_t type;
+    uint8_t is_leaf;
+    uint16_t reserved;
+    uint32_t id;             // the node, or the root for a root record
+    uint32_t num_keys;
+} RecordHeader;
+
+// Per-tree state: which file the tree was last checkpointed to and the
+// ids its nodes have there
+struct BPlusCheckpoint {
+    char* path;
+    uint64_t lineage;
+    dev_t dev;
+    ino_t ino;
+    uint32_t deltas;
+    BPlusNode** slots;       // node -> id, open addressing
+    uint32_t* ids;
+    size_t mask;
+    size_t used;
+    uint32_t next_id;
+    uint32_t* free_ids;
+    size_t free_count;
+    size_t free_capacity;
+};
+
+static size_t record_size(bool is_leaf, uint32_t num_keys) {
+    size_t size = sizeof(RecordHeader) + sizeof(int32_t) * num_keys;
+    if (!is_leaf) size += sizeof(uint32_t) * (num_keys + 1);
+    return size;
+}
+
+static uint32_t record_crc(const uint8_t* record, size_t size) {
+    return bplus_crc32c(0, record + sizeof(uint32_t), size - sizeof(uint32_t));
+}
+
+// Node ids
+
+static size_t slot_of(const struct BPlusCheckpoint* cp, const BPlusNode* node) {
+    uint64_t h = (uint64_t)(uintptr_t)node * 0x9E3779B97F4A7C15ull;
+    return (size_t)(h >> 32) & cp->mask;
+}
+
+static void map_put(struct BPlusCheckpoint* cp, BPlusNode* node, uint32_t id);
+
+static void map_grow(struct BPlusCheckpoint* cp) {
+    BPlusNode** old_slots = cp->slots;
+    uint32_t* old_ids = cp->ids;
+    size_t old_capacity = old_slots ? cp->mask + 1 : 0;
+    size_t capacity = old_capacity ? old_capacity * 2 : 256;
+
+    cp->slots = calloc(capacity, sizeof(BPlusNode*));
+    cp->ids = malloc(sizeof(uint32_t) * capacity);
+    cp->mask = capacity - 1;
+    cp->used = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_slots[i]) map_put(cp, old_slots[i], old_ids[i]);
+    }
+    free(old_slots);
+    free(old_ids);
+}
+
+static void map_put(struct BPlusCheckpoint* cp, BPlusNode* node, uint32_t id) {
+    if (!cp->slots || 2 * (cp->used + 1) > cp->mask + 1) map_grow(cp);
+    size_t i = slot_of(cp, node);
+    while (cp->slots[i] && cp->slots[i] != node) {
+        i = (i + 1) & cp->mask;
+    }
+    if (!cp->slots[i]) cp->used++;
+    cp->slots[i] = node;
+    cp->ids[i] = id;
+}
+
+static uint32_t map_get(const struct BPlusCheckpoint* cp, const BPlusNode* node) {
+    if (!cp->slots) return 0;
+    for (size_t i = slot_of(cp, node); cp->slots[i]; i = (i + 1) & cp->mask) {
+        if (cp->slots[i] == node) return cp->ids[i];
+    }
+    return 0;
+}
+
+// Backward-shift deletion keeps probe chains unbroken without tombstones
+static uint32_t map_remove(struct BPlusCheckpoint* cp, const BPlusNode* node) {
+    if (!cp->slots) return 0;
+    size_t i = slot_of(cp, node);
+    while (cp->slots[i] != node) {
+        if (!cp->slots[i]) return 0;
+        i = (i + 1) & cp->mask;
+    }
+    uint32_t id = cp->ids[i];
+    cp->used--;
+
+    size_t hole = i;
+    for (size_t j = (i + 1) & cp->mask; cp->slots[j]; j = (j + 1) & cp->mask) {
+        size_t home = slot_of(cp, cp->slots[j]);
+        // Move the entry back if the hole lies between its home and it
+        if (((j - home) & cp->mask) >= ((j - hole) & cp->mask)) {
+            cp->slots[hole] = cp->slots[j];
+            cp->ids[hole] = cp->ids[j];
+            hole = j;
+        }
+    }
+    cp->slots[hole] = NULL;
+    return id;
+}
+
+static void release_id(struct BPlusCheckpoint* cp, uint32_t id) {
+    if (cp->free_count == cp->free_capacity) {
+        cp->free_capacity = cp->free_capacity ? cp->free_capacity * 2 : 64;
+        cp->free_ids = realloc(cp->free_ids, sizeof(uint32_t) * cp->free_capacity);
+    }
+    cp->free_ids[cp->free_count++] = id;
+}
+
+// Ids of removed nodes are handed out again so they stay dense
+static uint32_t id_of(struct BPlusCheckpoint* cp, BPlusNode* node) {
+    uint32_t id = map_get(cp, node);
+    if (id == 0) {
+        id = cp->free_count > 0 ? cp->free_ids[--cp->free_count] : cp->next_id++;
+        map_put(cp, node, id);
+    }
+    return id;
+}
+
+static void reset_ids(struct BPlusCheckpoint* cp) {
+    free(cp->slots);
+    free(cp->ids);
+    cp->slots = NULL;
+    cp->ids = NULL;
+    cp->mask = 0;
+    cp->used = 0;
+    cp->next_id = 1;
+    cp->free_count = 0;
+}
+
+void checkpoint_forget(BPlusTree* tree, BPlusNode* node) {
+    uint32_t id = map_remove(tree->checkpoint, node);
+    if (id) release_id(tree->checkpoint, id);
+}
+
+void checkpoint_transfer(BPlusTree* tree, BPlusNode* from, BPlusNode* to) {
+    uint32_t id = map_remove(tree->checkpoint, from);
+    if (id) map_put(tree->checkpoint, to, id);
+    to->dirty = from->dirty;
+}
+
+void checkpoint_destroy(struct BPlusCheckpoint* cp) {
+    reset_ids(cp);
+    free(cp->free_ids);
+    free(cp->path);
+    free(cp);
+}
+
+// File access
+
+static bool read_at(int fd, void* buf, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pread(fd, buf, size, offset);
+        if (n <= 0) return false;
+        buf = (char*)buf + n;
+        size -= (size_t)n;
+        offset += n;
+    }
+    return true;
+}
+
+static bool write_at(int fd, const void* buf, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, buf, size, offset);
+        if (n <= 0) return false;
+        buf = (const char*)buf + n;
+        size -= (size_t)n;
+        offset += n;
+    }
+    return true;
+}
+
+// Opens `path` holding an exclusive lock on it. Compaction renames a new
+// file over the path, so a lock won on the replaced file is retried.
+static int open_locked(const char* path, bool create) {
+    for (;;) {
+        int fd = open(path, create ? O_RDWR | O_CREAT : O_RDWR, 0644);
+        if (fd < 0) return -1;
+        struct stat held, named;
+        if (flock(fd, LOCK_EX) != 0 || fstat(fd, &held) != 0) {
+            close(fd);
+            return -1;
+        }
+        if (stat(path, &named) == 0 && held.st_dev == named.st_dev && held.st_ino == named.st_ino) {
+            return fd;
+        }
+        close(fd);
+    }
+}
+
+// Makes a rename inside the directory holding `path` durable
+static bool sync_parent_dir(const char* path) {
+    const char* slash = strrchr(path, '/');
+    char* dir = slash ? strndup(path, (size_t)(slash - path) + 1) : strdup(".");
+    int fd = open(dir, O_RDONLY);
+    free(dir);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+static char* temp_path_for(const char* path) {
+    size_t len = strlen(path);
+    char* temp = malloc(len + 5);
+    memcpy(temp, path, len);
+    memcpy(temp + len, ".tmp", 5);
+    return temp;
+}
+
+// Buffered record output
+
+typedef struct {
+    int fd;
+    off_t offset;            // where the buffer goes in the file
+    uint8_t* buf;
+    size_t len;
+    size_t capacity;
+    bool ok;
+    uint64_t nodes;
+    int* keys;               // decode buffer for packed leaves
+} Writer;
+
+static void writer_flush(Writer* w) {
+    if (w->ok && w->len > 0) {
+        w->ok = write_at(w->fd, w->buf, w->len, w->offset);
+        w->offset += (off_t)w->len;
+    }
+    w->len = 0;
+}
+
+static uint8_t* writer_reserve(Writer* w, size_t size) {
+    if (w->len + size > FLUSH_BYTES) writer_flush(w);
+    if (w->len + size > w->capacity) {
+        w->capacity = w->len + size > FLUSH_BYTES ? w->len + size : FLUSH_BYTES;
+        w->buf = realloc(w->buf, w->capacity);
+    }
+    uint8_t* at = w->buf + w->len;
+    w->len += size;
+    return at;
+}
+
+static void put_header(uint8_t* at, uint8_t type, bool is_leaf, uint32_t id, uint32_t num_keys) {
+    RecordHeader header = { 0, type, is_leaf, 0, id, num_keys };
+    memcpy(at, &header, sizeof(header));
+}
+
+static void seal_record(uint8_t* at, size_t size) {
+    uint32_t crc = record_crc(at, size);
+    memcpy(at, &crc, sizeof(crc));
+}
+
+static void emit_node(Writer* w, struct BPlusCheckpoint* cp, BPlusNode* node) {
+    uint32_t n = (uint32_t)node->num_keys;
+    size_t size = record_size(node->is_leaf, n);
+    uint8_t* at = writer_reserve(w, size);
+    put_header(at, RECORD_NODE, node->is_leaf, id_of(cp, node), n);
+    memcpy(at + sizeof(RecordHeader), bplus_node_keys(node, w->keys), sizeof(int32_t) * n);
+    if (!node->is_leaf) {
+        uint8_t* ids = at + sizeof(RecordHeader) + sizeof(int32_t) * n;
+        for (uint32_t i = 0; i <= n; i++) {
+            uint32_t id = id_of(cp, node->children[i]);
+            memcpy(ids + sizeof(uint32_t) * i, &id, sizeof(id));
+        }
+    }
+    seal_record(at, size);
+    w->nodes++;
+}
+
+static void emit_root(Writer* w, uint32_t root_id) {
+    uint8_t* at = writer_reserve(w, sizeof(RecordHeader));
+    put_header(at, RECORD_ROOT, false, root_id, 0);
+    seal_record(at, sizeof(RecordHeader));
+}
+
+static bool writer_finish(Writer* w) {
+    writer_flush(w);
+    free(w->buf);
+    return w->ok && fdatasync(w->fd) == 0;
+}
+
+// Tree walks
+
+static void emit_all(Writer* w, struct BPlusCheckpoint* cp, BPlusNode* node) {
+    node->dirty &= ~CHECKPOINT_BITS;
+    emit_node(w, cp, node);
+    if (!node->is_leaf) {
+        for (int i = 0; i <= node->num_keys; i++) {
+            emit_all(w, cp, node->children[i]);
+        }
+    }
+}
+
+// Only subtrees flagged by a write are entered
+static void emit_dirty(Writer* w, struct BPlusCheckpoint* cp, BPlusNode* node) {
+    if (node->dirty & BPLUS_DIRTY_SELF) {
+        emit_node(w, cp, node);
+    }
+    if (!node->is_leaf) {
+        for (int i = 0; i <= node->num_keys; i++) {
+            if (node->children[i]->dirty & CHECKPOINT_BITS) emit_dirty(w, cp, node->children[i]);
+        }
+    }
+}
+
+static void clear_dirty(BPlusNode* node) {
+    if (!node->is_leaf) {
+        for (int i = 0; i <= node->num_keys; i++) {
+            if (node->children[i]->dirty & CHECKPOINT_BITS) clear_dirty(node->children[i]);
+        }
+    }
+    node->dirty &= ~CHECKPOINT_BITS;
+}
+
+static uint64_t new_lineage(const void* salt) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t x = (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+    x ^= ((uint64_t)getpid() << 32) ^ (uint64_t)(uintptr_t)salt;
+    // splitmix64 finaliser
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return (x ^ (x >> 31)) | 1;
+}
+
+// Writes every node to a new file and renames it over `path`. Nodes get
+// fresh ids, and the tree's chain starts over.
+static bool write_full_image(BPlusTree* tree, const char* path, Writer* w) {
+    struct BPlusCheckpoint* cp = tree->checkpoint;
+    reset_ids(cp);
+    cp->lineage = new_lineage(tree);
+    cp->deltas = 0;
+
+    char* temp = temp_path_for(path);
+    int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        free(temp);
+        return false;
+    }
+
+    FileHeader header = { .format = CHECKPOINT_FORMAT, .order = tree->order, .lineage = cp->lineage,
+                          .leaf_order = tree->leaf_order };
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic));
+    *w = (Writer){ .fd = fd, .offset = sizeof(header), .ok = write_at(fd, &header, sizeof(header), 0),
+                   .keys = tree->scratch };
+    emit_all(w, cp, tree->root);
+    emit_root(w, id_of(cp, tree->root));
+    bool ok = writer_finish(w);
+    ok = close(fd) == 0 && ok;
+
+    struct stat st;
+    ok = ok && rename(temp, path) == 0 && sync_parent_dir(path) && stat(path, &st) == 0;
+    if (ok) {
+        cp->dev = st.st_dev;
+        cp->ino = st.st_ino;
+    } else {
+        remove(temp);
+    }
+    free(temp);
+    return ok;
+}
+
+// Appends the changed nodes and a root record to the locked file `fd`.
+// A failed append is cut off again so the chain stays readable.
+static bool append_delta(BPlusTree* tree, int fd, Writer* w) {
+    struct BPlusCheckpoint* cp = tree->checkpoint;
+    struct stat st;
+    if (fstat(fd, &st) != 0) return false;
+
+    // A compaction replaced the file; it kept the ids but not the chain
+    if (st.st_dev != cp->dev || st.st_ino != cp->ino) {
+        cp->dev = st.st_dev;
+        cp->ino = st.st_ino;
+        cp->deltas = 0;
+    }
+
+    *w = (Writer){ .fd = fd, .offset = st.st_size, .ok = true, .keys = tree->scratch };
+    emit_dirty(w, cp, tree->root);
+    emit_root(w, id_of(cp, tree->root));
+    if (!writer_finish(w)) {
+        if (ftruncate(fd, st.st_size) == 0) fdatasync(fd);
+        return false;
+    }
+    clear_dirty(tree->root);
+    cp->deltas++;
+    return true;
+}
+
+// Deltas only go onto the file the tree's ids refer to
+static bool can_append(const struct BPlusCheckpoint* cp, int fd, const BPlusTree* tree, const char* path) {
+    FileHeader header;
+    return cp->path && strcmp(cp->path, path) == 0 && cp->lineage != 0 &&
+           read_at(fd, &header, sizeof(header), 0) &&
+           memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(header.magic)) == 0 &&
+           header.format == CHECKPOINT_FORMAT && header.lineage == cp->lineage &&
+           header.order == tree->order && header.leaf_order == tree->leaf_order;
+}
+
+bool bplus_tree_checkpoint(BPlusTree* tree, const char* path, BPlusCheckpointStats* stats) {
+    if (!tree || !path || tree->sync) return false;
+
+    int fd = open_locked(path, true);
+    if (fd < 0) return false;
+
+    if (!tree->checkpoint) {
+        tree->checkpoint = calloc(1, sizeof(struct BPlusCheckpoint));
+    }
+    struct BPlusCheckpoint* cp = tree->checkpoint;
+
+    Writer w;
+    bool ok;
+    if (can_append(cp, fd, tree, path)) {
+        ok = append_delta(tree, fd, &w);
+    } else {
+        free(cp->path);
+        cp->path = strdup(path);
+        ok = write_full_image(tree, path, &w);
+    }
+
+    // Without a chain to extend, the next checkpoint starts a new one
+    if (!ok) {
+        cp->lineage = 0;
+    } else if (stats) {
+        stats->deltas = cp->deltas;
+        stats->nodes_written = w.nodes;
+        stats->file_bytes = (uint64_t)w.offset;
+    }
+    close(fd);
+    return ok;
+}
+
+// Reading a chain
+
+typedef struct {
+    uint8_t* data;
+    size_t size;
+    FileHeader header;
+    size_t start;            // of the first record
+    size_t committed;        // bytes up to the end of the last root record
+    uint32_t root;
+    uint32_t roots;
+    size_t* offsets;         // id -> newest committed record, 0 if none
+    uint32_t max_id;
+    uint8_t* seen;           // id -> already placed in the tree being built
+} Chain;
+
+static void chain_free(Chain* chain) {
+    free(chain->data);
+    free(chain->offsets);
+    free(chain->seen);
+}
+
+// Length of the intact record at `pos`, or 0 if there is none
+static size_t check_record(const Chain* chain, size_t pos) {
+    RecordHeader header;
+    if (chain->size - pos < sizeof(header)) return 0;
+    memcpy(&header, chain->data + pos, sizeof(header));
+
+    size_t size;
+    if (header.type == RECORD_ROOT) {
+        size = sizeof(RecordHeader);
+    } else if (header.type == RECORD_NODE && header.is_leaf <= 1 &&
+               header.num_keys < (uint32_t)(header.is_leaf ? chain->header.leaf_order : chain->header.order)) {
+        size = record_size(header.is_leaf, header.num_keys);
+    } else {
+        return 0;
+    }
+    if (header.id == 0 || chain->size - pos < size) return 0;
+    uint32_t crc;
+    memcpy(&crc, chain->data + pos, sizeof(crc));
+    return crc == record_crc(chain->data + pos, size) ? size : 0;
+}
+
+static bool read_chain(int fd, Chain* chain) {
+    memset(chain, 0, sizeof(*chain));
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader)) return false;
+    chain->size = (size_t)st.st_size;
+    chain->data = malloc(chain->size);
+    if (!chain->data || !read_at(fd, chain->data, chain->size, 0)) return false;
+
+    memcpy(&chain->header, chain->data, sizeof(FileHeader));
+    chain->start = sizeof(FileHeader);
+    if (chain->header.format == CHECKPOINT_FORMAT_SINGLE_ORDER) {
+        // Read as the current format, which a compaction then writes
+        chain->start = offsetof(FileHeader, leaf_order);
+        chain->header.format = CHECKPOINT_FORMAT;
+        chain->header.leaf_order = chain->header.order;
+        chain->header.reserved = 0;
+    }
+    if (memcmp(chain->header.magic, CHECKPOINT_MAGIC, sizeof(chain->header.magic)) != 0 ||
+        chain->header.format != CHECKPOINT_FORMAT || chain->header.order < 3 ||
+        chain->header.leaf_order < 3 || chain->size < chain->start) {
+        return false;
+    }
+
+    // The chain ends at the last root record before the first bad record
+    size_t pos = chain->start;
+    size_t size;
+    while ((size = check_record(chain, pos)) > 0) {
+        RecordHeader header;
+        memcpy(&header, chain->data + pos, sizeof(header));
+        pos += size;
+        if (header.type == RECORD_ROOT) {
+            chain->committed = pos;
+            chain->root = header.id;
+            chain->roots++;
+        } else if (header.id > chain->max_id) {
+            chain->max_id = header.id;
+        }
+    }
+    if (chain->roots == 0) return false;
+
+    chain->offsets = calloc((size_t)chain->max_id + 1, sizeof(size_t));
+    chain->seen = calloc((size_t)chain->max_id + 1, 1);
+    for (pos = chain->start; pos < chain->committed; pos += check_record(chain, pos)) {
+        RecordHeader header;
+        memcpy(&header, chain->data + pos, sizeof(header));
+        if (header.type == RECORD_NODE) chain->offsets[header.id] = pos;
+    }
+    return chain->root <= chain->max_id && chain->offsets[chain->root] != 0;
+}
+
+// Newest record of node `id`, claimed for the tree being built; NULL if
+// it is missing or already claimed, which only a damaged chain causes
+static const uint8_t* claim_record(Chain* chain, uint32_t id, RecordHeader* header) {
+    if (id == 0 || id > chain->max_id || !chain->offsets[id] || chain->seen[id]) return NULL;
+    chain->seen[id] = 1;
+    const uint8_t* record = chain->data + chain->offsets[id];
+    memcpy(header, record, sizeof(*header));
+    return record;
+}
+
+static BPlusNode* build_node(BPlusTree* tree, Chain* chain, uint32_t id, int depth) {
+    RecordHeader header;
+    const uint8_t* record = claim_record(chain, id, &header);
+    if (!record || depth > MAX_DEPTH) return NULL;
+
+    // Loaded nodes match the file, so they start out clean
+    BPlusNode* node = bplus_tree_alloc_node(tree, header.is_leaf);
+    node->dirty = 0;
+    memcpy(node->keys, record + sizeof(RecordHeader), sizeof(int32_t) * header.num_keys);
+    node->num_keys = (int)header.num_keys;
+    map_put(tree->checkpoint, node, id);
+    if (header.is_leaf) {
+        tree->count += header.num_keys;
+        return node;
+    }
+
+    const uint8_t* ids = record + sizeof(RecordHeader) + sizeof(int32_t) * header.num_keys;
+    for (uint32_t i = 0; i <= header.num_keys; i++) {
+        uint32_t child_id;
+        memcpy(&child_id, ids + sizeof(uint32_t) * i, sizeof(child_id));
+        node->children[i] = build_node(tree, chain, child_id, depth + 1);
+        if (!node->children[i]) return NULL;
+    }
+    return node;
+}
+
+BPlusTree* bplus_checkpoint_load(const char* path) {
+    if (!path) return NULL;
+    int fd = open_locked(path, false);
+    if (fd < 0) return NULL;
+
+    Chain chain;
+    if (!read_chain(fd, &chain)) {
+        chain_free(&chain);
+        close(fd);
+        return NULL;
+    }
+
+    BPlusTreeOptions options = { .order = chain.header.order, .leaf_order = chain.header.leaf_order };
+    BPlusTree* tree = bplus_tree_create_with_options(&options);
+    bplus_tree_free_node(tree, tree->root);
+    struct BPlusCheckpoint* cp = calloc(1, sizeof(struct BPlusCheckpoint));
+    cp->path = strdup(path);
+    cp->lineage = chain.header.lineage;
+    cp->deltas = chain.roots - 1;
+    cp->next_id = chain.max_id + 1;
+    tree->checkpoint = cp;
+    tree->root = build_node(tree, &chain, chain.root, 0);
+
+    struct stat st;
+    bool ok = tree->root && fstat(fd, &st) == 0;
+    if (ok) {
+        cp->dev = st.st_dev;
+        cp->ino = st.st_ino;
+        for (uint32_t id = 1; id <= chain.max_id; id++) {
+            if (!chain.seen[id]) release_id(cp, id);
+        }
+        // Drop a torn delta so the next one follows the committed chain
+        if (chain.committed < chain.size && ftruncate(fd, (off_t)chain.committed) == 0) {
+            fdatasync(fd);
+        }
+    }
+    chain_free(&chain);
+    close(fd);
+
+    if (!ok) {
+        bplus_tree_destroy(tree);
+        return NULL;
+    }
+    link_leaves(tree->root, NULL);
+    return tree;
+}
+
+// Copies the newest record of every node reachable from `id`
+static bool copy_reachable(Writer* w, Chain* chain, uint32_t id, int depth) {
+    RecordHeader header;
+    const uint8_t* record = claim_record(chain, id, &header);
+    if (!record || depth > MAX_DEPTH) return false;
+
+    size_t size = record_size(header.is_leaf, header.num_keys);
+    memcpy(writer_reserve(w, size), record, size);
+    w->nodes++;
+    if (header.is_leaf) return true;
+
+    const uint8_t* ids = record + sizeof(RecordHeader) + sizeof(int32_t) * header.num_keys;
+    for (uint32_t i = 0; i <= header.num_keys; i++) {
+        uint32_t child_id;
+        memcpy(&child_id, ids + sizeof(uint32_t) * i, sizeof(child_id));
+        if (!copy_reachable(w, chain, child_id, depth + 1)) return false;
+    }
+    return true;
+}
+
+bool bplus_checkpoint_compact(const char* path, BPlusCheckpointStats* stats) {
+    if (!path) return false;
+    int fd = open_locked(path, false);
+    if (fd < 0) return false;
+
+    Chain chain;
+    bool ok = read_chain(fd, &chain);
+    Writer w = { .offset = (off_t)chain.size };
+
+    // Ids are kept, so trees checkpointing to this file can go on
+    // appending deltas to the compacted image
+    if (ok && (chain.roots > 1 || chain.committed < chain.size)) {
+        char* temp = temp_path_for(path);
+        int out = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ok = out >= 0;
+        if (ok) {
+            w = (Writer){ .fd = out, .offset = sizeof(FileHeader),
+                          .ok = write_at(out, &chain.header, sizeof(FileHeader), 0) };
+            ok = copy_reachable(&w, &chain, chain.root, 0);
+            emit_root(&w, chain.root);
+            ok = writer_finish(&w) && ok;
+            ok = close(out) == 0 && ok;
+            ok = ok && rename(temp, path) == 0 && sync_parent_dir(path);
+            if (!ok) remove(temp);
+        }
+        free(temp);
+    } else if (ok) {
+        w.nodes = 0;
+    }
+
+    if (ok && stats) {
+        stats->deltas = 0;
+        stats->nodes_written = w.nodes;
+        stats->file_bytes = (uint64_t)w.offset;
+    }
+    chain_free(&chain);
+    close(fd);
+    return ok;
+}
@@ -0,0 +1,481 @@
+// src/core/concurrent.c
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bplus/concurrent.h"
+#include "bplus/search.h"
+#include "internal.h"
+
+// Version word layout: bit 0 obsolete, bit 1 locked, the rest a counter
+// bumped by every write unlock
+#define NODE_OBSOLETE 1u
+#define NODE_LOCKED 2u
+
+#define RECLAIM_THRESHOLD 64
+
+// A slot also carries the tallies of the threads that hold it, so that
+// counting an operation writes a line no other thread is writing
+typedef struct {
+    uint64_t epoch;  // 0 while the owning thread is outside the tree
+    uint64_t keys;   // keys added minus keys removed, modulo 2^64
+    BPlusTreeCounters counters;
+    char pad[2 * BPLUS_CACHE_LINE - 2 * sizeof(uint64_t) - sizeof(BPlusTreeCounters)];
+} EpochSlot;
+
+typedef struct {
+    BPlusNode* node;
+    uint64_t epoch;
+} RetiredNode;
+
+struct BPlusSync {
+    EpochSlot slots[BPLUS_MAX_THREADS];
+    uint64_t global_epoch;
+    pthread_mutex_t pool_lock;
+    pthread_mutex_t retire_lock;
+    RetiredNode* retired;
+    size_t retired_count;
+    size_t retired_capacity;
+};
+
+static _Thread_local int slot_hint;
+
+// Optimistic lock primitives
+static bool read_lock(BPlusNode* node, uint64_t* version) {
+    uint64_t v = __atomic_load_n(&node->version, __ATOMIC_ACQUIRE);
+    if (v & (NODE_LOCKED | NODE_OBSOLETE)) return false;
+    *version = v;
+    return true;
+}
+
+static bool validate(BPlusNode* node, uint64_t version) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&node->version, __ATOMIC_RELAXED) == version;
+}
+
+static bool upgrade(BPlusNode* node, uint64_t version) {
+    return __atomic_compare_exchange_n(&node->version, &version, version + NODE_LOCKED,
+                                       false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+}
+
+static bool try_lock(BPlusNode* node) {
+    uint64_t version;
+    return read_lock(node, &version) && upgrade(node, version);
+}
+
+// Clears the lock bit and bumps the counter; an obsolete bit set while the
+// node was locked survives
+static void unlock(BPlusNode* node) {
+    __atomic_fetch_add(&node->version, NODE_LOCKED, __ATOMIC_RELEASE);
+}
+
+// Lock coupling step: the child's version only counts once the parent is
+// known unchanged after it was read, or a split of the child in between
+// would go unnoticed. The first check keeps a torn child pointer from being
+// dereferenced.
+static bool couple(BPlusNode* parent, uint64_t parent_version, BPlusNode* child, uint64_t* version) {
+    return validate(parent, parent_version) && read_lock(child, version) &&
+           validate(parent, parent_version);
+}
+
+static BPlusNode* load_root(BPlusTree* tree) {
+    return __atomic_load_n(&tree->root, __ATOMIC_ACQUIRE);
+}
+
+// Readers see num_keys mid-update; keep searches inside the arrays
+static int clamp_keys(BPlusTree* tree, BPlusNode* node) {
+    int n = __atomic_load_n(&node->num_keys, __ATOMIC_RELAXED);
+    if (n < 0) return 0;
+    int max_keys = max_keys_of(tree, node);
+    return n > max_keys ? max_keys : n;
+}
+
+static void backoff(int restarts) {
+    if (restarts > 8) {
+        sched_yield();
+    }
+}
+
+// Only the holder of a slot writes its tallies; bplus_tree_stats reads
+// them, so the stores are atomic but need no read-modify-write
+static void slot_add(uint64_t* tally, uint64_t n) {
+    __atomic_store_n(tally, __atomic_load_n(tally, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+#ifdef BPLUS_NO_COUNTERS
+#define SLOT_COUNT(slot, counter, n) ((void)(n))
+#else
+#define SLOT_COUNT(slot, counter, n) slot_add(&(slot)->counters.counter, (n))
+#endif
+
+// Epoch-based reclamation
+static EpochSlot* epoch_enter(struct BPlusSync* sync) {
+    for (;;) {
+        for (int i = 0; i < BPLUS_MAX_THREADS; i++) {
+            int index = (slot_hint + i) % BPLUS_MAX_THREADS;
+            EpochSlot* slot = &sync->slots[index];
+            uint64_t idle = 0;
+            uint64_t epoch = __atomic_load_n(&sync->global_epoch, __ATOMIC_RELAXED);
+            if (__atomic_compare_exchange_n(&slot->epoch, &idle, epoch, false,
+                                            __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                slot_hint = index;
+                return slot;
+            }
+        }
+        sched_yield();
+    }
+}
+
+static void epoch_exit(EpochSlot* slot) {
+    __atomic_store_n(&slot->epoch, 0, __ATOMIC_RELEASE);
+}
+
+// Moves the global epoch forward once every active thread has seen it
+static void try_advance_epoch(struct BPlusSync* sync) {
+    uint64_t epoch = __atomic_load_n(&sync->global_epoch, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < BPLUS_MAX_THREADS; i++) {
+        uint64_t local = __atomic_load_n(&sync->slots[i].epoch, __ATOMIC_SEQ_CST);
+        if (local != 0 && local != epoch) return;
+    }
+    __atomic_compare_exchange_n(&sync->global_epoch, &epoch, epoch + 1, false,
+                                __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+// Frees nodes retired two or more epochs ago; caller holds retire_lock
+static size_t reclaim_retired(BPlusTree* tree) {
+    struct BPlusSync* sync = tree->sync;
+    try_advance_epoch(sync);
+    uint64_t epoch = __atomic_load_n(&sync->global_epoch, __ATOMIC_SEQ_CST);
+
+    size_t kept = 0;
+    size_t freed = 0;
+    pthread_mutex_lock(&sync->pool_lock);
+    for (size_t i = 0; i < sync->retired_count; i++) {
+        RetiredNode* entry = &sync->retired[i];
+        if (entry->epoch + 2 <= epoch) {
+            node_pool_free(entry->node->is_leaf ? &tree->leaf_pool : &tree->internal_pool, entry->node);
+            freed++;
+        } else {
+            sync->retired[kept++] = *entry;
+        }
+    }
+    pthread_mutex_unlock(&sync->pool_lock);
+    sync->retired_count = kept;
+    return freed;
+}
+
+void* sync_pool_alloc(BPlusTree* tree, BPlusNodePool* pool) {
+    pthread_mutex_lock(&tree->sync->pool_lock);
+    void* block = node_pool_alloc(pool);
+    pthread_mutex_unlock(&tree->sync->pool_lock);
+    return block;
+}
+
+// The node is locked by the caller; readers that reach it restart
+void sync_retire(BPlusTree* tree, BPlusNode* node) {
+    struct BPlusSync* sync = tree->sync;
+    __atomic_fetch_or(&node->version, NODE_OBSOLETE, __ATOMIC_RELEASE);
+
+    pthread_mutex_lock(&sync->retire_lock);
+    if (sync->retired_count == sync->retired_capacity) {
+        sync->retired_capacity = sync->retired_capacity ? sync->retired_capacity * 2 : RECLAIM_THRESHOLD;
+        sync->retired = realloc(sync->retired, sizeof(RetiredNode) * sync->retired_capacity);
+    }
+    sync->retired[sync->retired_count].node = node;
+    sync->retired[sync->retired_count].epoch = __atomic_load_n(&sync->global_epoch, __ATOMIC_SEQ_CST);
+    sync->retired_count++;
+    if (sync->retired_count >= RECLAIM_THRESHOLD) {
+        reclaim_retired(tree);
+    }
+    pthread_mutex_unlock(&sync->retire_lock);
+}
+
+void sync_destroy(struct BPlusSync* sync) {
+    pthread_mutex_destroy(&sync->pool_lock);
+    pthread_mutex_destroy(&sync->retire_lock);
+    free(sync->retired);
+    free(sync);
+}
+
+BPlusTree* bplus_tree_create_concurrent(int order) {
+    BPlusTree* tree = bplus_tree_create(order);
+    if (!tree) return NULL;
+
+    struct BPlusSync* sync = calloc(1, sizeof(struct BPlusSync));
+    sync->global_epoch = 1;
+    pthread_mutex_init(&sync->pool_lock, NULL);
+    pthread_mutex_init(&sync->retire_lock, NULL);
+    tree->sync = sync;
+    // Resolve the search kernel now rather than racing on the first lookup
+    bplus_search_get_kernel();
+    return tree;
+}
+
+// Adds up the slots' tallies
+void sync_counters(BPlusTree* tree, BPlusTreeCounters* sum, size_t* keys) {
+    uint64_t added = 0;
+    for (int i = 0; i < BPLUS_MAX_THREADS; i++) {
+        EpochSlot* slot = &tree->sync->slots[i];
+        const uint64_t* tallies = (const uint64_t*)&slot->counters;
+        uint64_t* totals = (uint64_t*)sum;
+        for (size_t c = 0; c < sizeof(BPlusTreeCounters) / sizeof(uint64_t); c++) {
+            totals[c] += __atomic_load_n(&tallies[c], __ATOMIC_RELAXED);
+        }
+        added += __atomic_load_n(&slot->keys, __ATOMIC_RELAXED);
+    }
+    *keys += (size_t)added;
+}
+
+void sync_reset_counters(BPlusTree* tree) {
+    for (int i = 0; i < BPLUS_MAX_THREADS; i++) {
+        uint64_t* tallies = (uint64_t*)&tree->sync->slots[i].counters;
+        for (size_t c = 0; c < sizeof(BPlusTreeCounters) / sizeof(uint64_t); c++) {
+            __atomic_store_n(&tallies[c], 0, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+size_t bplus_tree_reclaim(BPlusTree* tree) {
+    if (!tree || !tree->sync) return 0;
+
+    // Two advances retire everything that was unreachable when we started
+    pthread_mutex_lock(&tree->sync->retire_lock);
+    size_t freed = reclaim_retired(tree);
+    freed += reclaim_retired(tree);
+    freed += reclaim_retired(tree);
+    pthread_mutex_unlock(&tree->sync->retire_lock);
+    return freed;
+}
+
+// Lookup: validate each node after reading from it, restart on conflict
+bool concurrent_search(BPlusTree* tree, int key) {
+    EpochSlot* slot = epoch_enter(tree->sync);
+    bool found = false;
+    uint64_t visits = 0;
+
+    for (int restarts = 0; ; backoff(++restarts)) {
+        BPlusNode* node = load_root(tree);
+        uint64_t version;
+        if (!read_lock(node, &version) || node != load_root(tree)) continue;
+
+        bool valid = true;
+        visits++;
+        while (!node->is_leaf) {
+            int n = clamp_keys(tree, node);
+            BPlusNode* child = node->children[bplus_upper_bound(node->keys, n, key)];
+            if (!couple(node, version, child, &version)) {
+                valid = false;
+                break;
+            }
+            node = child;
+            visits++;
+        }
+        if (!valid) continue;
+
+        int n = clamp_keys(tree, node);
+        int i = bplus_lower_bound(node->keys, n, key);
+        found = i < n && node->keys[i] == key;
+        if (validate(node, version)) break;
+    }
+
+    SLOT_COUNT(slot, searches, 1);
+    SLOT_COUNT(slot, node_visits, visits);
+    epoch_exit(slot);
+    return found;
+}
+
+// Splits `node` (child `index` of `parent`, or the root when parent is
+// NULL). Both are already write-locked; the leaf to the right is locked
+// here because the split rewires its prev link. Returns false on conflict.
+static bool split_locked(BPlusTree* tree, BPlusNode* parent, int index, BPlusNode* node) {
+    BPlusNode* neighbor = node->is_leaf ? node->next : NULL;
+    if (neighbor && !try_lock(neighbor)) return false;
+
+    if (parent) {
+        split_child(tree, parent, index);
+    } else {
+        BPlusNode* root = bplus_tree_alloc_node(tree, false);
+        root->children[0] = node;
+        split_child(tree, root, 0);
+        __atomic_store_n(&tree->root, root, __ATOMIC_RELEASE);
+    }
+
+    if (neighbor) unlock(neighbor);
+    return true;
+}
+
+// Insert with proactive splits: any full node met on the way down is split
+// under the locks of it and its parent, then the descent restarts
+bool concurrent_insert(BPlusTree* tree, int key) {
+    EpochSlot* slot = epoch_enter(tree->sync);
+    bool inserted = false;
+    uint64_t visits = 0;
+
+    for (int restarts = 0; ; backoff(++restarts)) {
+        BPlusNode* node = load_root(tree);
+        uint64_t version;
+        if (!read_lock(node, &version) || node != load_root(tree)) continue;
+
+        BPlusNode* parent = NULL;
+        uint64_t parent_version = 0;
+        int index = 0;
+        bool valid = true;
+
+        for (;;) {
+            visits++;
+            if (node->num_keys >= max_keys_of(tree, node)) {
+                valid = false;
+                if (parent && !upgrade(parent, parent_version)) break;
+                if (!upgrade(node, version)) {
+                    if (parent) unlock(parent);
+                    break;
+                }
+                if (parent || node == load_root(tree)) {
+                    split_locked(tree, parent, index, node);
+                }
+                unlock(node);
+                if (parent) unlock(parent);
+                break;
+            }
+            if (node->is_leaf) break;
+
+            int n = clamp_keys(tree, node);
+            int child_index = bplus_upper_bound(node->keys, n, key);
+            BPlusNode* child = node->children[child_index];
+            parent = node;
+            parent_version = version;
+            index = child_index;
+            node = child;
+            if (!couple(parent, parent_version, node, &version)) {
+                valid = false;
+                break;
+            }
+        }
+        if (!valid || !upgrade(node, version)) continue;
+
+        int i = bplus_lower_bound(node->keys, node->num_keys, key);
+        if (i >= node->num_keys || node->keys[i] != key) {
+            insert_into_leaf(tree, node, key);
+            inserted = true;
+            slot_add(&slot->keys, 1);
+        }
+        unlock(node);
+        break;
+    }
+
+    SLOT_COUNT(slot, inserts, 1);
+    SLOT_COUNT(slot, node_visits, visits);
+    epoch_exit(slot);
+    return inserted;
+}
+
+// Write-locks the nodes a leaf repair under `parent` may touch: the
+// siblings on both sides and the leaf beyond the right-hand one, whose prev
+// link a merge rewires. Returns how many were locked, or -1 on conflict.
+static int lock_neighborhood(BPlusNode* parent, int index, BPlusNode** locked) {
+    BPlusNode* leaf = parent->children[index];
+    BPlusNode* left = index > 0 ? parent->children[index - 1] : NULL;
+    BPlusNode* right = index < parent->num_keys ? parent->children[index + 1] : NULL;
+    BPlusNode* beyond = right ? right->next : leaf->next;
+    BPlusNode* wanted[3] = { left, right, beyond };
+    int count = 0;
+
+    for (int i = 0; i < 3; i++) {
+        if (!wanted[i]) continue;
+        if (!try_lock(wanted[i])) {
+            while (count > 0) unlock(locked[--count]);
+            return -1;
+        }
+        locked[count++] = wanted[i];
+    }
+    return count;
+}
+
+bool concurrent_delete(BPlusTree* tree, int key) {
+    EpochSlot* slot = epoch_enter(tree->sync);
+    int min_keys = (tree->leaf_order - 1) / 2;
+    bool deleted = false;
+    uint64_t visits = 0;
+
+    for (int restarts = 0; ; backoff(++restarts)) {
+        BPlusNode* node = load_root(tree);
+        uint64_t version;
+        if (!read_lock(node, &version) || node != load_root(tree)) continue;
+
+        BPlusNode* parent = NULL;
+        uint64_t parent_version = 0;
+        int index = 0;
+        bool valid = true;
+
+        visits++;
+        while (!node->is_leaf) {
+            int n = clamp_keys(tree, node);
+            int child_index = bplus_upper_bound(node->keys, n, key);
+            BPlusNode* child = node->children[child_index];
+            parent = node;
+            parent_version = version;
+            index = child_index;
+            node = child;
+            visits++;
+            if (!couple(parent, parent_version, node, &version)) {
+                valid = false;
+                break;
+            }
+        }
+        if (!valid) continue;
+
+        int n = clamp_keys(tree, node);
+        int i = bplus_lower_bound(node->keys, n, key);
+        if (i >= n || node->keys[i] != key) {
+            if (!validate(node, version)) continue;
+            break;
+        }
+
+        // Common case: the leaf stays at or above minimum occupancy
+        bool repair = parent && n - 1 < min_keys;
+        if (!repair) {
+            if (!upgrade(node, version)) continue;
+            memmove(&node->keys[i], &node->keys[i + 1], sizeof(int) * (node->num_keys - i - 1));
+            node->num_keys--;
+            unlock(node);
+            deleted = true;
+            break;
+        }
+
+        // Underflow: lock the parent, the leaf and its neighborhood
+        if (!upgrade(parent, parent_version)) continue;
+        if (!upgrade(node, version)) {
+            unlock(parent);
+            continue;
+        }
+        BPlusNode* locked[3];
+        int locked_count = lock_neighborhood(parent, index, locked);
+        if (locked_count < 0) {
+            unlock(node);
+            unlock(parent);
+            continue;
+        }
+
+        memmove(&node->keys[i], &node->keys[i + 1], sizeof(int) * (node->num_keys - i - 1));
+        node->num_keys--;
+        if (parent->num_keys > 0) {
+            fix_underflow(tree, parent, index);
+        }
+        if (parent->num_keys == 0 && parent == load_root(tree)) {
+            __atomic_store_n(&tree->root, parent->children[0], __ATOMIC_RELEASE);
+            bplus_tree_free_node(tree, parent);
+        }
+
+        while (locked_count > 0) unlock(locked[--locked_count]);
+        unlock(node);
+        unlock(parent);
+        deleted = true;
+        break;
+    }
+
+    if (deleted) slot_add(&slot->keys, (uint64_t)-1);
+    SLOT_COUNT(slot, deletes, 1);
+    SLOT_COUNT(slot, node_visits, visits);
+    epoch_exit(slot);
+    return deleted;
+}
@@ -0,0 +1,87 @@
+// src/core/cursor.c
+#include <string.h>
+#include "bplus/cursor.h"
+#include "bplus/search.h"
+#include "internal.h"
+
+static BPlusNode* find_leaf_for(BPlusTree* tree, int key) {
+    BPlusNode* node = tree->root;
+    while (!node->is_leaf) {
+        node = node->children[bplus_upper_bound(node->keys, node->num_keys, key)];
+    }
+    return node;
+}
+
+void bplus_cursor_seek(BPlusCursor* cursor, BPlusTree* tree, int key) {
+    cursor->leaf = find_leaf_for(tree, key);
+    cursor->index = leaf_lower_bound(cursor->leaf, key);
+}
+
+void bplus_cursor_seek_upper(BPlusCursor* cursor, BPlusTree* tree, int key) {
+    cursor->leaf = find_leaf_for(tree, key);
+    cursor->index = leaf_upper_bound(cursor->leaf, key);
+}
+
+void bplus_cursor_first(BPlusCursor* cursor, BPlusTree* tree) {
+    BPlusNode* node = tree->root;
+    while (!node->is_leaf) {
+        node = node->children[0];
+    }
+    cursor->leaf = node;
+    cursor->index = 0;
+}
+
+void bplus_cursor_last(BPlusCursor* cursor, BPlusTree* tree) {
+    BPlusNode* node = tree->root;
+    while (!node->is_leaf) {
+        node = node->children[node->num_keys];
+    }
+    cursor->leaf = node;
+    cursor->index = node->num_keys;
+}
+
+// At the end of the chain the cursor stays on the last leaf, so prev() can
+// still walk back from there
+bool bplus_cursor_next(BPlusCursor* cursor, int* key) {
+    while (cursor->index >= cursor->leaf->num_keys) {
+        if (!cursor->leaf->next) return false;
+        cursor->leaf = cursor->leaf->next;
+        cursor->index = 0;
+    }
+    *key = leaf_key(cursor->leaf, cursor->index++);
+    return true;
+}
+
+bool bplus_cursor_prev(BPlusCursor* cursor, int* key) {
+    while (cursor->index == 0) {
+        if (!cursor->leaf->prev) return false;
+        cursor->leaf = cursor->leaf->prev;
+        cursor->index = cursor->leaf->num_keys;
+    }
+    *key = leaf_key(cursor->leaf, --cursor->index);
+    return true;
+}
+
+size_t bplus_cursor_next_batch(BPlusCursor* cursor, int* buf, size_t n) {
+    size_t copied = 0;
+    while (copied < n) {
+        if (cursor->index >= cursor->leaf->num_keys) {
+            if (!cursor->leaf->next) break;
+            cursor->leaf = cursor->leaf->next;
+            cursor->index = 0;
+            continue;
+        }
+        size_t run = (size_t)(cursor->leaf->num_keys - cursor->index);
+        if (run > n - copied) run = n - copied;
+        if (cursor->leaf->packed) {
+            for (size_t i = 0; i < run; i++) {
+                buf[copied + i] = packed_key(cursor->leaf, cursor->index + (int)i);
+            }
+        } else {
+            memcpy(&buf[copied], &cursor->leaf->keys[cursor->index], sizeof(int) * run);
+        }
+        cursor->index += (int)run;
+        copied += run;
+    }
+    return copied;
+}
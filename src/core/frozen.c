@@ -0,0 +1,129 @@
+// src/core/frozen.c
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bplus/cursor.h"
+#include "bplus/frozen.h"
+#include "bplus/search.h"
+
+#define NODE_KEYS BPLUS_FROZEN_NODE_KEYS
+#define FANOUT (NODE_KEYS + 1)
+
+static int* alloc_lines(size_t nodes) {
+    return aligned_alloc(BPLUS_CACHE_LINE, sizeof(int) * NODE_KEYS * nodes);
+}
+
+static size_t count_keys(BPlusTree* tree) {
+    BPlusNode* leaf = tree->root;
+    while (!leaf->is_leaf) {
+        leaf = leaf->children[0];
+    }
+    size_t count = 0;
+    for (; leaf; leaf = leaf->next) {
+        count += (size_t)leaf->num_keys;
+    }
+    return count;
+}
+
+// Level sizes bottom-up: each level has one node per FANOUT nodes below
+static void plan_levels(BPlusFrozenTree* frozen, size_t blocks) {
+    size_t sizes[BPLUS_FROZEN_MAX_LEVELS + 1];
+    int levels = 0;
+    sizes[0] = blocks;
+    while (sizes[levels] > 1) {
+        sizes[levels + 1] = (sizes[levels] + FANOUT - 1) / FANOUT;
+        levels++;
+    }
+
+    frozen->levels = levels;
+    size_t start = 0;
+    for (int l = 0; l <= levels; l++) {
+        frozen->level_nodes[l] = sizes[levels - l];
+        if (l < levels) {
+            frozen->level_start[l] = start;
+            start += frozen->level_nodes[l];
+        }
+    }
+}
+
+// Separator j of a node is the smallest key under child j + 1, which is
+// the first key of that child's leftmost leaf block
+static void fill_index(BPlusFrozenTree* frozen) {
+    size_t span = 1;   // leaf blocks under one node of the level being filled
+    for (int l = frozen->levels - 1; l >= 0; l--) {
+        size_t child_span = span;
+        span *= FANOUT;
+        size_t blocks = frozen->level_nodes[frozen->levels];
+        for (size_t k = 0; k < frozen->level_nodes[l]; k++) {
+            int* node = frozen->index + (frozen->level_start[l] + k) * NODE_KEYS;
+            for (size_t j = 0; j < NODE_KEYS; j++) {
+                size_t block = k * span + (j + 1) * child_span;
+                node[j] = block < blocks ? frozen->keys[block * NODE_KEYS] : INT_MAX;
+            }
+        }
+    }
+}
+
+BPlusFrozenTree* bplus_tree_freeze(BPlusTree* tree) {
+    if (!tree || !tree->root) return NULL;
+
+    BPlusFrozenTree* frozen = calloc(1, sizeof(BPlusFrozenTree));
+    if (!frozen) return NULL;
+    frozen->count = count_keys(tree);
+    size_t blocks = frozen->count ? (frozen->count + NODE_KEYS - 1) / NODE_KEYS : 1;
+    plan_levels(frozen, blocks);
+
+    size_t index_nodes = frozen->levels ? frozen->level_start[frozen->levels - 1] +
+                                          frozen->level_nodes[frozen->levels - 1] : 0;
+    frozen->keys = alloc_lines(blocks);
+    frozen->index = index_nodes ? alloc_lines(index_nodes) : NULL;
+    if (!frozen->keys || (index_nodes && !frozen->index)) {
+        bplus_frozen_tree_destroy(frozen);
+        return NULL;
+    }
+
+    BPlusCursor cursor;
+    bplus_cursor_first(&cursor, tree);
+    size_t copied = bplus_cursor_next_batch(&cursor, frozen->keys, frozen->count);
+    for (size_t i = copied; i < blocks * NODE_KEYS; i++) {
+        frozen->keys[i] = INT_MAX;
+    }
+    fill_index(frozen);
+    return frozen;
+}
+
+void bplus_frozen_tree_destroy(BPlusFrozenTree* frozen) {
+    if (!frozen) return;
+    free(frozen->keys);
+    free(frozen->index);
+    free(frozen);
+}
+
+// Each level counts the separators below the key, which is the child to
+// take; padding separators are INT_MAX and never counted. A key equal to
+// a separator goes left, and if nothing there is >= key, the answer is
+// the first key of the next block, which follows in the array.
+size_t bplus_frozen_tree_rank(const BPlusFrozenTree* frozen, int key) {
+    size_t k = 0;
+    for (int l = 0; l < frozen->levels; l++) {
+        const int* node = frozen->index + (frozen->level_start[l] + k) * NODE_KEYS;
+        k = k * FANOUT + (size_t)bplus_lower_bound(node, NODE_KEYS, key);
+    }
+    size_t rank = k * NODE_KEYS + (size_t)bplus_lower_bound(frozen->keys + k * NODE_KEYS, NODE_KEYS, key);
+    return rank < frozen->count ? rank : frozen->count;
+}
+
+bool bplus_frozen_tree_search(const BPlusFrozenTree* frozen, int key) {
+    if (!frozen) return false;
+    size_t rank = bplus_frozen_tree_rank(frozen, key);
+    return rank < frozen->count && frozen->keys[rank] == key;
+}
+
+size_t bplus_frozen_tree_memory_usage(const BPlusFrozenTree* frozen) {
+    if (!frozen) return 0;
+    size_t nodes = frozen->level_nodes[frozen->levels];
+    if (frozen->levels) {
+        nodes += frozen->level_start[frozen->levels - 1] + frozen->level_nodes[frozen->levels - 1];
+    }
+    return sizeof(int) * NODE_KEYS * nodes;
+}
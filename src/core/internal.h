@@ -0,0 +1,176 @@
+// src/core/internal.h
+// Helpers shared between the core translation units; not part of the API.
+#ifndef BPLUS_INTERNAL_H
+#define BPLUS_INTERNAL_H
+
+#include <string.h>
+#include "bplus/tree.h"
+#include "bplus/journal.h"
+#include "bplus/search.h"
+#include "bplus/snapshot.h"
+
+// tree.c: single-node mutation steps
+void insert_into_leaf(BPlusTree* tree, BPlusNode* leaf, int key);
+void split_child(BPlusTree* tree, BPlusNode* parent, int index);
+void fix_underflow(BPlusTree* tree, BPlusNode* parent, int index);
+void print_node(BPlusNode* node, int level);
+
+// concurrent.c: optimistic lock coupling and epoch-based reclamation
+bool concurrent_search(BPlusTree* tree, int key);
+bool concurrent_insert(BPlusTree* tree, int key);
+bool concurrent_delete(BPlusTree* tree, int key);
+void* sync_pool_alloc(BPlusTree* tree, BPlusNodePool* pool);
+void sync_retire(BPlusTree* tree, BPlusNode* node);
+void sync_destroy(struct BPlusSync* sync);
+void sync_counters(BPlusTree* tree, BPlusTreeCounters* sum, size_t* keys);
+void sync_reset_counters(BPlusTree* tree);
+
+// snapshot.c: path copying while snapshots share nodes with the tree
+BPlusNode* snapshot_unshare(BPlusTree* tree, BPlusNode* parent, int index);
+uint64_t snapshot_generation(BPlusTree* tree);
+void snapshot_retire(BPlusTree* tree, BPlusNode* node);
+void snapshot_maintain(BPlusTree* tree);
+void snapshot_destroy(struct BPlusVersions* versions);
+BPlusTree* snapshot_tree(const BPlusSnapshot* snapshot);
+BPlusNode* snapshot_root(const BPlusSnapshot* snapshot);
+
+// utils.c: rebuilds the leaf chain of a tree read from a file
+BPlusNode* link_leaves(BPlusNode* node, BPlusNode* prev);
+
+// checkpoint.c: node ids that stay stable across incremental checkpoints
+void checkpoint_forget(BPlusTree* tree, BPlusNode* node);
+void checkpoint_transfer(BPlusTree* tree, BPlusNode* from, BPlusNode* to);
+void checkpoint_destroy(struct BPlusCheckpoint* checkpoint);
+
+// journal.c: node ids and the change log (journal.h)
+void journal_record(BPlusTree* tree, BPlusNode* node, BPlusChangeKind kind);
+void journal_forget(BPlusTree* tree, BPlusNode* node);
+void journal_transfer(BPlusTree* tree, BPlusNode* from, BPlusNode* to);
+void journal_destroy(struct BPlusJournal* journal);
+
+// packed.c: frame-of-reference leaf encoding (BPLUS_TREE_PACKED_LEAVES)
+struct BPlusPackedKeys* packed_create(BPlusTree* tree);
+void packed_free(BPlusTree* tree, BPlusNode* leaf);
+void packed_encode(BPlusTree* tree, BPlusNode* leaf, const int* keys);
+void packed_decode(const BPlusNode* leaf, int* out);
+int packed_key(const BPlusNode* leaf, int i);
+int packed_lower_bound(const BPlusNode* leaf, int key);
+int packed_upper_bound(const BPlusNode* leaf, int key);
+
+// Capacity and minimum occupancy of `node`; leaves and internal nodes
+// each have their own order
+static inline int max_keys_of(const BPlusTree* tree, const BPlusNode* node) {
+    return (node->is_leaf ? tree->leaf_order : tree->order) - 1;
+}
+
+static inline int min_keys_of(const BPlusTree* tree, const BPlusNode* node) {
+    return max_keys_of(tree, node) / 2;
+}
+
+// Leaf key access that works on plain and packed leaves alike
+static inline int leaf_key(const BPlusNode* leaf, int i) {
+    return leaf->packed ? packed_key(leaf, i) : leaf->keys[i];
+}
+
+static inline int leaf_lower_bound(const BPlusNode* leaf, int key) {
+    return leaf->packed ? packed_lower_bound(leaf, key)
+                        : bplus_lower_bound(leaf->keys, leaf->num_keys, key);
+}
+
+static inline int leaf_upper_bound(const BPlusNode* leaf, int key) {
+    return leaf->packed ? packed_upper_bound(leaf, key)
+                        : bplus_upper_bound(leaf->keys, leaf->num_keys, key);
+}
+
+// The keys of `leaf` as an array to edit in place: its own, or those of a
+// packed leaf decoded into scratch buffer `slot` (0 or 1). Edits to a
+// packed leaf take effect at leaf_store().
+static inline int* leaf_keys(BPlusTree* tree, BPlusNode* leaf, int slot) {
+    if (!leaf->packed) return leaf->keys;
+    int* keys = tree->scratch + slot * tree->leaf_order;
+    packed_decode(leaf, keys);
+    return keys;
+}
+
+static inline void leaf_store(BPlusTree* tree, BPlusNode* leaf, const int* keys) {
+    if (leaf->packed) packed_encode(tree, leaf, keys);
+}
+
+// Replaces the keys of `leaf` with n sorted keys
+static inline void leaf_assign(BPlusTree* tree, BPlusNode* leaf, const int* keys, int n) {
+    leaf->num_keys = n;
+    if (leaf->packed) {
+        packed_encode(tree, leaf, keys);
+    } else {
+        memmove(leaf->keys, keys, sizeof(int) * n);
+    }
+}
+
+// Counter updates (see stats.h). Concurrent writers reach the shared
+// mutation steps holding only node locks, so there the adds are atomic.
+// Lookups go through COUNT_READ instead: they may run in parallel on a
+// tree shared under a reader lock, so each thread adds to a slot of its
+// own in tree->reads rather than to tree->counters.
+#ifdef BPLUS_NO_COUNTERS
+#define COUNT(tree, counter, n) ((void)(n))
+#define COUNT_READ(tree, searches, visits) ((void)(searches), (void)(visits))
+#else
+#define COUNT(tree, counter, n) count_add((tree), &(tree)->counters.counter, (n))
+#define COUNT_READ(tree, searches, visits) count_read((tree), (searches), (visits))
+#endif
+
+// Slots are shared only by threads beyond the first BPLUS_READ_SLOTS
+#define BPLUS_READ_SLOTS 16
+
+struct BPlusReadTally {
+    uint64_t searches;
+    uint64_t node_visits;
+    char pad[BPLUS_CACHE_LINE - 2 * sizeof(uint64_t)];
+};
+
+// stats.c: the calling thread's slot
+unsigned read_slot(void);
+// stats.c: NULL when the library keeps no counters
+struct BPlusReadTally* read_tallies_create(void);
+
+static inline void count_read(BPlusTree* tree, uint64_t searches, uint64_t visits) {
+    if (!tree->reads) return;
+    struct BPlusReadTally* tally = &tree->reads[read_slot()];
+    __atomic_fetch_add(&tally->searches, searches, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&tally->node_visits, visits, __ATOMIC_RELAXED);
+}
+
+static inline void count_add(BPlusTree* tree, uint64_t* counter, uint64_t n) {
+    if (tree->sync) {
+        __atomic_fetch_add(counter, n, __ATOMIC_RELAXED);
+    } else {
+        *counter += n;
+    }
+}
+
+// Records a change to `node` for the next incremental checkpoint. Every
+// node a write modifies must be marked, and reached through the helpers
+// below so that its ancestors lead the checkpoint to it.
+static inline void mark_dirty(BPlusTree* tree, BPlusNode* node) {
+    if (tree->checkpoint) node->dirty |= BPLUS_DIRTY_SELF;
+    if (tree->journal) journal_record(tree, node, BPLUS_CHANGE_KEYS);
+}
+
+// Records a split or merge of `node`, on top of the change mark_dirty
+// records, for the journal
+static inline void note_change(BPlusTree* tree, BPlusNode* node, BPlusChangeKind kind) {
+    if (tree->journal) journal_record(tree, node, kind);
+}
+
+// Child `index` of `parent`, copied first if a snapshot shares it. Every
+// node a write modifies must be reached through these, root first.
+static inline BPlusNode* writable_child(BPlusTree* tree, BPlusNode* parent, int index) {
+    if (tree->checkpoint) parent->dirty |= BPLUS_DIRTY_BELOW;
+    return tree->versions ? snapshot_unshare(tree, parent, index) : parent->children[index];
+}
+
+static inline BPlusNode* writable_root(BPlusTree* tree) {
+    return tree->versions ? snapshot_unshare(tree, NULL, 0) : tree->root;
+}
+
+#endif // BPLUS_INTERNAL_H
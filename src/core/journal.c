@@ -0,0 +1,219 @@
+// src/core/journal.c
+#include <stdlib.h>
+#include "bplus/journal.h"
+#include "internal.h"
+
+// Open addressing from nonzero keys to values. Each journal keeps two:
+// node address to id and id to node address.
+typedef struct {
+    uint64_t* keys;
+    uint64_t* values;
+    size_t mask;
+    size_t used;
+} IdTable;
+
+struct BPlusJournal {
+    IdTable ids;
+    IdTable nodes;
+    uint32_t next_id;
+    BPlusChange* changes;    // ring: version v is at (v - 1) % capacity
+    size_t capacity;
+    uint64_t version;
+    uint64_t oldest;
+};
+
+static size_t slot_of(const IdTable* table, uint64_t key) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & table->mask;
+}
+
+static void table_put(IdTable* table, uint64_t key, uint64_t value);
+
+static void table_grow(IdTable* table) {
+    uint64_t* old_keys = table->keys;
+    uint64_t* old_values = table->values;
+    size_t old_capacity = old_keys ? table->mask + 1 : 0;
+    size_t capacity = old_capacity ? old_capacity * 2 : 256;
+
+    table->keys = calloc(capacity, sizeof(uint64_t));
+    table->values = malloc(sizeof(uint64_t) * capacity);
+    table->mask = capacity - 1;
+    table->used = 0;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (old_keys[i]) table_put(table, old_keys[i], old_values[i]);
+    }
+    free(old_keys);
+    free(old_values);
+}
+
+static void table_put(IdTable* table, uint64_t key, uint64_t value) {
+    if (!table->keys || 2 * (table->used + 1) > table->mask + 1) table_grow(table);
+    size_t i = slot_of(table, key);
+    while (table->keys[i] && table->keys[i] != key) {
+        i = (i + 1) & table->mask;
+    }
+    if (!table->keys[i]) table->used++;
+    table->keys[i] = key;
+    table->values[i] = value;
+}
+
+static uint64_t table_get(const IdTable* table, uint64_t key) {
+    if (!table->keys) return 0;
+    for (size_t i = slot_of(table, key); table->keys[i]; i = (i + 1) & table->mask) {
+        if (table->keys[i] == key) return table->values[i];
+    }
+    return 0;
+}
+
+// Backward-shift deletion, as for checkpoint ids
+static uint64_t table_remove(IdTable* table, uint64_t key) {
+    if (!table->keys) return 0;
+    size_t i = slot_of(table, key);
+    while (table->keys[i] != key) {
+        if (!table->keys[i]) return 0;
+        i = (i + 1) & table->mask;
+    }
+    uint64_t value = table->values[i];
+    table->used--;
+
+    size_t hole = i;
+    for (size_t j = (i + 1) & table->mask; table->keys[j]; j = (j + 1) & table->mask) {
+        size_t home = slot_of(table, table->keys[j]);
+        if (((j - home) & table->mask) >= ((j - hole) & table->mask)) {
+            table->keys[hole] = table->keys[j];
+            table->values[hole] = table->values[j];
+            hole = j;
+        }
+    }
+    table->keys[hole] = 0;
+    return value;
+}
+
+static void table_free(IdTable* table) {
+    free(table->keys);
+    free(table->values);
+}
+
+static void bind(struct BPlusJournal* journal, const BPlusNode* node, uint32_t id) {
+    table_put(&journal->ids, (uint64_t)(uintptr_t)node, id);
+    table_put(&journal->nodes, id, (uint64_t)(uintptr_t)node);
+}
+
+static uint32_t unbind(struct BPlusJournal* journal, const BPlusNode* node) {
+    uint32_t id = (uint32_t)table_remove(&journal->ids, (uint64_t)(uintptr_t)node);
+    if (id) table_remove(&journal->nodes, id);
+    return id;
+}
+
+static void append(struct BPlusJournal* journal, uint32_t id, BPlusChangeKind kind) {
+    // Nothing is folded into the previous change: a reader may already
+    // have taken it, and so must see a later version for this one
+    uint64_t version = ++journal->version;
+    journal->changes[(version - 1) % journal->capacity] = (BPlusChange){ version, id, kind };
+    if (version - journal->oldest >= journal->capacity) {
+        journal->oldest = version - journal->capacity + 1;
+    }
+}
+
+// A node not seen before was just allocated: whatever the write goes on
+// to do with it, it is new
+void journal_record(BPlusTree* tree, BPlusNode* node, BPlusChangeKind kind) {
+    struct BPlusJournal* journal = tree->journal;
+    uint32_t id = (uint32_t)table_get(&journal->ids, (uint64_t)(uintptr_t)node);
+    if (id == 0) {
+        id = journal->next_id++;
+        bind(journal, node, id);
+        kind = BPLUS_CHANGE_CREATED;
+    }
+    append(journal, id, kind);
+}
+
+void journal_forget(BPlusTree* tree, BPlusNode* node) {
+    uint32_t id = unbind(tree->journal, node);
+    if (id) append(tree->journal, id, BPLUS_CHANGE_REMOVED);
+}
+
+// The copy was recorded as created when it was allocated, just before
+// this; to readers of the journal it is the same node, so that record and
+// its id are withdrawn
+void journal_transfer(BPlusTree* tree, BPlusNode* from, BPlusNode* to) {
+    struct BPlusJournal* journal = tree->journal;
+    uint32_t fresh = unbind(journal, to);
+    if (fresh && fresh == journal->next_id - 1 && journal->version > 0) {
+        const BPlusChange* last = &journal->changes[(journal->version - 1) % journal->capacity];
+        if (last->node == fresh) journal->version--;
+        journal->next_id--;
+    }
+    uint32_t id = unbind(journal, from);
+    if (id) bind(journal, to, id);
+}
+
+static void bind_subtree(struct BPlusJournal* journal, const BPlusNode* node) {
+    bind(journal, node, journal->next_id++);
+    if (node->is_leaf) return;
+    for (int i = 0; i <= node->num_keys; i++) {
+        bind_subtree(journal, node->children[i]);
+    }
+}
+
+bool bplus_tree_journal_start(BPlusTree* tree, size_t capacity) {
+    if (!tree || !tree->root || tree->sync || tree->journal || capacity == 0) return false;
+
+    struct BPlusJournal* journal = calloc(1, sizeof(struct BPlusJournal));
+    journal->changes = malloc(sizeof(BPlusChange) * capacity);
+    journal->capacity = capacity;
+    journal->next_id = 1;
+    journal->oldest = 1;
+    bind_subtree(journal, tree->root);
+    tree->journal = journal;
+    return true;
+}
+
+void journal_destroy(struct BPlusJournal* journal) {
+    table_free(&journal->ids);
+    table_free(&journal->nodes);
+    free(journal->changes);
+    free(journal);
+}
+
+void bplus_tree_journal_stop(BPlusTree* tree) {
+    if (!tree || !tree->journal) return;
+    journal_destroy(tree->journal);
+    tree->journal = NULL;
+}
+
+uint64_t bplus_tree_journal_version(const BPlusTree* tree) {
+    return tree && tree->journal ? tree->journal->version : 0;
+}
+
+uint64_t bplus_tree_journal_oldest(const BPlusTree* tree) {
+    return tree && tree->journal ? tree->journal->oldest : 0;
+}
+
+bool bplus_tree_journal_get(const BPlusTree* tree, uint64_t version, BPlusChange* out) {
+    if (!tree || !tree->journal || !out) return false;
+    const struct BPlusJournal* journal = tree->journal;
+    if (version < journal->oldest || version > journal->version || version == 0) return false;
+    *out = journal->changes[(version - 1) % journal->capacity];
+    return true;
+}
+
+uint32_t bplus_tree_node_id(const BPlusTree* tree, const BPlusNode* node) {
+    if (!tree || !tree->journal || !node) return 0;
+    return (uint32_t)table_get(&tree->journal->ids, (uint64_t)(uintptr_t)node);
+}
+
+BPlusNode* bplus_tree_node_by_id(const BPlusTree* tree, uint32_t id) {
+    if (!tree || !tree->journal || id == 0) return NULL;
+    return (BPlusNode*)(uintptr_t)table_get(&tree->journal->nodes, id);
+}
+
+const char* bplus_change_kind_name(BPlusChangeKind kind) {
+    switch (kind) {
+    case BPLUS_CHANGE_CREATED: return "created";
+    case BPLUS_CHANGE_KEYS: return "keys";
+    case BPLUS_CHANGE_SPLIT: return "split";
+    case BPLUS_CHANGE_MERGED: return "merged";
+    case BPLUS_CHANGE_REMOVED: return "removed";
+    }
+    return "unknown";
+}
@@ -0,0 +1,141 @@
+// src/core/json.c
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "bplus/json.h"
+#include "internal.h"
+
+enum { STAGE_PROLOGUE, STAGE_NODES, STAGE_EPILOGUE, STAGE_DONE };
+enum { PHASE_OPEN, PHASE_KEYS, PHASE_CHILDREN };
+
+static void init_writer(BPlusJsonWriter* writer, const BPlusTree* tree, const BPlusNode* root,
+                        const BPlusJsonLimits* limits) {
+    memset(writer, 0, sizeof(*writer));
+    writer->tree = tree;
+    writer->root = root;
+    if (limits) writer->limits = *limits;
+    if (writer->limits.max_depth <= 0 || writer->limits.max_depth > BPLUS_JSON_MAX_HEIGHT) {
+        writer->limits.max_depth = BPLUS_JSON_MAX_HEIGHT;
+    }
+}
+
+void bplus_json_writer_init(BPlusJsonWriter* writer, const BPlusTree* tree,
+                            const BPlusJsonLimits* limits) {
+    init_writer(writer, tree, tree ? tree->root : NULL, limits);
+}
+
+void bplus_json_writer_init_snapshot(BPlusJsonWriter* writer, const BPlusSnapshot* snapshot,
+                                     const BPlusJsonLimits* limits) {
+    init_writer(writer, snapshot ? snapshot_tree(snapshot) : NULL,
+                snapshot ? snapshot_root(snapshot) : NULL, limits);
+}
+
+static void emit(BPlusJsonWriter* writer, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(writer->pending, sizeof(writer->pending), format, args);
+    va_end(args);
+    writer->pending_len = (size_t)n;
+}
+
+// One step of the walk of the node on top of the stack. A child is only
+// pushed if the limits allow it, so nothing written is ever taken back.
+static void node_token(BPlusJsonWriter* writer) {
+    BPlusJsonFrame* frame = &writer->stack[writer->depth - 1];
+    const BPlusNode* node = frame->node;
+
+    switch (frame->phase) {
+    case PHASE_OPEN:
+        writer->nodes++;
+        emit(writer, "%s{\"leaf\":%s,\"keys\":[", frame->first ? "" : ",",
+             node->is_leaf ? "true" : "false");
+        frame->phase = PHASE_KEYS;
+        return;
+
+    case PHASE_KEYS:
+        if (frame->index < node->num_keys) {
+            int key = node->is_leaf ? leaf_key(node, frame->index) : node->keys[frame->index];
+            emit(writer, "%s%d", frame->index ? "," : "", key);
+            frame->index++;
+        } else if (node->is_leaf) {
+            emit(writer, "]}");
+            writer->depth--;
+        } else {
+            emit(writer, "],\"children\":[");
+            frame->phase = PHASE_CHILDREN;
+            frame->index = 0;
+        }
+        return;
+
+    case PHASE_CHILDREN: {
+        if (frame->index > node->num_keys) {
+            emit(writer, "]}");
+            writer->depth--;
+            return;
+        }
+        bool first = frame->index == 0;
+        const BPlusNode* child = node->children[frame->index++];
+        if (writer->depth == writer->limits.max_depth ||
+            (writer->limits.max_nodes && writer->nodes >= writer->limits.max_nodes)) {
+            emit(writer, first ? "null" : ",null");
+            writer->truncated = true;
+            return;
+        }
+        writer->stack[writer->depth++] = (BPlusJsonFrame){ child, 0, PHASE_OPEN, first };
+        return;
+    }
+    }
+}
+
+static void next_token(BPlusJsonWriter* writer) {
+    writer->pending_len = 0;
+    writer->pending_pos = 0;
+
+    switch (writer->stage) {
+    case STAGE_PROLOGUE: {
+        if (!writer->root) {
+            emit(writer, "null");
+            writer->stage = STAGE_DONE;
+            return;
+        }
+        int height = 1;
+        for (const BPlusNode* node = writer->root; !node->is_leaf; node = node->children[0]) {
+            height++;
+        }
+        emit(writer, "{\"order\":%d,\"leaf_order\":%d,\"height\":%d,\"root\":",
+             writer->tree->order, writer->tree->leaf_order, height);
+        writer->stack[0] = (BPlusJsonFrame){ writer->root, 0, PHASE_OPEN, true };
+        writer->depth = 1;
+        writer->stage = STAGE_NODES;
+        return;
+    }
+
+    case STAGE_NODES:
+        node_token(writer);
+        if (writer->depth == 0) writer->stage = STAGE_EPILOGUE;
+        return;
+
+    case STAGE_EPILOGUE:
+        emit(writer, ",\"nodes\":%zu,\"truncated\":%s}", writer->nodes,
+             writer->truncated ? "true" : "false");
+        writer->stage = STAGE_DONE;
+        return;
+    }
+}
+
+size_t bplus_json_writer_read(BPlusJsonWriter* writer, char* buf, size_t cap) {
+    size_t written = 0;
+    while (written < cap) {
+        if (writer->pending_pos == writer->pending_len) {
+            if (writer->stage == STAGE_DONE) break;
+            next_token(writer);
+            continue;
+        }
+        size_t n = writer->pending_len - writer->pending_pos;
+        if (n > cap - written) n = cap - written;
+        memcpy(buf + written, writer->pending + writer->pending_pos, n);
+        writer->pending_pos += n;
+        written += n;
+    }
+    return written;
+}
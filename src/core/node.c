@@ -0,0 +1,182 @@
+// src/core/node.c
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bplus/tree.h"
+#include "internal.h"
+
+#define SLAB_BYTES (64 * 1024)
+#define AUTO_NODE_LINES 16
+// Larger requests get the order of a node this size
+#define MAX_NODE_BYTES (16u << 20)
+
+static size_t round_up(size_t size, size_t align) {
+    return (size + align - 1) & ~(align - 1);
+}
+
+// Header, then keys, then (internal nodes only) the children array
+size_t bplus_node_size(int order, bool is_leaf) {
+    size_t size = sizeof(BPlusNode) + sizeof(int) * (order - 1);
+    if (!is_leaf) {
+        size = round_up(size, sizeof(BPlusNode*)) + sizeof(BPlusNode*) * order;
+    }
+    return round_up(size, BPLUS_CACHE_LINE);
+}
+
+// Leaves take four bytes per key, internal nodes twelve, less alignment
+// padding: start from the estimate and step down until the block fits
+int bplus_order_for_bytes(size_t bytes, bool is_leaf) {
+    if (bytes > MAX_NODE_BYTES) bytes = MAX_NODE_BYTES;
+    size_t room = bytes > sizeof(BPlusNode) ? bytes - sizeof(BPlusNode) : 0;
+    size_t per_key = is_leaf ? sizeof(int) : sizeof(int) + sizeof(BPlusNode*);
+    int order = (int)(room / per_key) + 1;
+    while (order > 3 && bplus_node_size(order, is_leaf) > bytes) {
+        order--;
+    }
+    return order < 3 ? 3 : order;
+}
+
+size_t bplus_node_bytes_auto(void) {
+    long line = -1;
+#ifdef _SC_LEVEL1_DCACHE_LINESIZE
+    line = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+#endif
+    long page = sysconf(_SC_PAGESIZE);
+    if (line <= 0) line = BPLUS_CACHE_LINE;
+    if (page <= 0) page = 4096;
+    size_t bytes = (size_t)line * AUTO_NODE_LINES;
+    return bytes < (size_t)page ? bytes : (size_t)page;
+}
+
+static BPlusNode* init_node(void* block, int order, bool is_leaf) {
+    BPlusNode* node = (BPlusNode*)block;
+    node->keys = (int*)(node + 1);
+    node->children = NULL;
+    node->next = NULL;
+    node->prev = NULL;
+    node->version = 0;
+    node->is_leaf = is_leaf;
+    node->dirty = 0;
+    node->num_keys = 0;
+
+    if (!is_leaf) {
+        uintptr_t end = (uintptr_t)(node->keys + (order - 1));
+        node->children = (BPlusNode**)round_up(end, sizeof(BPlusNode*));
+        memset(node->children, 0, sizeof(BPlusNode*) * order);
+    }
+
+    return node;
+}
+
+// Standalone nodes: one aligned heap block each
+BPlusNode* create_node(int order, bool is_leaf) {
+    void* block = aligned_alloc(BPLUS_CACHE_LINE, bplus_node_size(order, is_leaf));
+    if (!block) return NULL;
+    return init_node(block, order, is_leaf);
+}
+
+void destroy_node(BPlusNode* node) {
+    free(node);
+}
+
+// Slab allocator
+void node_pool_init(BPlusNodePool* pool, size_t block_size) {
+    pool->block_size = block_size;
+    // The first block of every slab holds the slab header
+    pool->blocks_per_slab = SLAB_BYTES / block_size;
+    if (pool->blocks_per_slab < 8) {
+        pool->blocks_per_slab = 8;
+    }
+    pool->slabs = NULL;
+    pool->slab_used = pool->blocks_per_slab;
+    pool->free_list = NULL;
+    pool->in_use = 0;
+}
+
+void* node_pool_alloc(BPlusNodePool* pool) {
+    void* block;
+
+    if (pool->free_list) {
+        block = pool->free_list;
+        pool->free_list = *(void**)block;
+    } else {
+        if (pool->slab_used == pool->blocks_per_slab) {
+            BPlusSlab* slab = aligned_alloc(BPLUS_CACHE_LINE, pool->block_size * pool->blocks_per_slab);
+            if (!slab) return NULL;
+            slab->next = pool->slabs;
+            pool->slabs = slab;
+            pool->slab_used = 1;
+        }
+        block = (char*)pool->slabs + pool->block_size * pool->slab_used;
+        pool->slab_used++;
+    }
+
+    pool->in_use++;
+    return block;
+}
+
+void node_pool_free(BPlusNodePool* pool, void* block) {
+    if (!block) return;
+    *(void**)block = pool->free_list;
+    pool->free_list = block;
+    pool->in_use--;
+}
+
+void node_pool_destroy(BPlusNodePool* pool) {
+    BPlusSlab* slab = pool->slabs;
+    while (slab) {
+        BPlusSlab* next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    pool->slabs = NULL;
+    pool->slab_used = pool->blocks_per_slab;
+    pool->free_list = NULL;
+    pool->in_use = 0;
+}
+
+// Tree-owned nodes. A packed leaf gets its encoding buffer here and gives
+// it back when freed. In concurrent mode the pools are shared between
+// writers, and freed nodes are retired until no reader can still see them;
+// likewise nodes still shared with a snapshot outlive their removal.
+BPlusNode* bplus_tree_alloc_node(BPlusTree* tree, bool is_leaf) {
+    BPlusNodePool* pool = is_leaf ? &tree->leaf_pool : &tree->internal_pool;
+    void* block = tree->sync ? sync_pool_alloc(tree, pool) : node_pool_alloc(pool);
+    if (!block) return NULL;
+    BPlusNode* node = init_node(block, is_leaf ? tree->leaf_order : tree->order, is_leaf);
+    if (is_leaf && (tree->flags & BPLUS_TREE_PACKED_LEAVES)) {
+        node->keys = NULL;
+        node->packed = packed_create(tree);
+    }
+    if (tree->versions) {
+        node->birth = snapshot_generation(tree);
+    }
+    mark_dirty(tree, node);
+    return node;
+}
+
+void bplus_tree_free_node(BPlusTree* tree, BPlusNode* node) {
+    if (!node) return;
+    if (node == tree->tail) {
+        tree->tail = NULL;
+    }
+    if (tree->checkpoint) {
+        checkpoint_forget(tree, node);
+    }
+    if (tree->journal) {
+        journal_forget(tree, node);
+    }
+    if (node->is_leaf && node->packed) {
+        packed_free(tree, node);
+    }
+    if (tree->sync) {
+        sync_retire(tree, node);
+        return;
+    }
+    if (tree->versions) {
+        snapshot_retire(tree, node);
+        return;
+    }
+    node_pool_free(node->is_leaf ? &tree->leaf_pool : &tree->internal_pool, node);
+}
@@ -0,0 +1,401 @@
+// src/core/operations.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bplus/tree.h"
+#include "bplus/search.h"
+#include "internal.h"
+
+// Number of nodes to spread `items` entries over so each gets close to
+// `target` entries and none gets fewer than `min_items`
+static size_t nodes_for_level(size_t items, size_t target, size_t min_items) {
+    size_t nodes = (items + target - 1) / target;
+    if (nodes > 1 && items / nodes < min_items) {
+        nodes = items / min_items;
+    }
+    return nodes ? nodes : 1;
+}
+
+static size_t fill_target(double fill_factor, int capacity, int minimum) {
+    if (!(fill_factor > 0.0) || fill_factor > 1.0) {
+        fill_factor = 1.0;
+    }
+    int target = (int)(fill_factor * capacity + 0.5);
+    if (target < minimum) target = minimum;
+    if (target > capacity) target = capacity;
+    if (target < 1) target = 1;
+    return (size_t)target;
+}
+
+// Bottom-up construction from sorted input
+BPlusTree* bplus_tree_bulk_load(int order, const int* sorted, size_t n, double fill_factor) {
+    BPlusTreeOptions options = { .order = order };
+    return bplus_tree_bulk_load_with_options(&options, sorted, n, fill_factor);
+}
+
+BPlusTree* bplus_tree_bulk_load_with_options(const BPlusTreeOptions* options, const int* sorted,
+                                             size_t n, double fill_factor) {
+    if (n > 0 && !sorted) return NULL;
+    
+    // Keys must be strictly increasing
+    for (size_t i = 1; i < n; i++) {
+        if (sorted[i] <= sorted[i - 1]) return NULL;
+    }
+    
+    BPlusTree* tree = bplus_tree_create_with_options(options);
+    if (!tree || n == 0) return tree;
+    
+    int leaf_min = (tree->leaf_order - 1) / 2;
+    size_t leaf_count = nodes_for_level(n, fill_target(fill_factor, tree->leaf_order - 1, leaf_min), leaf_min);
+    
+    BPlusNode** level = malloc(sizeof(BPlusNode*) * leaf_count);
+    int* level_min = malloc(sizeof(int) * leaf_count);
+    
+    // Pack leaves left to right, spreading the remainder over the first ones
+    bplus_tree_free_node(tree, tree->root);
+    size_t pos = 0;
+    BPlusNode* prev = NULL;
+    for (size_t i = 0; i < leaf_count; i++) {
+        size_t count = n / leaf_count + (i < n % leaf_count ? 1 : 0);
+        BPlusNode* leaf = bplus_tree_alloc_node(tree, true);
+        leaf_assign(tree, leaf, &sorted[pos], (int)count);
+        if (prev) prev->next = leaf;
+        leaf->prev = prev;
+        prev = leaf;
+        
+        level[i] = leaf;
+        level_min[i] = sorted[pos];
+        pos += count;
+    }
+    
+    // Build internal levels until a single node remains; each node's
+    // separators are the smallest keys of its children after the first
+    size_t width = leaf_count;
+    int min_children = (tree->order - 1) / 2 + 1;
+    size_t target = fill_target(fill_factor, tree->order, min_children);
+    while (width > 1) {
+        size_t parents = nodes_for_level(width, target, (size_t)min_children);
+        size_t child = 0;
+        for (size_t i = 0; i < parents; i++) {
+            size_t count = width / parents + (i < width % parents ? 1 : 0);
+            BPlusNode* node = bplus_tree_alloc_node(tree, false);
+            int node_min = level_min[child];
+            
+            node->children[0] = level[child++];
+            for (size_t c = 1; c < count; c++, child++) {
+                node->keys[c - 1] = level_min[child];
+                node->children[c] = level[child];
+            }
+            node->num_keys = (int)count - 1;
+            
+            level[i] = node;
+            level_min[i] = node_min;
+        }
+        width = parents;
+    }
+    
+    tree->root = level[0];
+    tree->count = n;
+    free(level);
+    free(level_min);
+    return tree;
+}
+
+// Batched insertion
+
+// Right siblings produced by splitting one node, with their separators
+typedef struct {
+    int* separators;
+    BPlusNode** nodes;
+    size_t count;
+    size_t capacity;
+} SplitList;
+
+typedef struct {
+    BPlusTree* tree;
+    int* scratch;      // leaf merge buffers: 2 * batch size + leaf order entries
+    size_t inserted;
+} BatchContext;
+
+static void split_list_push(SplitList* list, int separator, BPlusNode* node) {
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 8;
+        list->separators = realloc(list->separators, sizeof(int) * list->capacity);
+        list->nodes = realloc(list->nodes, sizeof(BPlusNode*) * list->capacity);
+    }
+    list->separators[list->count] = separator;
+    list->nodes[list->count] = node;
+    list->count++;
+}
+
+static void split_list_free(SplitList* list) {
+    free(list->separators);
+    free(list->nodes);
+}
+
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Spreads `count` children (and the count - 1 keys between them) over
+// `node` and as many new internal nodes as needed; the new nodes and the
+// keys pushed up between them go to `out`
+static void distribute_internal(BatchContext* ctx, BPlusNode* node, const int* keys,
+                                BPlusNode** children, size_t count, SplitList* out) {
+    size_t order = (size_t)ctx->tree->order;
+    size_t parts = (count + order - 1) / order;
+    size_t start = 0;
+    mark_dirty(ctx->tree, node);
+    if (parts > 1) note_change(ctx->tree, node, BPLUS_CHANGE_SPLIT);
+    COUNT(ctx->tree, splits, parts - 1);
+    
+    for (size_t p = 0; p < parts; p++) {
+        size_t size = count / parts + (p < count % parts ? 1 : 0);
+        BPlusNode* target = p == 0 ? node : bplus_tree_alloc_node(ctx->tree, false);
+        
+        memmove(target->keys, &keys[start], sizeof(int) * (size - 1));
+        memmove(target->children, &children[start], sizeof(BPlusNode*) * size);
+        target->num_keys = (int)size - 1;
+        if (p > 0) {
+            target->dirty |= node->dirty & BPLUS_DIRTY_SPARSE;
+            split_list_push(out, keys[start - 1], target);
+        }
+        start += size;
+    }
+}
+
+// Merges a sorted run into a leaf, splitting it as often as needed
+static void batch_insert_leaf(BatchContext* ctx, BPlusNode* leaf, const int* keys, size_t n, SplitList* out) {
+    int max_keys = ctx->tree->leaf_order - 1;
+    size_t num_keys = (size_t)leaf->num_keys;
+    int* current = leaf_keys(ctx->tree, leaf, 0);
+    
+    // Drop keys that are already in the leaf or repeated in the batch
+    int* fresh = ctx->scratch;
+    size_t count = 0;
+    int at = 0;
+    for (size_t j = 0; j < n; j++) {
+        at += bplus_lower_bound(&current[at], (int)num_keys - at, keys[j]);
+        if ((at < (int)num_keys && current[at] == keys[j]) ||
+            (count > 0 && fresh[count - 1] == keys[j])) {
+            continue;
+        }
+        fresh[count++] = keys[j];
+    }
+    if (count == 0) return;
+    ctx->inserted += count;
+    mark_dirty(ctx->tree, leaf);
+    
+    size_t total = num_keys + count;
+    if (total <= (size_t)max_keys) {
+        // Fits: merge from the back in place
+        size_t i = num_keys, j = count, w = total;
+        while (j > 0) {
+            if (i > 0 && current[i - 1] > fresh[j - 1]) {
+                current[--w] = current[--i];
+            } else {
+                current[--w] = fresh[--j];
+            }
+        }
+        leaf->num_keys = (int)total;
+        leaf_store(ctx->tree, leaf, current);
+        return;
+    }
+    
+    int* merged = ctx->scratch + n;
+    size_t i = 0, j = 0, m = 0;
+    while (i < num_keys || j < count) {
+        if (j == count || (i < num_keys && current[i] < fresh[j])) {
+            merged[m++] = current[i++];
+        } else {
+            merged[m++] = fresh[j++];
+        }
+    }
+    
+    // Spread the merged keys evenly over as many leaves as they need
+    size_t parts = (total + max_keys - 1) / max_keys;
+    size_t start = 0;
+    BPlusNode* prev = leaf;
+    note_change(ctx->tree, leaf, BPLUS_CHANGE_SPLIT);
+    COUNT(ctx->tree, splits, parts - 1);
+    for (size_t p = 0; p < parts; p++) {
+        size_t size = total / parts + (p < total % parts ? 1 : 0);
+        BPlusNode* target = leaf;
+        if (p > 0) {
+            target = bplus_tree_alloc_node(ctx->tree, true);
+            target->next = prev->next;
+            target->prev = prev;
+            if (prev->next) prev->next->prev = target;
+            prev->next = target;
+            prev = target;
+            split_list_push(out, merged[start], target);
+        }
+        leaf_assign(ctx->tree, target, &merged[start], (int)size);
+        start += size;
+    }
+}
+
+// Inserts a sorted run into the subtree under `node`
+static void batch_insert_node(BatchContext* ctx, BPlusNode* node, const int* keys, size_t n, SplitList* out) {
+    if (node->is_leaf) {
+        batch_insert_leaf(ctx, node, keys, n, out);
+        return;
+    }
+    
+    // Route each child its run of keys in one pass over the batch, keeping
+    // track of which child every resulting split belongs after
+    SplitList pending = {0};
+    size_t* owners = NULL;
+    size_t owners_capacity = 0;
+    size_t pos = 0;
+    
+    while (pos < n) {
+        int c = bplus_upper_bound(node->keys, node->num_keys, keys[pos]);
+        size_t end = n;
+        if (c < node->num_keys) {
+            end = pos + (size_t)bplus_lower_bound(&keys[pos], (int)(n - pos), node->keys[c]);
+        }
+        
+        size_t before = pending.count;
+        batch_insert_node(ctx, writable_child(ctx->tree, node, c), &keys[pos], end - pos, &pending);
+        if (pending.count > owners_capacity) {
+            owners_capacity = pending.capacity;
+            owners = realloc(owners, sizeof(size_t) * owners_capacity);
+        }
+        for (size_t s = before; s < pending.count; s++) {
+            owners[s] = (size_t)c;
+        }
+        pos = end;
+    }
+    
+    if (pending.count == 0) {
+        split_list_free(&pending);
+        free(owners);
+        return;
+    }
+    
+    // Interleave the new children with the existing ones
+    size_t count = (size_t)node->num_keys + 1 + pending.count;
+    int* all_keys = malloc(sizeof(int) * count);
+    BPlusNode** all_children = malloc(sizeof(BPlusNode*) * count);
+    size_t k = 0, s = 0;
+    for (int c = 0; c <= node->num_keys; c++) {
+        if (c > 0) {
+            all_keys[k - 1] = node->keys[c - 1];
+        }
+        all_children[k++] = node->children[c];
+        for (; s < pending.count && owners[s] == (size_t)c; s++) {
+            all_keys[k - 1] = pending.separators[s];
+            all_children[k++] = pending.nodes[s];
+        }
+    }
+    
+    distribute_internal(ctx, node, all_keys, all_children, count, out);
+    
+    free(all_keys);
+    free(all_children);
+    split_list_free(&pending);
+    free(owners);
+}
+
+size_t bplus_tree_insert_batch(BPlusTree* tree, const int* keys, size_t n) {
+    if (!tree || !tree->root || !keys || n == 0) return 0;
+    
+    int* sorted = malloc(sizeof(int) * n);
+    memcpy(sorted, keys, sizeof(int) * n);
+    qsort(sorted, n, sizeof(int), compare_ints);
+    
+    if (tree->versions) snapshot_maintain(tree);
+    BatchContext ctx = { tree, malloc(sizeof(int) * (2 * n + tree->leaf_order)), 0 };
+    SplitList splits = {0};
+    batch_insert_node(&ctx, writable_root(tree), sorted, n, &splits);
+    
+    // Grow new roots until the top level fits in a single node
+    while (splits.count > 0) {
+        size_t count = splits.count + 1;
+        int* all_keys = malloc(sizeof(int) * count);
+        BPlusNode** all_children = malloc(sizeof(BPlusNode*) * count);
+        all_children[0] = tree->root;
+        memcpy(all_keys, splits.separators, sizeof(int) * splits.count);
+        memcpy(&all_children[1], splits.nodes, sizeof(BPlusNode*) * splits.count);
+        
+        BPlusNode* root = bplus_tree_alloc_node(tree, false);
+        root->dirty |= all_children[0]->dirty & BPLUS_DIRTY_SPARSE;
+        tree->root = root;
+        splits.count = 0;
+        distribute_internal(&ctx, root, all_keys, all_children, count, &splits);
+        
+        free(all_keys);
+        free(all_children);
+    }
+    
+    split_list_free(&splits);
+    free(ctx.scratch);
+    free(sorted);
+    tree->count += ctx.inserted;
+    COUNT(tree, inserts, n);
+    return ctx.inserted;
+}
+
+// Batched lookups
+
+#define SEARCH_GROUP 16
+
+// The header line, and the line the first probe of a key search reads
+static inline void prefetch_node(const BPlusNode* node, int order) {
+    __builtin_prefetch(node);
+    __builtin_prefetch((const char*)(node + 1) + sizeof(int) * (size_t)(order / 2));
+}
+
+size_t bplus_tree_search_batch(BPlusTree* tree, const int* keys, size_t n, bool* out_found) {
+    if (!tree || !tree->root || !keys || !out_found) return 0;
+    size_t found = 0;
+    
+    // Concurrent lookups need the optimistic read protocol per key
+    if (tree->sync) {
+        for (size_t i = 0; i < n; i++) {
+            out_found[i] = bplus_tree_search(tree, keys[i]);
+            found += out_found[i];
+        }
+        return found;
+    }
+    
+    // The level above the leaves prefetches nodes of the leaf order
+    uint64_t height = 1;
+    for (BPlusNode* node = tree->root; !node->is_leaf; node = node->children[0]) {
+        height++;
+    }
+    
+    BPlusNode* nodes[SEARCH_GROUP];
+    for (size_t base = 0; base < n; base += SEARCH_GROUP) {
+        size_t group = n - base < SEARCH_GROUP ? n - base : SEARCH_GROUP;
+        for (size_t g = 0; g < group; g++) {
+            nodes[g] = tree->root;
+        }
+        
+        // Every leaf is at the same depth, so the group moves down in
+        // lockstep: each step uses a node prefetched one round earlier
+        uint64_t levels = 1;
+        for (; !nodes[0]->is_leaf; levels++) {
+            int order = levels + 1 == height ? tree->leaf_order : tree->order;
+            for (size_t g = 0; g < group; g++) {
+                BPlusNode* node = nodes[g];
+                node = node->children[bplus_upper_bound(node->keys, node->num_keys, keys[base + g])];
+                prefetch_node(node, order);
+                nodes[g] = node;
+            }
+        }
+        
+        for (size_t g = 0; g < group; g++) {
+            BPlusNode* leaf = nodes[g];
+            int i = leaf_lower_bound(leaf, keys[base + g]);
+            bool hit = i < leaf->num_keys && leaf_key(leaf, i) == keys[base + g];
+            out_found[base + g] = hit;
+            found += hit;
+        }
+        COUNT_READ(tree, group, group * levels);
+    }
+    return found;
+}
@@ -0,0 +1,118 @@
+// src/core/packed.c
+// Packed leaves: each leaf stores its smallest key as a base and every key
+// as its offset from that base, bit-packed at the width of the largest
+// offset. Leaf keys in our workloads are dense and arrive mostly in order,
+// so offsets need far fewer than 32 bits. Lookups binary-search the packed
+// offsets directly; edits decode into the tree's scratch buffers, change
+// the plain array and encode it back.
+#include <stdlib.h>
+#include <string.h>
+#include "bplus/tree.h"
+#include "internal.h"
+
+struct BPlusPackedKeys {
+    int32_t base;            // smallest key
+    uint32_t width;          // bits per offset, 0..32
+    uint32_t capacity;       // words allocated
+    uint32_t reserved;
+    uint64_t words[];        // offsets, then at least one zero word
+};
+
+static size_t buffer_bytes(uint32_t words) {
+    return sizeof(struct BPlusPackedKeys) + sizeof(uint64_t) * words;
+}
+
+// Offset `i` spans at most two words; the trailing word lets both be read
+// unconditionally
+static inline uint32_t offset_at(const struct BPlusPackedKeys* p, int i) {
+    uint64_t bit = (uint64_t)i * p->width;
+    const uint64_t* w = p->words + (bit >> 6);
+    unsigned shift = (unsigned)(bit & 63);
+    uint64_t value = (w[0] >> shift) | ((w[1] << 1) << (63 - shift));
+    return (uint32_t)(value & (((uint64_t)1 << p->width) - 1));
+}
+
+struct BPlusPackedKeys* packed_create(BPlusTree* tree) {
+    struct BPlusPackedKeys* p = calloc(1, buffer_bytes(2));
+    p->capacity = 2;
+    tree->packed_bytes += buffer_bytes(2);
+    return p;
+}
+
+void packed_free(BPlusTree* tree, BPlusNode* leaf) {
+    tree->packed_bytes -= buffer_bytes(leaf->packed->capacity);
+    free(leaf->packed);
+    leaf->packed = NULL;
+}
+
+// Encodes leaf->num_keys sorted keys, resizing the buffer when it is too
+// small or more than twice the size needed
+void packed_encode(BPlusTree* tree, BPlusNode* leaf, const int* keys) {
+    int n = leaf->num_keys;
+    uint32_t range = n > 0 ? (uint32_t)((int64_t)keys[n - 1] - keys[0]) : 0;
+    uint32_t width = range ? 32 - (uint32_t)__builtin_clz(range) : 0;
+    uint32_t needed = (uint32_t)(((uint64_t)n * width + 63) / 64) + 1;
+    if (needed < 2) needed = 2;
+
+    struct BPlusPackedKeys* p = leaf->packed;
+    if (needed > p->capacity || needed * 2 < p->capacity) {
+        uint32_t capacity = needed > p->capacity ? needed + needed / 4 : needed;
+        tree->packed_bytes += buffer_bytes(capacity) - buffer_bytes(p->capacity);
+        p = realloc(p, buffer_bytes(capacity));
+        p->capacity = capacity;
+        leaf->packed = p;
+    }
+
+    p->base = n > 0 ? keys[0] : 0;
+    p->width = width;
+    memset(p->words, 0, sizeof(uint64_t) * needed);
+    for (int i = 0; i < n; i++) {
+        uint64_t value = (uint32_t)((int64_t)keys[i] - p->base);
+        uint64_t bit = (uint64_t)i * width;
+        unsigned shift = (unsigned)(bit & 63);
+        p->words[bit >> 6] |= value << shift;
+        if (shift + width > 64) {
+            p->words[(bit >> 6) + 1] |= value >> (64 - shift);
+        }
+    }
+}
+
+void packed_decode(const BPlusNode* leaf, int* out) {
+    const struct BPlusPackedKeys* p = leaf->packed;
+    for (int i = 0; i < leaf->num_keys; i++) {
+        out[i] = (int)((int64_t)p->base + offset_at(p, i));
+    }
+}
+
+int packed_key(const BPlusNode* leaf, int i) {
+    return (int)((int64_t)leaf->packed->base + offset_at(leaf->packed, i));
+}
+
+// Branchless binary search over the offsets, as in search.c. A key below
+// the base precedes every key; otherwise it compares as its own offset.
+static int search_offsets(const struct BPlusPackedKeys* p, int n, int64_t key, bool or_equal) {
+    if (n == 0 || key < p->base) return 0;
+    uint64_t target = (uint64_t)(key - p->base);
+    if (or_equal) target++;   // upper bound of target == lower bound of target + 1
+    int lo = 0;
+    while (n > 1) {
+        int half = n / 2;
+        lo = offset_at(p, lo + half) < target ? lo + half : lo;
+        n -= half;
+    }
+    return lo + (offset_at(p, lo) < target);
+}
+
+int packed_lower_bound(const BPlusNode* leaf, int key) {
+    return search_offsets(leaf->packed, leaf->num_keys, key, false);
+}
+
+int packed_upper_bound(const BPlusNode* leaf, int key) {
+    return search_offsets(leaf->packed, leaf->num_keys, key, true);
+}
+
+const int* bplus_node_keys(const BPlusNode* node, int* buffer) {
+    if (!node->is_leaf || !node->packed) return node->keys;
+    packed_decode(node, buffer);
+    return buffer;
+}
@@ -0,0 +1,237 @@
+// src/core/search.c
+#include <limits.h>
+#include <stddef.h>
+#include "bplus/search.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define BPLUS_HAVE_X86 1
+#endif
+
+typedef int (*KeySearchFn)(const int* keys, int n, int key);
+
+static int resolve_lower_bound(const int* keys, int n, int key);
+static int resolve_upper_bound(const int* keys, int n, int key);
+
+// Any thread may pick or switch the kernel while others search, so these
+// are only read and written atomically. Relaxed order is enough: every
+// kernel gives the same answers and the pointers lead only to code.
+static KeySearchFn lower_bound_fn = resolve_lower_bound;
+static KeySearchFn upper_bound_fn = resolve_upper_bound;
+static BPlusSearchKernel current_kernel = BPLUS_SEARCH_AUTO;
+
+// Scalar kernels: the original linear scans
+static int lower_bound_scalar(const int* keys, int n, int key) {
+    int i = 0;
+    while (i < n && keys[i] < key) {
+        i++;
+    }
+    return i;
+}
+
+static int upper_bound_scalar(const int* keys, int n, int key) {
+    int i = 0;
+    while (i < n && keys[i] <= key) {
+        i++;
+    }
+    return i;
+}
+
+// Branchless binary search: the loop trip count depends only on n and the
+// comparison compiles to a conditional move
+static int lower_bound_branchless(const int* keys, int n, int key) {
+    if (n == 0) return 0;
+    const int* base = keys;
+    while (n > 1) {
+        int half = n / 2;
+        base = (base[half] < key) ? base + half : base;
+        n -= half;
+    }
+    return (int)(base - keys) + (*base < key);
+}
+
+static int upper_bound_branchless(const int* keys, int n, int key) {
+    if (n == 0) return 0;
+    const int* base = keys;
+    while (n > 1) {
+        int half = n / 2;
+        base = (base[half] <= key) ? base + half : base;
+        n -= half;
+    }
+    return (int)(base - keys) + (*base <= key);
+}
+
+#ifdef BPLUS_HAVE_X86
+
+// SIMD kernels narrow the range with branchless halving until it fits in a
+// few vectors, then count matching keys with compare + movemask. Because the
+// keys are sorted, the count of keys below the probe is the insert position.
+#define SSE2_WINDOW 16
+#define AVX2_WINDOW 32
+
+__attribute__((target("sse2")))
+static int count_less_sse2(const int* keys, int n, int key, int or_equal) {
+    __m128i probe = _mm_set1_epi32(or_equal ? key : key - 1);
+    int count = 0;
+    int i = 0;
+    // keys[i] <= probe  <=>  !(keys[i] > probe)
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(keys + i));
+        int gt = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(v, probe)));
+        count += 4 - __builtin_popcount(gt);
+    }
+    for (; i < n; i++) {
+        count += or_equal ? keys[i] <= key : keys[i] < key;
+    }
+    return count;
+}
+
+__attribute__((target("avx2")))
+static int count_less_avx2(const int* keys, int n, int key, int or_equal) {
+    __m256i probe = _mm256_set1_epi32(or_equal ? key : key - 1);
+    int count = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(keys + i));
+        int gt = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, probe)));
+        count += 8 - __builtin_popcount(gt);
+    }
+    for (; i < n; i++) {
+        count += or_equal ? keys[i] <= key : keys[i] < key;
+    }
+    return count;
+}
+
+// Halve [keys, keys + *n) until at most `window` candidates remain
+static const int* narrow(const int* keys, int* n, int key, int or_equal, int window) {
+    const int* base = keys;
+    int len = *n;
+    while (len > window) {
+        int half = len / 2;
+        int below = or_equal ? base[half] <= key : base[half] < key;
+        base = below ? base + half : base;
+        len -= half;
+    }
+    *n = len;
+    return base;
+}
+
+// For strict bounds the kernels compare against key - 1, which would wrap
+// for INT_MIN; nothing is below INT_MIN anyway
+static int lower_bound_sse2(const int* keys, int n, int key) {
+    if (key == INT_MIN) return 0;
+    const int* base = narrow(keys, &n, key, 0, SSE2_WINDOW);
+    return (int)(base - keys) + count_less_sse2(base, n, key, 0);
+}
+
+static int upper_bound_sse2(const int* keys, int n, int key) {
+    const int* base = narrow(keys, &n, key, 1, SSE2_WINDOW);
+    return (int)(base - keys) + count_less_sse2(base, n, key, 1);
+}
+
+static int lower_bound_avx2(const int* keys, int n, int key) {
+    if (key == INT_MIN) return 0;
+    const int* base = narrow(keys, &n, key, 0, AVX2_WINDOW);
+    return (int)(base - keys) + count_less_avx2(base, n, key, 0);
+}
+
+static int upper_bound_avx2(const int* keys, int n, int key) {
+    const int* base = narrow(keys, &n, key, 1, AVX2_WINDOW);
+    return (int)(base - keys) + count_less_avx2(base, n, key, 1);
+}
+
+#endif // BPLUS_HAVE_X86
+
+bool bplus_search_kernel_supported(BPlusSearchKernel kernel) {
+    switch (kernel) {
+    case BPLUS_SEARCH_SCALAR:
+    case BPLUS_SEARCH_BRANCHLESS:
+    case BPLUS_SEARCH_AUTO:
+        return true;
+#ifdef BPLUS_HAVE_X86
+    case BPLUS_SEARCH_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case BPLUS_SEARCH_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+bool bplus_search_set_kernel(BPlusSearchKernel kernel) {
+    if (!bplus_search_kernel_supported(kernel)) return false;
+
+    if (kernel == BPLUS_SEARCH_AUTO) {
+        if (bplus_search_kernel_supported(BPLUS_SEARCH_AVX2)) {
+            kernel = BPLUS_SEARCH_AVX2;
+        } else if (bplus_search_kernel_supported(BPLUS_SEARCH_SSE2)) {
+            kernel = BPLUS_SEARCH_SSE2;
+        } else {
+            kernel = BPLUS_SEARCH_BRANCHLESS;
+        }
+    }
+
+    KeySearchFn lower, upper;
+    switch (kernel) {
+#ifdef BPLUS_HAVE_X86
+    case BPLUS_SEARCH_AVX2:
+        lower = lower_bound_avx2;
+        upper = upper_bound_avx2;
+        break;
+    case BPLUS_SEARCH_SSE2:
+        lower = lower_bound_sse2;
+        upper = upper_bound_sse2;
+        break;
+#endif
+    case BPLUS_SEARCH_BRANCHLESS:
+        lower = lower_bound_branchless;
+        upper = upper_bound_branchless;
+        break;
+    default:
+        lower = lower_bound_scalar;
+        upper = upper_bound_scalar;
+        break;
+    }
+
+    __atomic_store_n(&lower_bound_fn, lower, __ATOMIC_RELAXED);
+    __atomic_store_n(&upper_bound_fn, upper, __ATOMIC_RELAXED);
+    __atomic_store_n(&current_kernel, kernel, __ATOMIC_RELAXED);
+    return true;
+}
+
+BPlusSearchKernel bplus_search_get_kernel(void) {
+    if (__atomic_load_n(&current_kernel, __ATOMIC_RELAXED) == BPLUS_SEARCH_AUTO) {
+        bplus_search_set_kernel(BPLUS_SEARCH_AUTO);
+    }
+    return __atomic_load_n(&current_kernel, __ATOMIC_RELAXED);
+}
+
+const char* bplus_search_kernel_name(BPlusSearchKernel kernel) {
+    switch (kernel) {
+    case BPLUS_SEARCH_SCALAR: return "scalar";
+    case BPLUS_SEARCH_BRANCHLESS: return "branchless";
+    case BPLUS_SEARCH_SSE2: return "sse2";
+    case BPLUS_SEARCH_AVX2: return "avx2";
+    default: return "auto";
+    }
+}
+
+// The first call through either entry point picks the kernel
+static int resolve_lower_bound(const int* keys, int n, int key) {
+    bplus_search_set_kernel(BPLUS_SEARCH_AUTO);
+    return __atomic_load_n(&lower_bound_fn, __ATOMIC_RELAXED)(keys, n, key);
+}
+
+static int resolve_upper_bound(const int* keys, int n, int key) {
+    bplus_search_set_kernel(BPLUS_SEARCH_AUTO);
+    return __atomic_load_n(&upper_bound_fn, __ATOMIC_RELAXED)(keys, n, key);
+}
+
+int bplus_lower_bound(const int* keys, int n, int key) {
+    return __atomic_load_n(&lower_bound_fn, __ATOMIC_RELAXED)(keys, n, key);
+}
+
+int bplus_upper_bound(const int* keys, int n, int key) {
+    return __atomic_load_n(&upper_bound_fn, __ATOMIC_RELAXED)(keys, n, key);
+}
@@ -0,0 +1,280 @@
+// src/core/snapshot.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bplus/snapshot.h"
+#include "bplus/search.h"
+#include "internal.h"
+
+// Retired entries examined per write
+#define RECLAIM_BUDGET 32
+
+struct BPlusSnapshot {
+    BPlusTree* tree;
+    BPlusNode* root;
+    uint64_t generation;
+    int refs;
+    struct BPlusSnapshot* next;  // next newer snapshot
+};
+
+// A node removed from the tree that snapshots taken in [birth, death) see
+typedef struct {
+    BPlusNode* node;
+    uint64_t birth;
+    uint64_t death;
+} RetiredVersion;
+
+// Snapshot `s` sees exactly the nodes with birth <= s that were still in
+// the tree when it was taken. The generation advances with every snapshot.
+struct BPlusVersions {
+    uint64_t generation;
+    BPlusSnapshot* oldest;
+    BPlusSnapshot* newest;
+    RetiredVersion* retired;
+    size_t retired_count;
+    size_t retired_capacity;
+    size_t reclaim_at;
+};
+
+uint64_t snapshot_generation(BPlusTree* tree) {
+    return tree->versions->generation;
+}
+
+// Released snapshots stay listed until the next maintenance pass, which
+// only makes this conservative
+static bool is_shared(BPlusTree* tree, BPlusNode* node) {
+    BPlusSnapshot* newest = tree->versions->newest;
+    return newest && node->birth <= newest->generation;
+}
+
+static bool is_visible(struct BPlusVersions* versions, const RetiredVersion* entry) {
+    for (BPlusSnapshot* s = versions->oldest; s && s->generation < entry->death; s = s->next) {
+        if (s->generation >= entry->birth) return true;
+    }
+    return false;
+}
+
+static void free_to_pool(BPlusTree* tree, BPlusNode* node) {
+    node_pool_free(node->is_leaf ? &tree->leaf_pool : &tree->internal_pool, node);
+}
+
+// Replaces a shared node with a private copy. Leaf links are patched in
+// place: snapshots never follow them, so the neighbours need not be copied.
+BPlusNode* snapshot_unshare(BPlusTree* tree, BPlusNode* parent, int index) {
+    BPlusNode* node = parent ? parent->children[index] : tree->root;
+    if (!is_shared(tree, node)) return node;
+
+    BPlusNode* copy = bplus_tree_alloc_node(tree, node->is_leaf);
+    memcpy(copy->keys, node->keys, sizeof(int) * node->num_keys);
+    copy->num_keys = node->num_keys;
+    copy->dirty |= node->dirty & BPLUS_DIRTY_SPARSE;
+    if (node->is_leaf) {
+        copy->next = node->next;
+        copy->prev = node->prev;
+        if (node->next) node->next->prev = copy;
+        if (node->prev) node->prev->next = copy;
+    } else {
+        memcpy(copy->children, node->children, sizeof(BPlusNode*) * (node->num_keys + 1));
+    }
+
+    if (parent) {
+        parent->children[index] = copy;
+    } else {
+        tree->root = copy;
+    }
+    // The copy stands in for the original in checkpoints as well
+    if (tree->checkpoint) {
+        checkpoint_transfer(tree, node, copy);
+    }
+    if (tree->journal) {
+        journal_transfer(tree, node, copy);
+    }
+    snapshot_retire(tree, node);
+    return copy;
+}
+
+void snapshot_retire(BPlusTree* tree, BPlusNode* node) {
+    struct BPlusVersions* versions = tree->versions;
+    if (!is_shared(tree, node)) {
+        free_to_pool(tree, node);
+        return;
+    }
+
+    if (versions->retired_count == versions->retired_capacity) {
+        versions->retired_capacity = versions->retired_capacity ? versions->retired_capacity * 2 : 64;
+        versions->retired = realloc(versions->retired, sizeof(RetiredVersion) * versions->retired_capacity);
+    }
+    RetiredVersion* entry = &versions->retired[versions->retired_count++];
+    entry->node = node;
+    entry->birth = node->birth;
+    entry->death = versions->generation;
+}
+
+// Drops released snapshots, then frees a bounded number of retired nodes
+// that no remaining snapshot sees
+void snapshot_maintain(BPlusTree* tree) {
+    struct BPlusVersions* versions = tree->versions;
+
+    BPlusSnapshot** link = &versions->oldest;
+    versions->newest = NULL;
+    while (*link) {
+        BPlusSnapshot* s = *link;
+        if (__atomic_load_n(&s->refs, __ATOMIC_ACQUIRE) == 0) {
+            *link = s->next;
+            free(s);
+        } else {
+            versions->newest = s;
+            link = &s->next;
+        }
+    }
+
+    for (int examined = 0; examined < RECLAIM_BUDGET && versions->retired_count > 0; examined++) {
+        if (versions->reclaim_at >= versions->retired_count) {
+            versions->reclaim_at = 0;
+        }
+        RetiredVersion* entry = &versions->retired[versions->reclaim_at];
+        if (is_visible(versions, entry)) {
+            versions->reclaim_at++;
+        } else {
+            free_to_pool(tree, entry->node);
+            *entry = versions->retired[--versions->retired_count];
+        }
+    }
+}
+
+// Retired nodes live in the tree's pools and go with them
+void snapshot_destroy(struct BPlusVersions* versions) {
+    BPlusSnapshot* s = versions->oldest;
+    while (s) {
+        BPlusSnapshot* next = s->next;
+        free(s);
+        s = next;
+    }
+    free(versions->retired);
+    free(versions);
+}
+
+BPlusSnapshot* bplus_tree_snapshot(BPlusTree* tree) {
+    if (!tree || !tree->root || tree->sync || (tree->flags & BPLUS_TREE_PACKED_LEAVES)) return NULL;
+
+    if (!tree->versions) {
+        tree->versions = calloc(1, sizeof(struct BPlusVersions));
+        tree->versions->generation = 1;
+    }
+    snapshot_maintain(tree);
+
+    BPlusSnapshot* snapshot = malloc(sizeof(BPlusSnapshot));
+    snapshot->tree = tree;
+    snapshot->root = tree->root;
+    snapshot->generation = tree->versions->generation++;
+    snapshot->refs = 1;
+    snapshot->next = NULL;
+
+    if (tree->versions->newest) {
+        tree->versions->newest->next = snapshot;
+    } else {
+        tree->versions->oldest = snapshot;
+    }
+    tree->versions->newest = snapshot;
+    return snapshot;
+}
+
+BPlusTree* snapshot_tree(const BPlusSnapshot* snapshot) {
+    return snapshot->tree;
+}
+
+BPlusNode* snapshot_root(const BPlusSnapshot* snapshot) {
+    return snapshot->root;
+}
+
+BPlusSnapshot* bplus_snapshot_retain(BPlusSnapshot* snapshot) {
+    if (snapshot) {
+        __atomic_fetch_add(&snapshot->refs, 1, __ATOMIC_RELAXED);
+    }
+    return snapshot;
+}
+
+// The writer frees the handle and its nodes on a later write
+void bplus_snapshot_release(BPlusSnapshot* snapshot) {
+    if (snapshot) {
+        __atomic_fetch_sub(&snapshot->refs, 1, __ATOMIC_RELEASE);
+    }
+}
+
+// Readers descend from the snapshot's root only; the leaf links belong to
+// the live tree
+bool bplus_snapshot_search(const BPlusSnapshot* snapshot, int key) {
+    if (!snapshot) return false;
+
+    BPlusNode* node = snapshot->root;
+    while (!node->is_leaf) {
+        node = node->children[bplus_upper_bound(node->keys, node->num_keys, key)];
+    }
+    int i = bplus_lower_bound(node->keys, node->num_keys, key);
+    return i < node->num_keys && node->keys[i] == key;
+}
+
+typedef struct {
+    int start_key;
+    int end_key;
+    BPlusSnapshotVisitor visit;
+    void* ctx;
+    size_t visited;
+} ScanState;
+
+// In-order walk of the subtrees that overlap the range; false stops it
+static bool scan_node(BPlusNode* node, ScanState* state) {
+    if (node->is_leaf) {
+        for (int i = bplus_lower_bound(node->keys, node->num_keys, state->start_key); i < node->num_keys; i++) {
+            if (node->keys[i] > state->end_key) return false;
+            state->visited++;
+            if (!state->visit(node->keys[i], state->ctx)) return false;
+        }
+        return true;
+    }
+
+    int first = bplus_upper_bound(node->keys, node->num_keys, state->start_key);
+    for (int c = first; c <= node->num_keys; c++) {
+        if (c > first && node->keys[c - 1] > state->end_key) return false;
+        if (!scan_node(node->children[c], state)) return false;
+    }
+    return true;
+}
+
+size_t bplus_snapshot_scan(const BPlusSnapshot* snapshot, int start_key, int end_key,
+                           BPlusSnapshotVisitor visit, void* ctx) {
+    if (!snapshot || !visit || start_key > end_key) return 0;
+
+    ScanState state = { start_key, end_key, visit, ctx, 0 };
+    scan_node(snapshot->root, &state);
+    return state.visited;
+}
+
+static void print_leaves(BPlusNode* node) {
+    if (!node->is_leaf) {
+        for (int i = 0; i <= node->num_keys; i++) {
+            print_leaves(node->children[i]);
+        }
+        return;
+    }
+    printf("[");
+    for (int i = 0; i < node->num_keys; i++) {
+        printf("%d", node->keys[i]);
+        if (i < node->num_keys - 1) printf(" ");
+    }
+    printf("] -> ");
+}
+
+void bplus_snapshot_print(const BPlusSnapshot* snapshot) {
+    if (!snapshot) {
+        printf("Empty tree\n");
+        return;
+    }
+
+    printf("B+ Tree snapshot %llu (order %d):\n", (unsigned long long)snapshot->generation, snapshot->tree->order);
+    print_node(snapshot->root, 0);
+
+    printf("\nLeaf node chain: ");
+    print_leaves(snapshot->root);
+    printf("NULL\n");
+}
@@ -0,0 +1,70 @@
+// src/core/stats.c
+#include <stdlib.h>
+#include <string.h>
+#include "bplus/stats.h"
+#include "internal.h"
+
+// Threads take slots in the order they first look something up
+static unsigned next_read_slot;
+static _Thread_local unsigned thread_read_slot;
+
+unsigned read_slot(void) {
+    if (thread_read_slot == 0) {
+        thread_read_slot = __atomic_fetch_add(&next_read_slot, 1, __ATOMIC_RELAXED) % BPLUS_READ_SLOTS + 1;
+    }
+    return thread_read_slot - 1;
+}
+
+struct BPlusReadTally* read_tallies_create(void) {
+#ifdef BPLUS_NO_COUNTERS
+    return NULL;
+#else
+    size_t size = sizeof(struct BPlusReadTally) * BPLUS_READ_SLOTS;
+    struct BPlusReadTally* tallies = aligned_alloc(BPLUS_CACHE_LINE, size);
+    if (tallies) memset(tallies, 0, size);
+    return tallies;
+#endif
+}
+
+bool bplus_tree_stats(BPlusTree* tree, BPlusTreeStats* out) {
+    if (!tree || !out) return false;
+    memset(out, 0, sizeof(*out));
+
+    out->keys = tree->count;
+    out->counters = tree->counters;
+    for (int i = 0; tree->reads && i < BPLUS_READ_SLOTS; i++) {
+        out->counters.searches += __atomic_load_n(&tree->reads[i].searches, __ATOMIC_RELAXED);
+        out->counters.node_visits += __atomic_load_n(&tree->reads[i].node_visits, __ATOMIC_RELAXED);
+    }
+    if (tree->sync) {
+        sync_counters(tree, &out->counters, &out->keys);
+    }
+#ifndef BPLUS_NO_COUNTERS
+    out->counters_enabled = true;
+#endif
+
+    // Every leaf is at the same depth
+    BPlusNode* node = tree->root;
+    out->height = 1;
+    for (; !node->is_leaf; node = node->children[0]) {
+        out->height++;
+    }
+
+    out->leaves = tree->leaf_pool.in_use;
+    out->internal_nodes = tree->internal_pool.in_use;
+    out->fill = out->leaves ? (double)out->keys / ((double)out->leaves * (tree->leaf_order - 1)) : 0;
+    out->memory_bytes = bplus_tree_memory_usage(tree);
+    return true;
+}
+
+void bplus_tree_reset_counters(BPlusTree* tree) {
+    if (!tree) return;
+    memset(&tree->counters, 0, sizeof(tree->counters));
+    for (int i = 0; tree->reads && i < BPLUS_READ_SLOTS; i++) {
+        __atomic_store_n(&tree->reads[i].searches, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&tree->reads[i].node_visits, 0, __ATOMIC_RELAXED);
+    }
+    if (tree->sync) {
+        sync_reset_counters(tree);
+    }
+}
@@ -1,85 +1,156 @@
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "bplus/tree.h"
+#include "bplus/search.h"
+#include "bplus/cursor.h"
+#include "internal.h"
 
-// Node creation and destruction functions
-BPlusNode* create_node(int order, bool is_leaf) {
-    BPlusNode* node = (BPlusNode*)malloc(sizeof(BPlusNode));
-    node->keys = (int*)malloc(sizeof(int) * (order - 1));
-    node->children = (BPlusNode**)malloc(sizeof(BPlusNode*) * order);
-    node->is_leaf = is_leaf;
-    node->num_keys = 0;
-    node->next = NULL;
-    
-    for (int i = 0; i < order; i++) {
-        node->children[i] = NULL;
-    }
-    
-    return node;
-}
+// Deeper than any tree of order >= 3 over 32-bit keys can grow
+#define MAX_HEIGHT 64
+// Share of the keys a sequential split keeps on the left
+#define SEQUENTIAL_SPLIT_PERCENT 90
+// Appends in a row before inserts try the tail leaf first
+#define APPEND_DETECT_RUN 4
 
-void destroy_node(BPlusNode* node) {
-    if (node) {
-        free(node->keys);
-        free(node->children);
-        free(node);
-    }
-}
+// A node on the way down and the child taken from it
+typedef struct {
+    BPlusNode* node;
+    int index;
+    bool rightmost;          // the last node of its level
+} PathStep;
 
 // Tree creation and destruction
-BPlusTree* bplus_tree_create(int order) {
+static BPlusTree* create_tree(int order, int leaf_order, unsigned flags, BPlusSplitPolicy split) {
     BPlusTree* tree = (BPlusTree*)malloc(sizeof(BPlusTree));
-    tree->root = create_node(order, true);
     tree->order = order;
+    tree->leaf_order = leaf_order;
+    tree->flags = flags;
+    tree->split = split;
+    tree->sync = NULL;
+    tree->versions = NULL;
+    tree->checkpoint = NULL;
+    tree->journal = NULL;
+    tree->scratch = NULL;
+    tree->packed_bytes = 0;
+    tree->tail = NULL;
+    tree->append_run = 0;
+    tree->count = 0;
+    memset(&tree->counters, 0, sizeof(tree->counters));
+    tree->reads = read_tallies_create();
+    
+    // A packed leaf block holds only the node header
+    size_t leaf_size = bplus_node_size(leaf_order, true);
+    if (flags & BPLUS_TREE_PACKED_LEAVES) {
+        tree->scratch = malloc(sizeof(int) * 2 * leaf_order);
+        leaf_size = BPLUS_CACHE_LINE;
+    }
+    node_pool_init(&tree->leaf_pool, leaf_size);
+    node_pool_init(&tree->internal_pool, bplus_node_size(order, false));
+    tree->root = bplus_tree_alloc_node(tree, true);
     return tree;
 }
 
-static void destroy_tree_recursive(BPlusNode* node) {
-    if (!node->is_leaf) {
-        for (int i = 0; i <= node->num_keys; i++) {
-            if (node->children[i]) {
-                destroy_tree_recursive(node->children[i]);
-            }
-        }
-    }
-    destroy_node(node);
+BPlusTree* bplus_tree_create(int order) {
+    return create_tree(order, order, 0, BPLUS_SPLIT_EVEN);
 }
 
+BPlusTree* bplus_tree_create_with_options(const BPlusTreeOptions* options) {
+    if (!options ||
+        (options->flags & ~(BPLUS_TREE_PACKED_LEAVES | BPLUS_TREE_LAZY_DELETE)) ||
+        (options->split != BPLUS_SPLIT_EVEN && options->split != BPLUS_SPLIT_SEQUENTIAL)) {
+        return NULL;
+    }
+    int order = options->order;
+    int leaf_order = options->leaf_order ? options->leaf_order : order;
+    if (options->node_bytes) {
+        size_t bytes = options->node_bytes == BPLUS_NODE_BYTES_AUTO ? bplus_node_bytes_auto()
+                                                                    : options->node_bytes;
+        order = bplus_order_for_bytes(bytes, false);
+        leaf_order = bplus_order_for_bytes(bytes, true);
+    }
+    if (order < 3 || leaf_order < 3) return NULL;
+    return create_tree(order, leaf_order, options->flags, options->split);
+}
+
+// Every node lives in one of the tree's pools, so no walk is needed except
+// to release the encodings of packed leaves
 void bplus_tree_destroy(BPlusTree* tree) {
     if (tree) {
-        destroy_tree_recursive(tree->root);
+        if (tree->scratch && tree->root) {
+            BPlusNode* leaf = tree->root;
+            while (!leaf->is_leaf) {
+                leaf = leaf->children[0];
+            }
+            for (; leaf; leaf = leaf->next) {
+                packed_free(tree, leaf);
+            }
+        }
+        free(tree->scratch);
+        if (tree->sync) {
+            sync_destroy(tree->sync);
+        }
+        if (tree->versions) {
+            snapshot_destroy(tree->versions);
+        }
+        if (tree->checkpoint) {
+            checkpoint_destroy(tree->checkpoint);
+        }
+        if (tree->journal) {
+            journal_destroy(tree->journal);
+        }
+        free(tree->reads);
+        node_pool_destroy(&tree->leaf_pool);
+        node_pool_destroy(&tree->internal_pool);
         free(tree);
     }
 }
 
-// Helper functions for insertion
-static void insert_into_leaf(BPlusNode* leaf, int key) {
-    int i = leaf->num_keys - 1;
-    
-    while (i >= 0 && leaf->keys[i] > key) {
-        leaf->keys[i + 1] = leaf->keys[i];
-        i--;
+// Child to descend into; keys equal to a separator live in its right subtree
+static int find_child_index(BPlusNode* node, int key) {
+    return bplus_upper_bound(node->keys, node->num_keys, key);
+}
+
+// A lookup that leaves the counters alone, for writes checking first
+static bool contains(BPlusTree* tree, int key) {
+    BPlusNode* node = tree->root;
+    while (!node->is_leaf) {
+        node = node->children[find_child_index(node, key)];
     }
+    int i = leaf_lower_bound(node, key);
+    return i < node->num_keys && leaf_key(node, i) == key;
+}
+
+// Helper functions for insertion
+void insert_into_leaf(BPlusTree* tree, BPlusNode* leaf, int key) {
+    mark_dirty(tree, leaf);
+    int* keys = leaf_keys(tree, leaf, 0);
+    int pos = bplus_upper_bound(keys, leaf->num_keys, key);
     
-    leaf->keys[i + 1] = key;
+    memmove(&keys[pos + 1], &keys[pos], sizeof(int) * (leaf->num_keys - pos));
+    keys[pos] = key;
     leaf->num_keys++;
+    leaf_store(tree, leaf, keys);
 }
 
-static void split_leaf_node(BPlusNode* parent, int index, BPlusNode* leaf) {
-    int order = parent->num_keys + 2;
-    BPlusNode* new_leaf = create_node(order, true);
+static void split_leaf_node(BPlusTree* tree, BPlusNode* parent, int index, BPlusNode* leaf) {
+    BPlusNode* new_leaf = bplus_tree_alloc_node(tree, true);
+    COUNT(tree, splits, 1);
+    mark_dirty(tree, leaf);
+    note_change(tree, leaf, BPLUS_CHANGE_SPLIT);
+    mark_dirty(tree, parent);
     
     int mid = (leaf->num_keys + 1) / 2;
+    int* keys = leaf_keys(tree, leaf, 0);
     
-    for (int i = mid; i < leaf->num_keys; i++) {
-        new_leaf->keys[new_leaf->num_keys] = leaf->keys[i];
-        new_leaf->num_keys++;
-    }
-    
+    leaf_assign(tree, new_leaf, &keys[mid], leaf->num_keys - mid);
     leaf->num_keys = mid;
+    leaf_store(tree, leaf, keys);
     
     new_leaf->next = leaf->next;
+    new_leaf->prev = leaf;
+    if (leaf->next) leaf->next->prev = new_leaf;
     leaf->next = new_leaf;
     
     for (int i = parent->num_keys; i > index; i--) {
@@ -87,14 +158,17 @@ static void split_leaf_node(BPlusNode* parent, int index, BPlusNode* leaf) {
         parent->keys[i] = parent->keys[i - 1];
     }
     
-    parent->keys[index] = new_leaf->keys[0];
+    parent->keys[index] = keys[mid];
     parent->children[index + 1] = new_leaf;
     parent->num_keys++;
 }
 
-static void split_internal_node(BPlusNode* parent, int index, BPlusNode* node) {
-    int order = parent->num_keys + 2;
-    BPlusNode* new_node = create_node(order, false);
+static void split_internal_node(BPlusTree* tree, BPlusNode* parent, int index, BPlusNode* node) {
+    BPlusNode* new_node = bplus_tree_alloc_node(tree, false);
+    COUNT(tree, splits, 1);
+    mark_dirty(tree, node);
+    note_change(tree, node, BPLUS_CHANGE_SPLIT);
+    mark_dirty(tree, parent);
     
     int mid = node->num_keys / 2;
     
@@ -117,105 +191,251 @@ static void split_internal_node(BPlusNode* parent, int index, BPlusNode* node) {
     parent->num_keys++;
 }
 
-static void insert_non_full(BPlusNode* node, int key) {
-    int i = node->num_keys - 1;
-    
-    if (node->is_leaf) {
-        insert_into_leaf(node, key);
+void split_child(BPlusTree* tree, BPlusNode* parent, int index) {
+    BPlusNode* child = parent->children[index];
+    if (child->is_leaf) {
+        split_leaf_node(tree, parent, index, child);
     } else {
-        while (i >= 0 && key < node->keys[i]) {
-            i--;
-        }
-        i++;
-        
-        if (node->children[i]->num_keys == node->num_keys + 1) {
-            if (node->children[i]->is_leaf) {
-                split_leaf_node(node, i, node->children[i]);
-            } else {
-                split_internal_node(node, i, node->children[i]);
-            }
-            
-            if (key > node->keys[i]) {
-                i++;
-            }
-        }
-        
-        insert_non_full(node->children[i], key);
+        split_internal_node(tree, parent, index, child);
     }
 }
 
-// Insert operation
-bool bplus_tree_insert(BPlusTree* tree, int key) {
-    BPlusNode* root = tree->root;
-    
-    if (root->num_keys == tree->order - 1) {
-        BPlusNode* new_root = create_node(tree->order, false);
-        new_root->children[0] = root;
-        tree->root = new_root;
-        
-        if (root->is_leaf) {
-            split_leaf_node(new_root, 0, root);
+// Bottom-up splits. A full node gets one more key (and, for internal
+// nodes, the child to its right) and is cut in two around it; only the
+// nodes on the path that are actually full are split.
+
+// Keys the left node keeps out of `total`; `even` and `most` bound it
+static int split_point(BPlusTree* tree, int total, int even, int most, bool append) {
+    if (!append || tree->split != BPLUS_SPLIT_SEQUENTIAL) return even;
+    int biased = total * SEQUENTIAL_SPLIT_PERCENT / 100;
+    return biased < even ? even : biased > most ? most : biased;
+}
+
+// Splits the full `leaf` as if `key` were inserted at `pos`. Returns the
+// new right sibling's first key, which separates the two.
+static int split_leaf_insert(BPlusTree* tree, BPlusNode* leaf, int pos, int key, bool append, BPlusNode** right_out) {
+    int total = leaf->num_keys + 1;
+    int left_count = split_point(tree, total, total - total / 2, total - 1, append);
+    BPlusNode* right = bplus_tree_alloc_node(tree, true);
+    COUNT(tree, splits, 1);
+    mark_dirty(tree, leaf);
+    note_change(tree, leaf, BPLUS_CHANGE_SPLIT);
+    
+    // The right half first, read from the keys as they stand, then the key
+    // goes into the left half if it belongs there
+    int* keys = leaf_keys(tree, leaf, 0);
+    int* right_keys = leaf_keys(tree, right, 1);
+    for (int i = left_count; i < total; i++) {
+        right_keys[i - left_count] = i < pos ? keys[i] : i == pos ? key : keys[i - 1];
+    }
+    right->num_keys = total - left_count;
+    if (pos < left_count) {
+        memmove(&keys[pos + 1], &keys[pos], sizeof(int) * (left_count - 1 - pos));
+        keys[pos] = key;
+    }
+    leaf->num_keys = left_count;
+    leaf_store(tree, leaf, keys);
+    leaf_store(tree, right, right_keys);
+    
+    right->next = leaf->next;
+    right->prev = leaf;
+    if (leaf->next) leaf->next->prev = right;
+    leaf->next = right;
+    
+    *right_out = right;
+    return right_keys[0];
+}
+
+// Key i and child i of `node` with `separator` inserted as key `index` and
+// `child` as child index + 1
+static int combined_key(const BPlusNode* node, int index, int separator, int i) {
+    return i < index ? node->keys[i] : i == index ? separator : node->keys[i - 1];
+}
+
+static BPlusNode* combined_child(const BPlusNode* node, int index, BPlusNode* child, int i) {
+    return i <= index ? node->children[i] : i == index + 1 ? child : node->children[i - 1];
+}
+
+// Splits the full internal `node` as if `separator` and `child` were
+// inserted after child `index`. Returns the key that moves up.
+static int split_internal_insert(BPlusTree* tree, BPlusNode* node, int index, int separator,
+                                 BPlusNode* child, bool append, BPlusNode** right_out) {
+    int total = node->num_keys + 1;
+    int left_count = split_point(tree, total, (total - 1) / 2, total - 2, append);
+    BPlusNode* right = bplus_tree_alloc_node(tree, false);
+    COUNT(tree, splits, 1);
+    mark_dirty(tree, node);
+    note_change(tree, node, BPLUS_CHANGE_SPLIT);
+    // Short nodes left by lazy deletes may move to the right half
+    right->dirty |= node->dirty & BPLUS_DIRTY_SPARSE;
+    
+    for (int i = left_count + 1; i < total; i++) {
+        right->keys[i - left_count - 1] = combined_key(node, index, separator, i);
+    }
+    for (int i = left_count + 1; i <= total; i++) {
+        right->children[i - left_count - 1] = combined_child(node, index, child, i);
+    }
+    right->num_keys = total - left_count - 1;
+    int up = combined_key(node, index, separator, left_count);
+    
+    if (index < left_count) {
+        int moved = left_count - 1 - index;
+        memmove(&node->keys[index + 1], &node->keys[index], sizeof(int) * moved);
+        memmove(&node->children[index + 2], &node->children[index + 1], sizeof(BPlusNode*) * moved);
+        node->keys[index] = separator;
+        node->children[index + 1] = child;
+    }
+    node->num_keys = left_count;
+    
+    *right_out = right;
+    return up;
+}
+
+static void insert_into_internal(BPlusTree* tree, BPlusNode* node, int index, int separator, BPlusNode* child) {
+    mark_dirty(tree, node);
+    int moved = node->num_keys - index;
+    memmove(&node->keys[index + 1], &node->keys[index], sizeof(int) * moved);
+    memmove(&node->children[index + 2], &node->children[index + 1], sizeof(BPlusNode*) * moved);
+    node->keys[index] = separator;
+    node->children[index + 1] = child;
+    node->num_keys++;
+}
+
+// Adds `key` at `pos` of the full `leaf` at the end of `path`, splitting
+// upwards for as long as the node receiving a new separator is full
+static void insert_with_split(BPlusTree* tree, PathStep* path, int depth, BPlusNode* leaf,
+                              int pos, int key, bool rightmost) {
+    BPlusNode* right;
+    int separator = split_leaf_insert(tree, leaf, pos, key, rightmost && pos == leaf->num_keys, &right);
+    if (rightmost) tree->tail = right;
+    while (depth > 0) {
+        PathStep step = path[--depth];
+        if (step.node->num_keys < tree->order - 1) {
+            insert_into_internal(tree, step.node, step.index, separator, right);
+            return;
+        }
+        bool append = step.rightmost && step.index == step.node->num_keys;
+        separator = split_internal_insert(tree, step.node, step.index, separator, right, append, &right);
+    }
+    
+    // The root split: a new root above the two halves
+    BPlusNode* root = bplus_tree_alloc_node(tree, false);
+    root->keys[0] = separator;
+    root->children[0] = tree->root;
+    root->children[1] = right;
+    root->num_keys = 1;
+    root->dirty |= tree->root->dirty & BPLUS_DIRTY_SPARSE;
+    tree->root = root;
+}
+
+// Appends a key larger than the tail leaf's last key to that leaf. Every
+// separator on the rightmost spine is at most the tail's keys, so a descent
+// would end there as well. The spine is walked only when the tail is full,
+// once per split, so an append costs amortized O(1). Returns false when the
+// hint cannot be used: it is stale, a snapshot may share the tail, or the
+// tail's ancestors are not yet marked for the next checkpoint.
+static bool append_to_tail(BPlusTree* tree, int key) {
+    BPlusNode* tail = tree->tail;
+    if (!tail || tail->next || tail->num_keys == 0 || tree->versions) return false;
+    if (tree->checkpoint && !(tail->dirty & BPLUS_DIRTY_SELF)) return false;
+    if (key <= leaf_key(tail, tail->num_keys - 1)) return false;
+    
+    if (tail->num_keys < tree->leaf_order - 1) {
+        if (tail->packed) {
+            insert_into_leaf(tree, tail, key);
         } else {
-            split_internal_node(new_root, 0, root);
+            mark_dirty(tree, tail);
+            tail->keys[tail->num_keys++] = key;
         }
-        
-        insert_non_full(new_root, key);
     } else {
-        insert_non_full(root, key);
+        PathStep path[MAX_HEIGHT];
+        int depth = 0;
+        BPlusNode* node = tree->root;
+        while (!node->is_leaf) {
+            path[depth++] = (PathStep){ node, node->num_keys, true };
+            node = writable_child(tree, node, node->num_keys);
+        }
+        if (node != tail) return false;
+        insert_with_split(tree, path, depth, tail, tail->num_keys, key, true);
     }
-    
+    COUNT(tree, inserts, 1);
+    COUNT(tree, node_visits, 1);
+    tree->count++;
     return true;
 }
 
-// Helper functions for deletion
-static int find_key_index(BPlusNode* node, int key) {
-    int index = 0;
-    while (index < node->num_keys && node->keys[index] < key) {
-        ++index;
+// Insert operation: descend once recording the path, add the key to its
+// leaf, then split upwards as needed. Concurrent mode keeps splitting on
+// the way down, which its lock coupling relies on. Once inserts arrive in
+// ascending order they skip the descent (append_to_tail).
+bool bplus_tree_insert(BPlusTree* tree, int key) {
+    if (tree->sync) return concurrent_insert(tree, key);
+    if (tree->append_run >= APPEND_DETECT_RUN && append_to_tail(tree, key)) return true;
+    COUNT(tree, inserts, 1);
+    
+    // Copying the path for a key already present would only waste nodes
+    if (tree->versions) {
+        snapshot_maintain(tree);
+        if (contains(tree, key)) return false;
     }
-    return index;
-}
-
-static BPlusNode* find_leaf(BPlusNode* root, int key, BPlusNode** parent, int* parent_index) {
-    BPlusNode* current = root;
-    *parent = NULL;
     
-    while (!current->is_leaf) {
-        int i = find_key_index(current, key);
-        if (i < current->num_keys && current->keys[i] == key) {
-            i++;
-        }
-        *parent = current;
-        *parent_index = i;
-        current = current->children[i];
+    PathStep path[MAX_HEIGHT];
+    int depth = 0;
+    bool rightmost = true;
+    BPlusNode* node = writable_root(tree);
+    while (!node->is_leaf) {
+        int i = find_child_index(node, key);
+        path[depth++] = (PathStep){ node, i, rightmost };
+        rightmost = rightmost && i == node->num_keys;
+        node = writable_child(tree, node, i);
+    }
+    COUNT(tree, node_visits, depth + 1);
+    
+    int pos = leaf_lower_bound(node, key);
+    if (pos < node->num_keys && leaf_key(node, pos) == key) return false;
+    if (rightmost) tree->tail = node;
+    if (rightmost && pos == node->num_keys && node->num_keys > 0) {
+        if (tree->append_run < APPEND_DETECT_RUN) tree->append_run++;
+    } else {
+        tree->append_run = 0;
     }
     
-    return current;
-}
-
-static void update_parent_key(BPlusNode* parent, int index, int new_key) {
-    if (index > 0) {
-        parent->keys[index - 1] = new_key;
+    if (node->num_keys < tree->leaf_order - 1) {
+        insert_into_leaf(tree, node, key);
+    } else {
+        insert_with_split(tree, path, depth, node, pos, key, rightmost);
     }
+    tree->count++;
+    return true;
 }
 
-static void merge_nodes(BPlusNode* left, BPlusNode* right, BPlusNode* parent, int index) {
-    // Copy keys and children from right to left
-    for (int i = 0; i < right->num_keys; i++) {
-        left->keys[left->num_keys + i] = right->keys[i];
-        if (!left->is_leaf) {
-            left->children[left->num_keys + i + 1] = right->children[i + 1];
-        }
-    }
-    
-    if (!left->is_leaf) {
-        left->children[left->num_keys] = right->children[0];
-    } else {
+// Helper functions for deletion
+static void merge_nodes(BPlusTree* tree, BPlusNode* left, BPlusNode* right, BPlusNode* parent, int index) {
+    COUNT(tree, merges, 1);
+    mark_dirty(tree, left);
+    mark_dirty(tree, parent);
+    note_change(tree, left, BPLUS_CHANGE_MERGED);
+    
+    if (left->is_leaf) {
+        // Copy keys from right to left
+        int* keys = leaf_keys(tree, left, 0);
+        memcpy(&keys[left->num_keys], leaf_keys(tree, right, 1), sizeof(int) * right->num_keys);
+        left->num_keys += right->num_keys;
+        leaf_store(tree, left, keys);
         left->next = right->next;
+        if (right->next) right->next->prev = left;
+    } else {
+        // Pull the separator down, then append right's keys and children
+        left->keys[left->num_keys] = parent->keys[index];
+        for (int i = 0; i < right->num_keys; i++) {
+            left->keys[left->num_keys + 1 + i] = right->keys[i];
+        }
+        for (int i = 0; i <= right->num_keys; i++) {
+            left->children[left->num_keys + 1 + i] = right->children[i];
+        }
+        left->num_keys += right->num_keys + 1;
     }
     
-    left->num_keys += right->num_keys;
-    
     // Remove the separator key from parent
     for (int i = index; i < parent->num_keys - 1; i++) {
         parent->keys[i] = parent->keys[i + 1];
@@ -223,164 +443,225 @@ static void merge_nodes(BPlusNode* left, BPlusNode* right, BPlusNode* parent, in
     }
     parent->num_keys--;
     
-    destroy_node(right);
+    bplus_tree_free_node(tree, right);
 }
 
-static void redistribute_nodes(BPlusNode* left, BPlusNode* right, BPlusNode* parent, int index, bool from_left) {
+// Moves one key between adjacent leaves; the separator becomes the new
+// first key of the right one
+static void redistribute_leaves(BPlusTree* tree, BPlusNode* left, BPlusNode* right, BPlusNode* parent, int index, bool from_left) {
+    int* left_keys = leaf_keys(tree, left, 0);
+    int* right_keys = leaf_keys(tree, right, 1);
+    
     if (from_left) {
-        if (right->is_leaf) {
-            // Shift right's keys to make room
-            for (int i = right->num_keys; i > 0; i--) {
-                right->keys[i] = right->keys[i - 1];
-            }
-            right->keys[0] = left->keys[left->num_keys - 1];
-            parent->keys[index] = right->keys[0];
-        } else {
-            // For internal nodes
-            for (int i = right->num_keys; i > 0; i--) {
-                right->keys[i] = right->keys[i - 1];
-                right->children[i + 1] = right->children[i];
-            }
-            right->children[1] = right->children[0];
-            right->keys[0] = parent->keys[index];
-            parent->keys[index] = left->keys[left->num_keys - 1];
-            right->children[0] = left->children[left->num_keys];
+        memmove(&right_keys[1], right_keys, sizeof(int) * right->num_keys);
+        right_keys[0] = left_keys[--left->num_keys];
+        right->num_keys++;
+    } else {
+        left_keys[left->num_keys++] = right_keys[0];
+        right->num_keys--;
+        memmove(right_keys, &right_keys[1], sizeof(int) * right->num_keys);
+    }
+    parent->keys[index] = right_keys[0];
+    
+    leaf_store(tree, left, left_keys);
+    leaf_store(tree, right, right_keys);
+}
+
+static void redistribute_nodes(BPlusTree* tree, BPlusNode* left, BPlusNode* right, BPlusNode* parent, int index, bool from_left) {
+    COUNT(tree, redistributions, 1);
+    mark_dirty(tree, left);
+    mark_dirty(tree, right);
+    mark_dirty(tree, parent);
+    
+    if (left->is_leaf) {
+        redistribute_leaves(tree, left, right, parent, index, from_left);
+        return;
+    }
+    
+    if (from_left) {
+        for (int i = right->num_keys; i > 0; i--) {
+            right->keys[i] = right->keys[i - 1];
+            right->children[i + 1] = right->children[i];
         }
+        right->children[1] = right->children[0];
+        right->keys[0] = parent->keys[index];
+        parent->keys[index] = left->keys[left->num_keys - 1];
+        right->children[0] = left->children[left->num_keys];
         right->num_keys++;
         left->num_keys--;
     } else {
-        if (left->is_leaf) {
-            left->keys[left->num_keys] = right->keys[0];
-            parent->keys[index] = right->keys[1];
-            // Shift right's keys
-            for (int i = 0; i < right->num_keys - 1; i++) {
-                right->keys[i] = right->keys[i + 1];
-            }
-        } else {
-            left->keys[left->num_keys] = parent->keys[index];
-            left->children[left->num_keys + 1] = right->children[0];
-            parent->keys[index] = right->keys[0];
-            // Shift right's keys and children
-            for (int i = 0; i < right->num_keys - 1; i++) {
-                right->keys[i] = right->keys[i + 1];
-                right->children[i] = right->children[i + 1];
-            }
-            right->children[right->num_keys - 1] = right->children[right->num_keys];
+        left->keys[left->num_keys] = parent->keys[index];
+        left->children[left->num_keys + 1] = right->children[0];
+        parent->keys[index] = right->keys[0];
+        // Shift right's keys and children
+        for (int i = 0; i < right->num_keys - 1; i++) {
+            right->keys[i] = right->keys[i + 1];
+            right->children[i] = right->children[i + 1];
         }
+        right->children[right->num_keys - 1] = right->children[right->num_keys];
         left->num_keys++;
         right->num_keys--;
     }
 }
 
-static bool delete_from_node(BPlusTree* tree, BPlusNode* node, int key, BPlusNode* parent, int parent_index) {
-    int min_keys = (tree->order - 1) / 2;
+// Borrow from a sibling of parent->children[index], or merge with one
+void fix_underflow(BPlusTree* tree, BPlusNode* parent, int index) {
+    BPlusNode* child = parent->children[index];
+    int min_keys = min_keys_of(tree, child);
+    
+    if (index > 0 && parent->children[index - 1]->num_keys > min_keys) {
+        redistribute_nodes(tree, writable_child(tree, parent, index - 1), child, parent, index - 1, true);
+    } else if (index < parent->num_keys && 
+              parent->children[index + 1]->num_keys > min_keys) {
+        redistribute_nodes(tree, child, writable_child(tree, parent, index + 1), parent, index, false);
+    } else if (index > 0) {
+        merge_nodes(tree, writable_child(tree, parent, index - 1), child, parent, index - 1);
+    } else {
+        // The right sibling is only read before it is freed
+        merge_nodes(tree, child, parent->children[index + 1], parent, index);
+    }
+}
+
+// Delete operation: descend once recording the path, remove the key from
+// its leaf, then repair underflows upwards for as long as they occur
+bool bplus_tree_delete(BPlusTree* tree, int key) {
+    if (tree && tree->sync) return concurrent_delete(tree, key);
+    if (!tree || !tree->root) return false;
+    COUNT(tree, deletes, 1);
     
-    if (node->is_leaf) {
-        // Find key in leaf node
-        int key_index = find_key_index(node, key);
-        if (key_index >= node->num_keys || node->keys[key_index] != key) {
-            return false;  // Key not found
-        }
-        
-        // Remove key
-        for (int i = key_index; i < node->num_keys - 1; i++) {
-            node->keys[i] = node->keys[i + 1];
-        }
-        node->num_keys--;
-        
-        // Handle underflow
-        if (node != tree->root && node->num_keys < min_keys) {
-            // Try to borrow from siblings
-            if (parent_index > 0 && parent->children[parent_index - 1]->num_keys > min_keys) {
-                redistribute_nodes(parent->children[parent_index - 1], node, parent, parent_index - 1, true);
-            } else if (parent_index < parent->num_keys && 
-                      parent->children[parent_index + 1]->num_keys > min_keys) {
-                redistribute_nodes(node, parent->children[parent_index + 1], parent, parent_index, false);
-            } else {
-                // Merge with a sibling
-                if (parent_index > 0) {
-                    merge_nodes(parent->children[parent_index - 1], node, parent, parent_index - 1);
-                } else {
-                    merge_nodes(node, parent->children[parent_index + 1], parent, parent_index);
-                }
+    // Copying the path for a missing key would only waste nodes
+    if (tree->versions) {
+        snapshot_maintain(tree);
+        if (!contains(tree, key)) return false;
+    }
+    
+    PathStep path[MAX_HEIGHT];
+    int depth = 0;
+    BPlusNode* node = writable_root(tree);
+    while (!node->is_leaf) {
+        int i = find_child_index(node, key);
+        path[depth++] = (PathStep){ node, i, false };
+        node = writable_child(tree, node, i);
+    }
+    COUNT(tree, node_visits, depth + 1);
+    
+    int key_index = leaf_lower_bound(node, key);
+    if (key_index >= node->num_keys || leaf_key(node, key_index) != key) {
+        return false;  // Key not found
+    }
+    tree->count--;
+    
+    mark_dirty(tree, node);
+    int* keys = leaf_keys(tree, node, 0);
+    memmove(&keys[key_index], &keys[key_index + 1], sizeof(int) * (node->num_keys - key_index - 1));
+    node->num_keys--;
+    leaf_store(tree, node, keys);
+    
+    // Lazy deletes flag the path instead, which is all rebalancing needs
+    if (tree->flags & BPLUS_TREE_LAZY_DELETE) {
+        if (node->num_keys < min_keys_of(tree, node)) {
+            for (int d = 0; d < depth; d++) {
+                path[d].node->dirty |= BPLUS_DIRTY_SPARSE;
             }
         }
-        
-        // Update parent's key if necessary
-        if (parent && key_index == 0 && parent_index > 0) {
-            parent->keys[parent_index - 1] = node->keys[0];
+        return true;
+    }
+    
+    while (depth > 0 && node->num_keys < min_keys_of(tree, node)) {
+        PathStep step = path[--depth];
+        fix_underflow(tree, step.node, step.index);
+        node = step.node;
+    }
+    
+    // If root becomes empty, make its only child the new root
+    BPlusNode* root = tree->root;
+    if (!root->is_leaf && root->num_keys == 0) {
+        tree->root = root->children[0];
+        bplus_tree_free_node(tree, root);
+    }
+    
+    return true;
+}
+
+// Repairs the children of `node` that are under the minimum, entering the
+// flagged subtrees first so that merges below settle before this level.
+// A child that one borrow leaves short is looked at again, and so is the
+// node a merge leaves. A node with a single child cannot repair it and
+// leaves that to the next call. The flag is cleared once every child is
+// done.
+static void rebalance_node(BPlusTree* tree, BPlusNode* node, size_t budget, size_t* steps) {
+    int i = 0;
+    while (i <= node->num_keys) {
+        if (*steps == budget) return;
+        BPlusNode* child = node->children[i];
+        if (!child->is_leaf && (child->dirty & BPLUS_DIRTY_SPARSE)) {
+            rebalance_node(tree, writable_child(tree, node, i), budget, steps);
+            if (*steps == budget) return;
+            child = node->children[i];
         }
-    } else {
-        // Internal node
-        int key_index = find_key_index(node, key);
-        BPlusNode* child = node->children[key_index];
-        
-        bool deleted = delete_from_node(tree, child, key, node, key_index);
-        if (!deleted) return false;
-        
-        // Handle child underflow if necessary
-        if (child->num_keys < min_keys) {
-            if (key_index > 0 && node->children[key_index - 1]->num_keys > min_keys) {
-                redistribute_nodes(node->children[key_index - 1], child, node, key_index - 1, true);
-            } else if (key_index < node->num_keys && 
-                      node->children[key_index + 1]->num_keys > min_keys) {
-                redistribute_nodes(child, node->children[key_index + 1], node, key_index, false);
-            } else {
-                if (key_index > 0) {
-                    merge_nodes(node->children[key_index - 1], child, node, key_index - 1);
-                } else {
-                    merge_nodes(child, node->children[key_index + 1], node, key_index);
-                }
-            }
+        if (child->num_keys >= min_keys_of(tree, child) || node->num_keys == 0) {
+            i++;
+            continue;
         }
         
-        // If root becomes empty, make its only child the new root
-        if (node == tree->root && node->num_keys == 0) {
-            tree->root = node->children[0];
-            destroy_node(node);
-        }
+        int before = node->num_keys;
+        bool internal = !child->is_leaf;
+        writable_child(tree, node, i);
+        fix_underflow(tree, node, i);
+        (*steps)++;
+        if (node->num_keys < before && i > 0) i--;
+        
+        // A child that was too small to repair its own children may have
+        // the siblings for it now
+        if (internal) node->children[i]->dirty |= BPLUS_DIRTY_SPARSE;
     }
-    
-    return true;
+    node->dirty &= ~BPLUS_DIRTY_SPARSE;
 }
 
-// Delete operation
-bool bplus_tree_delete(BPlusTree* tree, int key) {
-    if (!tree || !tree->root) return false;
+size_t bplus_tree_rebalance(BPlusTree* tree, size_t budget) {
+    if (!tree || !tree->root || tree->sync || budget == 0) return 0;
+    if (tree->root->is_leaf || !(tree->root->dirty & BPLUS_DIRTY_SPARSE)) return 0;
+    if (tree->versions) snapshot_maintain(tree);
     
-    BPlusNode* parent;
-    int parent_index;
-    BPlusNode* leaf = find_leaf(tree->root, key, &parent, &parent_index);
+    size_t steps = 0;
+    rebalance_node(tree, writable_root(tree), budget, &steps);
     
-    return delete_from_node(tree, leaf, key, parent, parent_index);
+    // Merges may have emptied the root, possibly more than one level of it
+    while (!tree->root->is_leaf && tree->root->num_keys == 0) {
+        BPlusNode* root = tree->root;
+        tree->root = root->children[0];
+        bplus_tree_free_node(tree, root);
+    }
+    return steps;
 }
 
 // Search operation
 bool bplus_tree_search(BPlusTree* tree, int key) {
+    if (tree && tree->sync) return concurrent_search(tree, key);
     if (!tree || !tree->root) return false;
     
     BPlusNode* node = tree->root;
+    uint64_t visits = 1;
     
     // Traverse to leaf node
     while (!node->is_leaf) {
-        int i = 0;
-        while (i < node->num_keys && key >= node->keys[i]) {
-            i++;
-        }
-        node = node->children[i];
+        node = node->children[find_child_index(node, key)];
+        visits++;
     }
+    COUNT_READ(tree, 1, visits);
     
     // Search in leaf node
-    for (int i = 0; i < node->num_keys; i++) {
-        if (node->keys[i] == key) {
-            return true;
-        }
-    }
-    return false;
+    int i = leaf_lower_bound(node, key);
+    return i < node->num_keys && leaf_key(node, i) == key;
+}
+
+// Key i of a leaf or internal node
+static int key_at(const BPlusNode* node, int i) {
+    return node->is_leaf ? leaf_key(node, i) : node->keys[i];
 }
 
 // Helper functions for printing
-static void print_node(BPlusNode* node, int level) {
+void print_node(BPlusNode* node, int level) {
     if (!node) return;
     
     // Print indentation
@@ -391,7 +672,7 @@ static void print_node(BPlusNode* node, int level) {
     // Print keys
     printf("[");
     for (int i = 0; i < node->num_keys; i++) {
-        printf("%d", node->keys[i]);
+        printf("%d", key_at(node, i));
         if (i < node->num_keys - 1) printf(" ");
     }
     printf("] (%s)\n", node->is_leaf ? "leaf" : "internal");
@@ -411,7 +692,11 @@ void bplus_tree_print(BPlusTree* tree) {
         return;
     }
     
-    printf("B+ Tree (order %d):\n", tree->order);
+    if (tree->leaf_order != tree->order) {
+        printf("B+ Tree (order %d, leaf order %d):\n", tree->order, tree->leaf_order);
+    } else {
+        printf("B+ Tree (order %d):\n", tree->order);
+    }
     print_node(tree->root, 0);
     
     // Print leaf node chain
@@ -424,7 +709,7 @@ void bplus_tree_print(BPlusTree* tree) {
     while (leaf) {
         printf("[");
         for (int i = 0; i < leaf->num_keys; i++) {
-            printf("%d", leaf->keys[i]);
+            printf("%d", leaf_key(leaf, i));
             if (i < leaf->num_keys - 1) printf(" ");
         }
         printf("] -> ");
@@ -437,97 +722,102 @@ void bplus_tree_print(BPlusTree* tree) {
 void bplus_tree_range_search(BPlusTree* tree, int start_key, int end_key) {
     if (!tree || !tree->root) return;
     
-    BPlusNode* node = tree->root;
+    BPlusCursor cursor;
+    int key;
     
-    // Find the leaf node containing the start key
-    while (!node->is_leaf) {
-        int i = 0;
-        while (i < node->num_keys && start_key >= node->keys[i]) {
-            i++;
-        }
-        node = node->children[i];
-    }
-    
-    // Traverse the leaf nodes and print keys in range
-    while (node) {
-        for (int i = 0; i < node->num_keys; i++) {
-            if (node->keys[i] >= start_key && node->keys[i] <= end_key) {
-                printf("%d ", node->keys[i]);
-            } else if (node->keys[i] > end_key) {
-                return;
-            }
-        }
-        node = node->next;
+    // Print keys in range until the cursor passes end_key
+    bplus_cursor_seek(&cursor, tree, start_key);
+    while (bplus_cursor_next(&cursor, &key) && key <= end_key) {
+        printf("%d ", key);
     }
     printf("\n");
 }
 
-// Helper function to validate B+ tree properties
-bool bplus_tree_validate(BPlusTree* tree) {
-    if (!tree || !tree->root) return true;
+// Helper function to validate a subtree; reports its smallest and largest key.
+// Under the sequential split policy the last node of a level may be short
+// of the minimum, but never empty.
+static bool validate_node(BPlusTree* tree, BPlusNode* node, bool is_root, bool rightmost,
+                          int* min_key, int* max_key) {
+    int min_keys = min_keys_of(tree, node);
+    if (rightmost && tree->split == BPLUS_SPLIT_SEQUENTIAL) min_keys = 1;
+    if (tree->flags & BPLUS_TREE_LAZY_DELETE) min_keys = 0;
+    
+    // Check number of keys
+    if (!is_root && node->num_keys < min_keys) {
+        printf("Validation failed: Node has too few keys\n");
+        return false;
+    }
     
-    // Check if root has at least one key when it's not a leaf
-    if (!tree->root->is_leaf && tree->root->num_keys == 0) {
-        printf("Validation failed: Root node is empty\n");
+    if (node->num_keys > max_keys_of(tree, node)) {
+        printf("Validation failed: Node has too many keys\n");
         return false;
     }
     
-    int min_keys = (tree->order - 1) / 2;
+    // Check key ordering
+    for (int i = 1; i < node->num_keys; i++) {
+        if (key_at(node, i) <= key_at(node, i - 1)) {
+            printf("Validation failed: Keys not in order\n");
+            return false;
+        }
+    }
+    
+    // An empty leaf, which lazy deletes leave behind, bounds nothing
+    if (node->is_leaf) {
+        *min_key = node->num_keys ? leaf_key(node, 0) : INT_MAX;
+        *max_key = node->num_keys ? leaf_key(node, node->num_keys - 1) : INT_MIN;
+        return true;
+    }
     
-    // Helper function to validate a node
-    bool validate_node(BPlusNode* node, bool is_root, int* min_key, int* max_key) {
-        // Check number of keys
-        if (!is_root && node->num_keys < min_keys) {
-            printf("Validation failed: Node has too few keys\n");
+    // For internal nodes, recursively validate children
+    for (int i = 0; i <= node->num_keys; i++) {
+        if (!node->children[i]) {
+            printf("Validation failed: Missing child pointer\n");
             return false;
         }
         
-        if (node->num_keys >= tree->order) {
-            printf("Validation failed: Node has too many keys\n");
+        int child_min, child_max;
+        if (!validate_node(tree, node->children[i], false, rightmost && i == node->num_keys,
+                           &child_min, &child_max)) {
             return false;
         }
         
-        // Check key ordering
-        for (int i = 1; i < node->num_keys; i++) {
-            if (node->keys[i] <= node->keys[i-1]) {
-                printf("Validation failed: Keys not in order\n");
-                return false;
-            }
+        // Verify key relationships between parent and children
+        if (i > 0 && child_min < node->keys[i-1]) {
+            printf("Validation failed: Child key less than parent separator\n");
+            return false;
         }
-        
-        *min_key = node->keys[0];
-        *max_key = node->keys[node->num_keys - 1];
-        
-        // For internal nodes, recursively validate children
-        if (!node->is_leaf) {
-            for (int i = 0; i <= node->num_keys; i++) {
-                if (!node->children[i]) {
-                    printf("Validation failed: Missing child pointer\n");
-                    return false;
-                }
-                
-                int child_min, child_max;
-                if (!validate_node(node->children[i], false, &child_min, &child_max)) {
-                    return false;
-                }
-                
-                // Verify key relationships between parent and children
-                if (i > 0 && child_min <= node->keys[i-1]) {
-                    printf("Validation failed: Child key less than parent separator\n");
-                    return false;
-                }
-                if (i < node->num_keys && child_max >= node->keys[i]) {
-                    printf("Validation failed: Child key greater than parent separator\n");
-                    return false;
-                }
-            }
+        if (i < node->num_keys && child_max >= node->keys[i]) {
+            printf("Validation failed: Child key greater than parent separator\n");
+            return false;
         }
         
-        return true;
+        if (i == 0 || child_min < *min_key) *min_key = child_min;
+        if (i == 0 || child_max > *max_key) *max_key = child_max;
     }
     
+    return true;
+}
+
+size_t bplus_tree_memory_usage(const BPlusTree* tree) {
+    if (!tree) return 0;
+    return tree->leaf_pool.in_use * tree->leaf_pool.block_size +
+           tree->internal_pool.in_use * tree->internal_pool.block_size + tree->packed_bytes;
+}
+
+// Validate B+ tree properties
+bool bplus_tree_validate(BPlusTree* tree) {
+    if (!tree || !tree->root) return true;
+    
+    // Check if root has at least one key when it's not a leaf
+    if (!tree->root->is_leaf && tree->root->num_keys == 0) {
+        printf("Validation failed: Root node is empty\n");
+        return false;
+    }
+    
+    if (tree->root->num_keys == 0) return true;
+    
     int min_key, max_key;
-    return validate_node(tree->root, true, &min_key, &max_key);
+    return validate_node(tree, tree->root, true, true, &min_key, &max_key);
 }
 
 // Test function
@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include "bplus/utils.h"
 #include "bplus/tree.h"
+#include "internal.h"
 
 #define TREE_STATE_FILE "tree_state.bin"
 
@@ -10,8 +11,15 @@ bool save_tree_state(BPlusTree* tree, const char* filename) {
     FILE* fp = fopen(filename, "wb");
     if (!fp) return false;
     
-    // Write tree order
-    fwrite(&tree->order, sizeof(int), 1, fp);
+    // Write tree order; a negated order is followed by a different leaf
+    // order, so files of trees with a single order read as before
+    if (tree->leaf_order == tree->order) {
+        fwrite(&tree->order, sizeof(int), 1, fp);
+    } else {
+        int negated = -tree->order;
+        fwrite(&negated, sizeof(int), 1, fp);
+        fwrite(&tree->leaf_order, sizeof(int), 1, fp);
+    }
     
     // Write nodes recursively
     serialize_node(fp, tree->root);
@@ -27,8 +35,15 @@ void serialize_node(FILE* fp, BPlusNode* node) {
     fwrite(&node->is_leaf, sizeof(bool), 1, fp);
     fwrite(&node->num_keys, sizeof(int), 1, fp);
     
-    // Write keys
-    fwrite(node->keys, sizeof(int), node->num_keys, fp);
+    // Write keys; packed leaves are written decoded
+    if (node->is_leaf && node->packed) {
+        for (int i = 0; i < node->num_keys; i++) {
+            int key = leaf_key(node, i);
+            fwrite(&key, sizeof(int), 1, fp);
+        }
+    } else {
+        fwrite(node->keys, sizeof(int), node->num_keys, fp);
+    }
     
     // Write children recursively if not leaf
     if (!node->is_leaf) {
@@ -38,26 +53,51 @@ void serialize_node(FILE* fp, BPlusNode* node) {
     }
 }
 
+// Links leaves left to right; returns the rightmost leaf seen so far
+BPlusNode* link_leaves(BPlusNode* node, BPlusNode* prev) {
+    if (node->is_leaf) {
+        if (prev) prev->next = node;
+        node->prev = prev;
+        node->next = NULL;
+        return node;
+    }
+    for (int i = 0; i <= node->num_keys; i++) {
+        prev = link_leaves(node->children[i], prev);
+    }
+    return prev;
+}
+
 BPlusTree* load_tree_state(const char* filename) {
     FILE* fp = fopen(filename, "rb");
     if (!fp) return NULL;
     
-    int order;
-    fread(&order, sizeof(int), 1, fp);
+    BPlusTreeOptions options = {0};
+    fread(&options.order, sizeof(int), 1, fp);
+    if (options.order < 0) {
+        options.order = -options.order;
+        fread(&options.leaf_order, sizeof(int), 1, fp);
+    }
     
-    BPlusTree* tree = bplus_tree_create(order);
+    BPlusTree* tree = bplus_tree_create_with_options(&options);
+    if (!tree) {
+        fclose(fp);
+        return NULL;
+    }
     
     // Free the automatically created root
-    destroy_node(tree->root);
+    bplus_tree_free_node(tree, tree->root);
     
     // Load the actual root
-    tree->root = deserialize_node(fp, order);
+    tree->root = deserialize_node(fp, tree);
+    
+    // Rebuild the leaf chain, which is not part of the stream
+    link_leaves(tree->root, NULL);
     
     fclose(fp);
     return tree;
 }
 
-BPlusNode* deserialize_node(FILE* fp, int order) {
+BPlusNode* deserialize_node(FILE* fp, BPlusTree* tree) {
     bool is_leaf;
     int num_keys;
     
@@ -65,8 +105,9 @@ BPlusNode* deserialize_node(FILE* fp, int order) {
     fread(&is_leaf, sizeof(bool), 1, fp);
     fread(&num_keys, sizeof(int), 1, fp);
     
-    BPlusNode* node = create_node(order, is_leaf);
+    BPlusNode* node = bplus_tree_alloc_node(tree, is_leaf);
     node->num_keys = num_keys;
+    if (is_leaf) tree->count += (size_t)num_keys;
     
     // Read keys
     fread(node->keys, sizeof(int), num_keys, fp);
@@ -74,7 +115,7 @@ BPlusNode* deserialize_node(FILE* fp, int order) {
     // Read children recursively if not leaf
     if (!is_leaf) {
         for (int i = 0; i <= num_keys; i++) {
-            node->children[i] = deserialize_node(fp, order);
+            node->children[i] = deserialize_node(fp, tree);
         }
     }
     
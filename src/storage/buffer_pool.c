@@ -0,0 +1,216 @@
+// src/storage/buffer_pool.c
+#include <stdlib.h>
+#include <string.h>
+#include "bplus/buffer_pool.h"
+
+#define NO_FRAME (-1)
+
+static size_t hash_page(BPlusPageId id, size_t mask) {
+    return ((size_t)id * 2654435761u) & mask;
+}
+
+static size_t page_size(const BPlusBufferPool* pool) {
+    return pool->pager->header.page_size;
+}
+
+static int32_t table_find(const BPlusBufferPool* pool, BPlusPageId id) {
+    for (size_t i = hash_page(id, pool->table_mask); pool->table[i] != NO_FRAME; i = (i + 1) & pool->table_mask) {
+        if (pool->frames[pool->table[i]].page_id == id) return pool->table[i];
+    }
+    return NO_FRAME;
+}
+
+static void table_insert(BPlusBufferPool* pool, BPlusPageId id, int32_t frame) {
+    size_t i = hash_page(id, pool->table_mask);
+    while (pool->table[i] != NO_FRAME) {
+        i = (i + 1) & pool->table_mask;
+    }
+    pool->table[i] = frame;
+}
+
+// Linear probing delete: shift later entries of the cluster back into the
+// hole so lookups never stop early
+static void table_remove(BPlusBufferPool* pool, BPlusPageId id) {
+    size_t i = hash_page(id, pool->table_mask);
+    while (pool->frames[pool->table[i]].page_id != id) {
+        i = (i + 1) & pool->table_mask;
+    }
+    pool->table[i] = NO_FRAME;
+
+    for (size_t j = (i + 1) & pool->table_mask; pool->table[j] != NO_FRAME; j = (j + 1) & pool->table_mask) {
+        size_t home = hash_page(pool->frames[pool->table[j]].page_id, pool->table_mask);
+        // Move the entry if its home slot is not in (i, j]
+        bool stays = i <= j ? (home > i && home <= j) : (home > i || home <= j);
+        if (!stays) {
+            pool->table[i] = pool->table[j];
+            pool->table[j] = NO_FRAME;
+            i = j;
+        }
+    }
+}
+
+BPlusBufferPool* bplus_buffer_pool_create(BPlusPager* pager, size_t frame_count,
+                                          BPlusEvictionPolicy policy) {
+    if (!pager || frame_count == 0) return NULL;
+
+    BPlusBufferPool* pool = calloc(1, sizeof(BPlusBufferPool));
+    pool->pager = pager;
+    pool->policy = policy;
+    pool->frame_count = frame_count;
+    pool->frames = calloc(frame_count, sizeof(BPlusFrame));
+    pool->memory = malloc(frame_count * pager->header.page_size);
+
+    size_t table_size = 1;
+    while (table_size < frame_count * 2) {
+        table_size <<= 1;
+    }
+    pool->table = malloc(sizeof(int32_t) * table_size);
+    pool->table_mask = table_size - 1;
+    for (size_t i = 0; i < table_size; i++) {
+        pool->table[i] = NO_FRAME;
+    }
+
+    for (size_t i = 0; i < frame_count; i++) {
+        pool->frames[i].page_id = BPLUS_NO_PAGE;
+        pool->frames[i].data = pool->memory + i * pager->header.page_size;
+    }
+    return pool;
+}
+
+bool bplus_buffer_pool_destroy(BPlusBufferPool* pool) {
+    if (!pool) return false;
+    bool ok = bplus_buffer_pool_flush(pool);
+    free(pool->frames);
+    free(pool->memory);
+    free(pool->table);
+    free(pool);
+    return ok;
+}
+
+static BPlusFrame* clock_victim(BPlusBufferPool* pool) {
+    // Each full turn lowers every unpinned count by one, so after
+    // BPLUS_CLOCK_MAX_USAGE + 1 turns only pinned frames can be left
+    size_t limit = pool->frame_count * (BPLUS_CLOCK_MAX_USAGE + 1);
+    for (size_t step = 0; step < limit; step++) {
+        BPlusFrame* frame = &pool->frames[pool->clock_hand];
+        pool->clock_hand = (pool->clock_hand + 1) % pool->frame_count;
+
+        if (frame->page_id == BPLUS_NO_PAGE) return frame;
+        if (frame->pin_count > 0) continue;
+        if (frame->usage == 0) return frame;
+        frame->usage--;
+    }
+    return NULL;
+}
+
+// Largest backward 2-distance: the oldest previous pin, where pages never
+// pinned twice count as infinitely old; ties go to the least recent pin
+static BPlusFrame* lru2_victim(BPlusBufferPool* pool) {
+    BPlusFrame* victim = NULL;
+    for (size_t i = 0; i < pool->frame_count; i++) {
+        BPlusFrame* frame = &pool->frames[i];
+        if (frame->page_id == BPLUS_NO_PAGE) return frame;
+        if (frame->pin_count > 0) continue;
+        if (!victim || frame->history[1] < victim->history[1] ||
+            (frame->history[1] == victim->history[1] && frame->history[0] < victim->history[0])) {
+            victim = frame;
+        }
+    }
+    return victim;
+}
+
+// Finds a frame to reuse, writing back its page if dirty
+static BPlusFrame* evict(BPlusBufferPool* pool) {
+    BPlusFrame* frame = pool->policy == BPLUS_EVICT_LRU2 ? lru2_victim(pool) : clock_victim(pool);
+    if (!frame || frame->page_id == BPLUS_NO_PAGE) return frame;
+
+    if (frame->dirty) {
+        if (!bplus_pager_write(pool->pager, frame->page_id, frame->data)) return NULL;
+        pool->write_backs++;
+    }
+    table_remove(pool, frame->page_id);
+    frame->page_id = BPLUS_NO_PAGE;
+    frame->dirty = false;
+    pool->evictions++;
+    return frame;
+}
+
+static void touch(BPlusBufferPool* pool, BPlusFrame* frame) {
+    if (frame->usage < BPLUS_CLOCK_MAX_USAGE) frame->usage++;
+    frame->history[1] = frame->history[0];
+    frame->history[0] = ++pool->tick;
+}
+
+static uint8_t* pin_page(BPlusBufferPool* pool, BPlusPageId id, bool fresh) {
+    int32_t index = table_find(pool, id);
+    if (index != NO_FRAME) {
+        BPlusFrame* frame = &pool->frames[index];
+        pool->hits++;
+        frame->pin_count++;
+        touch(pool, frame);
+        if (fresh) memset(frame->data, 0, page_size(pool));
+        return frame->data;
+    }
+
+    pool->misses++;
+    BPlusFrame* frame = evict(pool);
+    if (!frame) return NULL;
+    if (fresh) {
+        memset(frame->data, 0, page_size(pool));
+    } else if (!bplus_pager_read(pool->pager, id, frame->data)) {
+        return NULL;
+    }
+
+    frame->page_id = id;
+    frame->pin_count = 1;
+    frame->usage = 0;
+    frame->history[0] = 0;
+    frame->history[1] = 0;
+    frame->dirty = fresh;
+    touch(pool, frame);
+    table_insert(pool, id, (int32_t)(frame - pool->frames));
+    return frame->data;
+}
+
+uint8_t* bplus_buffer_pool_pin(BPlusBufferPool* pool, BPlusPageId id) {
+    if (!pool || id == BPLUS_NO_PAGE) return NULL;
+    return pin_page(pool, id, false);
+}
+
+uint8_t* bplus_buffer_pool_pin_new(BPlusBufferPool* pool, BPlusPageId id) {
+    if (!pool || id == BPLUS_NO_PAGE) return NULL;
+    return pin_page(pool, id, true);
+}
+
+void bplus_buffer_pool_unpin(BPlusBufferPool* pool, BPlusPageId id, bool dirty) {
+    int32_t index = table_find(pool, id);
+    if (index == NO_FRAME) return;
+    BPlusFrame* frame = &pool->frames[index];
+    if (frame->pin_count > 0) frame->pin_count--;
+    frame->dirty = frame->dirty || dirty;
+}
+
+void bplus_buffer_pool_discard(BPlusBufferPool* pool, BPlusPageId id) {
+    int32_t index = table_find(pool, id);
+    if (index == NO_FRAME) return;
+    BPlusFrame* frame = &pool->frames[index];
+    table_remove(pool, id);
+    frame->page_id = BPLUS_NO_PAGE;
+    frame->pin_count = 0;
+    frame->dirty = false;
+}
+
+bool bplus_buffer_pool_flush(BPlusBufferPool* pool) {
+    bool ok = true;
+    for (size_t i = 0; i < pool->frame_count; i++) {
+        BPlusFrame* frame = &pool->frames[i];
+        if (frame->page_id == BPLUS_NO_PAGE || !frame->dirty) continue;
+        if (bplus_pager_write(pool->pager, frame->page_id, frame->data)) {
+            frame->dirty = false;
+            pool->write_backs++;
+        } else {
+            ok = false;
+        }
+    }
+    return ok;
+}
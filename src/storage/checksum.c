@@ -0,0 +1,68 @@
+// src/storage/checksum.c
+#include <stdbool.h>
+#include <string.h>
+#include "bplus/checksum.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define BPLUS_HAVE_X86 1
+#endif
+
+#define CRC32C_POLY 0x82F63B78u
+
+typedef uint32_t (*Crc32cFn)(uint32_t crc, const uint8_t* p, size_t len);
+
+static uint32_t resolve_crc32c(uint32_t crc, const uint8_t* p, size_t len);
+
+static Crc32cFn crc32c_fn = resolve_crc32c;
+static uint32_t crc32c_table[256];
+
+static void build_table(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int bit = 0; bit < 8; bit++) {
+            c = (c & 1) ? (c >> 1) ^ CRC32C_POLY : c >> 1;
+        }
+        crc32c_table[i] = c;
+    }
+}
+
+// Operates on the pre/post-inverted register, as does the hardware kernel
+static uint32_t crc32c_table_driven(uint32_t crc, const uint8_t* p, size_t len) {
+    while (len--) {
+        crc = crc32c_table[(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#ifdef BPLUS_HAVE_X86
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_sse42(uint32_t crc, const uint8_t* p, size_t len) {
+    uint64_t c = crc;
+    for (; len >= 8; p += 8, len -= 8) {
+        uint64_t word;
+        memcpy(&word, p, sizeof(word));
+        c = _mm_crc32_u64(c, word);
+    }
+    crc = (uint32_t)c;
+    for (; len > 0; p++, len--) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+#endif
+
+// The first call picks the kernel
+static uint32_t resolve_crc32c(uint32_t crc, const uint8_t* p, size_t len) {
+    build_table();
+    Crc32cFn fn = crc32c_table_driven;
+#ifdef BPLUS_HAVE_X86
+    if (__builtin_cpu_supports("sse4.2")) fn = crc32c_sse42;
+#endif
+    crc32c_fn = fn;
+    return fn(crc, p, len);
+}
+
+uint32_t bplus_crc32c(uint32_t crc, const void* data, size_t len) {
+    return ~crc32c_fn(~crc, data, len);
+}
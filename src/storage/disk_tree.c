@@ -0,0 +1,582 @@
+// src/storage/disk_tree.c
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bplus/disk_tree.h"
+#include "bplus/search.h"
+
+#define PAGE_LEAF 1
+#define PAGE_INTERNAL 2
+
+// Every node page starts with this header, followed by the keys and, for
+// internal pages, the child ids after room for internal_capacity keys
+typedef struct {
+    uint16_t type;
+    uint16_t num_keys;
+    BPlusPageId next;  // next leaf to the right, BPLUS_NO_PAGE at the end
+} PageHeader;
+
+// Pages pinned at once: a full path, a new page for each of its levels and
+// a new root, and one more for walks
+#define MIN_FRAMES (2 * BPLUS_DISK_MAX_HEIGHT + 2)
+
+// The pinned root-to-leaf path of one operation
+typedef struct {
+    BPlusPageId ids[BPLUS_DISK_MAX_HEIGHT];
+    uint8_t* pages[BPLUS_DISK_MAX_HEIGHT];
+    int slots[BPLUS_DISK_MAX_HEIGHT];   // child taken at each internal level
+    bool dirty[BPLUS_DISK_MAX_HEIGHT];
+    int depth;                          // level of the leaf
+} PagePath;
+
+// The new pages an insert's splits take, leaf first and new root last,
+// all allocated and pinned before the insert changes anything
+typedef struct {
+    BPlusPageId ids[BPLUS_DISK_MAX_HEIGHT + 1];
+    uint8_t* pages[BPLUS_DISK_MAX_HEIGHT + 1];
+    int count;
+    int used;
+} SplitPages;
+
+static uint32_t page_size(const BPlusDiskTree* tree) {
+    return tree->pager->header.page_size;
+}
+
+static PageHeader* header_of(uint8_t* page) {
+    return (PageHeader*)page;
+}
+
+static int* keys_of(uint8_t* page) {
+    return (int*)(page + sizeof(PageHeader));
+}
+
+static BPlusPageId* children_of(const BPlusDiskTree* tree, uint8_t* page) {
+    return (BPlusPageId*)(keys_of(page) + tree->internal_capacity);
+}
+
+// Split buffers: merged keys and merged children
+static int* scratch_keys(const BPlusDiskTree* tree) {
+    return (int*)tree->scratch;
+}
+
+static BPlusPageId* scratch_children(const BPlusDiskTree* tree) {
+    return (BPlusPageId*)(tree->scratch + page_size(tree));
+}
+
+// Allocates and pins an empty page; the caller unpins it dirty
+static uint8_t* new_page(BPlusDiskTree* tree, uint16_t type, BPlusPageId* id) {
+    *id = bplus_pager_alloc(tree->pager);
+    if (*id == BPLUS_NO_PAGE) return NULL;
+    uint8_t* page = bplus_buffer_pool_pin_new(tree->pool, *id);
+    if (!page) return NULL;
+    header_of(page)->type = type;
+    header_of(page)->next = BPLUS_NO_PAGE;
+    return page;
+}
+
+static bool free_page(BPlusDiskTree* tree, BPlusPageId id) {
+    bplus_buffer_pool_discard(tree->pool, id);
+    return bplus_pager_free(tree->pager, id);
+}
+
+BPlusDiskTree* bplus_disk_tree_open(const char* path, uint32_t page_size_hint, size_t cache_frames) {
+    BPlusPager* pager = bplus_pager_open(path, page_size_hint);
+    if (!pager) return NULL;
+
+    if (cache_frames == 0) cache_frames = BPLUS_DISK_DEFAULT_FRAMES;
+    if (cache_frames < MIN_FRAMES) cache_frames = MIN_FRAMES;
+
+    uint32_t size = pager->header.page_size;
+    BPlusDiskTree* tree = malloc(sizeof(BPlusDiskTree));
+    tree->pager = pager;
+    // LRU-2 keeps the upper levels resident however large the tree grows
+    tree->pool = bplus_buffer_pool_create(pager, cache_frames, BPLUS_EVICT_LRU2);
+    tree->leaf_capacity = (int)((size - sizeof(PageHeader)) / sizeof(int));
+    tree->internal_capacity = (int)((size - sizeof(PageHeader) - sizeof(BPlusPageId)) /
+                                    (sizeof(int) + sizeof(BPlusPageId)));
+    tree->scratch = malloc((size_t)size * 2);
+
+    // A new file starts with an empty leaf as its root
+    if (pager->header.root == BPLUS_NO_PAGE) {
+        BPlusPageId root;
+        if (!new_page(tree, PAGE_LEAF, &root)) {
+            bplus_disk_tree_close(tree);
+            return NULL;
+        }
+        bplus_buffer_pool_unpin(tree->pool, root, true);
+        pager->header.root = root;
+        pager->header.height = 0;
+        pager->header.key_count = 0;
+        pager->header_dirty = true;
+        bplus_disk_tree_sync(tree);
+    }
+
+    return tree;
+}
+
+bool bplus_disk_tree_close(BPlusDiskTree* tree) {
+    if (!tree) return false;
+    bool ok = bplus_buffer_pool_destroy(tree->pool);
+    ok = bplus_pager_close(tree->pager) && ok;
+    free(tree->scratch);
+    free(tree);
+    return ok;
+}
+
+bool bplus_disk_tree_sync(BPlusDiskTree* tree) {
+    if (!tree) return false;
+    bool ok = bplus_buffer_pool_flush(tree->pool);
+    return bplus_pager_sync(tree->pager) && ok;
+}
+
+uint64_t bplus_disk_tree_count(const BPlusDiskTree* tree) {
+    return tree ? tree->pager->header.key_count : 0;
+}
+
+static void release_path(BPlusDiskTree* tree, PagePath* path, int deepest) {
+    for (int level = 0; level <= deepest; level++) {
+        if (path->pages[level]) {
+            bplus_buffer_pool_unpin(tree->pool, path->ids[level], path->dirty[level]);
+        }
+    }
+}
+
+// Pins the root-to-leaf path for `key`. Fails on an I/O error or a
+// corrupt page, with nothing left pinned.
+static bool descend(BPlusDiskTree* tree, int key, PagePath* path) {
+    BPlusPageId id = tree->pager->header.root;
+    for (int level = 0; level < BPLUS_DISK_MAX_HEIGHT; level++) {
+        uint8_t* page = bplus_buffer_pool_pin(tree->pool, id);
+        if (!page) {
+            release_path(tree, path, level - 1);
+            return false;
+        }
+        path->ids[level] = id;
+        path->pages[level] = page;
+        path->dirty[level] = false;
+
+        PageHeader* header = header_of(page);
+        if (header->type == PAGE_LEAF) {
+            path->depth = level;
+            return true;
+        }
+        if (header->type != PAGE_INTERNAL) {
+            release_path(tree, path, level);
+            return false;
+        }
+
+        path->slots[level] = bplus_upper_bound(keys_of(page), header->num_keys, key);
+        id = children_of(tree, page)[path->slots[level]];
+    }
+    release_path(tree, path, BPLUS_DISK_MAX_HEIGHT - 1);
+    return false;
+}
+
+bool bplus_disk_tree_search(BPlusDiskTree* tree, int key) {
+    if (!tree) return false;
+
+    PagePath path;
+    if (!descend(tree, key, &path)) return false;
+
+    uint8_t* leaf = path.pages[path.depth];
+    int n = header_of(leaf)->num_keys;
+    int i = bplus_lower_bound(keys_of(leaf), n, key);
+    bool found = i < n && keys_of(leaf)[i] == key;
+    release_path(tree, &path, path.depth);
+    return found;
+}
+
+static void release_split(BPlusDiskTree* tree, SplitPages* split) {
+    for (int i = split->used; i < split->count; i++) {
+        free_page(tree, split->ids[i]);
+    }
+    split->count = split->used;
+}
+
+// Reserves a page for the leaf and for each full internal page above it,
+// plus a new root if the root is one of them. Fails, having reserved
+// nothing, when the tree would grow past BPLUS_DISK_MAX_HEIGHT or a page
+// cannot be had.
+static bool reserve_split(BPlusDiskTree* tree, const PagePath* path, SplitPages* split) {
+    int needed = 1;
+    int level = path->depth - 1;
+    while (level >= 0 && header_of(path->pages[level])->num_keys >= tree->internal_capacity) {
+        needed++;
+        level--;
+    }
+    if (level < 0) {
+        if (tree->pager->header.height + 1 >= BPLUS_DISK_MAX_HEIGHT) return false;
+        needed++;
+    }
+
+    split->count = 0;
+    split->used = 0;
+    for (int i = 0; i < needed; i++) {
+        BPlusPageId id;
+        uint8_t* page = new_page(tree, i == 0 ? PAGE_LEAF : PAGE_INTERNAL, &id);
+        if (!page) {
+            if (id != BPLUS_NO_PAGE) bplus_pager_free(tree->pager, id);
+            release_split(tree, split);
+            return false;
+        }
+        split->ids[i] = id;
+        split->pages[i] = page;
+        split->count++;
+    }
+    return true;
+}
+
+static uint8_t* take_page(SplitPages* split, BPlusPageId* id) {
+    *id = split->ids[split->used];
+    return split->pages[split->used++];
+}
+
+// Adds (separator, child) to the internal page at `level` after its slot
+// on the path, splitting upwards as long as pages overflow. The pages it
+// needs come from `split`, so it cannot fail.
+static void insert_into_parents(BPlusDiskTree* tree, PagePath* path, SplitPages* split, int level,
+                                int separator, BPlusPageId child) {
+    BPlusPager* pager = tree->pager;
+
+    for (; level >= 0; level--) {
+        uint8_t* page = path->pages[level];
+        PageHeader* header = header_of(page);
+        int* keys = keys_of(page);
+        BPlusPageId* children = children_of(tree, page);
+        int n = header->num_keys;
+        int slot = path->slots[level];
+        path->dirty[level] = true;
+
+        if (n < tree->internal_capacity) {
+            memmove(&keys[slot + 1], &keys[slot], sizeof(int) * (n - slot));
+            memmove(&children[slot + 2], &children[slot + 1], sizeof(BPlusPageId) * (n - slot));
+            keys[slot] = separator;
+            children[slot + 1] = child;
+            header->num_keys++;
+            return;
+        }
+
+        // Full: merge the new entry in, keep the lower half, push the
+        // middle key up and move the rest to a new page
+        int* all_keys = scratch_keys(tree);
+        BPlusPageId* all_children = scratch_children(tree);
+        memcpy(all_keys, keys, sizeof(int) * slot);
+        all_keys[slot] = separator;
+        memcpy(&all_keys[slot + 1], &keys[slot], sizeof(int) * (n - slot));
+        memcpy(all_children, children, sizeof(BPlusPageId) * (slot + 1));
+        all_children[slot + 1] = child;
+        memcpy(&all_children[slot + 2], &children[slot + 1], sizeof(BPlusPageId) * (n - slot));
+
+        int mid = (n + 1) / 2;
+        BPlusPageId right_id;
+        uint8_t* right = take_page(split, &right_id);
+        header_of(right)->num_keys = (uint16_t)(n - mid);
+        memcpy(keys_of(right), &all_keys[mid + 1], sizeof(int) * (n - mid));
+        memcpy(children_of(tree, right), &all_children[mid + 1], sizeof(BPlusPageId) * (n - mid + 1));
+        bplus_buffer_pool_unpin(tree->pool, right_id, true);
+
+        header->num_keys = (uint16_t)mid;
+        memcpy(keys, all_keys, sizeof(int) * mid);
+        memcpy(children, all_children, sizeof(BPlusPageId) * (mid + 1));
+
+        separator = all_keys[mid];
+        child = right_id;
+    }
+
+    // The root split: grow the tree by one level
+    BPlusPageId root_id;
+    uint8_t* root = take_page(split, &root_id);
+    header_of(root)->num_keys = 1;
+    keys_of(root)[0] = separator;
+    children_of(tree, root)[0] = pager->header.root;
+    children_of(tree, root)[1] = child;
+    bplus_buffer_pool_unpin(tree->pool, root_id, true);
+
+    pager->header.root = root_id;
+    pager->header.height++;
+    pager->header_dirty = true;
+}
+
+static bool insert_into_path(BPlusDiskTree* tree, PagePath* path, int key) {
+    BPlusPager* pager = tree->pager;
+    uint8_t* leaf = path->pages[path->depth];
+    PageHeader* header = header_of(leaf);
+    int* keys = keys_of(leaf);
+    int n = header->num_keys;
+    int pos = bplus_lower_bound(keys, n, key);
+    if (pos < n && keys[pos] == key) return false;
+
+    if (n < tree->leaf_capacity) {
+        memmove(&keys[pos + 1], &keys[pos], sizeof(int) * (n - pos));
+        keys[pos] = key;
+        header->num_keys++;
+        path->dirty[path->depth] = true;
+        pager->header.key_count++;
+        pager->header_dirty = true;
+        return true;
+    }
+
+    SplitPages split;
+    if (!reserve_split(tree, path, &split)) return false;
+    path->dirty[path->depth] = true;
+
+    // Split the leaf evenly and link the new page in after it
+    int* all_keys = scratch_keys(tree);
+    memcpy(all_keys, keys, sizeof(int) * pos);
+    all_keys[pos] = key;
+    memcpy(&all_keys[pos + 1], &keys[pos], sizeof(int) * (n - pos));
+
+    int total = n + 1;
+    int mid = total / 2;
+    BPlusPageId right_id;
+    uint8_t* right = take_page(&split, &right_id);
+    header_of(right)->num_keys = (uint16_t)(total - mid);
+    header_of(right)->next = header->next;
+    memcpy(keys_of(right), &all_keys[mid], sizeof(int) * (total - mid));
+    int separator = keys_of(right)[0];
+    bplus_buffer_pool_unpin(tree->pool, right_id, true);
+
+    header->num_keys = (uint16_t)mid;
+    header->next = right_id;
+    memcpy(keys, all_keys, sizeof(int) * mid);
+
+    insert_into_parents(tree, path, &split, path->depth - 1, separator, right_id);
+    pager->header.key_count++;
+    pager->header_dirty = true;
+    return true;
+}
+
+bool bplus_disk_tree_insert(BPlusDiskTree* tree, int key) {
+    if (!tree) return false;
+
+    PagePath path;
+    if (!descend(tree, key, &path)) return false;
+    bool inserted = insert_into_path(tree, &path, key);
+    release_path(tree, &path, path.depth);
+    return inserted;
+}
+
+// Points the leaf left of the path's leaf to `next`. That leaf is the
+// rightmost one under the nearest left sibling subtree.
+static bool relink_predecessor(BPlusDiskTree* tree, PagePath* path, BPlusPageId next) {
+    int level = path->depth - 1;
+    while (level >= 0 && path->slots[level] == 0) {
+        level--;
+    }
+    if (level < 0) return true;  // the leftmost leaf has no predecessor
+
+    BPlusPageId id = children_of(tree, path->pages[level])[path->slots[level] - 1];
+    for (;;) {
+        uint8_t* page = bplus_buffer_pool_pin(tree->pool, id);
+        if (!page) return false;
+        if (header_of(page)->type == PAGE_LEAF) {
+            header_of(page)->next = next;
+            bplus_buffer_pool_unpin(tree->pool, id, true);
+            return true;
+        }
+        BPlusPageId child = children_of(tree, page)[header_of(page)->num_keys];
+        bplus_buffer_pool_unpin(tree->pool, id, false);
+        id = child;
+    }
+}
+
+// Unlinks the path's emptied leaf, frees it and drops it from its parent;
+// parents left without children go too
+static bool remove_empty_leaf(BPlusDiskTree* tree, PagePath* path) {
+    BPlusPager* pager = tree->pager;
+    int depth = path->depth;
+
+    if (!relink_predecessor(tree, path, header_of(path->pages[depth])->next)) return false;
+
+    for (int level = depth; level > 0; level--) {
+        path->pages[level] = NULL;
+        if (!free_page(tree, path->ids[level])) return false;
+
+        uint8_t* page = path->pages[level - 1];
+        PageHeader* parent = header_of(page);
+        int count = parent->num_keys;
+        if (count == 0 && level - 1 > 0) continue;
+
+        if (count == 0) {
+            // Nothing left anywhere: the root becomes an empty leaf
+            memset(page, 0, page_size(tree));
+            header_of(page)->type = PAGE_LEAF;
+            header_of(page)->next = BPLUS_NO_PAGE;
+            path->dirty[0] = true;
+            pager->header.height = 0;
+            pager->header_dirty = true;
+            return true;
+        }
+
+        int slot = path->slots[level - 1];
+        int key_slot = slot > 0 ? slot - 1 : 0;
+        int* keys = keys_of(page);
+        BPlusPageId* children = children_of(tree, page);
+        memmove(&keys[key_slot], &keys[key_slot + 1], sizeof(int) * (count - key_slot - 1));
+        memmove(&children[slot], &children[slot + 1], sizeof(BPlusPageId) * (count - slot));
+        parent->num_keys--;
+        path->dirty[level - 1] = true;
+        break;
+    }
+
+    // Shrink the tree while the root is an internal page with one child
+    while (pager->header.height > 0 && header_of(path->pages[0])->num_keys == 0) {
+        BPlusPageId old_root = path->ids[0];
+        BPlusPageId new_root = children_of(tree, path->pages[0])[0];
+        path->pages[0] = NULL;
+        if (!free_page(tree, old_root)) return false;
+
+        uint8_t* root = bplus_buffer_pool_pin(tree->pool, new_root);
+        if (!root) return false;
+        path->ids[0] = new_root;
+        path->pages[0] = root;
+        path->dirty[0] = false;
+        pager->header.root = new_root;
+        pager->header.height--;
+        pager->header_dirty = true;
+    }
+    return true;
+}
+
+static bool delete_from_path(BPlusDiskTree* tree, PagePath* path, int key) {
+    BPlusPager* pager = tree->pager;
+    uint8_t* leaf = path->pages[path->depth];
+    PageHeader* header = header_of(leaf);
+    int* keys = keys_of(leaf);
+    int n = header->num_keys;
+    int pos = bplus_lower_bound(keys, n, key);
+    if (pos >= n || keys[pos] != key) return false;
+
+    memmove(&keys[pos], &keys[pos + 1], sizeof(int) * (n - pos - 1));
+    header->num_keys--;
+    path->dirty[path->depth] = true;
+    pager->header.key_count--;
+    pager->header_dirty = true;
+
+    if (header->num_keys > 0 || path->depth == 0) return true;
+    return remove_empty_leaf(tree, path);
+}
+
+bool bplus_disk_tree_delete(BPlusDiskTree* tree, int key) {
+    if (!tree) return false;
+
+    PagePath path;
+    if (!descend(tree, key, &path)) return false;
+    int depth = path.depth;
+    bool deleted = delete_from_path(tree, &path, key);
+    release_path(tree, &path, depth);
+    return deleted;
+}
+
+size_t bplus_disk_tree_scan(BPlusDiskTree* tree, int start_key, int end_key,
+                            BPlusDiskVisitor visit, void* ctx) {
+    if (!tree || !visit || start_key > end_key) return 0;
+
+    PagePath path;
+    if (!descend(tree, start_key, &path)) return 0;
+
+    // Keep only the leaf pinned, then walk the chain from it
+    BPlusPageId id = path.ids[path.depth];
+    uint8_t* leaf = path.pages[path.depth];
+    release_path(tree, &path, path.depth - 1);
+
+    size_t visited = 0;
+    int i = bplus_lower_bound(keys_of(leaf), header_of(leaf)->num_keys, start_key);
+    for (;;) {
+        bool more = true;
+        for (; more && i < header_of(leaf)->num_keys; i++) {
+            int key = keys_of(leaf)[i];
+            if (key > end_key) {
+                more = false;
+            } else {
+                visited++;
+                more = visit(key, ctx);
+            }
+        }
+        BPlusPageId next = header_of(leaf)->next;
+        bplus_buffer_pool_unpin(tree->pool, id, false);
+        if (!more || next == BPLUS_NO_PAGE) return visited;
+
+        id = next;
+        leaf = bplus_buffer_pool_pin(tree->pool, id);
+        if (!leaf) return visited;
+        i = 0;
+    }
+}
+
+typedef struct {
+    BPlusPageId* leaves;
+    size_t leaf_count;
+    size_t leaf_capacity;
+    uint64_t keys;
+} ValidateState;
+
+// Checks the subtree at `id` against the interval [low, high) its parent
+// allows. Pages are unpinned before recursing, so depth pins nothing.
+static bool validate_page(BPlusDiskTree* tree, BPlusPageId id, int level, long long low, long long high,
+                          ValidateState* state) {
+    if (level >= BPLUS_DISK_MAX_HEIGHT) return false;
+    uint8_t* page = bplus_buffer_pool_pin(tree->pool, id);
+    if (!page) return false;
+
+    PageHeader* header = header_of(page);
+    int* keys = keys_of(page);
+    int n = header->num_keys;
+    bool ok = header->type == PAGE_LEAF ? n <= tree->leaf_capacity
+                                        : header->type == PAGE_INTERNAL && n <= tree->internal_capacity;
+    for (int i = 0; ok && i < n; i++) {
+        ok = keys[i] >= low && keys[i] < high && (i == 0 || keys[i] > keys[i - 1]);
+    }
+
+    if (!ok || header->type == PAGE_LEAF) {
+        bplus_buffer_pool_unpin(tree->pool, id, false);
+        if (!ok || level != (int)tree->pager->header.height) return false;
+        if (state->leaf_count == state->leaf_capacity) {
+            state->leaf_capacity = state->leaf_capacity ? state->leaf_capacity * 2 : 64;
+            state->leaves = realloc(state->leaves, sizeof(BPlusPageId) * state->leaf_capacity);
+        }
+        state->leaves[state->leaf_count++] = id;
+        state->keys += (uint64_t)n;
+        return true;
+    }
+
+    BPlusPageId* children = malloc(sizeof(BPlusPageId) * (n + 1));
+    long long* bounds = malloc(sizeof(long long) * (n + 2));
+    memcpy(children, children_of(tree, page), sizeof(BPlusPageId) * (n + 1));
+    bounds[0] = low;
+    for (int i = 0; i < n; i++) {
+        bounds[i + 1] = keys[i];
+    }
+    bounds[n + 1] = high;
+    bplus_buffer_pool_unpin(tree->pool, id, false);
+
+    for (int i = 0; ok && i <= n; i++) {
+        ok = validate_page(tree, children[i], level + 1, bounds[i], bounds[i + 1], state);
+    }
+    free(children);
+    free(bounds);
+    return ok;
+}
+
+bool bplus_disk_tree_validate(BPlusDiskTree* tree) {
+    if (!tree) return false;
+
+    ValidateState state = { NULL, 0, 0, 0 };
+    bool ok = validate_page(tree, tree->pager->header.root, 0, (long long)INT_MIN, (long long)INT_MAX + 1, &state);
+    ok = ok && state.keys == tree->pager->header.key_count;
+
+    // The leaf chain must visit the leaves in tree order
+    for (size_t i = 0; ok && i < state.leaf_count; i++) {
+        uint8_t* page = bplus_buffer_pool_pin(tree->pool, state.leaves[i]);
+        if (!page) {
+            ok = false;
+            break;
+        }
+        BPlusPageId expected = i + 1 < state.leaf_count ? state.leaves[i + 1] : BPLUS_NO_PAGE;
+        ok = header_of(page)->next == expected;
+        bplus_buffer_pool_unpin(tree->pool, state.leaves[i], false);
+    }
+
+    free(state.leaves);
+    return ok;
+}
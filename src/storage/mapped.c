@@ -0,0 +1,310 @@
+// src/storage/mapped.c
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bplus/checksum.h"
+#include "bplus/mapped.h"
+#include "bplus/search.h"
+
+#define MAPPED_MAGIC "BPLUSMAP"
+#define MAPPED_FORMAT 1
+#define MAPPED_MAX_HEIGHT 64
+#define WRITE_BUFFER (1 << 20)
+
+typedef struct {
+    int32_t num_keys;
+    uint32_t is_leaf;
+} NodeHeader;
+
+static size_t round8(size_t size) {
+    return (size + 7) & ~(size_t)7;
+}
+
+// Records start 8-aligned, so child offsets are aligned in the mapping
+static size_t record_size(bool is_leaf, int num_keys) {
+    size_t size = sizeof(NodeHeader) + sizeof(int32_t) * (size_t)num_keys;
+    if (!is_leaf) size = round8(size) + sizeof(uint64_t) * (size_t)(num_keys + 1);
+    return round8(size);
+}
+
+static const int32_t* keys_of(const NodeHeader* node) {
+    return (const int32_t*)(node + 1);
+}
+
+static const uint64_t* children_of(const NodeHeader* node) {
+    return (const uint64_t*)((const uint8_t*)node +
+                             round8(sizeof(NodeHeader) + sizeof(int32_t) * (size_t)node->num_keys));
+}
+
+static uint32_t header_crc(const BPlusMappedHeader* header) {
+    BPlusMappedHeader copy = *header;
+    copy.header_crc = 0;
+    return bplus_crc32c(0, &copy, sizeof(copy));
+}
+
+// Makes a rename inside the directory holding `path` durable
+static bool sync_parent_dir(const char* path) {
+    const char* slash = strrchr(path, '/');
+    char* dir = slash ? strndup(path, (size_t)(slash - path) + 1) : strdup(".");
+    int fd = open(dir, O_RDONLY);
+    free(dir);
+    if (fd < 0) return false;
+    bool ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// Writing
+
+typedef struct {
+    BPlusNode** nodes;
+    size_t count;
+} Level;
+
+// Splits the tree into levels, root first; every leaf is on the last one
+static Level* collect_levels(BPlusTree* tree, uint32_t* height) {
+    size_t capacity = 4;
+    Level* levels = malloc(sizeof(Level) * capacity);
+    levels[0].nodes = malloc(sizeof(BPlusNode*));
+    levels[0].nodes[0] = tree->root;
+    levels[0].count = 1;
+
+    uint32_t h = 0;
+    while (!levels[h].nodes[0]->is_leaf) {
+        if (h + 1 == capacity) {
+            capacity *= 2;
+            levels = realloc(levels, sizeof(Level) * capacity);
+        }
+        size_t count = 0;
+        for (size_t i = 0; i < levels[h].count; i++) {
+            count += (size_t)levels[h].nodes[i]->num_keys + 1;
+        }
+        Level* next = &levels[h + 1];
+        next->nodes = malloc(sizeof(BPlusNode*) * count);
+        next->count = 0;
+        for (size_t i = 0; i < levels[h].count; i++) {
+            BPlusNode* node = levels[h].nodes[i];
+            for (int c = 0; c <= node->num_keys; c++) {
+                next->nodes[next->count++] = node->children[c];
+            }
+        }
+        h++;
+    }
+    *height = h;
+    return levels;
+}
+
+static bool write_records(FILE* fp, Level* levels, uint32_t height, int order, int leaf_order,
+                          BPlusMappedHeader* header) {
+    int most = order > leaf_order ? order : leaf_order;
+    uint8_t* record = calloc(1, record_size(false, most - 1));
+    int* keys = malloc(sizeof(int) * (size_t)most);
+    uint64_t offset = sizeof(BPlusMappedHeader);
+    uint32_t crc = 0;
+    bool ok = true;
+
+    for (uint32_t h = 0; ok && h <= height; h++) {
+        // Children of this level are the next level in order, so their
+        // offsets follow from the sizes of the records before them
+        uint64_t child_offset = offset;
+        for (size_t i = 0; i < levels[h].count; i++) {
+            BPlusNode* node = levels[h].nodes[i];
+            child_offset += record_size(node->is_leaf, node->num_keys);
+        }
+
+        if (h == height) header->first_leaf = offset;
+        for (size_t i = 0; ok && i < levels[h].count; i++) {
+            BPlusNode* node = levels[h].nodes[i];
+            size_t size = record_size(node->is_leaf, node->num_keys);
+            memset(record, 0, size);
+            NodeHeader* out = (NodeHeader*)record;
+            out->num_keys = node->num_keys;
+            out->is_leaf = node->is_leaf;
+            memcpy(out + 1, bplus_node_keys(node, keys), sizeof(int32_t) * (size_t)node->num_keys);
+            if (!node->is_leaf) {
+                uint64_t* children = (uint64_t*)children_of(out);
+                for (int c = 0; c <= node->num_keys; c++) {
+                    children[c] = child_offset;
+                    BPlusNode* child = node->children[c];
+                    child_offset += record_size(child->is_leaf, child->num_keys);
+                }
+            } else {
+                header->key_count += (uint64_t)node->num_keys;
+            }
+            crc = bplus_crc32c(crc, record, size);
+            ok = fwrite(record, 1, size, fp) == size;
+            offset += size;
+        }
+    }
+
+    free(keys);
+    free(record);
+    header->file_size = offset;
+    header->body_crc = crc;
+    return ok;
+}
+
+bool bplus_mapped_tree_write(BPlusTree* tree, const char* path) {
+    if (!tree || !tree->root || !path) return false;
+
+    size_t len = strlen(path);
+    char* temp = malloc(len + 5);
+    memcpy(temp, path, len);
+    memcpy(temp + len, ".tmp", 5);
+    FILE* fp = fopen(temp, "wb");
+    if (!fp) {
+        free(temp);
+        return false;
+    }
+    setvbuf(fp, NULL, _IOFBF, WRITE_BUFFER);
+
+    BPlusMappedHeader header = { .format = MAPPED_FORMAT, .order = tree->order,
+                                 .leaf_order = tree->leaf_order == tree->order ? 0 : tree->leaf_order,
+                                 .root = sizeof(BPlusMappedHeader) };
+    memcpy(header.magic, MAPPED_MAGIC, sizeof(header.magic));
+    Level* levels = collect_levels(tree, &header.height);
+
+    // The header goes in last, once the body checksum is known
+    bool ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+              write_records(fp, levels, header.height, tree->order, tree->leaf_order, &header);
+    for (uint32_t h = 0; h <= header.height; h++) {
+        free(levels[h].nodes);
+    }
+    free(levels);
+
+    header.header_crc = header_crc(&header);
+    ok = ok && fseek(fp, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, fp) == 1 &&
+         fflush(fp) == 0 && fsync(fileno(fp)) == 0;
+    ok = fclose(fp) == 0 && ok;
+    ok = ok && rename(temp, path) == 0 && sync_parent_dir(path);
+    if (!ok) remove(temp);
+    free(temp);
+    return ok;
+}
+
+// Reading
+
+static bool valid_header(const BPlusMappedHeader* header, size_t size) {
+    return memcmp(header->magic, MAPPED_MAGIC, sizeof(header->magic)) == 0 &&
+           header->format == MAPPED_FORMAT && header->header_crc == header_crc(header) &&
+           header->file_size == size && header->order >= 3 &&
+           (header->leaf_order == 0 || header->leaf_order >= 3) &&
+           header->height <= MAPPED_MAX_HEIGHT &&
+           header->root == sizeof(BPlusMappedHeader) &&
+           header->first_leaf >= header->root && header->first_leaf < size;
+}
+
+BPlusMappedTree* bplus_mapped_tree_open(const char* path) {
+    if (!path) return NULL;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    void* data = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(BPlusMappedHeader)) {
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+
+    size_t size = (size_t)st.st_size;
+    if (!valid_header(data, size)) {
+        munmap(data, size);
+        return NULL;
+    }
+
+    // The internal levels are small and on every lookup path; leaves are
+    // read on demand
+    const BPlusMappedHeader* header = data;
+    if (header->first_leaf > header->root) {
+        madvise(data, (size_t)header->first_leaf, MADV_WILLNEED);
+    }
+
+    BPlusMappedTree* tree = malloc(sizeof(BPlusMappedTree));
+    tree->data = data;
+    tree->size = size;
+    tree->header = header;
+    return tree;
+}
+
+void bplus_mapped_tree_close(BPlusMappedTree* tree) {
+    if (!tree) return;
+    munmap((void*)tree->data, tree->size);
+    free(tree);
+}
+
+bool bplus_mapped_tree_verify(const BPlusMappedTree* tree) {
+    size_t body = sizeof(BPlusMappedHeader);
+    return tree && bplus_crc32c(0, tree->data + body, tree->size - body) == tree->header->body_crc;
+}
+
+// The record at `offset` if it lies inside the mapping and has the
+// expected kind; NULL otherwise
+static const NodeHeader* node_at(const BPlusMappedTree* tree, uint64_t offset, bool is_leaf) {
+    if (offset % 8 != 0 || offset < sizeof(BPlusMappedHeader) ||
+        offset + sizeof(NodeHeader) > tree->size) {
+        return NULL;
+    }
+    const NodeHeader* node = (const NodeHeader*)(tree->data + offset);
+    int order = is_leaf && tree->header->leaf_order ? tree->header->leaf_order : tree->header->order;
+    if (node->num_keys < 0 || node->num_keys >= order ||
+        node->is_leaf != (uint32_t)is_leaf ||
+        offset + record_size(is_leaf, node->num_keys) > tree->size) {
+        return NULL;
+    }
+    return node;
+}
+
+// Offset of the leaf that may hold `key`, or 0 if the image is damaged.
+// Children always lie after their parent, so the walk cannot loop.
+static uint64_t find_leaf(const BPlusMappedTree* tree, int key) {
+    uint64_t offset = tree->header->root;
+    for (uint32_t depth = 0; depth < tree->header->height; depth++) {
+        const NodeHeader* node = node_at(tree, offset, false);
+        if (!node) return 0;
+        uint64_t child = children_of(node)[bplus_upper_bound(keys_of(node), node->num_keys, key)];
+        if (child <= offset) return 0;
+        offset = child;
+    }
+    return offset;
+}
+
+bool bplus_mapped_tree_search(const BPlusMappedTree* tree, int key) {
+    if (!tree) return false;
+    const NodeHeader* leaf = node_at(tree, find_leaf(tree, key), true);
+    if (!leaf) return false;
+    int i = bplus_lower_bound(keys_of(leaf), leaf->num_keys, key);
+    return i < leaf->num_keys && keys_of(leaf)[i] == key;
+}
+
+size_t bplus_mapped_tree_scan(const BPlusMappedTree* tree, int start_key, int end_key,
+                              BPlusMappedVisitor visit, void* ctx) {
+    if (!tree || !visit || start_key > end_key) return 0;
+
+    uint64_t offset = find_leaf(tree, start_key);
+    const NodeHeader* leaf = node_at(tree, offset, true);
+    size_t visited = 0;
+    int i = leaf ? bplus_lower_bound(keys_of(leaf), leaf->num_keys, start_key) : 0;
+
+    // Leaves are stored back to back in key order up to the end of the file
+    while (leaf) {
+        for (; i < leaf->num_keys; i++) {
+            int key = keys_of(leaf)[i];
+            if (key > end_key) return visited;
+            visited++;
+            if (!visit(key, ctx)) return visited;
+        }
+        offset += record_size(true, leaf->num_keys);
+        leaf = offset < tree->size ? node_at(tree, offset, true) : NULL;
+        i = 0;
+    }
+    return visited;
+}
+
+uint64_t bplus_mapped_tree_count(const BPlusMappedTree* tree) {
+    return tree ? tree->header->key_count : 0;
+}
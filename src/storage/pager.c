@@ -0,0 +1,146 @@
+// src/storage/pager.c
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bplus/pager.h"
+
+#define PAGER_MAGIC "BPLUSPGF"
+#define PAGER_FORMAT 1
+
+static bool valid_page_size(uint32_t page_size) {
+    return page_size >= BPLUS_MIN_PAGE_SIZE && page_size <= BPLUS_MAX_PAGE_SIZE &&
+           (page_size & (page_size - 1)) == 0;
+}
+
+static off_t page_offset(const BPlusPager* pager, BPlusPageId id) {
+    return (off_t)id * pager->header.page_size;
+}
+
+// Full-length positional I/O; short transfers only happen on errors
+static bool read_at(int fd, void* buf, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pread(fd, buf, size, offset);
+        if (n <= 0) return false;
+        buf = (char*)buf + n;
+        size -= (size_t)n;
+        offset += n;
+    }
+    return true;
+}
+
+static bool write_at(int fd, const void* buf, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, buf, size, offset);
+        if (n <= 0) return false;
+        buf = (const char*)buf + n;
+        size -= (size_t)n;
+        offset += n;
+    }
+    return true;
+}
+
+// The header is padded out to a whole page so page 1 starts aligned
+static bool write_header(BPlusPager* pager) {
+    uint8_t* page = calloc(1, pager->header.page_size);
+    if (!page) return false;
+    memcpy(page, &pager->header, sizeof(BPlusFileHeader));
+    bool ok = write_at(pager->fd, page, pager->header.page_size, 0);
+    free(page);
+    if (ok) pager->header_dirty = false;
+    return ok;
+}
+
+// Writes a fresh header into an empty file, or checks the existing one
+static bool init_or_check_header(BPlusPager* pager, uint32_t page_size) {
+    struct stat st;
+    if (fstat(pager->fd, &st) != 0) return false;
+
+    if (st.st_size == 0) {
+        memcpy(pager->header.magic, PAGER_MAGIC, sizeof(pager->header.magic));
+        pager->header.format = PAGER_FORMAT;
+        pager->header.page_size = page_size;
+        pager->header.page_count = 1;
+        pager->header.free_head = BPLUS_NO_PAGE;
+        pager->header.root = BPLUS_NO_PAGE;
+        return write_header(pager);
+    }
+
+    return read_at(pager->fd, &pager->header, sizeof(BPlusFileHeader), 0) &&
+           memcmp(pager->header.magic, PAGER_MAGIC, sizeof(pager->header.magic)) == 0 &&
+           pager->header.format == PAGER_FORMAT &&
+           valid_page_size(pager->header.page_size);
+}
+
+BPlusPager* bplus_pager_open(const char* path, uint32_t page_size) {
+    if (page_size == 0) page_size = BPLUS_PAGE_SIZE;
+    if (!path || !valid_page_size(page_size)) return NULL;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return NULL;
+
+    BPlusPager* pager = calloc(1, sizeof(BPlusPager));
+    pager->fd = fd;
+    if (!init_or_check_header(pager, page_size)) {
+        close(fd);
+        free(pager);
+        return NULL;
+    }
+    return pager;
+}
+
+bool bplus_pager_sync(BPlusPager* pager) {
+    if (pager->header_dirty && !write_header(pager)) return false;
+    return fsync(pager->fd) == 0;
+}
+
+bool bplus_pager_close(BPlusPager* pager) {
+    if (!pager) return false;
+    bool ok = bplus_pager_sync(pager);
+    ok = close(pager->fd) == 0 && ok;
+    free(pager);
+    return ok;
+}
+
+bool bplus_pager_read(BPlusPager* pager, BPlusPageId id, void* buf) {
+    if (id == BPLUS_NO_PAGE || id >= pager->header.page_count) return false;
+    pager->reads++;
+    return read_at(pager->fd, buf, pager->header.page_size, page_offset(pager, id));
+}
+
+bool bplus_pager_write(BPlusPager* pager, BPlusPageId id, const void* buf) {
+    if (id == BPLUS_NO_PAGE || id >= pager->header.page_count) return false;
+    pager->writes++;
+    return write_at(pager->fd, buf, pager->header.page_size, page_offset(pager, id));
+}
+
+// A free page stores the id of the next free page in its first bytes
+BPlusPageId bplus_pager_alloc(BPlusPager* pager) {
+    BPlusPageId id = pager->header.free_head;
+    if (id != BPLUS_NO_PAGE) {
+        BPlusPageId next;
+        pager->reads++;
+        if (!read_at(pager->fd, &next, sizeof(next), page_offset(pager, id))) return BPLUS_NO_PAGE;
+        pager->header.free_head = next;
+    } else {
+        id = pager->header.page_count++;
+    }
+    pager->header_dirty = true;
+    return id;
+}
+
+bool bplus_pager_free(BPlusPager* pager, BPlusPageId id) {
+    if (id == BPLUS_NO_PAGE || id >= pager->header.page_count) return false;
+
+    uint8_t* page = calloc(1, pager->header.page_size);
+    if (!page) return false;
+    memcpy(page, &pager->header.free_head, sizeof(BPlusPageId));
+    bool ok = bplus_pager_write(pager, id, page);
+    free(page);
+    if (!ok) return false;
+
+    pager->header.free_head = id;
+    pager->header_dirty = true;
+    return true;
+}
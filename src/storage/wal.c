@@ -0,0 +1,318 @@
+// src/storage/wal.c
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "bplus/checkpoint.h"
+#include "bplus/checksum.h"
+#include "bplus/wal.h"
+
+#define WAL_MAGIC "BPLUSWAL"
+#define WAL_FORMAT 1
+#define WAL_SCAN_BATCH 256
+
+typedef struct {
+    char magic[8];
+    uint32_t format;
+    uint32_t reserved;
+    uint64_t start_lsn;      // LSN of the first record after this header
+} WalHeader;
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t record_crc(const BPlusWalRecord* record) {
+    return bplus_crc32c(0, (const char*)record + sizeof(record->crc),
+                        sizeof(BPlusWalRecord) - sizeof(record->crc));
+}
+
+static bool read_at(int fd, void* buf, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pread(fd, buf, size, offset);
+        if (n <= 0) return false;
+        buf = (char*)buf + n;
+        size -= (size_t)n;
+        offset += n;
+    }
+    return true;
+}
+
+static bool write_at(int fd, const void* buf, size_t size, off_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, buf, size, offset);
+        if (n <= 0) return false;
+        buf = (const char*)buf + n;
+        size -= (size_t)n;
+        offset += n;
+    }
+    return true;
+}
+
+// Empties the log; its next record gets `start_lsn`
+static bool reset_log(BPlusWal* wal, uint64_t start_lsn) {
+    WalHeader header = { .format = WAL_FORMAT, .start_lsn = start_lsn };
+    memcpy(header.magic, WAL_MAGIC, sizeof(header.magic));
+    if (ftruncate(wal->fd, sizeof(WalHeader)) != 0 ||
+        !write_at(wal->fd, &header, sizeof(header), 0) ||
+        fdatasync(wal->fd) != 0) {
+        return false;
+    }
+    wal->size = sizeof(WalHeader);
+    wal->next_lsn = start_lsn;
+    return true;
+}
+
+// Finds the end of the intact records and drops whatever follows it
+static bool scan_log(BPlusWal* wal, off_t file_size) {
+    WalHeader header;
+    if (!read_at(wal->fd, &header, sizeof(header), 0) ||
+        memcmp(header.magic, WAL_MAGIC, sizeof(header.magic)) != 0 ||
+        header.format != WAL_FORMAT) {
+        return false;
+    }
+
+    BPlusWalRecord batch[WAL_SCAN_BATCH];
+    uint64_t offset = sizeof(WalHeader);
+    uint64_t lsn = header.start_lsn;
+    bool intact = true;
+    while (intact && offset + sizeof(BPlusWalRecord) <= (uint64_t)file_size) {
+        size_t n = (size_t)(((uint64_t)file_size - offset) / sizeof(BPlusWalRecord));
+        if (n > WAL_SCAN_BATCH) n = WAL_SCAN_BATCH;
+        if (!read_at(wal->fd, batch, n * sizeof(BPlusWalRecord), (off_t)offset)) return false;
+        for (size_t i = 0; i < n && intact; i++) {
+            intact = batch[i].lsn == lsn && record_crc(&batch[i]) == batch[i].crc &&
+                     (batch[i].op == BPLUS_WAL_INSERT || batch[i].op == BPLUS_WAL_DELETE);
+            if (intact) {
+                offset += sizeof(BPlusWalRecord);
+                lsn++;
+            }
+        }
+    }
+
+    if (offset != (uint64_t)file_size &&
+        (ftruncate(wal->fd, (off_t)offset) != 0 || fdatasync(wal->fd) != 0)) {
+        return false;
+    }
+    wal->size = offset;
+    wal->next_lsn = lsn;
+    return true;
+}
+
+static bool commit_group(BPlusWal* wal, size_t own);
+
+// Sleeps until the oldest pending record is a window old, then syncs its
+// group. Once a sync fails the log is failed and nothing is retried.
+static void* flusher_main(void* arg) {
+    BPlusWal* wal = arg;
+    uint64_t window = (uint64_t)wal->options.group_window_ms * 1000000u;
+
+    pthread_mutex_lock(&wal->lock);
+    while (!wal->closing) {
+        if (wal->pending_count == 0 || wal->failed) {
+            pthread_cond_wait(&wal->flush_wake, &wal->lock);
+            continue;
+        }
+        uint64_t deadline = wal->pending_since + window;
+        if (monotonic_ns() >= deadline) {
+            commit_group(wal, 0);
+            continue;
+        }
+        struct timespec until = { .tv_sec = (time_t)(deadline / 1000000000u),
+                                  .tv_nsec = (long)(deadline % 1000000000u) };
+        pthread_cond_timedwait(&wal->flush_wake, &wal->lock, &until);
+    }
+    pthread_mutex_unlock(&wal->lock);
+    return NULL;
+}
+
+// The flusher's timed waits run on the monotonic clock, like pending_since
+static bool start_flusher(BPlusWal* wal) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&wal->flush_wake, &attr);
+    pthread_condattr_destroy(&attr);
+    if (wal->options.group_records == 1 || wal->options.group_window_ms == 0) return true;
+    wal->flusher_running = pthread_create(&wal->flusher, NULL, flusher_main, wal) == 0;
+    return wal->flusher_running;
+}
+
+static void stop_flusher(BPlusWal* wal) {
+    if (wal->flusher_running) {
+        pthread_mutex_lock(&wal->lock);
+        wal->closing = true;
+        pthread_cond_signal(&wal->flush_wake);
+        pthread_mutex_unlock(&wal->lock);
+        pthread_join(wal->flusher, NULL);
+        wal->flusher_running = false;
+    }
+    pthread_cond_destroy(&wal->flush_wake);
+}
+
+BPlusWal* bplus_wal_open(const char* path, const BPlusWalOptions* options) {
+    if (!path) return NULL;
+
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return NULL;
+
+    BPlusWal* wal = calloc(1, sizeof(BPlusWal));
+    wal->fd = fd;
+    wal->options.group_records = 1;
+    if (options) wal->options = *options;
+    if (wal->options.group_records == 0) wal->options.group_records = 1;
+    pthread_mutex_init(&wal->lock, NULL);
+
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 &&
+              (st.st_size == 0 ? reset_log(wal, 1) : scan_log(wal, st.st_size));
+    if (!ok || !start_flusher(wal)) {
+        if (ok) pthread_cond_destroy(&wal->flush_wake);
+        pthread_mutex_destroy(&wal->lock);
+        close(fd);
+        free(wal);
+        return NULL;
+    }
+    return wal;
+}
+
+// Writes the pending group behind the synced log with one fdatasync. The
+// last `own` pending records belong to the caller, which reports the
+// failure for them. On failure those are dropped and whatever reached the
+// file is cut off, so no later commit or reopen brings them back. Any
+// other record in the group was accepted by an append that returned true
+// and cannot be dropped quietly, so the log is then failed. Called with
+// the lock held, except on close.
+static bool commit_group(BPlusWal* wal, size_t own) {
+    if (wal->failed) return false;
+    if (wal->pending_count == 0) return true;
+
+    size_t bytes = wal->pending_count * sizeof(BPlusWalRecord);
+    if (!write_at(wal->fd, wal->pending, bytes, (off_t)wal->size) ||
+        fdatasync(wal->fd) != 0) {
+        wal->pending_count -= own;
+        wal->next_lsn -= own;
+        if (wal->pending_count > 0 || ftruncate(wal->fd, (off_t)wal->size) != 0) {
+            wal->failed = true;
+        }
+        return false;
+    }
+    wal->size += bytes;
+    wal->pending_count = 0;
+    wal->syncs++;
+    return true;
+}
+
+bool bplus_wal_close(BPlusWal* wal) {
+    if (!wal) return false;
+    stop_flusher(wal);
+    bool ok = commit_group(wal, 0);
+    ok = close(wal->fd) == 0 && ok;
+    pthread_mutex_destroy(&wal->lock);
+    free(wal->pending);
+    free(wal);
+    return ok;
+}
+
+bool bplus_wal_replay(BPlusWal* wal, BPlusWalApply apply, void* ctx, uint64_t* replayed) {
+    BPlusWalRecord batch[WAL_SCAN_BATCH];
+    uint64_t count = 0;
+
+    pthread_mutex_lock(&wal->lock);
+    uint64_t offset = sizeof(WalHeader);
+    bool ok = true;
+    while (ok && offset < wal->size) {
+        size_t n = (size_t)((wal->size - offset) / sizeof(BPlusWalRecord));
+        if (n > WAL_SCAN_BATCH) n = WAL_SCAN_BATCH;
+        ok = read_at(wal->fd, batch, n * sizeof(BPlusWalRecord), (off_t)offset);
+        for (size_t i = 0; ok && i < n; i++) {
+            apply((BPlusWalOp)batch[i].op, batch[i].key, ctx);
+        }
+        offset += n * sizeof(BPlusWalRecord);
+        if (ok) count += n;
+    }
+    pthread_mutex_unlock(&wal->lock);
+
+    if (replayed) *replayed = count;
+    return ok;
+}
+
+bool bplus_wal_append(BPlusWal* wal, BPlusWalOp op, int key) {
+    pthread_mutex_lock(&wal->lock);
+    if (wal->failed) {
+        pthread_mutex_unlock(&wal->lock);
+        return false;
+    }
+
+    if (wal->pending_count == wal->pending_capacity) {
+        size_t capacity = wal->pending_capacity ? wal->pending_capacity * 2 : 16;
+        BPlusWalRecord* grown = realloc(wal->pending, capacity * sizeof(BPlusWalRecord));
+        if (!grown) {
+            pthread_mutex_unlock(&wal->lock);
+            return false;
+        }
+        wal->pending = grown;
+        wal->pending_capacity = capacity;
+    }
+
+    BPlusWalRecord* record = &wal->pending[wal->pending_count];
+    *record = (BPlusWalRecord){ .op = (uint32_t)op, .lsn = wal->next_lsn++, .key = key };
+    record->crc = record_crc(record);
+    wal->appends++;
+
+    // Only the time window needs the clock
+    uint64_t now = wal->options.group_window_ms ? monotonic_ns() : 0;
+    if (wal->pending_count++ == 0) {
+        wal->pending_since = now;
+        if (wal->flusher_running) pthread_cond_signal(&wal->flush_wake);
+    }
+
+    bool ok = true;
+    if (wal->pending_count >= wal->options.group_records ||
+        (wal->options.group_window_ms &&
+         now - wal->pending_since >= (uint64_t)wal->options.group_window_ms * 1000000u)) {
+        ok = commit_group(wal, 1);
+    }
+
+    pthread_mutex_unlock(&wal->lock);
+    return ok;
+}
+
+bool bplus_wal_sync(BPlusWal* wal) {
+    pthread_mutex_lock(&wal->lock);
+    bool ok = commit_group(wal, 0);
+    pthread_mutex_unlock(&wal->lock);
+    return ok;
+}
+
+static void apply_to_tree(BPlusWalOp op, int key, void* ctx) {
+    BPlusTree* tree = ctx;
+    if (op == BPLUS_WAL_INSERT) {
+        if (!bplus_tree_search(tree, key)) bplus_tree_insert(tree, key);
+    } else {
+        bplus_tree_delete(tree, key);
+    }
+}
+
+bool bplus_wal_recover(BPlusWal* wal, BPlusTree* tree) {
+    return bplus_wal_replay(wal, apply_to_tree, tree, NULL);
+}
+
+bool bplus_wal_checkpoint(BPlusWal* wal, BPlusTree* tree, const char* snapshot_path) {
+    if (!bplus_tree_checkpoint(tree, snapshot_path, NULL)) return false;
+
+    // The checkpoint covers every record, pending ones included. A crash
+    // before the reset replays them onto it, which changes nothing. It
+    // also holds the changes of a group that failed to sync, so the log
+    // can be used again.
+    pthread_mutex_lock(&wal->lock);
+    wal->pending_count = 0;
+    bool ok = reset_log(wal, wal->next_lsn);
+    if (ok) wal->failed = false;
+    pthread_mutex_unlock(&wal->lock);
+    return ok;
+}
@@ -0,0 +1,232 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "internal.h"
+
+// Bytes of JSON per chunk of a streamed response
+#define CHUNK_SIZE 4096
+// Room for a chunk's size line ahead of its data
+#define CHUNK_PREFIX 10
+
+static const char* status_text(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 503: return "Service Unavailable";
+    default: return "Internal Server Error";
+    }
+}
+
+static long find_blank_line(const char* buf, size_t len) {
+    for (size_t i = 0; i + 3 < len; i++) {
+        if (buf[i] == '\r' && buf[i + 1] == '\n' && buf[i + 2] == '\r' && buf[i + 3] == '\n') {
+            return (long)i;
+        }
+    }
+    return -1;
+}
+
+static bool copy_param(char* out, const char* text, size_t len) {
+    if (len >= PARAMS_MAX) return false;
+    memcpy(out, text, len);
+    out[len] = '\0';
+    return true;
+}
+
+int http_parse(const char* buf, size_t len, HttpRequest* req) {
+    long head_len = find_blank_line(buf, len);
+    if (head_len < 0) return len >= REQUEST_MAX ? -1 : 0;
+
+    char head[REQUEST_MAX + 1];
+    memcpy(head, buf, (size_t)head_len);
+    head[head_len] = '\0';
+
+    // Request line
+    char target[PARAMS_MAX + 256];
+    int major, minor;
+    memset(req, 0, sizeof(*req));
+    if (sscanf(head, "%7s %1279s HTTP/%d.%d", req->method, target, &major, &minor) != 4) return -1;
+    char* query = strchr(target, '?');
+    if (query) {
+        *query++ = '\0';
+        if (!copy_param(req->query, query, strlen(query))) return -1;
+    }
+    if (strlen(target) >= sizeof(req->path)) return -1;
+    strcpy(req->path, target);
+    req->keep_alive = major > 1 || (major == 1 && minor >= 1);
+
+    // Headers
+    long content_length = 0;
+    for (char* line = strstr(head, "\r\n"); line; line = strstr(line, "\r\n")) {
+        line += 2;
+        if (strncasecmp(line, "Content-Length:", 15) == 0) {
+            char* end;
+            content_length = strtol(line + 15, &end, 10);
+            if (content_length < 0 || end == line + 15) return -1;
+        } else if (strncasecmp(line, "Connection:", 11) == 0) {
+            const char* value = line + 11 + strspn(line + 11, " \t");
+            if (strncasecmp(value, "close", 5) == 0) req->keep_alive = false;
+            if (strncasecmp(value, "keep-alive", 10) == 0) req->keep_alive = true;
+        } else if (strncasecmp(line, "Transfer-Encoding:", 18) == 0) {
+            return -1;
+        }
+    }
+
+    size_t total = (size_t)head_len + 4 + (size_t)content_length;
+    if (total > REQUEST_MAX || (size_t)content_length >= PARAMS_MAX) return -1;
+    if (total > len) return 0;
+    copy_param(req->form, buf + head_len + 4, (size_t)content_length);
+    return (int)total;
+}
+
+// The value of `name` in a list of &-separated pairs, if it fits in `out`
+static bool find_param(const char* params, const char* name, char* out, size_t cap) {
+    size_t name_len = strlen(name);
+    for (const char* p = params; *p; ) {
+        size_t pair_len = strcspn(p, "&");
+        if (pair_len > name_len && strncmp(p, name, name_len) == 0 && p[name_len] == '=') {
+            size_t value_len = pair_len - name_len - 1;
+            if (value_len >= cap) return false;
+            memcpy(out, p + name_len + 1, value_len);
+            out[value_len] = '\0';
+            return true;
+        }
+        p += pair_len;
+        if (*p) p++;
+    }
+    return false;
+}
+
+static bool param_text(const HttpRequest* req, const char* name, char* out, size_t cap) {
+    return find_param(req->query, name, out, cap) || find_param(req->form, name, out, cap);
+}
+
+bool http_param(const HttpRequest* req, const char* name, int* value) {
+    char text[16];
+    if (!param_text(req, name, text, sizeof(text)) || !text[0]) return false;
+    char* end;
+    errno = 0;
+    long parsed = strtol(text, &end, 10);
+    if (*end || errno || parsed < INT_MIN || parsed > INT_MAX) return false;
+    *value = (int)parsed;
+    return true;
+}
+
+bool http_param_u64(const HttpRequest* req, const char* name, uint64_t* value) {
+    char text[24];
+    if (!param_text(req, name, text, sizeof(text)) || !text[0]) return false;
+    if (strspn(text, "0123456789") != strlen(text)) return false;
+    char* end;
+    errno = 0;
+    unsigned long long parsed = strtoull(text, &end, 10);
+    if (*end || errno) return false;
+    *value = parsed;
+    return true;
+}
+
+bool http_send(int fd, const void* data, size_t len) {
+    const char* p = data;
+    while (len > 0) {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+bool http_respond(int fd, int status, const char* type, const char* body, size_t len, bool keep_alive) {
+    char buf[4096];
+    int head = snprintf(buf, sizeof(buf), "HTTP/1.1 %d %s\r\n"
+                        "Content-Type: %s\r\n"
+                        "Content-Length: %zu\r\n"
+                        "Connection: %s\r\n\r\n",
+                        status, status_text(status), type, len, keep_alive ? "keep-alive" : "close");
+    // Small responses go out in one segment
+    if (len <= sizeof(buf) - (size_t)head) {
+        memcpy(buf + head, body, len);
+        return http_send(fd, buf, (size_t)head + len);
+    }
+    return http_send(fd, buf, (size_t)head) && http_send(fd, body, len);
+}
+
+bool http_error(int fd, int status, bool keep_alive) {
+    char body[64];
+    int len = snprintf(body, sizeof(body), "{\"error\":\"%s\"}", status_text(status));
+    return http_respond(fd, status, "application/json", body, (size_t)len, keep_alive);
+}
+
+// Each chunk is its size in hex, CRLF, the data and CRLF; an empty chunk
+// ends the response
+bool http_stream_json(int fd, BPlusJsonWriter* writer, bool keep_alive) {
+    char head[128];
+    int head_len = snprintf(head, sizeof(head), "HTTP/1.1 200 OK\r\n"
+                            "Content-Type: application/json\r\n"
+                            "Transfer-Encoding: chunked\r\n"
+                            "Connection: %s\r\n\r\n", keep_alive ? "keep-alive" : "close");
+    if (!http_send(fd, head, (size_t)head_len)) return false;
+
+    char buf[CHUNK_PREFIX + CHUNK_SIZE + 2];
+    size_t n;
+    while ((n = bplus_json_writer_read(writer, buf + CHUNK_PREFIX, CHUNK_SIZE)) > 0) {
+        char size[CHUNK_PREFIX + 1];
+        int size_len = snprintf(size, sizeof(size), "%zx\r\n", n);
+        char* start = buf + CHUNK_PREFIX - size_len;
+        memcpy(start, size, (size_t)size_len);
+        memcpy(buf + CHUNK_PREFIX + n, "\r\n", 2);
+        if (!http_send(fd, start, (size_t)size_len + n + 2)) return false;
+    }
+    return http_send(fd, "0\r\n\r\n", 5);
+}
+
+static const char* content_type(const char* path) {
+    const char* dot = strrchr(path, '.');
+    if (!dot) return "application/octet-stream";
+    if (strcmp(dot, ".html") == 0) return "text/html; charset=utf-8";
+    if (strcmp(dot, ".js") == 0) return "application/javascript";
+    if (strcmp(dot, ".css") == 0) return "text/css";
+    if (strcmp(dot, ".json") == 0) return "application/json";
+    return "application/octet-stream";
+}
+
+bool http_send_file(int fd, const char* path, bool keep_alive) {
+    int file = open(path, O_RDONLY | O_CLOEXEC);
+    struct stat st;
+    if (file < 0 || fstat(file, &st) != 0 || !S_ISREG(st.st_mode)) {
+        if (file >= 0) close(file);
+        return http_error(fd, 404, keep_alive);
+    }
+
+    char buf[CHUNK_SIZE];
+    int head = snprintf(buf, sizeof(buf), "HTTP/1.1 200 OK\r\n"
+                        "Content-Type: %s\r\n"
+                        "Content-Length: %lld\r\n"
+                        "Connection: %s\r\n\r\n",
+                        content_type(path), (long long)st.st_size, keep_alive ? "keep-alive" : "close");
+    bool ok = http_send(fd, buf, (size_t)head);
+    // A file that shrinks while it is sent leaves the response short,
+    // which the client sees as a failed transfer
+    long long left = st.st_size;
+    while (ok && left > 0) {
+        size_t want = left < (long long)sizeof(buf) ? (size_t)left : sizeof(buf);
+        ssize_t n = read(file, buf, want);
+        if (n < 0 && errno == EINTR) continue;
+        ok = n > 0 && http_send(fd, buf, (size_t)n);
+        left -= n;
+    }
+    close(file);
+    return ok;
+}
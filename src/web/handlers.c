@@ -0,0 +1,292 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bplus/journal.h"
+#include "bplus/snapshot.h"
+#include "internal.h"
+
+#define JSON_TYPE "application/json"
+
+static bool handle_search(BPlusWebServer* server, int fd, const HttpRequest* req) {
+    int key;
+    if (!http_param(req, "key", &key)) return http_error(fd, 400, req->keep_alive);
+
+    BPlusSnapshot* snapshot = web_read(server);
+    bool found = bplus_snapshot_search(snapshot, key);
+    bplus_snapshot_release(snapshot);
+
+    char body[64];
+    int len = snprintf(body, sizeof(body), "{\"key\":%d,\"found\":%s}", key, found ? "true" : "false");
+    return http_respond(fd, 200, JSON_TYPE, body, (size_t)len, req->keep_alive);
+}
+
+typedef struct {
+    char* out;
+    size_t len;
+    int count;
+    int limit;
+    bool truncated;
+} RangeState;
+
+static bool add_key(int key, void* ctx) {
+    RangeState* state = ctx;
+    if (state->count == state->limit) {
+        state->truncated = true;
+        return false;
+    }
+    state->len += (size_t)sprintf(state->out + state->len, "%s%d", state->count ? "," : "", key);
+    state->count++;
+    return true;
+}
+
+static bool handle_range(BPlusWebServer* server, int fd, const HttpRequest* req) {
+    int from, to;
+    int limit = BPLUS_WEB_RANGE_MAX;
+    if (!http_param(req, "from", &from) || !http_param(req, "to", &to)) {
+        return http_error(fd, 400, req->keep_alive);
+    }
+    if (http_param(req, "limit", &limit) && (limit < 1 || limit > BPLUS_WEB_RANGE_MAX)) {
+        return http_error(fd, 400, req->keep_alive);
+    }
+
+    // Up to 11 characters and a comma per key
+    char body[BPLUS_WEB_RANGE_MAX * 12 + 64];
+    RangeState state = { body, 0, 0, limit, false };
+    state.len = (size_t)sprintf(body, "{\"keys\":[");
+    BPlusSnapshot* snapshot = web_read(server);
+    bplus_snapshot_scan(snapshot, from, to, add_key, &state);
+    bplus_snapshot_release(snapshot);
+    state.len += (size_t)sprintf(body + state.len, "],\"count\":%d,\"truncated\":%s}",
+                                 state.count, state.truncated ? "true" : "false");
+    return http_respond(fd, 200, JSON_TYPE, body, state.len, req->keep_alive);
+}
+
+// The dump reads its own snapshot, so it holds nothing another request
+// waits for however slowly the client takes it
+static bool stream_snapshot(BPlusWebServer* server, int fd, const HttpRequest* req,
+                            BPlusSnapshot* snapshot) {
+    BPlusJsonWriter writer;
+    bplus_json_writer_init_snapshot(&writer, snapshot, &server->dump_limits);
+    bool ok = http_stream_json(fd, &writer, req->keep_alive);
+    bplus_snapshot_release(snapshot);
+    return ok;
+}
+
+static bool handle_tree(BPlusWebServer* server, int fd, const HttpRequest* req) {
+    return stream_snapshot(server, fd, req, web_read(server));
+}
+
+// A response whose size is not known in advance
+typedef struct {
+    char* data;
+    size_t len;
+    size_t capacity;
+} Buffer;
+
+static void buffer_printf(Buffer* buffer, const char* format, ...) {
+    for (;;) {
+        size_t room = buffer->capacity - buffer->len;
+        va_list args;
+        va_start(args, format);
+        int len = vsnprintf(buffer->data + buffer->len, room, format, args);
+        va_end(args);
+        if ((size_t)len < room) {
+            buffer->len += (size_t)len;
+            return;
+        }
+        buffer->capacity = (buffer->capacity + (size_t)len) * 2;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+    }
+}
+
+typedef struct {
+    uint64_t since;
+    bool has_since;
+    const bool* changed;         // writes only
+    size_t max_nodes;
+    Buffer out;
+} DeltaRequest;
+
+static void append_node(Buffer* out, const BPlusTree* tree, const BPlusNode* node, bool first) {
+    buffer_printf(out, "%s{\"id\":%u,\"leaf\":%s,\"keys\":[", first ? "" : ",",
+                  bplus_tree_node_id(tree, node), node->is_leaf ? "true" : "false");
+    for (int i = 0; i < node->num_keys; i++) {
+        buffer_printf(out, "%s%d", i ? "," : "", node->keys[i]);
+    }
+    buffer_printf(out, "]");
+    if (!node->is_leaf) {
+        buffer_printf(out, ",\"children\":[");
+        for (int i = 0; i <= node->num_keys; i++) {
+            buffer_printf(out, "%s%u", i ? "," : "", bplus_tree_node_id(tree, node->children[i]));
+        }
+        buffer_printf(out, "]");
+    }
+    buffer_printf(out, "}");
+}
+
+// Every node, root first and level by level; false if max_nodes cut it short
+static bool append_tree(DeltaRequest* request, const BPlusTree* tree) {
+    size_t capacity = 64, head = 0, tail = 0;
+    const BPlusNode** queue = malloc(capacity * sizeof(*queue));
+    queue[tail++] = tree->root;
+    while (head < tail) {
+        if (request->max_nodes && head == request->max_nodes) break;
+        const BPlusNode* node = queue[head];
+        append_node(&request->out, tree, node, head == 0);
+        head++;
+        if (node->is_leaf) continue;
+        if (tail + (size_t)node->num_keys + 1 > capacity) {
+            capacity = (tail + (size_t)node->num_keys + 1) * 2;
+            queue = realloc(queue, capacity * sizeof(*queue));
+        }
+        for (int i = 0; i <= node->num_keys; i++) queue[tail++] = node->children[i];
+    }
+    bool complete = head == tail;
+    free(queue);
+    return complete;
+}
+
+static int compare_ids(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Lists the changes after request->since and the nodes they name
+static void append_changes(DeltaRequest* request, const BPlusTree* tree, uint64_t version) {
+    Buffer* out = &request->out;
+    size_t count = (size_t)(version - request->since);
+    uint32_t* ids = malloc((count ? count : 1) * sizeof(*ids));
+    for (size_t i = 0; i < count; i++) {
+        BPlusChange change;
+        bplus_tree_journal_get(tree, request->since + 1 + i, &change);
+        buffer_printf(out, "%s{\"version\":%llu,\"node\":%u,\"kind\":\"%s\"}", i ? "," : "",
+                      (unsigned long long)change.version, change.node,
+                      bplus_change_kind_name(change.kind));
+        ids[i] = change.node;
+    }
+
+    qsort(ids, count, sizeof(*ids), compare_ids);
+    size_t unique = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (unique == 0 || ids[unique - 1] != ids[i]) ids[unique++] = ids[i];
+    }
+    buffer_printf(out, "],\"nodes\":[");
+    bool first = true;
+    for (size_t i = 0; i < unique; i++) {
+        const BPlusNode* node = bplus_tree_node_by_id(tree, ids[i]);
+        if (!node) continue;
+        append_node(out, tree, node, first);
+        first = false;
+    }
+    buffer_printf(out, "],\"removed\":[");
+    first = true;
+    for (size_t i = 0; i < unique; i++) {
+        if (bplus_tree_node_by_id(tree, ids[i])) continue;
+        buffer_printf(out, "%s%u", first ? "" : ",", ids[i]);
+        first = false;
+    }
+    free(ids);
+}
+
+// Runs with the tree to itself, so the journal and the nodes agree
+static void report_changes(BPlusTree* tree, void* ctx) {
+    DeltaRequest* request = ctx;
+    Buffer* out = &request->out;
+    uint64_t version = bplus_tree_journal_version(tree);
+    bool reset = !request->has_since || request->since > version ||
+                 request->since + 1 < bplus_tree_journal_oldest(tree);
+
+    buffer_printf(out, "{");
+    if (request->changed) buffer_printf(out, "\"changed\":%s,", *request->changed ? "true" : "false");
+    buffer_printf(out, "\"version\":%llu,\"root\":%u,\"reset\":%s,\"changes\":[",
+                  (unsigned long long)version, bplus_tree_node_id(tree, tree->root),
+                  reset ? "true" : "false");
+    bool truncated = false;
+    if (reset) {
+        buffer_printf(out, "],\"nodes\":[");
+        truncated = !append_tree(request, tree);
+        buffer_printf(out, "],\"removed\":[");
+    } else {
+        append_changes(request, tree, version);
+    }
+    buffer_printf(out, "],\"truncated\":%s}", truncated ? "true" : "false");
+}
+
+static void delta_init(DeltaRequest* request, BPlusWebServer* server, const HttpRequest* req) {
+    request->has_since = http_param_u64(req, "since", &request->since);
+    request->changed = NULL;
+    request->max_nodes = server->dump_limits.max_nodes;
+    request->out.capacity = 4096;
+    request->out.len = 0;
+    request->out.data = malloc(request->out.capacity);
+}
+
+static bool delta_respond(int fd, const HttpRequest* req, DeltaRequest* request) {
+    bool ok = http_respond(fd, 200, JSON_TYPE, request->out.data, request->out.len, req->keep_alive);
+    free(request->out.data);
+    return ok;
+}
+
+static bool handle_changes(BPlusWebServer* server, int fd, const HttpRequest* req) {
+    DeltaRequest request;
+    delta_init(&request, server, req);
+    web_inspect(server, report_changes, &request);
+    return delta_respond(fd, req, &request);
+}
+
+// Answers with the changes since the client's version, which normally
+// come down to the write's own
+static bool handle_write(BPlusWebServer* server, int fd, const HttpRequest* req, WebWrite write) {
+    int value;
+    if (!http_param(req, "value", &value)) return http_error(fd, 400, req->keep_alive);
+    DeltaRequest request;
+    bool changed;
+    delta_init(&request, server, req);
+    request.changed = &changed;
+    web_write(server, write, value, &changed, report_changes, &request);
+    return delta_respond(fd, req, &request);
+}
+
+static bool handle_insert(BPlusWebServer* server, int fd, const HttpRequest* req) {
+    return handle_write(server, fd, req, bplus_tree_insert);
+}
+
+static bool handle_delete(BPlusWebServer* server, int fd, const HttpRequest* req) {
+    return handle_write(server, fd, req, bplus_tree_delete);
+}
+
+static bool handle_file(BPlusWebServer* server, int fd, const HttpRequest* req) {
+    if (strcmp(req->method, "GET") != 0) return http_error(fd, 405, req->keep_alive);
+    if (!server->document_root || strstr(req->path, "..")) return http_error(fd, 404, req->keep_alive);
+
+    char path[4096];
+    const char* name = strcmp(req->path, "/") == 0 ? "/index.html" : req->path;
+    snprintf(path, sizeof(path), "%s%s", server->document_root, name);
+    return http_send_file(fd, path, req->keep_alive);
+}
+
+typedef struct {
+    const char* path;
+    const char* method;
+    bool (*handle)(BPlusWebServer* server, int fd, const HttpRequest* req);
+} Route;
+
+static const Route routes[] = {
+    { "/api/search", "GET", handle_search },
+    { "/api/range", "GET", handle_range },
+    { "/api/tree", "GET", handle_tree },
+    { "/api/changes", "GET", handle_changes },
+    { "/api/insert", "POST", handle_insert },
+    { "/api/delete", "POST", handle_delete },
+};
+
+bool handle_request(BPlusWebServer* server, int fd, const HttpRequest* req) {
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); i++) {
+        if (strcmp(req->path, routes[i].path) != 0) continue;
+        if (strcmp(req->method, routes[i].method) != 0) return http_error(fd, 405, req->keep_alive);
+        return routes[i].handle(server, fd, req);
+    }
+    if (strncmp(req->path, "/api/", 5) == 0) return http_error(fd, 404, req->keep_alive);
+    return handle_file(server, fd, req);
+}
@@ -0,0 +1,91 @@
+// src/web/internal.h
+// Pieces of the web server shared between its translation units.
+#ifndef BPLUS_WEB_INTERNAL_H
+#define BPLUS_WEB_INTERNAL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "bplus/json.h"
+#include "bplus/snapshot.h"
+#include "bplus/web.h"
+
+// Longest request, from the request line to the end of the body
+#define REQUEST_MAX 8192
+#define PARAMS_MAX 1024
+
+typedef struct {
+    char method[8];
+    char path[256];
+    char query[PARAMS_MAX];      // after the '?', if any
+    char form[PARAMS_MAX];       // a form-encoded body
+    bool keep_alive;
+} HttpRequest;
+
+struct Connection;
+
+struct BPlusWebServer {
+    BPlusTree* tree;
+    bool owns_tree;
+    bool owns_journal;
+    BPlusJsonLimits dump_limits;
+    char* document_root;
+
+    // Writers hold write_lock, and so does anything reading the journal;
+    // publish_lock only covers swapping and retaining `current`, the
+    // snapshot the other readers use
+    pthread_mutex_t write_lock;
+    pthread_mutex_t publish_lock;
+    BPlusSnapshot* current;
+
+    int listen_fd;
+    int epoll_fd;
+    int port;
+    int stopping;
+    pthread_t dispatcher;
+    pthread_t* workers;
+    int worker_count;
+
+    // Connections with a request to read, in arrival order, and all open
+    // ones; both under queue_lock
+    pthread_mutex_t queue_lock;
+    pthread_cond_t queue_ready;
+    struct Connection** queue;
+    size_t queue_head;
+    size_t queue_count;
+    struct Connection* connections;
+    size_t connection_count;
+};
+
+// api.c: HTTP/1.1 over blocking sockets
+// Parses the request at the front of buf; returns its length, 0 if it is
+// incomplete, or -1 if it is malformed
+int http_parse(const char* buf, size_t len, HttpRequest* req);
+// A number parameter from the query string or else the form body
+bool http_param(const HttpRequest* req, const char* name, int* value);
+bool http_param_u64(const HttpRequest* req, const char* name, uint64_t* value);
+// Each returns false if the connection failed
+bool http_send(int fd, const void* data, size_t len);
+bool http_respond(int fd, int status, const char* type, const char* body, size_t len, bool keep_alive);
+bool http_error(int fd, int status, bool keep_alive);
+bool http_stream_json(int fd, BPlusJsonWriter* writer, bool keep_alive);
+bool http_send_file(int fd, const char* path, bool keep_alive);
+
+// handlers.c: answers one request; false if the connection must be closed
+bool handle_request(BPlusWebServer* server, int fd, const HttpRequest* req);
+
+// server.c: access to the tree
+typedef bool (*WebWrite)(BPlusTree* tree, int key);
+typedef void (*WebReport)(BPlusTree* tree, void* ctx);
+// The latest version of the tree, retained for the caller
+BPlusSnapshot* web_read(BPlusWebServer* server);
+// Applies a write, publishes the result and sets *changed to what the
+// write returned; then calls report, if not NULL, with the tree still to
+// itself
+void web_write(BPlusWebServer* server, WebWrite write, int key, bool* changed,
+               WebReport report, void* ctx);
+// Calls report with the tree to itself, between writes
+void web_inspect(BPlusWebServer* server, WebReport report, void* ctx);
+
+#endif // BPLUS_WEB_INTERNAL_H
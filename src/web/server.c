@@ -1,24 +1,334 @@
-#include <mongoose.h>
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include "bplus/journal.h"
+#include "bplus/snapshot.h"
 #include "bplus/tree.h"
 #include "bplus/web.h"
+#include "internal.h"
 
-static struct mg_serve_http_opts s_http_server_opts;
-static BPlusTree* tree = NULL;
-
-static void handle_insert(struct mg_connection *nc, struct http_message *hm) {
-    char value[32];
-    mg_get_http_var(&hm->body, "value", value, sizeof(value));
-    
-    int val = atoi(value);
-    bool success = bplus_tree_insert(tree, val);
-    
-    char* json = bplus_tree_to_json(tree);
-    
-    mg_printf(nc, "HTTP/1.1 200 OK\r\n"
-              "Content-Type: application/json\r\n"
-              "Connection: close\r\n\r\n"
-              "%s", json);
-    
-    free(json);
+#define MAX_CONNECTIONS 1024
+#define MAX_WORKERS 256
+// How often the accept thread looks for a stop request
+#define POLL_MS 100
+// A client that accepts no data for this long is dropped
+#define SEND_TIMEOUT_S 10
+
+// An open connection and the bytes of requests not yet answered. It is
+// watched by the accept thread until data arrives, then owned by one
+// worker until it has been answered and handed back.
+typedef struct Connection {
+    int fd;
+    size_t len;
+    struct Connection* prev;
+    struct Connection* next;
+    char buf[REQUEST_MAX];
+} Connection;
+
+BPlusSnapshot* web_read(BPlusWebServer* server) {
+    pthread_mutex_lock(&server->publish_lock);
+    BPlusSnapshot* snapshot = bplus_snapshot_retain(server->current);
+    pthread_mutex_unlock(&server->publish_lock);
+    return snapshot;
+}
+
+// Readers keep whichever version they retained; the previous one goes
+// once the last of them lets go. If no snapshot can be taken, readers go
+// on with the previous version until a later write publishes one.
+void web_write(BPlusWebServer* server, WebWrite write, int key, bool* changed,
+               WebReport report, void* ctx) {
+    pthread_mutex_lock(&server->write_lock);
+    *changed = write(server->tree, key);
+    if (*changed) {
+        BPlusSnapshot* next = bplus_tree_snapshot(server->tree);
+        if (next) {
+            pthread_mutex_lock(&server->publish_lock);
+            BPlusSnapshot* previous = server->current;
+            server->current = next;
+            pthread_mutex_unlock(&server->publish_lock);
+            bplus_snapshot_release(previous);
+        }
+    }
+    if (report) report(server->tree, ctx);
+    pthread_mutex_unlock(&server->write_lock);
+}
+
+void web_inspect(BPlusWebServer* server, WebReport report, void* ctx) {
+    pthread_mutex_lock(&server->write_lock);
+    report(server->tree, ctx);
+    pthread_mutex_unlock(&server->write_lock);
+}
+
+static void close_connection(BPlusWebServer* server, Connection* conn) {
+    pthread_mutex_lock(&server->queue_lock);
+    if (conn->prev) conn->prev->next = conn->next;
+    else server->connections = conn->next;
+    if (conn->next) conn->next->prev = conn->prev;
+    server->connection_count--;
+    pthread_mutex_unlock(&server->queue_lock);
+    close(conn->fd);
+    free(conn);
+}
+
+// Hands the connection back to the accept thread to wait for its next
+// request; after this another worker may own it. Doing so under the queue
+// lock, which the accept thread takes to queue it, orders this worker's
+// use of the connection before the next one's without relying on epoll.
+static void rearm(BPlusWebServer* server, Connection* conn) {
+    struct epoll_event event = { .events = EPOLLIN | EPOLLONESHOT, .data.ptr = conn };
+    pthread_mutex_lock(&server->queue_lock);
+    int failed = epoll_ctl(server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+    pthread_mutex_unlock(&server->queue_lock);
+    if (failed) close_connection(server, conn);
+}
+
+// Answers every complete request that has arrived; false once the
+// connection is finished
+static bool serve(BPlusWebServer* server, Connection* conn) {
+    for (;;) {
+        HttpRequest req;
+        int used = http_parse(conn->buf, conn->len, &req);
+        if (used < 0) {
+            http_error(conn->fd, conn->len >= REQUEST_MAX ? 413 : 400, false);
+            return false;
+        }
+        if (used > 0) {
+            bool open = handle_request(server, conn->fd, &req) && req.keep_alive;
+            conn->len -= (size_t)used;
+            memmove(conn->buf, conn->buf + used, conn->len);
+            if (!open) return false;
+            continue;
+        }
+
+        ssize_t n = recv(conn->fd, conn->buf + conn->len, sizeof(conn->buf) - conn->len, MSG_DONTWAIT);
+        if (n > 0) {
+            conn->len += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        // Wait for the rest unless the client has gone
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+}
+
+static Connection* next_ready(BPlusWebServer* server) {
+    pthread_mutex_lock(&server->queue_lock);
+    while (server->queue_count == 0 && !__atomic_load_n(&server->stopping, __ATOMIC_ACQUIRE)) {
+        pthread_cond_wait(&server->queue_ready, &server->queue_lock);
+    }
+    Connection* conn = NULL;
+    if (server->queue_count > 0) {
+        conn = server->queue[server->queue_head];
+        server->queue_head = (server->queue_head + 1) % MAX_CONNECTIONS;
+        server->queue_count--;
+    }
+    pthread_mutex_unlock(&server->queue_lock);
+    return conn;
+}
+
+static void* worker_main(void* arg) {
+    BPlusWebServer* server = arg;
+    Connection* conn;
+    while ((conn = next_ready(server))) {
+        if (serve(server, conn)) {
+            rearm(server, conn);
+        } else {
+            close_connection(server, conn);
+        }
+    }
+    return NULL;
+}
+
+static void accept_connections(BPlusWebServer* server) {
+    for (;;) {
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+        // Responses are written whole, so there is nothing for Nagle's
+        // algorithm to gather; it would only hold back the last segment
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        struct timeval timeout = { .tv_sec = SEND_TIMEOUT_S };
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        Connection* conn = malloc(sizeof(Connection));
+        if (!conn) {
+            close(fd);
+            continue;
+        }
+        conn->fd = fd;
+        conn->len = 0;
+        conn->prev = NULL;
+        pthread_mutex_lock(&server->queue_lock);
+        bool full = server->connection_count == MAX_CONNECTIONS;
+        if (!full) {
+            conn->next = server->connections;
+            if (conn->next) conn->next->prev = conn;
+            server->connections = conn;
+            server->connection_count++;
+        }
+        pthread_mutex_unlock(&server->queue_lock);
+
+        struct epoll_event event = { .events = EPOLLIN | EPOLLONESHOT, .data.ptr = conn };
+        if (full) {
+            http_error(fd, 503, false);
+            close(fd);
+            free(conn);
+        } else if (epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            close_connection(server, conn);
+        }
+    }
+}
+
+// Each connection is queued at most once at a time, since epoll reports
+// it once and then waits for rearm()
+static void* dispatch_main(void* arg) {
+    BPlusWebServer* server = arg;
+    struct epoll_event events[64];
+    while (!__atomic_load_n(&server->stopping, __ATOMIC_ACQUIRE)) {
+        int n = epoll_wait(server->epoll_fd, events, 64, POLL_MS);
+        for (int i = 0; i < n; i++) {
+            Connection* conn = events[i].data.ptr;
+            if (!conn) {
+                accept_connections(server);
+                continue;
+            }
+            pthread_mutex_lock(&server->queue_lock);
+            server->queue[(server->queue_head + server->queue_count) % MAX_CONNECTIONS] = conn;
+            server->queue_count++;
+            pthread_cond_signal(&server->queue_ready);
+            pthread_mutex_unlock(&server->queue_lock);
+        }
+    }
+    return NULL;
+}
+
+static int listen_on(const char* port, int* bound_port) {
+    struct addrinfo hints = { .ai_family = AF_INET, .ai_socktype = SOCK_STREAM, .ai_flags = AI_PASSIVE };
+    struct addrinfo* addr;
+    if (getaddrinfo(NULL, port, &hints, &addr) != 0) return -1;
+
+    int fd = socket(addr->ai_family, addr->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    int one = 1;
+    if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (fd < 0 || bind(fd, addr->ai_addr, addr->ai_addrlen) != 0 || listen(fd, SOMAXCONN) != 0) {
+        if (fd >= 0) close(fd);
+        freeaddrinfo(addr);
+        return -1;
+    }
+    freeaddrinfo(addr);
+
+    struct sockaddr_in bound;
+    socklen_t len = sizeof(bound);
+    getsockname(fd, (struct sockaddr*)&bound, &len);
+    *bound_port = ntohs(bound.sin_port);
+    return fd;
+}
+
+BPlusWebServer* bplus_web_server_start(const BPlusWebOptions* options) {
+    if (!options || !options->port || options->workers < 0 || options->workers > MAX_WORKERS) return NULL;
+
+    BPlusWebServer* server = calloc(1, sizeof(BPlusWebServer));
+    server->tree = options->tree ? options->tree : bplus_tree_create(4);
+    server->owns_tree = !options->tree;
+    server->current = bplus_tree_snapshot(server->tree);
+    // A journal the caller keeps already serves as well
+    server->owns_journal = bplus_tree_journal_start(server->tree, BPLUS_WEB_JOURNAL_CAPACITY);
+    server->listen_fd = listen_on(options->port, &server->port);
+    server->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event = { .events = EPOLLIN, .data.ptr = NULL };
+    if (!server->current || !server->tree->journal || server->listen_fd < 0 || server->epoll_fd < 0 ||
+        epoll_ctl(server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &event) != 0) {
+        if (server->listen_fd >= 0) close(server->listen_fd);
+        if (server->epoll_fd >= 0) close(server->epoll_fd);
+        bplus_snapshot_release(server->current);
+        if (server->owns_journal) bplus_tree_journal_stop(server->tree);
+        if (server->owns_tree) bplus_tree_destroy(server->tree);
+        free(server);
+        return NULL;
+    }
+
+    server->dump_limits = options->dump_limits;
+    server->document_root = options->document_root ? strdup(options->document_root) : NULL;
+    pthread_mutex_init(&server->write_lock, NULL);
+    pthread_mutex_init(&server->publish_lock, NULL);
+    pthread_mutex_init(&server->queue_lock, NULL);
+    pthread_cond_init(&server->queue_ready, NULL);
+    server->queue = malloc(sizeof(Connection*) * MAX_CONNECTIONS);
+
+    server->worker_count = options->workers ? options->workers : BPLUS_WEB_DEFAULT_WORKERS;
+    server->workers = malloc(sizeof(pthread_t) * server->worker_count);
+    for (int i = 0; i < server->worker_count; i++) {
+        pthread_create(&server->workers[i], NULL, worker_main, server);
+    }
+    pthread_create(&server->dispatcher, NULL, dispatch_main, server);
+    return server;
+}
+
+int bplus_web_server_port(const BPlusWebServer* server) {
+    return server ? server->port : -1;
+}
+
+void bplus_web_server_stop(BPlusWebServer* server) {
+    if (!server) return;
+
+    __atomic_store_n(&server->stopping, 1, __ATOMIC_RELEASE);
+    pthread_join(server->dispatcher, NULL);
+
+    // Workers finish the request in hand; shutting the sockets down cuts
+    // short any that is waiting on a client
+    pthread_mutex_lock(&server->queue_lock);
+    for (Connection* conn = server->connections; conn; conn = conn->next) {
+        shutdown(conn->fd, SHUT_RDWR);
+    }
+    pthread_cond_broadcast(&server->queue_ready);
+    pthread_mutex_unlock(&server->queue_lock);
+    for (int i = 0; i < server->worker_count; i++) {
+        pthread_join(server->workers[i], NULL);
+    }
+
+    while (server->connections) {
+        close_connection(server, server->connections);
+    }
+    close(server->epoll_fd);
+    close(server->listen_fd);
+    bplus_snapshot_release(server->current);
+    if (server->owns_journal) bplus_tree_journal_stop(server->tree);
+    if (server->owns_tree) bplus_tree_destroy(server->tree);
+
+    pthread_mutex_destroy(&server->write_lock);
+    pthread_mutex_destroy(&server->publish_lock);
+    pthread_mutex_destroy(&server->queue_lock);
+    pthread_cond_destroy(&server->queue_ready);
+    free(server->queue);
+    free(server->workers);
+    free(server->document_root);
+    free(server);
+}
+
+void start_web_server(const char* port) {
+    BPlusWebOptions options = {
+        .port = port,
+        .document_root = "web/static",
+        .dump_limits = { .max_depth = 16, .max_nodes = 20000 },
+    };
+    BPlusWebServer* server = bplus_web_server_start(&options);
+    if (!server) {
+        fprintf(stderr, "Failed to listen on port %s\n", port);
+        return;
+    }
+    printf("Serving on port %d\n", bplus_web_server_port(server));
+    for (;;) {
+        pause();
+    }
 }
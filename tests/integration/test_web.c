@@ -0,0 +1,571 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include "bplus/tree.h"
+#include "bplus/web.h"
+
+#define WEB_ROOT "test_web_root"
+#define WRITERS 4
+#define WRITER_KEYS 500
+#define LOAD_CLIENTS 4
+#define LOAD_READERS 8
+#define LOAD_CLIENTS_MAX 8
+#define LOAD_KEYS 1000000
+// Slow readers' dumps, well beyond what the sockets buffer, and how long
+// the readers leave each one waiting
+#define LOAD_DUMP_NODES 3000
+#define LOAD_DUMP_BYTES 96000
+#define LOAD_STALL_US 40000
+// Fewest requests a rate is taken over, where the clients get that far
+#define LOAD_MIN_REQUESTS 40
+
+// A keep-alive connection to the server under test
+typedef struct {
+    int fd;
+    char buf[65536];
+    size_t start;
+    size_t len;
+} Client;
+
+typedef struct {
+    int status;
+    char* body;
+    size_t len;
+    bool chunked;
+} Response;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void client_open(Client* client, int port, int receive_buffer) {
+    client->fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(client->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    // A small receive buffer stands for a slow link. Small segments go with
+    // it; loopback's 64 KB ones would let the server's send buffer grow to
+    // megabytes and hide how slowly the client reads.
+    if (receive_buffer) {
+        int segment = 536;
+        setsockopt(client->fd, SOL_SOCKET, SO_RCVBUF, &receive_buffer, sizeof(receive_buffer));
+        setsockopt(client->fd, IPPROTO_TCP, TCP_MAXSEG, &segment, sizeof(segment));
+    }
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(port) };
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    int connected = connect(client->fd, (struct sockaddr*)&addr, sizeof(addr));
+    assert(connected == 0);
+    client->start = client->len = 0;
+}
+
+static bool fill(Client* client) {
+    if (client->start > 0) {
+        memmove(client->buf, client->buf + client->start, client->len);
+        client->start = 0;
+    }
+    ssize_t n = recv(client->fd, client->buf + client->len, sizeof(client->buf) - client->len, 0);
+    if (n <= 0) return false;
+    client->len += (size_t)n;
+    return true;
+}
+
+// One CRLF-terminated line, without the CRLF
+static bool read_line(Client* client, char* line, size_t cap) {
+    for (;;) {
+        char* data = client->buf + client->start;
+        size_t n = 0;
+        while (n + 1 < client->len && !(data[n] == '\r' && data[n + 1] == '\n')) {
+            n++;
+        }
+        if (n + 1 < client->len) {
+            assert(n < cap);
+            memcpy(line, data, n);
+            line[n] = '\0';
+            client->start += n + 2;
+            client->len -= n + 2;
+            return true;
+        }
+        if (!fill(client)) return false;
+    }
+}
+
+static bool read_bytes(Client* client, char* out, size_t n) {
+    while (client->len < n) {
+        if (!fill(client)) return false;
+    }
+    memcpy(out, client->buf + client->start, n);
+    client->start += n;
+    client->len -= n;
+    return true;
+}
+
+static bool read_response(Client* client, Response* response) {
+    char line[1024];
+    size_t length = 0;
+    memset(response, 0, sizeof(*response));
+    if (!read_line(client, line, sizeof(line))) return false;
+    int matched = sscanf(line, "HTTP/1.1 %d", &response->status);
+    assert(matched == 1);
+    while (read_line(client, line, sizeof(line)) && line[0]) {
+        if (strncmp(line, "Content-Length: ", 16) == 0) length = strtoul(line + 16, NULL, 10);
+        if (strcmp(line, "Transfer-Encoding: chunked") == 0) response->chunked = true;
+    }
+
+    if (!response->chunked) {
+        response->body = malloc(length + 1);
+        response->len = length;
+        if (!read_bytes(client, response->body, length)) return false;
+        response->body[length] = '\0';
+        return true;
+    }
+    size_t capacity = 4096;
+    response->body = malloc(capacity);
+    for (;;) {
+        if (!read_line(client, line, sizeof(line))) return false;
+        size_t n = strtoul(line, NULL, 16);
+        if (response->len + n + 1 > capacity) {
+            capacity = (response->len + n + 1) * 2;
+            response->body = realloc(response->body, capacity);
+        }
+        if (!read_bytes(client, response->body + response->len, n)) return false;
+        response->len += n;
+        if (!read_line(client, line, sizeof(line))) return false;
+        if (n == 0) break;
+    }
+    response->body[response->len] = '\0';
+    return true;
+}
+
+static void send_request(Client* client, const char* method, const char* target, const char* form) {
+    char request[1024];
+    int len = snprintf(request, sizeof(request), "%s %s HTTP/1.1\r\nHost: localhost\r\n"
+                       "Content-Type: application/x-www-form-urlencoded\r\n"
+                       "Content-Length: %zu\r\n\r\n%s",
+                       method, target, form ? strlen(form) : 0, form ? form : "");
+    ssize_t sent = send(client->fd, request, (size_t)len, MSG_NOSIGNAL);
+    assert(sent == len);
+}
+
+// Sends a request and returns the status; the body is left in `response`
+static int call(Client* client, const char* method, const char* target, const char* form,
+                Response* response) {
+    send_request(client, method, target, form);
+    bool received = read_response(client, response);
+    assert(received);
+    return response->status;
+}
+
+static int call_status(Client* client, const char* method, const char* target, const char* form) {
+    Response response;
+    int status = call(client, method, target, form, &response);
+    free(response.body);
+    return status;
+}
+
+static bool search_over_http(Client* client, int key) {
+    char target[64];
+    snprintf(target, sizeof(target), "/api/search?key=%d", key);
+    Response response;
+    int status = call(client, "GET", target, NULL, &response);
+    assert(status == 200);
+    bool found = strstr(response.body, "\"found\":true") != NULL;
+    free(response.body);
+    return found;
+}
+
+// The top-level "version" of a changes document
+static unsigned long long version_of(const char* body) {
+    const char* field = strstr(body, "\"version\":");
+    assert(field);
+    return strtoull(field + strlen("\"version\":"), NULL, 10);
+}
+
+void test_web_endpoints() {
+    printf("Running web endpoint tests...\n");
+
+    mkdir(WEB_ROOT, 0755);
+    FILE* page = fopen(WEB_ROOT "/index.html", "w");
+    fputs("<p>tree</p>", page);
+    fclose(page);
+
+    BPlusWebOptions options = { .port = "0", .workers = 2, .document_root = WEB_ROOT };
+    BPlusWebServer* server = bplus_web_server_start(&options);
+    assert(server);
+    Client* client = malloc(sizeof(Client));
+    client_open(client, bplus_web_server_port(server), 0);
+
+    Response response;
+    char form[64];
+    int status = call(client, "GET", "/api/changes", NULL, &response);
+    assert(status == 200);
+    assert(strstr(response.body, "\"reset\":true") && strstr(response.body, "\"leaf\":true"));
+    unsigned long long version = version_of(response.body);
+    free(response.body);
+    for (int i = 1; i <= 100; i++) {
+        snprintf(form, sizeof(form), "value=%d&since=%llu", i * 2, version);
+        status = call(client, "POST", "/api/insert", form, &response);
+        assert(status == 200);
+        assert(strncmp(response.body, "{\"changed\":true,", 16) == 0);
+        assert(strstr(response.body, "\"reset\":false") && strstr(response.body, "\"kind\":\"keys\""));
+        assert(version_of(response.body) > version);
+        version = version_of(response.body);
+        free(response.body);
+    }
+    snprintf(form, sizeof(form), "value=2&since=%llu", version);
+    status = call(client, "POST", "/api/insert", form, &response);
+    assert(status == 200);
+    assert(strncmp(response.body, "{\"changed\":false,", 17) == 0 && version_of(response.body) == version);
+    free(response.body);
+    snprintf(form, sizeof(form), "/api/changes?since=%llu", version);
+    status = call(client, "GET", form, NULL, &response);
+    assert(status == 200);
+    assert(strstr(response.body, "\"changes\":[],\"nodes\":[],\"removed\":[],"));
+    free(response.body);
+    bool found = search_over_http(client, 100);
+    assert(found);
+    found = search_over_http(client, 101);
+    assert(!found);
+    status = call_status(client, "POST", "/api/delete", "value=100");
+    assert(status == 200);
+    found = search_over_http(client, 100);
+    assert(!found);
+
+    status = call(client, "GET", "/api/range?from=11&to=29", NULL, &response);
+    assert(status == 200);
+    assert(strcmp(response.body, "{\"keys\":[12,14,16,18,20,22,24,26,28],\"count\":9,\"truncated\":false}") == 0);
+    free(response.body);
+    status = call(client, "GET", "/api/range?from=-5&to=300&limit=3", NULL, &response);
+    assert(status == 200);
+    assert(strcmp(response.body, "{\"keys\":[2,4,6],\"count\":3,\"truncated\":true}") == 0);
+    free(response.body);
+
+    // Changes: a merge after deletes, and the whole tree for a version the
+    // server never had
+    for (int i = 1; i <= 30; i++) {
+        snprintf(form, sizeof(form), "value=%d", i * 2);
+        status = call_status(client, "POST", "/api/delete", form);
+        assert(status == 200);
+    }
+    snprintf(form, sizeof(form), "/api/changes?since=%llu", version);
+    status = call(client, "GET", form, NULL, &response);
+    assert(status == 200);
+    assert(strstr(response.body, "\"reset\":false") && strstr(response.body, "\"kind\":\"merged\""));
+    assert(!strstr(response.body, "\"removed\":[]"));
+    free(response.body);
+    status = call(client, "GET", "/api/changes?since=999999999", NULL, &response);
+    assert(status == 200);
+    assert(strstr(response.body, "\"reset\":true") && strstr(response.body, "\"truncated\":false}"));
+    free(response.body);
+    status = call_status(client, "GET", "/api/changes?since=-1", NULL);
+    assert(status == 200);
+
+    status = call(client, "GET", "/api/tree", NULL, &response);
+    assert(status == 200);
+    assert(strncmp(response.body, "{\"order\":4,", 11) == 0);
+    assert(strstr(response.body, "\"truncated\":false}"));
+    free(response.body);
+    status = call(client, "GET", "/", NULL, &response);
+    assert(status == 200);
+    assert(strcmp(response.body, "<p>tree</p>") == 0);
+    free(response.body);
+
+    // Errors leave the connection usable
+    status = call_status(client, "GET", "/api/search", NULL);
+    assert(status == 400);
+    status = call_status(client, "GET", "/api/search?key=12x", NULL);
+    assert(status == 400);
+    status = call_status(client, "GET", "/api/range?from=1&to=2&limit=0", NULL);
+    assert(status == 400);
+    status = call_status(client, "GET", "/api/insert?value=1", NULL);
+    assert(status == 405);
+    status = call_status(client, "GET", "/api/unknown", NULL);
+    assert(status == 404);
+    status = call_status(client, "GET", "/missing.html", NULL);
+    assert(status == 404);
+    status = call_status(client, "GET", "/../CMakeLists.txt", NULL);
+    assert(status == 404);
+
+    // Two requests in one segment get two responses in order
+    const char* pipelined = "GET /api/search?key=62 HTTP/1.1\r\n\r\n"
+                            "GET /api/search?key=63 HTTP/1.1\r\n\r\n";
+    ssize_t sent = send(client->fd, pipelined, strlen(pipelined), 0);
+    assert(sent == (ssize_t)strlen(pipelined));
+    bool received = read_response(client, &response);
+    assert(received && strstr(response.body, "\"found\":true"));
+    free(response.body);
+    received = read_response(client, &response);
+    assert(received && strstr(response.body, "\"found\":false"));
+    free(response.body);
+
+    // A malformed request is answered and the connection closed
+    const char* garbage = "NONSENSE\r\n\r\n";
+    sent = send(client->fd, garbage, strlen(garbage), 0);
+    assert(sent == (ssize_t)strlen(garbage));
+    received = read_response(client, &response);
+    assert(received && response.status == 400);
+    free(response.body);
+    bool filled = fill(client);
+    assert(!filled);
+    close(client->fd);
+    free(client);
+
+    bplus_web_server_stop(server);
+    remove(WEB_ROOT "/index.html");
+    rmdir(WEB_ROOT);
+
+    printf("Web endpoint tests passed!\n");
+}
+
+typedef struct {
+    int port;
+    int id;
+} WebWriter;
+
+static void* web_writer(void* arg) {
+    WebWriter* w = arg;
+    Client* client = malloc(sizeof(Client));
+    client_open(client, w->port, 0);
+    char form[32];
+    for (int i = 0; i < WRITER_KEYS; i++) {
+        snprintf(form, sizeof(form), "value=%d", i * WRITERS + w->id);
+        int status = call_status(client, "POST", "/api/insert", form);
+        assert(status == 200);
+        // Our own writes are visible to our next read
+        bool found = search_over_http(client, i * WRITERS + w->id);
+        assert(found);
+    }
+    close(client->fd);
+    free(client);
+    return NULL;
+}
+
+// Writes from many connections are applied one at a time
+void test_web_concurrent_writes() {
+    printf("Running concurrent web write tests...\n");
+
+    BPlusTree* tree = bplus_tree_create(8);
+    BPlusWebOptions options = { .port = "0", .workers = 4, .tree = tree,
+                                .dump_limits = { .max_nodes = 64 } };
+    BPlusWebServer* server = bplus_web_server_start(&options);
+    assert(server);
+
+    pthread_t threads[WRITERS];
+    WebWriter writers[WRITERS];
+    for (int t = 0; t < WRITERS; t++) {
+        writers[t] = (WebWriter){ bplus_web_server_port(server), t };
+        pthread_create(&threads[t], NULL, web_writer, &writers[t]);
+    }
+    for (int t = 0; t < WRITERS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    bplus_web_server_stop(server);
+
+    assert(bplus_tree_validate(tree));
+    for (int k = 0; k < WRITERS * WRITER_KEYS; k++) {
+        assert(bplus_tree_search(tree, k));
+    }
+    bplus_tree_destroy(tree);
+
+    // Trees without snapshots cannot be served
+    BPlusTreeOptions packed = { .order = 8, .flags = BPLUS_TREE_PACKED_LEAVES };
+    tree = bplus_tree_create_with_options(&packed);
+    options = (BPlusWebOptions){ .port = "0", .tree = tree };
+    BPlusWebServer* started = bplus_web_server_start(&options);
+    assert(!started);
+    bplus_tree_destroy(tree);
+
+    printf("Concurrent web write tests passed!\n");
+}
+
+typedef struct {
+    int port;
+    int id;
+    int* stop;
+    int* dumping;
+    size_t requests;
+} LoadClient;
+
+// Keeps a whole-tree dump open, reading it a trickle at a time
+static void* slow_dump(void* arg) {
+    LoadClient* c = arg;
+    Client* client = malloc(sizeof(Client));
+    client_open(client, c->port, 4096);
+    send_request(client, "GET", "/api/tree", NULL);
+    while (!__atomic_load_n(c->stop, __ATOMIC_ACQUIRE)) {
+        char buf[1024];
+        if (recv(client->fd, buf, sizeof(buf), 0) <= 0) break;
+        __atomic_store_n(c->dumping, 1, __ATOMIC_RELEASE);
+        usleep(10000);
+    }
+    close(client->fd);
+    free(client);
+    return NULL;
+}
+
+static void* fast_client(void* arg) {
+    LoadClient* c = arg;
+    Client* client = malloc(sizeof(Client));
+    client_open(client, c->port, 0);
+    unsigned seed = (unsigned)c->id * 2654435761u + 1;
+    char target[96];
+    while (!__atomic_load_n(c->stop, __ATOMIC_ACQUIRE)) {
+        seed = seed * 1103515245u + 12345u;
+        int key = (int)(seed % (2u * LOAD_KEYS));
+        if (__atomic_load_n(&c->requests, __ATOMIC_RELAXED) % 10 == 9) {
+            snprintf(target, sizeof(target), "/api/range?from=%d&to=%d&limit=100", key, key + 200);
+        } else {
+            snprintf(target, sizeof(target), "/api/search?key=%d", key);
+        }
+        int status = call_status(client, "GET", target, NULL);
+        assert(status == 200);
+        __atomic_fetch_add(&c->requests, 1, __ATOMIC_RELAXED);
+    }
+    close(client->fd);
+    free(client);
+    return NULL;
+}
+
+// Fetches bounded dumps, each larger than the socket buffers hold, and
+// stops reading for a while once each starts to arrive: the worker
+// answering spends that time blocked on the socket, not on the CPU. Each
+// dump gets a new connection, since the kernel grows the buffers of one
+// that keeps carrying dumps until they hold them whole.
+static void* slow_reader(void* arg) {
+    LoadClient* c = arg;
+    Client* client = malloc(sizeof(Client));
+    while (!__atomic_load_n(c->stop, __ATOMIC_ACQUIRE)) {
+        client_open(client, c->port, 4096);
+        send_request(client, "GET", "/api/tree", NULL);
+        bool started = fill(client);
+        assert(started);
+        usleep(LOAD_STALL_US);
+        Response response;
+        bool received = read_response(client, &response);
+        assert(received && response.status == 200 && response.len > LOAD_DUMP_BYTES);
+        free(response.body);
+        close(client->fd);
+        __atomic_fetch_add(&c->requests, 1, __ATOMIC_RELAXED);
+    }
+    free(client);
+    return NULL;
+}
+
+static size_t requests_of(LoadClient* clients, int count) {
+    size_t requests = 0;
+    for (int t = 0; t < count; t++) {
+        requests += __atomic_load_n(&clients[t].requests, __ATOMIC_RELAXED);
+    }
+    return requests;
+}
+
+// Requests per second the clients complete over `seconds`, after as long
+// again to settle. Clients that are getting answers are given up to eight
+// times that to complete LOAD_MIN_REQUESTS.
+static double rate_of(LoadClient* clients, int count, double seconds) {
+    usleep((useconds_t)(seconds * 1e6));
+    double start = now_seconds();
+    size_t before = requests_of(clients, count);
+    size_t after;
+    do {
+        usleep((useconds_t)(seconds * 1e6));
+        after = requests_of(clients, count);
+    } while (after > before && after - before < LOAD_MIN_REQUESTS &&
+             now_seconds() - start < 8 * seconds);
+    return (double)(after - before) / (now_seconds() - start);
+}
+
+// Runs `count` clients of one kind against a server with `workers`
+// threads, beside a slow whole-tree dump if `with_dump`
+static double measure(BPlusTree* tree, int workers, double seconds, void* (*client)(void*),
+                      int count, bool with_dump) {
+    // Dumps the slow readers can finish, or the whole tree for slow_dump
+    BPlusWebOptions options = { .port = "0", .workers = workers, .tree = tree };
+    if (!with_dump) options.dump_limits.max_nodes = LOAD_DUMP_NODES;
+    BPlusWebServer* server = bplus_web_server_start(&options);
+    assert(server);
+    int port = bplus_web_server_port(server);
+
+    int stop = 0;
+    int dumping = 0;
+    LoadClient dump = { port, 0, &stop, &dumping, 0 };
+    pthread_t dump_thread;
+    if (with_dump) {
+        pthread_create(&dump_thread, NULL, slow_dump, &dump);
+        while (!__atomic_load_n(&dumping, __ATOMIC_ACQUIRE)) {
+            usleep(1000);
+        }
+    }
+
+    LoadClient clients[LOAD_CLIENTS_MAX];
+    pthread_t threads[LOAD_CLIENTS_MAX];
+    for (int t = 0; t < count; t++) {
+        clients[t] = (LoadClient){ port, t + 1, &stop, &dumping, 0 };
+        pthread_create(&threads[t], NULL, client, &clients[t]);
+    }
+    double rate = rate_of(clients, count, seconds);
+
+    // Ending the dump frees its worker for the requests still waiting
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    if (with_dump) pthread_join(dump_thread, NULL);
+    for (int t = 0; t < count; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    bplus_web_server_stop(server);
+    return rate;
+}
+
+void test_web_load(double seconds) {
+    printf("Running web load tests...\n");
+
+    int* keys = malloc(sizeof(int) * LOAD_KEYS);
+    for (int i = 0; i < LOAD_KEYS; i++) {
+        keys[i] = i * 2;
+    }
+    BPlusTree* tree = bplus_tree_bulk_load(4, keys, LOAD_KEYS, 1.0);
+    free(keys);
+
+    // Slow readers keep every worker waiting on a socket, so each worker
+    // up to their number adds throughput even on one CPU. Beside a slow
+    // dump, a single worker is held by the dump and serves no one else;
+    // more workers serve the other clients meanwhile.
+    int workers[] = { 1, 2, 4, 8 };
+    double readers[4], beside_dump[4];
+    printf("workers,slow_readers_rps,beside_slow_dump_rps\n");
+    for (int w = 0; w < 4; w++) {
+        readers[w] = measure(tree, workers[w], seconds, slow_reader, LOAD_READERS, false);
+        beside_dump[w] = measure(tree, workers[w], seconds, fast_client, LOAD_CLIENTS, true);
+        printf("%d,%.0f,%.0f\n", workers[w], readers[w], beside_dump[w]);
+    }
+    for (int w = 1; w < 4; w++) {
+        assert(readers[w] > 1.25 * readers[0]);
+        assert(beside_dump[w] > beside_dump[0]);
+    }
+    bool valid = bplus_tree_validate(tree);
+    assert(valid);
+    bplus_tree_destroy(tree);
+
+    printf("Web load tests passed!\n");
+}
+
+// The optional argument is the length of each load measurement in seconds
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? atof(argv[1]) : 0.25;
+    printf("\n=== Running Web Server Tests ===\n\n");
+
+    test_web_endpoints();
+    test_web_concurrent_writes();
+    test_web_load(seconds);
+
+    printf("\n=== All Web Server Tests Completed Successfully ===\n\n");
+    return 0;
+}
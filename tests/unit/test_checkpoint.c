@@ -0,0 +1,417 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "bplus/checkpoint.h"
+#include "bplus/cursor.h"
+#include "bplus/snapshot.h"
+#include "bplus/tree.h"
+
+#define CHECKPOINT_TEST_FILE "test_checkpoint.img"
+#define CHECKPOINT_KEY_RANGE 4000
+
+static long file_size(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+// Loads the checkpoint and compares it key by key with the expected set
+static void assert_checkpoint_holds(const bool* present, int range) {
+    BPlusTree* loaded = bplus_checkpoint_load(CHECKPOINT_TEST_FILE);
+    assert(loaded && bplus_tree_validate(loaded));
+
+    BPlusCursor cursor;
+    int key;
+    int expected = 0;
+    bplus_cursor_seek(&cursor, loaded, -1);
+    while (bplus_cursor_next(&cursor, &key)) {
+        assert(key >= 0 && key < range && present[key]);
+        expected++;
+    }
+    for (int k = 0; k < range; k++) {
+        expected -= present[k];
+    }
+    assert(expected == 0);
+    bplus_tree_destroy(loaded);
+}
+
+static void set_insert(BPlusTree* tree, bool* present, int key) {
+    if (!present[key]) {
+        bool inserted = bplus_tree_insert(tree, key);
+        assert(inserted);
+        present[key] = true;
+    }
+}
+
+static void set_delete(BPlusTree* tree, bool* present, int key) {
+    bool deleted = bplus_tree_delete(tree, key);
+    assert(deleted == present[key]);
+    present[key] = false;
+}
+
+void test_checkpoint_incremental() {
+    printf("Running incremental checkpoint tests...\n");
+    remove(CHECKPOINT_TEST_FILE);
+
+    BPlusTree* loaded = bplus_checkpoint_load(CHECKPOINT_TEST_FILE);
+    assert(loaded == NULL);
+
+    bool present[CHECKPOINT_KEY_RANGE] = {0};
+    BPlusTree* tree = bplus_tree_create(16);
+    for (int k = 0; k < CHECKPOINT_KEY_RANGE; k += 2) {
+        set_insert(tree, present, k);
+    }
+
+    // The first checkpoint writes every node
+    BPlusCheckpointStats stats;
+    size_t nodes = tree->leaf_pool.in_use + tree->internal_pool.in_use;
+    bool saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 0 && stats.nodes_written == nodes);
+    assert(stats.file_bytes == (uint64_t)file_size(CHECKPOINT_TEST_FILE));
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    // Nothing changed: the delta is just a root record
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 1 && stats.nodes_written == 0);
+
+    // A few scattered changes write a few leaves and no internal node
+    // that did not change
+    set_insert(tree, present, 1);
+    set_insert(tree, present, 2001);
+    set_delete(tree, present, 3998);
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 2 && stats.nodes_written >= 3 && stats.nodes_written <= 8);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    // Splits and merges
+    for (int k = 1; k < 800; k += 2) {
+        set_insert(tree, present, k);
+    }
+    for (int k = 1000; k < 3000; k++) {
+        set_delete(tree, present, k);
+    }
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    // Appends that skip the descent still reach the next delta
+    for (int k = 3000; k < CHECKPOINT_KEY_RANGE; k++) {
+        set_delete(tree, present, k);
+    }
+    for (int k = 3000; k < CHECKPOINT_KEY_RANGE; k++) {
+        set_insert(tree, present, k);
+        if (k % 250 == 0) {
+            saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+            assert(saved);
+            assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+        }
+    }
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    // Random mixed batches, each checkpointed and reloaded
+    srand(7);
+    for (int round = 0; round < 20; round++) {
+        for (int i = 0; i < 300; i++) {
+            int key = rand() % CHECKPOINT_KEY_RANGE;
+            if (rand() % 2) {
+                set_insert(tree, present, key);
+            } else {
+                set_delete(tree, present, key);
+            }
+        }
+        saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+        assert(saved);
+        assert(stats.deltas == 9 + (uint32_t)round);
+        assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+    }
+
+    // Emptying the tree collapses it to a single leaf
+    for (int k = 0; k < CHECKPOINT_KEY_RANGE; k++) {
+        set_delete(tree, present, k);
+    }
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    bplus_tree_destroy(tree);
+    remove(CHECKPOINT_TEST_FILE);
+    printf("Incremental checkpoint tests passed!\n");
+}
+
+void test_checkpoint_reload_and_torn_delta() {
+    printf("Running checkpoint reload tests...\n");
+    remove(CHECKPOINT_TEST_FILE);
+
+    bool present[CHECKPOINT_KEY_RANGE] = {0};
+    BPlusTree* tree = bplus_tree_create(6);
+    for (int k = 0; k < 1000; k++) {
+        set_insert(tree, present, (k * 37) % CHECKPOINT_KEY_RANGE);
+    }
+    bool saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, NULL);
+    assert(saved);
+    bplus_tree_destroy(tree);
+
+    // A loaded tree goes on appending to the same chain
+    BPlusCheckpointStats stats;
+    tree = bplus_checkpoint_load(CHECKPOINT_TEST_FILE);
+    assert(tree && tree->order == 6);
+    set_insert(tree, present, 1);
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 1 && stats.nodes_written < 10);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+    long committed = file_size(CHECKPOINT_TEST_FILE);
+
+    // A delta cut short by a crash is dropped on load
+    set_insert(tree, present, 3);
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, NULL);
+    assert(saved);
+    int truncated = truncate(CHECKPOINT_TEST_FILE, file_size(CHECKPOINT_TEST_FILE) - 3);
+    assert(truncated == 0);
+    bplus_tree_destroy(tree);
+    present[3] = false;
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+    assert(file_size(CHECKPOINT_TEST_FILE) == committed);
+
+    // Garbage after the chain is dropped too, and appends resume cleanly
+    FILE* fp = fopen(CHECKPOINT_TEST_FILE, "ab");
+    fputs("not a record at all", fp);
+    fclose(fp);
+    tree = bplus_checkpoint_load(CHECKPOINT_TEST_FILE);
+    assert(tree && !bplus_tree_search(tree, 3));
+    set_insert(tree, present, 3);
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 2);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    // A fresh tree checkpointed to the same path replaces the chain
+    BPlusTree* other = bplus_tree_create(4);
+    bool other_present[CHECKPOINT_KEY_RANGE] = {0};
+    set_insert(other, other_present, 42);
+    saved = bplus_tree_checkpoint(other, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 0 && stats.nodes_written == 1);
+    assert_checkpoint_holds(other_present, CHECKPOINT_KEY_RANGE);
+
+    // ...after which the first tree can no longer append to it
+    set_insert(tree, present, 5);
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 0);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    bplus_tree_destroy(other);
+    bplus_tree_destroy(tree);
+    remove(CHECKPOINT_TEST_FILE);
+    printf("Checkpoint reload tests passed!\n");
+}
+
+void test_checkpoint_with_snapshots() {
+    printf("Running checkpoint with snapshot tests...\n");
+    remove(CHECKPOINT_TEST_FILE);
+
+    bool present[CHECKPOINT_KEY_RANGE] = {0};
+    BPlusTree* tree = bplus_tree_create(4);
+    for (int k = 0; k < 2000; k++) {
+        set_insert(tree, present, k);
+    }
+    bool saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, NULL);
+    assert(saved);
+
+    // Path copies stand in for the nodes they replace, so only changed
+    // nodes are written
+    BPlusSnapshot* snap = bplus_tree_snapshot(tree);
+    set_delete(tree, present, 10);
+    set_insert(tree, present, 2500);
+    BPlusCheckpointStats stats;
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.nodes_written <= 8);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+    assert(bplus_snapshot_search(snap, 10) && !bplus_snapshot_search(snap, 2500));
+
+    for (int k = 0; k < 2000; k += 3) {
+        set_delete(tree, present, k);
+    }
+    bplus_snapshot_release(snap);
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, NULL);
+    assert(saved);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    bplus_tree_destroy(tree);
+    remove(CHECKPOINT_TEST_FILE);
+    printf("Checkpoint with snapshot tests passed!\n");
+}
+
+// `stop` is shared with the test's thread; `compactions` is read only
+// after the join
+typedef struct {
+    bool stop;
+    int compactions;
+} CompactorArgs;
+
+static void* compactor(void* arg) {
+    CompactorArgs* args = arg;
+    while (!__atomic_load_n(&args->stop, __ATOMIC_ACQUIRE)) {
+        if (bplus_checkpoint_compact(CHECKPOINT_TEST_FILE, NULL)) args->compactions++;
+        usleep(200);
+    }
+    return NULL;
+}
+
+void test_checkpoint_compaction() {
+    printf("Running checkpoint compaction tests...\n");
+    remove(CHECKPOINT_TEST_FILE);
+
+    bool compacted = bplus_checkpoint_compact(CHECKPOINT_TEST_FILE, NULL);
+    assert(!compacted);
+
+    bool present[CHECKPOINT_KEY_RANGE] = {0};
+    BPlusTree* tree = bplus_tree_create(8);
+    for (int k = 0; k < CHECKPOINT_KEY_RANGE; k++) {
+        set_insert(tree, present, k);
+    }
+    bool saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, NULL);
+    assert(saved);
+    long full_size = file_size(CHECKPOINT_TEST_FILE);
+    for (int round = 0; round < 10; round++) {
+        for (int k = round; k < CHECKPOINT_KEY_RANGE; k += 10) {
+            set_delete(tree, present, k);
+        }
+        saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, NULL);
+        assert(saved);
+    }
+    assert(file_size(CHECKPOINT_TEST_FILE) > full_size);
+
+    // The chain folds into one image of the newest tree
+    BPlusCheckpointStats stats;
+    compacted = bplus_checkpoint_compact(CHECKPOINT_TEST_FILE, &stats);
+    assert(compacted);
+    assert(stats.deltas == 0);
+    assert(stats.nodes_written == tree->leaf_pool.in_use + tree->internal_pool.in_use);
+    assert(stats.file_bytes == (uint64_t)file_size(CHECKPOINT_TEST_FILE));
+    assert(stats.file_bytes < (uint64_t)full_size);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    // The tree keeps appending deltas to the compacted image
+    for (int k = 0; k < 100; k++) {
+        set_insert(tree, present, k * 7);
+    }
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 1);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    // Compaction in the background while the tree changes and checkpoints
+    CompactorArgs args = { false, 0 };
+    pthread_t thread;
+    pthread_create(&thread, NULL, compactor, &args);
+    srand(11);
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 100; i++) {
+            int key = rand() % CHECKPOINT_KEY_RANGE;
+            if (rand() % 2) {
+                set_insert(tree, present, key);
+            } else {
+                set_delete(tree, present, key);
+            }
+        }
+        saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, NULL);
+        assert(saved);
+        usleep(100);
+    }
+    __atomic_store_n(&args.stop, true, __ATOMIC_RELEASE);
+    pthread_join(thread, NULL);
+    assert(args.compactions > 0);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+
+    bplus_tree_destroy(tree);
+    remove(CHECKPOINT_TEST_FILE);
+    printf("Checkpoint compaction tests passed!\n");
+}
+
+// Trees sized in bytes keep both orders; files from before leaf orders
+// were recorded still load
+void test_checkpoint_node_sizes() {
+    printf("Running checkpoint node size tests...\n");
+    remove(CHECKPOINT_TEST_FILE);
+
+    bool present[CHECKPOINT_KEY_RANGE] = {0};
+    BPlusTreeOptions options = { .node_bytes = 256 };
+    BPlusTree* tree = bplus_tree_create_with_options(&options);
+    for (int k = 0; k < 3000; k++) {
+        set_insert(tree, present, (k * 37) % CHECKPOINT_KEY_RANGE);
+    }
+    bool saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, NULL);
+    assert(saved);
+    BPlusCheckpointStats stats;
+    set_insert(tree, present, 1);
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 1);
+    assert_checkpoint_holds(present, CHECKPOINT_KEY_RANGE);
+    BPlusTree* loaded = bplus_checkpoint_load(CHECKPOINT_TEST_FILE);
+    assert(loaded->order == tree->order && loaded->leaf_order == tree->leaf_order);
+    assert(loaded->leaf_order > loaded->order);
+    bplus_tree_destroy(loaded);
+    bplus_tree_destroy(tree);
+
+    // A format 1 file: the same records behind the header without the
+    // leaf order
+    tree = bplus_tree_create(6);
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, NULL);
+    assert(saved);
+    bplus_tree_destroy(tree);
+    long size = file_size(CHECKPOINT_TEST_FILE);
+    unsigned char* data = malloc((size_t)size);
+    FILE* fp = fopen(CHECKPOINT_TEST_FILE, "rb");
+    size_t fetched = fread(data, 1, (size_t)size, fp);
+    assert(fetched == (size_t)size);
+    fclose(fp);
+    uint32_t format = 1;
+    memcpy(data + 8, &format, sizeof(format));
+    fp = fopen(CHECKPOINT_TEST_FILE, "wb");
+    fwrite(data, 1, 24, fp);
+    fwrite(data + 32, 1, (size_t)size - 32, fp);
+    fclose(fp);
+    free(data);
+
+    tree = bplus_checkpoint_load(CHECKPOINT_TEST_FILE);
+    assert(tree && tree->order == 6 && tree->leaf_order == 6);
+    assert(bplus_tree_validate(tree));
+    // Appending needs the current format, so the next checkpoint is a full image
+    bplus_tree_insert(tree, 7);
+    saved = bplus_tree_checkpoint(tree, CHECKPOINT_TEST_FILE, &stats);
+    assert(saved);
+    assert(stats.deltas == 0);
+    bplus_tree_destroy(tree);
+    tree = bplus_checkpoint_load(CHECKPOINT_TEST_FILE);
+    assert(tree && bplus_tree_search(tree, 7));
+    bplus_tree_destroy(tree);
+
+    remove(CHECKPOINT_TEST_FILE);
+    printf("Checkpoint node size tests passed!\n");
+}
+
+void test_checkpoint_suite() {
+    printf("Starting checkpoint tests...\n\n");
+
+    test_checkpoint_incremental();
+    test_checkpoint_reload_and_torn_delta();
+    test_checkpoint_with_snapshots();
+    test_checkpoint_compaction();
+    test_checkpoint_node_sizes();
+
+    printf("All checkpoint tests passed!\n");
+}
@@ -2,8 +2,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <unistd.h>
 #include "bplus/cli.h"
 #include "bplus/tree.h"
+#include "bplus/checkpoint.h"
+#include "bplus/stats.h"
+#include "bplus/wal.h"
 
 // Mock functions to simulate user input
 void simulate_command(const char* command) {
@@ -23,6 +27,27 @@ void simulate_command(const char* command) {
     free(cmd_copy);
 }
 
+// Runs a command and returns what it printed, which the caller frees
+static char* capture_cli(int argc, char* argv[]) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    FILE* out = tmpfile();
+    assert(saved >= 0 && out != NULL);
+    dup2(fileno(out), STDOUT_FILENO);
+    run_cli(argc, argv);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    
+    long size = ftell(out);
+    char* text = calloc((size_t)size + 1, 1);
+    rewind(out);
+    size_t got = fread(text, 1, (size_t)size, out);
+    assert(got == (size_t)size);
+    fclose(out);
+    return text;
+}
+
 void test_cli_basic_commands() {
     printf("Running CLI basic commands tests...\n");
     
@@ -71,15 +96,122 @@ void test_cli_order_parameter() {
     char* argv2[] = {"b-plus-tree", "order", "3", "insert", "20"};
     run_cli(5, argv2);
     
+    // Node sizes and the automatic size in place of an order
+    char* argv3[] = {"b-plus-tree", "order", "4K", "insert", "30"};
+    run_cli(5, argv3);
+    char* argv4[] = {"b-plus-tree", "order", "auto", "display"};
+    run_cli(4, argv4);
+    char* argv5[] = {"b-plus-tree", "order", "12X", "display"};
+    run_cli(4, argv5);
+    char* argv6[] = {"b-plus-tree", "order", "3", "display"};
+    run_cli(4, argv6);
+    
     printf("CLI order parameter tests passed!\n");
 }
 
+void test_cli_load_command() {
+    printf("Running CLI load command tests...\n");
+    
+    FILE* fp = fopen("test_load.txt", "w");
+    assert(fp != NULL);
+    for (int i = 100; i > 0; i--) {
+        fprintf(fp, "%d\n", i % 50);
+    }
+    fclose(fp);
+    
+    remove("test_load.db");
+    remove("test_load.db.wal");
+    
+    // Every value appears twice; the duplicates are dropped
+    char* load[] = {"b-plus-tree", "load", "test_load.txt"};
+    char* output = capture_cli(3, load);
+    assert(strstr(output, "Loaded 50 keys from test_load.txt") != NULL);
+    free(output);
+    
+    // With a database the loaded tree is checkpointed, so its contents
+    // outlive the run
+    char* load_db[] = {"b-plus-tree", "db", "test_load.db", "load", "test_load.txt"};
+    output = capture_cli(5, load_db);
+    assert(strstr(output, "Loaded 50 keys") != NULL);
+    free(output);
+    BPlusTree* tree = bplus_checkpoint_load("test_load.db");
+    assert(tree != NULL && bplus_tree_validate(tree));
+    BPlusTreeStats stats;
+    bool collected = bplus_tree_stats(tree, &stats);
+    assert(collected && stats.keys == 50);
+    for (int i = -1; i <= 50; i++) {
+        assert(bplus_tree_search(tree, i) == (i >= 0 && i < 50));
+    }
+    bplus_tree_destroy(tree);
+    
+    // A missing file is reported and leaves the database as it was
+    char* load_missing[] = {"b-plus-tree", "db", "test_load.db", "load", "missing_file.txt"};
+    output = capture_cli(5, load_missing);
+    assert(strstr(output, "Failed to open missing_file.txt") != NULL);
+    assert(strstr(output, "Loaded") == NULL);
+    free(output);
+    tree = bplus_checkpoint_load("test_load.db");
+    collected = tree && bplus_tree_stats(tree, &stats);
+    assert(collected && stats.keys == 50);
+    bplus_tree_destroy(tree);
+    
+    remove("test_load.txt");
+    remove("test_load.db");
+    remove("test_load.db.wal");
+    
+    printf("CLI load command tests passed!\n");
+}
+
+void test_cli_database() {
+    printf("Running CLI database tests...\n");
+    remove("test_cli.db");
+    remove("test_cli.db.wal");
+    
+    // Each run starts from the checkpoint plus the log of earlier runs
+    char* insert_a[] = {"b-plus-tree", "db", "test_cli.db", "insert", "5"};
+    char* insert_b[] = {"b-plus-tree", "db", "test_cli.db", "insert", "7"};
+    char* remove_a[] = {"b-plus-tree", "db", "test_cli.db", "delete", "5"};
+    char* checkpoint[] = {"b-plus-tree", "db", "test_cli.db", "checkpoint"};
+    run_cli(5, insert_a);
+    run_cli(5, insert_b);
+    run_cli(5, remove_a);
+    run_cli(5, remove_a);
+    
+    // The failed second delete is not logged
+    BPlusTree* tree = bplus_tree_create(4);
+    BPlusWal* wal = bplus_wal_open("test_cli.db.wal", NULL);
+    assert(wal && wal->next_lsn == 4);
+    bool recovered = bplus_wal_recover(wal, tree);
+    assert(recovered);
+    assert(bplus_tree_search(tree, 7) && !bplus_tree_search(tree, 5));
+    bplus_wal_close(wal);
+    bplus_tree_destroy(tree);
+    
+    run_cli(4, checkpoint);
+    wal = bplus_wal_open("test_cli.db.wal", NULL);
+    uint64_t replayed;
+    bool replayed_all = bplus_wal_replay(wal, NULL, NULL, &replayed);
+    assert(replayed_all && replayed == 0);
+    bplus_wal_close(wal);
+    
+    tree = bplus_checkpoint_load("test_cli.db");
+    assert(tree != NULL);
+    assert(bplus_tree_search(tree, 7) && !bplus_tree_search(tree, 5));
+    bplus_tree_destroy(tree);
+    
+    remove("test_cli.db");
+    remove("test_cli.db.wal");
+    printf("CLI database tests passed!\n");
+}
+
 void test_cli_suite() {
     printf("Starting CLI tests...\n\n");
     
     test_cli_basic_commands();
     test_cli_invalid_commands();
     test_cli_order_parameter();
+    test_cli_load_command();
+    test_cli_database();
     
     printf("All CLI tests passed!\n");
 }
\ No newline at end of file
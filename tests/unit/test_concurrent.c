@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "bplus/tree.h"
+#include "bplus/cursor.h"
+#include "bplus/concurrent.h"
+
+#define STRESS_THREADS 8
+#define STRESS_KEYS 20000
+
+typedef struct {
+    BPlusTree* tree;
+    int id;
+    int failures;
+} StressArgs;
+
+// Walks the leaf chain of a quiescent tree: keys strictly increasing and
+// prev links matching next links. Returns the number of keys.
+static int check_leaf_chain(BPlusTree* tree) {
+    BPlusNode* leaf = tree->root;
+    while (!leaf->is_leaf) {
+        leaf = leaf->children[0];
+    }
+    assert(leaf->prev == NULL);
+
+    int count = 0;
+    int last = 0;
+    for (; leaf; leaf = leaf->next) {
+        if (leaf->next) assert(leaf->next->prev == leaf);
+        for (int i = 0; i < leaf->num_keys; i++) {
+            if (count > 0) assert(leaf->keys[i] > last);
+            last = leaf->keys[i];
+            count++;
+        }
+    }
+    return count;
+}
+
+// Each writer owns the keys congruent to its id: insert them all, then
+// delete every other one, checking its own keys as it goes
+static void* stripe_writer(void* arg) {
+    StressArgs* args = arg;
+    for (int k = args->id; k < STRESS_KEYS; k += STRESS_THREADS) {
+        if (!bplus_tree_insert(args->tree, k)) args->failures++;
+        if (bplus_tree_insert(args->tree, k)) args->failures++;
+        if (!bplus_tree_search(args->tree, k)) args->failures++;
+    }
+    for (int k = args->id; k < STRESS_KEYS; k += 2 * STRESS_THREADS) {
+        if (!bplus_tree_delete(args->tree, k)) args->failures++;
+        if (bplus_tree_search(args->tree, k)) args->failures++;
+    }
+    return NULL;
+}
+
+// Readers probe keys no writer ever touches; they must always be found
+static void* stable_reader(void* arg) {
+    StressArgs* args = arg;
+    for (int round = 0; round < 20; round++) {
+        for (int k = -1; k > -2000; k -= 7) {
+            if (!bplus_tree_search(args->tree, k)) args->failures++;
+        }
+    }
+    return NULL;
+}
+
+void test_concurrent_disjoint_writers() {
+    printf("Running concurrent disjoint writer tests...\n");
+
+    int orders[] = { 4, 5, 16 };
+    for (int o = 0; o < 3; o++) {
+        BPlusTree* tree = bplus_tree_create_concurrent(orders[o]);
+        for (int k = -1; k > -2000; k -= 7) {
+            bool inserted = bplus_tree_insert(tree, k);
+            assert(inserted);
+        }
+
+        pthread_t threads[STRESS_THREADS + 2];
+        StressArgs args[STRESS_THREADS + 2];
+        for (int t = 0; t < STRESS_THREADS + 2; t++) {
+            args[t].tree = tree;
+            args[t].id = t;
+            args[t].failures = 0;
+            pthread_create(&threads[t], NULL, t < STRESS_THREADS ? stripe_writer : stable_reader, &args[t]);
+        }
+        for (int t = 0; t < STRESS_THREADS + 2; t++) {
+            pthread_join(threads[t], NULL);
+            assert(args[t].failures == 0);
+        }
+
+        // Keys that survived are exactly the odd-numbered stripe passes
+        int expected = 0;
+        for (int k = 0; k < STRESS_KEYS; k++) {
+            bool kept = (k % (2 * STRESS_THREADS)) >= STRESS_THREADS;
+            assert(bplus_tree_search(tree, k) == kept);
+            expected += kept;
+        }
+        assert(check_leaf_chain(tree) == expected + 286);
+
+        bplus_tree_reclaim(tree);
+        bplus_tree_destroy(tree);
+    }
+
+    printf("Concurrent disjoint writer tests passed!\n");
+}
+
+// Every thread inserts and deletes random keys from one small shared range
+static void* contended_worker(void* arg) {
+    StressArgs* args = arg;
+    unsigned seed = 12345u + (unsigned)args->id;
+    for (int i = 0; i < 30000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int key = (int)((seed >> 8) % 512);
+        switch ((seed >> 4) % 3) {
+        case 0: bplus_tree_insert(args->tree, key); break;
+        case 1: bplus_tree_delete(args->tree, key); break;
+        default: bplus_tree_search(args->tree, key); break;
+        }
+    }
+    return NULL;
+}
+
+void test_concurrent_contended() {
+    printf("Running concurrent contended tests...\n");
+
+    BPlusTree* tree = bplus_tree_create_concurrent(4);
+    pthread_t threads[STRESS_THREADS];
+    StressArgs args[STRESS_THREADS];
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        args[t].tree = tree;
+        args[t].id = t;
+        args[t].failures = 0;
+        pthread_create(&threads[t], NULL, contended_worker, &args[t]);
+    }
+    for (int t = 0; t < STRESS_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    // The final contents are unpredictable, but search and the leaf chain
+    // must agree and a single-threaded delete must empty the tree
+    int present = 0;
+    for (int k = 0; k < 512; k++) {
+        present += bplus_tree_search(tree, k);
+    }
+    assert(check_leaf_chain(tree) == present);
+    for (int k = 0; k < 512; k++) {
+        bplus_tree_delete(tree, k);
+    }
+    assert(check_leaf_chain(tree) == 0);
+    bool inserted = bplus_tree_insert(tree, 7);
+    assert(inserted && bplus_tree_search(tree, 7));
+
+    bplus_tree_destroy(tree);
+    printf("Concurrent contended tests passed!\n");
+}
+
+void test_concurrent_suite() {
+    printf("Starting concurrent tests...\n\n");
+
+    test_concurrent_disjoint_writers();
+    test_concurrent_contended();
+
+    printf("All concurrent tests passed!\n");
+}
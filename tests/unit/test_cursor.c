@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include "bplus/tree.h"
+#include "bplus/cursor.h"
+
+void test_cursor_empty_tree() {
+    printf("Running cursor empty tree tests...\n");
+    
+    BPlusTree* tree = bplus_tree_create(4);
+    BPlusCursor cursor;
+    int key;
+    
+    bplus_cursor_first(&cursor, tree);
+    bool stepped = bplus_cursor_next(&cursor, &key);
+    assert(!stepped);
+    stepped = bplus_cursor_prev(&cursor, &key);
+    assert(!stepped);
+    bplus_cursor_seek(&cursor, tree, 10);
+    size_t copied = bplus_cursor_next_batch(&cursor, &key, 1);
+    assert(copied == 0);
+    
+    bplus_tree_destroy(tree);
+    printf("Cursor empty tree tests passed!\n");
+}
+
+void test_cursor_scans() {
+    printf("Running cursor scan tests...\n");
+    
+    // Even keys 0..19998, built by inserts, deletes and a bulk load
+    BPlusTree* trees[3];
+    trees[0] = bplus_tree_create(4);
+    trees[1] = bplus_tree_create(16);
+    for (int i = 0; i < 20000; i++) {
+        if (i < 10000) bplus_tree_insert(trees[0], ((i * 7919) % 10000) * 2);
+        bplus_tree_insert(trees[1], i);
+    }
+    for (int i = 1; i < 20000; i += 2) {
+        bplus_tree_delete(trees[1], i);
+    }
+    int* sorted = malloc(sizeof(int) * 10000);
+    for (int i = 0; i < 10000; i++) {
+        sorted[i] = i * 2;
+    }
+    trees[2] = bplus_tree_bulk_load(32, sorted, 10000, 0.8);
+    free(sorted);
+    
+    for (int t = 0; t < 3; t++) {
+        BPlusTree* tree = trees[t];
+        BPlusCursor cursor;
+        int key;
+        
+        // Full forward and backward scans
+        bplus_cursor_first(&cursor, tree);
+        for (int i = 0; i < 10000; i++) {
+            bool stepped = bplus_cursor_next(&cursor, &key);
+            assert(stepped && key == i * 2);
+        }
+        bool stepped = bplus_cursor_next(&cursor, &key);
+        assert(!stepped);
+        for (int i = 9999; i >= 0; i--) {
+            stepped = bplus_cursor_prev(&cursor, &key);
+            assert(stepped && key == i * 2);
+        }
+        stepped = bplus_cursor_prev(&cursor, &key);
+        assert(!stepped);
+        
+        bplus_cursor_last(&cursor, tree);
+        stepped = bplus_cursor_prev(&cursor, &key);
+        assert(stepped && key == 19998);
+        
+        // Seeks on present and missing keys, and past either end
+        bplus_cursor_seek(&cursor, tree, 501);
+        stepped = bplus_cursor_next(&cursor, &key);
+        assert(stepped && key == 502);
+        bplus_cursor_seek(&cursor, tree, 502);
+        stepped = bplus_cursor_next(&cursor, &key);
+        assert(stepped && key == 502);
+        stepped = bplus_cursor_prev(&cursor, &key);
+        assert(stepped && key == 502);
+        stepped = bplus_cursor_prev(&cursor, &key);
+        assert(stepped && key == 500);
+        bplus_cursor_seek_upper(&cursor, tree, 502);
+        stepped = bplus_cursor_prev(&cursor, &key);
+        assert(stepped && key == 502);
+        bplus_cursor_seek_upper(&cursor, tree, 503);
+        stepped = bplus_cursor_prev(&cursor, &key);
+        assert(stepped && key == 502);
+        bplus_cursor_seek(&cursor, tree, INT_MIN);
+        stepped = bplus_cursor_next(&cursor, &key);
+        assert(stepped && key == 0);
+        bplus_cursor_seek(&cursor, tree, INT_MAX);
+        stepped = bplus_cursor_next(&cursor, &key);
+        assert(!stepped);
+        stepped = bplus_cursor_prev(&cursor, &key);
+        assert(stepped && key == 19998);
+        
+        // Batches cross leaf boundaries and stop at the end
+        int buf[333];
+        size_t total = 0;
+        size_t count;
+        bplus_cursor_seek(&cursor, tree, 1000);
+        while ((count = bplus_cursor_next_batch(&cursor, buf, 333)) > 0) {
+            for (size_t i = 0; i < count; i++) {
+                assert(buf[i] == 1000 + (int)(total + i) * 2);
+            }
+            total += count;
+        }
+        assert(total == 9500);
+        
+        bplus_tree_destroy(tree);
+    }
+    
+    printf("Cursor scan tests passed!\n");
+}
+
+void test_cursor_suite() {
+    printf("Starting cursor tests...\n\n");
+    
+    test_cursor_empty_tree();
+    test_cursor_scans();
+    
+    printf("All cursor tests passed!\n");
+}
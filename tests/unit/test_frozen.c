@@ -0,0 +1,91 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include "bplus/frozen.h"
+#include "bplus/tree.h"
+
+// Sizes around block and level boundaries (16 keys per block, 17 children)
+static const size_t frozen_sizes[] = { 0, 1, 15, 16, 17, 272, 273, 4624, 4625, 100000 };
+
+void test_frozen_search() {
+    printf("Running frozen tree search tests...\n");
+
+    for (size_t s = 0; s < sizeof(frozen_sizes) / sizeof(frozen_sizes[0]); s++) {
+        size_t n = frozen_sizes[s];
+        BPlusTree* tree = bplus_tree_create(16);
+        for (size_t k = 0; k < n; k++) {
+            bplus_tree_insert(tree, (int)((k * 7919) % n) * 2);
+        }
+        BPlusFrozenTree* frozen = bplus_tree_freeze(tree);
+        assert(frozen && frozen->count == n);
+        bplus_tree_destroy(tree);
+
+        // Every present key is found at its rank; the gaps between are not
+        for (size_t k = 0; k < n; k++) {
+            int key = (int)k * 2;
+            assert(frozen->keys[k] == key);
+            assert(bplus_frozen_tree_search(frozen, key));
+            assert(bplus_frozen_tree_rank(frozen, key) == k);
+            assert(!bplus_frozen_tree_search(frozen, key + 1));
+            assert(bplus_frozen_tree_rank(frozen, key + 1) == k + 1);
+        }
+        assert(bplus_frozen_tree_rank(frozen, INT_MIN) == 0);
+        assert(bplus_frozen_tree_rank(frozen, INT_MAX) == n);
+        assert(!bplus_frozen_tree_search(frozen, -1));
+        assert(!bplus_frozen_tree_search(frozen, INT_MAX));
+        assert(bplus_frozen_tree_memory_usage(frozen) >= n * sizeof(int));
+        bplus_frozen_tree_destroy(frozen);
+    }
+
+    printf("Frozen tree search tests passed!\n");
+}
+
+// INT_MAX pads the last block and the index, so it must still be found
+// when it is a real key
+void test_frozen_extremes() {
+    printf("Running frozen tree extreme key tests...\n");
+
+    BPlusTree* tree = bplus_tree_create(8);
+    for (int k = 0; k < 1000; k++) {
+        bplus_tree_insert(tree, INT_MIN + k);
+        bplus_tree_insert(tree, INT_MAX - k);
+    }
+    BPlusFrozenTree* frozen = bplus_tree_freeze(tree);
+    bplus_tree_destroy(tree);
+
+    assert(frozen->count == 2000);
+    for (int k = 0; k < 1000; k++) {
+        assert(bplus_frozen_tree_search(frozen, INT_MIN + k));
+        assert(bplus_frozen_tree_search(frozen, INT_MAX - k));
+        assert(bplus_frozen_tree_rank(frozen, INT_MAX - k) == (size_t)(1999 - k));
+    }
+    assert(!bplus_frozen_tree_search(frozen, 0));
+    assert(bplus_frozen_tree_rank(frozen, 0) == 1000);
+    bplus_frozen_tree_destroy(frozen);
+
+    // Packed leaves freeze the same way
+    BPlusTreeOptions options = { .order = 8, .flags = BPLUS_TREE_PACKED_LEAVES };
+    tree = bplus_tree_create_with_options(&options);
+    for (int k = 0; k < 5000; k++) {
+        bplus_tree_insert(tree, k * 3);
+    }
+    frozen = bplus_tree_freeze(tree);
+    bplus_tree_destroy(tree);
+    for (int k = 0; k < 5000; k++) {
+        assert(bplus_frozen_tree_search(frozen, k * 3));
+        assert(!bplus_frozen_tree_search(frozen, k * 3 + 1));
+    }
+    bplus_frozen_tree_destroy(frozen);
+
+    printf("Frozen tree extreme key tests passed!\n");
+}
+
+void test_frozen_suite() {
+    printf("Starting frozen tree tests...\n\n");
+
+    test_frozen_search();
+    test_frozen_extremes();
+
+    printf("All frozen tree tests passed!\n");
+}
@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "bplus/journal.h"
+#include "bplus/snapshot.h"
+#include "bplus/tree.h"
+
+#define MODEL_IDS 200000
+#define MODEL_KEYS 64
+
+// What a reader of the journal knows about each node
+typedef struct {
+    bool alive;
+    bool leaf;
+    int num_keys;
+    int keys[MODEL_KEYS];
+    uint32_t children[MODEL_KEYS + 1];
+} ModelNode;
+
+typedef struct {
+    ModelNode* nodes;
+    uint64_t version;
+} Model;
+
+static void copy_node(const BPlusTree* tree, ModelNode* out, const BPlusNode* node) {
+    int buffer[MODEL_KEYS];
+    const int* keys = node->is_leaf ? bplus_node_keys(node, buffer) : node->keys;
+    assert(node->num_keys <= MODEL_KEYS);
+    out->alive = true;
+    out->leaf = node->is_leaf;
+    out->num_keys = node->num_keys;
+    memcpy(out->keys, keys, sizeof(int) * node->num_keys);
+    for (int i = 0; !node->is_leaf && i <= node->num_keys; i++) {
+        out->children[i] = bplus_tree_node_id(tree, node->children[i]);
+    }
+}
+
+static size_t load_subtree(const BPlusTree* tree, Model* model, const BPlusNode* node) {
+    uint32_t id = bplus_tree_node_id(tree, node);
+    assert(id > 0 && id < MODEL_IDS && bplus_tree_node_by_id(tree, id) == node);
+    copy_node(tree, &model->nodes[id], node);
+    size_t count = 1;
+    for (int i = 0; !node->is_leaf && i <= node->num_keys; i++) {
+        count += load_subtree(tree, model, node->children[i]);
+    }
+    return count;
+}
+
+// Brings the model up to date from the changes alone
+static void catch_up(const BPlusTree* tree, Model* model) {
+    uint64_t version = bplus_tree_journal_version(tree);
+    assert(model->version + 1 >= bplus_tree_journal_oldest(tree));
+    for (uint64_t v = model->version + 1; v <= version; v++) {
+        BPlusChange change;
+        bool kept = bplus_tree_journal_get(tree, v, &change);
+        assert(kept);
+        assert(change.version == v && change.node > 0 && change.node < MODEL_IDS);
+        BPlusNode* node = bplus_tree_node_by_id(tree, change.node);
+        if (node) {
+            copy_node(tree, &model->nodes[change.node], node);
+        } else {
+            model->nodes[change.node].alive = false;
+        }
+    }
+    model->version = version;
+}
+
+// The model matches the tree node for node
+static void assert_model(const BPlusTree* tree, const Model* model) {
+    Model fresh = { calloc(MODEL_IDS, sizeof(ModelNode)), 0 };
+    size_t count = load_subtree(tree, &fresh, tree->root);
+    size_t alive = 0;
+    for (size_t id = 0; id < MODEL_IDS; id++) {
+        const ModelNode* a = &model->nodes[id];
+        const ModelNode* b = &fresh.nodes[id];
+        assert(a->alive == b->alive);
+        if (!a->alive) continue;
+        alive++;
+        assert(a->leaf == b->leaf && a->num_keys == b->num_keys);
+        assert(memcmp(a->keys, b->keys, sizeof(int) * a->num_keys) == 0);
+        if (!a->leaf) {
+            assert(memcmp(a->children, b->children, sizeof(uint32_t) * (a->num_keys + 1)) == 0);
+        }
+    }
+    assert(alive == count);
+    free(fresh.nodes);
+}
+
+static bool seen_since(const BPlusTree* tree, uint64_t since, BPlusChangeKind kind) {
+    BPlusChange change;
+    for (uint64_t v = since + 1; bplus_tree_journal_get(tree, v, &change); v++) {
+        if (change.kind == kind) return true;
+    }
+    return false;
+}
+
+// Random writes in rounds, with the model caught up after each
+static void replay(BPlusTree* tree, int rounds, bool snapshots) {
+    Model model = { calloc(MODEL_IDS, sizeof(ModelNode)), 0 };
+    bool started = bplus_tree_journal_start(tree, 1 << 16);
+    assert(started);
+    started = bplus_tree_journal_start(tree, 16);
+    assert(!started);
+    load_subtree(tree, &model, tree->root);
+    model.version = bplus_tree_journal_version(tree);
+
+    unsigned seed = 12345;
+    for (int round = 0; round < rounds; round++) {
+        for (int i = 0; i < 50; i++) {
+            seed = seed * 1103515245u + 12345u;
+            int key = (int)((seed >> 8) % 2000);
+            BPlusSnapshot* snapshot = snapshots ? bplus_tree_snapshot(tree) : NULL;
+            if ((seed >> 4) % 3 == 0) {
+                bplus_tree_delete(tree, key);
+            } else {
+                bplus_tree_insert(tree, key);
+            }
+            bplus_snapshot_release(snapshot);
+        }
+        if (round % 5 == 4) {
+            int batch[100];
+            for (int i = 0; i < 100; i++) {
+                batch[i] = (round * 37 + i * 11) % 2000;
+            }
+            bplus_tree_insert_batch(tree, batch, 100);
+        }
+        if (tree->flags & BPLUS_TREE_LAZY_DELETE) {
+            bplus_tree_rebalance(tree, 8);
+        }
+        catch_up(tree, &model);
+        assert_model(tree, &model);
+    }
+    assert(bplus_tree_validate(tree) || (tree->flags & BPLUS_TREE_LAZY_DELETE));
+    free(model.nodes);
+}
+
+void test_journal_replay() {
+    printf("Running journal replay tests...\n");
+
+    BPlusTree* tree = bplus_tree_create(4);
+    for (int i = 0; i < 500; i++) {
+        bplus_tree_insert(tree, i * 4);
+    }
+    replay(tree, 60, false);
+    bplus_tree_destroy(tree);
+
+    // Snapshots copy nodes on every write; the copies keep their ids
+    tree = bplus_tree_create(5);
+    replay(tree, 60, true);
+    bplus_tree_destroy(tree);
+
+    BPlusTreeOptions options = { .order = 6, .leaf_order = 9, .flags = BPLUS_TREE_PACKED_LEAVES };
+    tree = bplus_tree_create_with_options(&options);
+    replay(tree, 40, false);
+    bplus_tree_destroy(tree);
+
+    options = (BPlusTreeOptions){ .order = 4, .flags = BPLUS_TREE_LAZY_DELETE };
+    tree = bplus_tree_create_with_options(&options);
+    replay(tree, 40, true);
+    bplus_tree_destroy(tree);
+
+    printf("Journal replay tests passed!\n");
+}
+
+void test_journal_changes() {
+    printf("Running journal change tests...\n");
+
+    BPlusTree* tree = bplus_tree_create(4);
+    assert(bplus_tree_journal_version(tree) == 0 && bplus_tree_node_id(tree, tree->root) == 0);
+    bool started = bplus_tree_journal_start(tree, 4096);
+    assert(started);
+    uint32_t first_root = bplus_tree_node_id(tree, tree->root);
+    assert(first_root == 1 && bplus_tree_journal_version(tree) == 0);
+
+    // Three keys fit in the first leaf; the fourth splits it
+    for (int i = 1; i <= 3; i++) {
+        bplus_tree_insert(tree, i);
+    }
+    // Each write gets versions of its own, even touching the same node
+    BPlusChange change;
+    assert(bplus_tree_journal_version(tree) == 3);
+    for (uint64_t v = 1; v <= 3; v++) {
+        bool kept = bplus_tree_journal_get(tree, v, &change);
+        assert(kept);
+        assert(change.node == first_root && change.kind == BPLUS_CHANGE_KEYS);
+    }
+    bool kept = bplus_tree_journal_get(tree, 4, &change);
+    assert(!kept);
+    kept = bplus_tree_journal_get(tree, 0, &change);
+    assert(!kept);
+
+    uint64_t before = bplus_tree_journal_version(tree);
+    bplus_tree_insert(tree, 4);
+    assert(seen_since(tree, before, BPLUS_CHANGE_SPLIT) && seen_since(tree, before, BPLUS_CHANGE_CREATED));
+    assert(bplus_tree_node_id(tree, tree->root) != first_root);
+    assert(bplus_tree_node_by_id(tree, first_root) == tree->root->children[0]);
+
+    // Inserting a key already present changes nothing
+    before = bplus_tree_journal_version(tree);
+    bplus_tree_insert(tree, 4);
+    assert(bplus_tree_journal_version(tree) == before);
+
+    before = bplus_tree_journal_version(tree);
+    for (int i = 4; i >= 2; i--) {
+        bplus_tree_delete(tree, i);
+    }
+    assert(seen_since(tree, before, BPLUS_CHANGE_MERGED) && seen_since(tree, before, BPLUS_CHANGE_REMOVED));
+    assert(tree->root->is_leaf && bplus_tree_node_id(tree, tree->root) == first_root);
+    bplus_tree_journal_stop(tree);
+    assert(bplus_tree_journal_version(tree) == 0 && bplus_tree_node_id(tree, tree->root) == 0);
+    bplus_tree_destroy(tree);
+
+    // A small journal keeps only the latest changes
+    tree = bplus_tree_create(4);
+    started = bplus_tree_journal_start(tree, 0);
+    assert(!started);
+    started = bplus_tree_journal_start(tree, 16);
+    assert(started);
+    for (int i = 0; i < 200; i++) {
+        bplus_tree_insert(tree, i);
+    }
+    uint64_t version = bplus_tree_journal_version(tree);
+    assert(version > 16 && bplus_tree_journal_oldest(tree) == version - 15);
+    kept = bplus_tree_journal_get(tree, version - 16, &change);
+    assert(!kept);
+    kept = bplus_tree_journal_get(tree, version - 15, &change);
+    assert(kept && change.version == version - 15);
+    bplus_tree_destroy(tree);
+
+    printf("Journal change tests passed!\n");
+}
+
+void test_journal_suite() {
+    printf("Starting journal tests...\n\n");
+
+    test_journal_changes();
+    test_journal_replay();
+
+    printf("All journal tests passed!\n");
+}
@@ -0,0 +1,215 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "bplus/json.h"
+#include "bplus/snapshot.h"
+#include "bplus/tree.h"
+
+#define JSON_MAX (1 << 20)
+
+// The whole document, built the obvious way
+static void append_node(char* out, size_t* len, const BPlusNode* node) {
+    int buffer[1024];
+    const int* keys = node->is_leaf ? bplus_node_keys(node, buffer) : node->keys;
+    *len += sprintf(out + *len, "{\"leaf\":%s,\"keys\":[", node->is_leaf ? "true" : "false");
+    for (int i = 0; i < node->num_keys; i++) {
+        *len += sprintf(out + *len, "%s%d", i ? "," : "", keys[i]);
+    }
+    if (node->is_leaf) {
+        *len += sprintf(out + *len, "]}");
+        return;
+    }
+    *len += sprintf(out + *len, "],\"children\":[");
+    for (int i = 0; i <= node->num_keys; i++) {
+        if (i) out[(*len)++] = ',';
+        append_node(out, len, node->children[i]);
+    }
+    *len += sprintf(out + *len, "]}");
+}
+
+static char* expected_json(BPlusTree* tree, const BPlusNode* root, size_t nodes) {
+    int height = 1;
+    for (const BPlusNode* node = root; !node->is_leaf; node = node->children[0]) {
+        height++;
+    }
+    char* out = malloc(JSON_MAX);
+    size_t len = sprintf(out, "{\"order\":%d,\"leaf_order\":%d,\"height\":%d,\"root\":",
+                         tree->order, tree->leaf_order, height);
+    append_node(out, &len, root);
+    sprintf(out + len, ",\"nodes\":%zu,\"truncated\":false}", nodes);
+    return out;
+}
+
+// Drains the writer `cap` bytes at a time
+static char* read_all(BPlusJsonWriter* writer, size_t cap) {
+    char* out = malloc(JSON_MAX);
+    size_t len = 0;
+    size_t n;
+    while ((n = bplus_json_writer_read(writer, out + len, cap)) > 0) {
+        assert(n <= cap);
+        len += n;
+        assert(len < JSON_MAX);
+    }
+    out[len] = '\0';
+    size_t produced = bplus_json_writer_read(writer, out + len, cap);
+    assert(produced == 0);
+    return out;
+}
+
+static size_t count_of(const char* text, const char* word) {
+    size_t count = 0;
+    for (const char* p = strstr(text, word); p; p = strstr(p + 1, word)) {
+        count++;
+    }
+    return count;
+}
+
+void test_json_document() {
+    printf("Running JSON document tests...\n");
+
+    BPlusJsonWriter writer;
+    BPlusTree* tree = bplus_tree_create(4);
+    bplus_json_writer_init(&writer, tree, NULL);
+    char* json = read_all(&writer, 64);
+    assert(strcmp(json, "{\"order\":4,\"leaf_order\":4,\"height\":1,\"root\":"
+                        "{\"leaf\":true,\"keys\":[]},\"nodes\":1,\"truncated\":false}") == 0);
+    free(json);
+
+    for (int i = 0; i < 500; i++) {
+        bplus_tree_insert(tree, (i * 7919) % 1000 - 500);
+    }
+    size_t nodes = tree->leaf_pool.in_use + tree->internal_pool.in_use;
+    char* expected = expected_json(tree, tree->root, nodes);
+
+    // Tokens split across reads of every size come out the same
+    size_t caps[] = { 1, 2, 7, 128, JSON_MAX };
+    for (size_t c = 0; c < sizeof(caps) / sizeof(caps[0]); c++) {
+        bplus_json_writer_init(&writer, tree, NULL);
+        json = read_all(&writer, caps[c]);
+        assert(strcmp(json, expected) == 0);
+        assert(writer.nodes == nodes && !writer.truncated);
+        free(json);
+    }
+    free(expected);
+    bplus_tree_destroy(tree);
+
+    // Packed leaves and separate leaf sizes
+    BPlusTreeOptions options = { .order = 8, .leaf_order = 32, .flags = BPLUS_TREE_PACKED_LEAVES };
+    tree = bplus_tree_create_with_options(&options);
+    for (int i = 0; i < 2000; i++) {
+        bplus_tree_insert(tree, i * 3);
+    }
+    expected = expected_json(tree, tree->root, tree->leaf_pool.in_use + tree->internal_pool.in_use);
+    bplus_json_writer_init(&writer, tree, NULL);
+    json = read_all(&writer, 100);
+    assert(strcmp(json, expected) == 0);
+    free(json);
+    free(expected);
+    bplus_tree_destroy(tree);
+
+    bplus_json_writer_init(&writer, NULL, NULL);
+    json = read_all(&writer, 3);
+    assert(strcmp(json, "null") == 0);
+    free(json);
+
+    printf("JSON document tests passed!\n");
+}
+
+void test_json_limits() {
+    printf("Running JSON limit tests...\n");
+
+    BPlusTree* tree = bplus_tree_create(4);
+    for (int i = 0; i < 300; i++) {
+        bplus_tree_insert(tree, i);
+    }
+    BPlusJsonWriter writer;
+
+    // Only the root: each of its children is left out
+    BPlusJsonLimits limits = { .max_depth = 1 };
+    bplus_json_writer_init(&writer, tree, &limits);
+    char* json = read_all(&writer, 5);
+    assert(writer.nodes == 1 && writer.truncated);
+    assert(count_of(json, "null") == (size_t)tree->root->num_keys + 1);
+    assert(count_of(json, "\"leaf\":") == 1);
+    assert(strstr(json, "\"truncated\":true}"));
+    free(json);
+
+    limits = (BPlusJsonLimits){ .max_depth = 2 };
+    bplus_json_writer_init(&writer, tree, &limits);
+    json = read_all(&writer, 16);
+    size_t second_level = 0;
+    for (int i = 0; i <= tree->root->num_keys; i++) {
+        second_level += (size_t)tree->root->children[i]->num_keys + 1;
+    }
+    assert(writer.nodes == (size_t)tree->root->num_keys + 2);
+    assert(count_of(json, "null") == second_level);
+    free(json);
+
+    // A node budget is exact, and the document stays well formed
+    limits = (BPlusJsonLimits){ .max_nodes = 10 };
+    bplus_json_writer_init(&writer, tree, &limits);
+    json = read_all(&writer, 1);
+    assert(writer.nodes == 10 && writer.truncated);
+    assert(count_of(json, "\"leaf\":") == 10);
+    assert(count_of(json, "{") == count_of(json, "}"));
+    assert(count_of(json, "[") == count_of(json, "]"));
+    free(json);
+
+    // Limits the tree is within change nothing
+    limits = (BPlusJsonLimits){ .max_depth = 20, .max_nodes = 100000 };
+    bplus_json_writer_init(&writer, tree, &limits);
+    json = read_all(&writer, 4096);
+    char* expected = expected_json(tree, tree->root, writer.nodes);
+    assert(!writer.truncated && strcmp(json, expected) == 0);
+    free(json);
+    free(expected);
+    bplus_tree_destroy(tree);
+
+    printf("JSON limit tests passed!\n");
+}
+
+// A writer over a snapshot can be drained while the tree changes
+void test_json_snapshot() {
+    printf("Running JSON snapshot tests...\n");
+
+    BPlusTree* tree = bplus_tree_create(6);
+    for (int i = 0; i < 1000; i++) {
+        bplus_tree_insert(tree, i * 2);
+    }
+    BPlusJsonWriter writer;
+    bplus_json_writer_init(&writer, tree, NULL);
+    char* expected = read_all(&writer, 4096);
+
+    BPlusSnapshot* snapshot = bplus_tree_snapshot(tree);
+    bplus_json_writer_init_snapshot(&writer, snapshot, NULL);
+    char* json = malloc(JSON_MAX);
+    size_t len = 0;
+    size_t n;
+    int key = 0;
+    while ((n = bplus_json_writer_read(&writer, json + len, 32)) > 0) {
+        len += n;
+        bplus_tree_insert(tree, key * 2 + 1);
+        bplus_tree_delete(tree, key * 4);
+        key++;
+    }
+    json[len] = '\0';
+    assert(strcmp(json, expected) == 0);
+    assert(bplus_tree_validate(tree));
+    free(json);
+    free(expected);
+    bplus_snapshot_release(snapshot);
+    bplus_tree_destroy(tree);
+
+    printf("JSON snapshot tests passed!\n");
+}
+
+void test_json_suite() {
+    printf("Starting JSON writer tests...\n\n");
+
+    test_json_document();
+    test_json_limits();
+    test_json_snapshot();
+
+    printf("All JSON writer tests passed!\n");
+}
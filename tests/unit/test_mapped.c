@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bplus/mapped.h"
+#include "bplus/tree.h"
+
+#define MAPPED_TEST_FILE "test_mapped.img"
+
+typedef struct {
+    int last;
+    size_t count;
+    size_t limit;
+} ScanState;
+
+static bool check_ascending(int key, void* ctx) {
+    ScanState* state = ctx;
+    if (state->count > 0) assert(key > state->last);
+    state->last = key;
+    state->count++;
+    return state->count < state->limit;
+}
+
+static bool count_key(int key, void* ctx) {
+    (void)key;
+    (*(size_t*)ctx)++;
+    return true;
+}
+
+static void flip_byte(const char* path, long offset) {
+    int fd = open(path, O_RDWR);
+    unsigned char byte;
+    ssize_t fetched = pread(fd, &byte, 1, offset);
+    assert(fetched == 1);
+    byte ^= 0xFF;
+    ssize_t patched = pwrite(fd, &byte, 1, offset);
+    assert(patched == 1);
+    close(fd);
+}
+
+void test_mapped_tree() {
+    printf("Running mapped tree tests...\n");
+    remove(MAPPED_TEST_FILE);
+
+    // The last tree's leaves hold more keys than its internal nodes
+    BPlusTreeOptions variants[] = { { .order = 4 }, { .order = 16 }, { .order = 64 }, { .node_bytes = 256 } };
+    for (int v = 0; v < 4; v++) {
+        BPlusTree* tree = bplus_tree_create_with_options(&variants[v]);
+        for (int k = 0; k < 30000; k++) {
+            bplus_tree_insert(tree, (k * 7919) % 30000 * 2);
+        }
+        bool written = bplus_mapped_tree_write(tree, MAPPED_TEST_FILE);
+        assert(written);
+        bplus_tree_destroy(tree);
+
+        BPlusMappedTree* mapped = bplus_mapped_tree_open(MAPPED_TEST_FILE);
+        assert(mapped && bplus_mapped_tree_verify(mapped));
+        assert(bplus_mapped_tree_count(mapped) == 30000);
+        for (int k = 0; k < 30000; k++) {
+            int key = (k * 7919) % 30000 * 2;
+            assert(bplus_mapped_tree_search(mapped, key));
+            assert(!bplus_mapped_tree_search(mapped, key + 1));
+        }
+        assert(!bplus_mapped_tree_search(mapped, -5));
+        assert(!bplus_mapped_tree_search(mapped, 1 << 30));
+
+        // Full scan walks the leaves in order across the whole file
+        ScanState state = { 0, 0, (size_t)-1 };
+        size_t visited = bplus_mapped_tree_scan(mapped, -100, 1 << 30, check_ascending, &state);
+        assert(visited == 30000);
+
+        // Bounded and early-stopped scans
+        state = (ScanState){ 0, 0, (size_t)-1 };
+        visited = bplus_mapped_tree_scan(mapped, 1001, 2000, check_ascending, &state);
+        assert(visited == 500);
+        assert(state.last == 2000);
+        state = (ScanState){ 0, 0, 10 };
+        visited = bplus_mapped_tree_scan(mapped, 0, 1 << 30, check_ascending, &state);
+        assert(visited == 10);
+        assert(state.last == 18);
+        visited = bplus_mapped_tree_scan(mapped, 50, 10, check_ascending, &state);
+        assert(visited == 0);
+
+        bplus_mapped_tree_close(mapped);
+    }
+
+    // An empty tree maps to a single empty leaf
+    BPlusTree* empty = bplus_tree_create(4);
+    bool written = bplus_mapped_tree_write(empty, MAPPED_TEST_FILE);
+    assert(written);
+    bplus_tree_destroy(empty);
+    BPlusMappedTree* mapped = bplus_mapped_tree_open(MAPPED_TEST_FILE);
+    assert(mapped && bplus_mapped_tree_verify(mapped));
+    assert(bplus_mapped_tree_count(mapped) == 0 && !bplus_mapped_tree_search(mapped, 0));
+    ScanState state = { 0, 0, (size_t)-1 };
+    size_t visited = bplus_mapped_tree_scan(mapped, 0, 100, check_ascending, &state);
+    assert(visited == 0);
+    bplus_mapped_tree_close(mapped);
+
+    remove(MAPPED_TEST_FILE);
+    printf("Mapped tree tests passed!\n");
+}
+
+void test_mapped_tree_damage() {
+    printf("Running mapped tree damage tests...\n");
+    remove(MAPPED_TEST_FILE);
+
+    BPlusMappedTree* opened = bplus_mapped_tree_open(MAPPED_TEST_FILE);
+    assert(opened == NULL);
+
+    BPlusTree* tree = bplus_tree_create(8);
+    for (int k = 0; k < 5000; k++) {
+        bplus_tree_insert(tree, k);
+    }
+    bool written = bplus_mapped_tree_write(tree, MAPPED_TEST_FILE);
+    assert(written);
+    bplus_tree_destroy(tree);
+
+    // A damaged body still opens, fails verification, and stays in bounds
+    BPlusMappedTree* mapped = bplus_mapped_tree_open(MAPPED_TEST_FILE);
+    long size = (long)mapped->size;
+    bplus_mapped_tree_close(mapped);
+    for (long offset = 64; offset < size; offset += 97) {
+        flip_byte(MAPPED_TEST_FILE, offset);
+    }
+    mapped = bplus_mapped_tree_open(MAPPED_TEST_FILE);
+    assert(mapped && !bplus_mapped_tree_verify(mapped));
+    for (int k = -10; k < 5010; k++) {
+        bplus_mapped_tree_search(mapped, k);
+    }
+    size_t count = 0;
+    bplus_mapped_tree_scan(mapped, -10, 5010, count_key, &count);
+    bplus_mapped_tree_close(mapped);
+
+    // A damaged header or a truncated file does not open
+    flip_byte(MAPPED_TEST_FILE, 20);
+    opened = bplus_mapped_tree_open(MAPPED_TEST_FILE);
+    assert(opened == NULL);
+    flip_byte(MAPPED_TEST_FILE, 20);
+    mapped = bplus_mapped_tree_open(MAPPED_TEST_FILE);
+    assert(mapped);
+    bplus_mapped_tree_close(mapped);
+    int truncated = truncate(MAPPED_TEST_FILE, size - 8);
+    assert(truncated == 0);
+    opened = bplus_mapped_tree_open(MAPPED_TEST_FILE);
+    assert(opened == NULL);
+
+    remove(MAPPED_TEST_FILE);
+    printf("Mapped tree damage tests passed!\n");
+}
+
+void test_mapped_suite() {
+    printf("Starting mapped tree tests...\n\n");
+
+    test_mapped_tree();
+    test_mapped_tree_damage();
+
+    printf("All mapped tree tests passed!\n");
+}
@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <stdint.h>
+#include "bplus/concurrent.h"
 #include "bplus/tree.h"
 #include "bplus/utils.h"
 
@@ -18,6 +20,13 @@ void test_node_operations() {
     assert(internal->is_leaf == false);
     assert(internal->num_keys == 0);
     
+    // Test single-block layout
+    assert((uintptr_t)leaf % BPLUS_CACHE_LINE == 0);
+    assert(leaf->children == NULL);
+    assert((char*)leaf->keys < (char*)leaf + bplus_node_size(4, true));
+    assert((char*)(internal->children + 4) <= (char*)internal + bplus_node_size(4, false));
+    assert(bplus_node_size(4, true) < bplus_node_size(4, false));
+    
     // Test node destruction
     destroy_node(leaf);
     destroy_node(internal);
@@ -25,6 +34,53 @@ void test_node_operations() {
     printf("Node operations tests passed!\n");
 }
 
+void test_node_pool() {
+    printf("Running node pool tests...\n");
+    
+    BPlusNodePool pool;
+    node_pool_init(&pool, bplus_node_size(8, true));
+    
+    // Freed blocks are reused before new ones are carved out
+    void* a = node_pool_alloc(&pool);
+    void* b = node_pool_alloc(&pool);
+    assert(a != NULL && b != NULL && a != b);
+    assert((uintptr_t)a % BPLUS_CACHE_LINE == 0);
+    node_pool_free(&pool, a);
+    BPlusNode* allocated = node_pool_alloc(&pool);
+    assert(allocated == a);
+    assert(pool.in_use == 2);
+    
+    // Allocations span several slabs
+    for (int i = 0; i < 10000; i++) {
+        allocated = node_pool_alloc(&pool);
+        assert(allocated != NULL);
+    }
+    assert(pool.in_use == 10002);
+    node_pool_destroy(&pool);
+    assert(pool.in_use == 0);
+    
+    // Nodes released by merges go back to the tree's pools
+    BPlusTree* tree = bplus_tree_create(4);
+    for (int i = 0; i < 1000; i++) {
+        bplus_tree_insert(tree, (i * 37) % 1000);
+    }
+    assert(bplus_tree_validate(tree));
+    size_t peak = tree->leaf_pool.in_use;
+    for (int i = 0; i < 1000; i++) {
+        bool deleted = bplus_tree_delete(tree, i);
+        assert(deleted);
+    }
+    assert(bplus_tree_validate(tree));
+    assert(tree->leaf_pool.in_use == 1 && tree->internal_pool.in_use == 0);
+    for (int i = 0; i < 1000; i++) {
+        bplus_tree_insert(tree, (i * 37) % 1000);
+    }
+    assert(tree->leaf_pool.in_use == peak);
+    bplus_tree_destroy(tree);
+    
+    printf("Node pool tests passed!\n");
+}
+
 void test_tree_persistence() {
     printf("Running tree persistence tests...\n");
     
@@ -36,7 +92,8 @@ void test_tree_persistence() {
     }
     
     // Save tree state
-    assert(save_tree_state(original, "test_tree.bin") == true);
+    bool saved = save_tree_state(original, "test_tree.bin");
+    assert(saved == true);
     
     // Load tree state
     BPlusTree* loaded = load_tree_state("test_tree.bin");
@@ -62,24 +119,223 @@ void test_tree_operations() {
     
     // Test empty tree properties
     assert(bplus_tree_search(tree, 10) == false);
-    assert(bplus_tree_delete(tree, 10) == false);
+    bool deleted = bplus_tree_delete(tree, 10);
+    assert(deleted == false);
     
     // Test operations sequence
-    assert(bplus_tree_insert(tree, 10) == true);
+    bool inserted = bplus_tree_insert(tree, 10);
+    assert(inserted == true);
     assert(bplus_tree_search(tree, 10) == true);
-    assert(bplus_tree_delete(tree, 10) == true);
+    deleted = bplus_tree_delete(tree, 10);
+    assert(deleted == true);
     assert(bplus_tree_search(tree, 10) == false);
     
     bplus_tree_destroy(tree);
     printf("Tree operations tests passed!\n");
 }
 
+// Counts keys along the leaf chain, checking they are strictly increasing
+static size_t count_leaf_chain(BPlusTree* tree) {
+    BPlusNode* leaf = tree->root;
+    while (!leaf->is_leaf) {
+        leaf = leaf->children[0];
+    }
+    
+    size_t count = 0;
+    int last = 0;
+    for (; leaf; leaf = leaf->next) {
+        for (int i = 0; i < leaf->num_keys; i++, count++) {
+            assert(count == 0 || leaf->keys[i] > last);
+            last = leaf->keys[i];
+        }
+    }
+    return count;
+}
+
+void test_bulk_load() {
+    printf("Running bulk load tests...\n");
+    
+    int orders[] = {3, 4, 5, 64};
+    double fills[] = {0.5, 0.7, 1.0};
+    size_t sizes[] = {0, 1, 2, 5, 100, 20000};
+    
+    int* keys = malloc(sizeof(int) * 20000);
+    for (int i = 0; i < 20000; i++) {
+        keys[i] = i * 2;
+    }
+    
+    for (int o = 0; o < 4; o++) {
+        for (int f = 0; f < 3; f++) {
+            for (int s = 0; s < 6; s++) {
+                size_t n = sizes[s];
+                BPlusTree* tree = bplus_tree_bulk_load(orders[o], keys, n, fills[f]);
+                assert(tree != NULL);
+                assert(bplus_tree_validate(tree));
+                assert(count_leaf_chain(tree) == n);
+                for (size_t i = 0; i < n; i++) {
+                    assert(bplus_tree_search(tree, keys[i]));
+                    assert(!bplus_tree_search(tree, keys[i] + 1));
+                }
+                bplus_tree_destroy(tree);
+            }
+        }
+    }
+    
+    // Full leaves at fill factor 1.0
+    BPlusTree* tree = bplus_tree_bulk_load(8, keys, 7000, 1.0);
+    assert(tree->leaf_pool.in_use == 1000);
+    
+    // A bulk-loaded tree accepts regular updates
+    for (int i = 0; i < 7000; i++) {
+        bplus_tree_insert(tree, i * 2 + 1);
+    }
+    for (int i = 0; i < 14000; i += 3) {
+        bool deleted = bplus_tree_delete(tree, i);
+        assert(deleted);
+    }
+    assert(count_leaf_chain(tree) == 14000 - 4667);
+    bplus_tree_destroy(tree);
+    
+    // Unsorted or duplicate input and bad orders are rejected
+    int unsorted[] = {1, 3, 2};
+    int duplicates[] = {1, 2, 2};
+    BPlusTree* loaded = bplus_tree_bulk_load(4, unsorted, 3, 1.0);
+    assert(loaded == NULL);
+    loaded = bplus_tree_bulk_load(4, duplicates, 3, 1.0);
+    assert(loaded == NULL);
+    loaded = bplus_tree_bulk_load(2, keys, 10, 1.0);
+    assert(loaded == NULL);
+    
+    free(keys);
+    printf("Bulk load tests passed!\n");
+}
+
+void test_insert_batch() {
+    printf("Running batch insert tests...\n");
+    
+    int orders[] = {4, 5, 8, 64};
+    for (int o = 0; o < 4; o++) {
+        BPlusTree* tree = bplus_tree_create(orders[o]);
+        bool* present = calloc(60000, sizeof(bool));
+        size_t expected = 0;
+        
+        // Batches of growing size with duplicates inside and across batches
+        int batch[4096];
+        unsigned seed = 12345;
+        for (int round = 0; round < 20; round++) {
+            int n = 1 << (round % 13);
+            size_t fresh = 0;
+            for (int i = 0; i < n; i++) {
+                seed = seed * 1103515245 + 12345;
+                batch[i] = (int)((seed >> 8) % 60000);
+            }
+            for (int i = 0; i < n; i++) {
+                if (!present[batch[i]]) {
+                    present[batch[i]] = true;
+                    fresh++;
+                }
+            }
+            size_t added = bplus_tree_insert_batch(tree, batch, (size_t)n);
+            assert(added == fresh);
+            expected += fresh;
+            assert(bplus_tree_validate(tree));
+        }
+        
+        assert(count_leaf_chain(tree) == expected);
+        for (int k = 0; k < 60000; k++) {
+            assert(bplus_tree_search(tree, k) == present[k]);
+        }
+        
+        // Mixed with single-key operations afterwards
+        for (int k = 0; k < 60000; k += 7) {
+            if (present[k]) {
+                bool deleted = bplus_tree_delete(tree, k);
+                assert(deleted);
+                expected--;
+            }
+        }
+        assert(count_leaf_chain(tree) == expected);
+        
+        free(present);
+        bplus_tree_destroy(tree);
+    }
+    
+    // One batch that splits a single leaf many times, up through new roots
+    BPlusTree* tree = bplus_tree_create(4);
+    int* keys = malloc(sizeof(int) * 10000);
+    for (int i = 0; i < 10000; i++) {
+        keys[i] = 10000 - i;
+    }
+    size_t added = bplus_tree_insert_batch(tree, keys, 10000);
+    assert(added == 10000);
+    assert(bplus_tree_validate(tree));
+    assert(count_leaf_chain(tree) == 10000);
+    added = bplus_tree_insert_batch(tree, keys, 10000);
+    assert(added == 0);
+    added = bplus_tree_insert_batch(tree, keys, 0);
+    assert(added == 0);
+    free(keys);
+    bplus_tree_destroy(tree);
+    
+    printf("Batch insert tests passed!\n");
+}
+
+void test_search_batch() {
+    printf("Running batch search tests...\n");
+    
+    // Probes cover hits, misses, repeats and a tail shorter than a group
+    int probes[1000];
+    bool found[1000];
+    unsigned seed = 777;
+    for (int i = 0; i < 1000; i++) {
+        seed = seed * 1103515245 + 12345;
+        probes[i] = (int)((seed >> 8) % 30000) - 100;
+    }
+    
+    BPlusTreeOptions packed = { .order = 8, .flags = BPLUS_TREE_PACKED_LEAVES };
+    BPlusTree* trees[] = {
+        bplus_tree_create(4), bplus_tree_create(64),
+        bplus_tree_create_with_options(&packed), bplus_tree_create_concurrent(16)
+    };
+    for (int t = 0; t < 4; t++) {
+        BPlusTree* tree = trees[t];
+        size_t counted = bplus_tree_search_batch(tree, probes, 1000, found);
+        assert(counted == 0);
+        for (int k = 0; k < 30000; k += 3) {
+            bplus_tree_insert(tree, k);
+        }
+        
+        size_t hits = 0;
+        for (int i = 0; i < 1000; i++) {
+            hits += bplus_tree_search(tree, probes[i]);
+        }
+        counted = bplus_tree_search_batch(tree, probes, 997, found);
+        assert(counted == hits -
+               bplus_tree_search(tree, probes[997]) - bplus_tree_search(tree, probes[998]) -
+               bplus_tree_search(tree, probes[999]));
+        counted = bplus_tree_search_batch(tree, probes, 1000, found);
+        assert(counted == hits);
+        for (int i = 0; i < 1000; i++) {
+            assert(found[i] == bplus_tree_search(tree, probes[i]));
+        }
+        counted = bplus_tree_search_batch(tree, probes, 0, found);
+        assert(counted == 0);
+        bplus_tree_destroy(tree);
+    }
+    
+    printf("Batch search tests passed!\n");
+}
+
 void test_operations_suite() {
     printf("Starting operations tests...\n\n");
     
     test_node_operations();
+    test_node_pool();
     test_tree_persistence();
     test_tree_operations();
+    test_bulk_load();
+    test_insert_batch();
+    test_search_batch();
     
     printf("All operations tests passed!\n");
 }
\ No newline at end of file
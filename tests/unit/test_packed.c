@@ -0,0 +1,236 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include "bplus/checkpoint.h"
+#include "bplus/cursor.h"
+#include "bplus/mapped.h"
+#include "bplus/snapshot.h"
+#include "bplus/tree.h"
+#include "bplus/utils.h"
+
+#define PACKED_TEST_FILE "test_packed.img"
+#define PACKED_KEYS 20000
+
+static BPlusTree* create_packed(int order) {
+    BPlusTreeOptions options = { .order = order, .flags = BPLUS_TREE_PACKED_LEAVES };
+    BPlusTree* tree = bplus_tree_create_with_options(&options);
+    assert(tree);
+    return tree;
+}
+
+// Walks the tree with a cursor and compares it with the sorted keys
+static void assert_holds(BPlusTree* tree, const int* sorted, size_t n) {
+    BPlusCursor cursor;
+    int key;
+    size_t seen = 0;
+    bplus_cursor_first(&cursor, tree);
+    while (bplus_cursor_next(&cursor, &key)) {
+        assert(seen < n && key == sorted[seen]);
+        seen++;
+    }
+    assert(seen == n);
+}
+
+static int compare_ints(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+void test_packed_options() {
+    printf("Running packed leaf option tests...\n");
+
+    BPlusTreeOptions options = { .order = 2, .flags = BPLUS_TREE_PACKED_LEAVES };
+    BPlusTree* created = bplus_tree_create_with_options(&options);
+    assert(created == NULL);
+    options = (BPlusTreeOptions){ .order = 8, .flags = 0x80 };
+    created = bplus_tree_create_with_options(&options);
+    assert(created == NULL);
+    created = bplus_tree_create_with_options(NULL);
+    assert(created == NULL);
+
+    // Without the flag the tree is an ordinary one
+    options = (BPlusTreeOptions){ .order = 8, .flags = 0 };
+    BPlusTree* plain = bplus_tree_create_with_options(&options);
+    assert(plain && plain->root->keys != NULL);
+    bplus_tree_destroy(plain);
+
+    // Packed trees do not take snapshots
+    BPlusTree* tree = create_packed(8);
+    assert(tree->root->keys == NULL && tree->root->packed != NULL);
+    BPlusSnapshot* taken = bplus_tree_snapshot(tree);
+    assert(taken == NULL);
+    bplus_tree_destroy(tree);
+
+    printf("Packed leaf option tests passed!\n");
+}
+
+void test_packed_operations() {
+    printf("Running packed leaf operation tests...\n");
+
+    // Dense, sparse and extreme keys; the last set needs 32-bit offsets
+    int* keys = malloc(sizeof(int) * PACKED_KEYS);
+    int* sorted = malloc(sizeof(int) * PACKED_KEYS);
+    int orders[] = { 4, 16, 64 };
+    for (int pattern = 0; pattern < 3; pattern++) {
+        for (int k = 0; k < PACKED_KEYS; k++) {
+            int dense = (k * 7919) % PACKED_KEYS;
+            keys[k] = pattern == 0 ? dense
+                    : pattern == 1 ? dense * 1000 - 5000000
+                    : (dense % 2 ? INT_MAX - dense : INT_MIN + dense);
+            sorted[k] = keys[k];
+        }
+        qsort(sorted, PACKED_KEYS, sizeof(int), compare_ints);
+
+        for (int o = 0; o < 3; o++) {
+            BPlusTree* tree = create_packed(orders[o]);
+            for (int k = 0; k < PACKED_KEYS; k++) {
+                bplus_tree_insert(tree, keys[k]);
+            }
+            assert(bplus_tree_validate(tree));
+            assert_holds(tree, sorted, PACKED_KEYS);
+            for (int k = 0; k < PACKED_KEYS; k += 7) {
+                assert(bplus_tree_search(tree, sorted[k]));
+                if (k > 0 && sorted[k] - 1 != sorted[k - 1]) {
+                    assert(!bplus_tree_search(tree, sorted[k] - 1));
+                }
+            }
+
+            // Seeks land between keys the same way as on plain leaves
+            BPlusCursor cursor;
+            int key;
+            bplus_cursor_seek(&cursor, tree, sorted[100] + 1);
+            bool stepped = bplus_cursor_next(&cursor, &key);
+            assert(stepped && key == sorted[101]);
+            bplus_cursor_seek_upper(&cursor, tree, sorted[100]);
+            stepped = bplus_cursor_prev(&cursor, &key);
+            assert(stepped && key == sorted[100]);
+
+            // Deleting every other key exercises merges and borrowing
+            for (int k = 0; k < PACKED_KEYS; k += 2) {
+                bool deleted = bplus_tree_delete(tree, sorted[k]);
+                assert(deleted);
+            }
+            bool deleted = bplus_tree_delete(tree, sorted[0]);
+            assert(!deleted);
+            assert(bplus_tree_validate(tree));
+            size_t left = 0;
+            for (int k = 1; k < PACKED_KEYS; k += 2) {
+                sorted[left++] = sorted[k];
+            }
+            assert_holds(tree, sorted, left);
+            for (int k = 0; k < PACKED_KEYS; k++) {
+                sorted[k] = keys[k];
+            }
+            qsort(sorted, PACKED_KEYS, sizeof(int), compare_ints);
+            bplus_tree_destroy(tree);
+        }
+    }
+
+    // Batch insertion merges runs into packed leaves
+    BPlusTree* tree = create_packed(16);
+    for (int k = 0; k < PACKED_KEYS; k++) {
+        keys[k] = (k * 7919) % PACKED_KEYS * 3;
+    }
+    size_t added = bplus_tree_insert_batch(tree, keys, PACKED_KEYS / 2);
+    assert(added == PACKED_KEYS / 2);
+    added = bplus_tree_insert_batch(tree, keys, PACKED_KEYS);
+    assert(added == PACKED_KEYS / 2);
+    assert(bplus_tree_validate(tree));
+    for (int k = 0; k < PACKED_KEYS; k++) {
+        sorted[k] = k * 3;
+    }
+    assert_holds(tree, sorted, PACKED_KEYS);
+    bplus_tree_destroy(tree);
+
+    free(keys);
+    free(sorted);
+    printf("Packed leaf operation tests passed!\n");
+}
+
+void test_packed_footprint() {
+    printf("Running packed leaf footprint tests...\n");
+
+    // Dense keys need a few bits each instead of 32
+    BPlusTree* plain = bplus_tree_create(64);
+    BPlusTree* packed = create_packed(64);
+    for (int k = 0; k < PACKED_KEYS; k++) {
+        bplus_tree_insert(plain, k);
+        bplus_tree_insert(packed, k);
+    }
+    size_t plain_bytes = bplus_tree_memory_usage(plain);
+    size_t packed_bytes = bplus_tree_memory_usage(packed);
+    assert(packed_bytes * 2 < plain_bytes);
+
+    // Deleting everything gives the encodings back
+    for (int k = 0; k < PACKED_KEYS; k++) {
+        bplus_tree_delete(packed, k);
+    }
+    assert(bplus_tree_memory_usage(packed) < 256);
+    bplus_tree_destroy(plain);
+    bplus_tree_destroy(packed);
+
+    printf("Packed leaf footprint tests passed!\n");
+}
+
+// Files written from a packed tree hold plain keys
+void test_packed_files() {
+    printf("Running packed leaf file tests...\n");
+    remove(PACKED_TEST_FILE);
+
+    BPlusTree* tree = create_packed(8);
+    int* sorted = malloc(sizeof(int) * PACKED_KEYS);
+    for (int k = 0; k < PACKED_KEYS; k++) {
+        bplus_tree_insert(tree, (k * 7919) % PACKED_KEYS * 5);
+        sorted[k] = k * 5;
+    }
+
+    bool saved = save_tree_state(tree, PACKED_TEST_FILE);
+    assert(saved);
+    BPlusTree* loaded = load_tree_state(PACKED_TEST_FILE);
+    assert(loaded && bplus_tree_validate(loaded));
+    assert_holds(loaded, sorted, PACKED_KEYS);
+    bplus_tree_destroy(loaded);
+    remove(PACKED_TEST_FILE);
+
+    // A delta after the full image carries the re-encoded leaves too
+    saved = bplus_tree_checkpoint(tree, PACKED_TEST_FILE, NULL);
+    assert(saved);
+    for (int k = 0; k < 100; k++) {
+        bplus_tree_delete(tree, k * 5);
+    }
+    saved = bplus_tree_checkpoint(tree, PACKED_TEST_FILE, NULL);
+    assert(saved);
+    loaded = bplus_checkpoint_load(PACKED_TEST_FILE);
+    assert(loaded && bplus_tree_validate(loaded));
+    assert_holds(loaded, sorted + 100, PACKED_KEYS - 100);
+    bplus_tree_destroy(loaded);
+    remove(PACKED_TEST_FILE);
+
+    bool written = bplus_mapped_tree_write(tree, PACKED_TEST_FILE);
+    assert(written);
+    BPlusMappedTree* mapped = bplus_mapped_tree_open(PACKED_TEST_FILE);
+    assert(mapped && bplus_mapped_tree_verify(mapped));
+    assert(bplus_mapped_tree_count(mapped) == PACKED_KEYS - 100);
+    for (int k = 0; k < PACKED_KEYS; k++) {
+        assert(bplus_mapped_tree_search(mapped, k * 5) == (k >= 100));
+    }
+    bplus_mapped_tree_close(mapped);
+    remove(PACKED_TEST_FILE);
+
+    bplus_tree_destroy(tree);
+    free(sorted);
+    printf("Packed leaf file tests passed!\n");
+}
+
+void test_packed_suite() {
+    printf("Starting packed leaf tests...\n\n");
+
+    test_packed_options();
+    test_packed_operations();
+    test_packed_footprint();
+    test_packed_files();
+
+    printf("All packed leaf tests passed!\n");
+}
@@ -6,6 +6,20 @@
 void test_tree_suite(void);
 void test_operations_suite(void);
 void test_cli_suite(void);
+void test_search_suite(void);
+void test_template_suite(void);
+void test_cursor_suite(void);
+void test_concurrent_suite(void);
+void test_snapshot_suite(void);
+void test_storage_suite(void);
+void test_wal_suite(void);
+void test_checkpoint_suite(void);
+void test_mapped_suite(void);
+void test_packed_suite(void);
+void test_frozen_suite(void);
+void test_stats_suite(void);
+void test_json_suite(void);
+void test_journal_suite(void);
 
 int main() {
     printf("\n=== Running All B+ Tree Tests ===\n\n");
@@ -18,6 +32,62 @@ int main() {
     printf("---------------------------\n");
     test_operations_suite();
     
+    printf("\nRunning Search Kernel Tests...\n");
+    printf("-----------------------------\n");
+    test_search_suite();
+    
+    printf("\nRunning Template Tree Tests...\n");
+    printf("-----------------------------\n");
+    test_template_suite();
+    
+    printf("\nRunning Cursor Tests...\n");
+    printf("----------------------\n");
+    test_cursor_suite();
+    
+    printf("\nRunning Concurrent Tests...\n");
+    printf("--------------------------\n");
+    test_concurrent_suite();
+    
+    printf("\nRunning Snapshot Tests...\n");
+    printf("------------------------\n");
+    test_snapshot_suite();
+    
+    printf("\nRunning Storage Tests...\n");
+    printf("-----------------------\n");
+    test_storage_suite();
+    
+    printf("\nRunning WAL Tests...\n");
+    printf("-------------------\n");
+    test_wal_suite();
+    
+    printf("\nRunning Checkpoint Tests...\n");
+    printf("--------------------------\n");
+    test_checkpoint_suite();
+    
+    printf("\nRunning Mapped Tree Tests...\n");
+    printf("---------------------------\n");
+    test_mapped_suite();
+    
+    printf("\nRunning Packed Leaf Tests...\n");
+    printf("---------------------------\n");
+    test_packed_suite();
+    
+    printf("\nRunning Frozen Tree Tests...\n");
+    printf("---------------------------\n");
+    test_frozen_suite();
+    
+    printf("\nRunning Statistics Tests...\n");
+    printf("--------------------------\n");
+    test_stats_suite();
+    
+    printf("\nRunning JSON Writer Tests...\n");
+    printf("---------------------------\n");
+    test_json_suite();
+    
+    printf("\nRunning Journal Tests...\n");
+    printf("-----------------------\n");
+    test_journal_suite();
+    
     printf("\nRunning CLI Tests...\n");
     printf("-------------------\n");
     test_cli_suite();
@@ -0,0 +1,97 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <assert.h>
+#include "bplus/tree.h"
+#include "bplus/search.h"
+
+static const BPlusSearchKernel kernels[] = {
+    BPLUS_SEARCH_SCALAR,
+    BPLUS_SEARCH_BRANCHLESS,
+    BPLUS_SEARCH_SSE2,
+    BPLUS_SEARCH_AVX2
+};
+
+// Reference results straight from the definition
+static int reference_bound(const int* keys, int n, int key, bool or_equal) {
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        if (keys[i] < key || (or_equal && keys[i] == key)) count++;
+    }
+    return count;
+}
+
+void test_search_kernels() {
+    printf("Running search kernel tests...\n");
+    
+    int keys[300];
+    
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (!bplus_search_set_kernel(kernels[k])) {
+            printf("  %s not supported, skipping\n", bplus_search_kernel_name(kernels[k]));
+            continue;
+        }
+        assert(bplus_search_get_kernel() == kernels[k]);
+        
+        // Every length up to 300, probing below, between, on and above keys
+        for (int n = 0; n <= 300; n++) {
+            for (int i = 0; i < n; i++) {
+                keys[i] = i * 3 - 200;
+            }
+            for (int probe = -205; probe <= n * 3 - 195; probe++) {
+                assert(bplus_lower_bound(keys, n, probe) == reference_bound(keys, n, probe, false));
+                assert(bplus_upper_bound(keys, n, probe) == reference_bound(keys, n, probe, true));
+            }
+        }
+        
+        // Extreme keys must not wrap
+        int extremes[] = {INT_MIN, -1, 0, INT_MAX};
+        for (int i = 0; i < 4; i++) {
+            assert(bplus_lower_bound(extremes, 4, extremes[i]) == i);
+            assert(bplus_upper_bound(extremes, 4, extremes[i]) == i + 1);
+        }
+    }
+    
+    bool chosen = bplus_search_set_kernel(BPLUS_SEARCH_AUTO);
+    assert(chosen);
+    assert(bplus_search_get_kernel() != BPLUS_SEARCH_AUTO);
+    
+    printf("Search kernel tests passed!\n");
+}
+
+void test_search_kernels_in_tree() {
+    printf("Running tree search with each kernel...\n");
+    
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        if (!bplus_search_set_kernel(kernels[k])) continue;
+        
+        BPlusTree* tree = bplus_tree_create(64);
+        for (int i = 0; i < 5000; i++) {
+            bplus_tree_insert(tree, (i * 7919) % 5000 * 2);
+        }
+        for (int i = 0; i < 10000; i++) {
+            assert(bplus_tree_search(tree, i) == (i % 2 == 0));
+        }
+        for (int i = 0; i < 10000; i += 4) {
+            bool deleted = bplus_tree_delete(tree, i);
+            assert(deleted);
+        }
+        assert(bplus_tree_validate(tree));
+        for (int i = 0; i < 10000; i += 2) {
+            assert(bplus_tree_search(tree, i) == (i % 4 != 0));
+        }
+        bplus_tree_destroy(tree);
+    }
+    
+    bplus_search_set_kernel(BPLUS_SEARCH_AUTO);
+    printf("Tree search with each kernel passed!\n");
+}
+
+void test_search_suite() {
+    printf("Starting search kernel tests...\n\n");
+    
+    test_search_kernels();
+    test_search_kernels_in_tree();
+    
+    printf("All search kernel tests passed!\n");
+}
@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "bplus/tree.h"
+#include "bplus/cursor.h"
+#include "bplus/snapshot.h"
+
+typedef struct {
+    int* keys;
+    size_t count;
+} KeyList;
+
+static bool collect_key(int key, void* ctx) {
+    KeyList* list = ctx;
+    list->keys[list->count++] = key;
+    return true;
+}
+
+static bool stop_after_ten(int key, void* ctx) {
+    (void)key;
+    return ++*(int*)ctx < 10;
+}
+
+static size_t live_nodes(BPlusTree* tree) {
+    return tree->leaf_pool.in_use + tree->internal_pool.in_use;
+}
+
+static size_t count_nodes(BPlusNode* node) {
+    if (node->is_leaf) return 1;
+    size_t total = 1;
+    for (int i = 0; i <= node->num_keys; i++) {
+        total += count_nodes(node->children[i]);
+    }
+    return total;
+}
+
+void test_snapshot_isolation() {
+    printf("Running snapshot isolation tests...\n");
+    
+    BPlusTree* tree = bplus_tree_create(6);
+    for (int i = 0; i < 2000; i++) {
+        bplus_tree_insert(tree, i * 2);
+    }
+    
+    // The first snapshot sees the even keys, the second one also the odd
+    // keys below 1000, whatever the tree does afterwards
+    BPlusSnapshot* even = bplus_tree_snapshot(tree);
+    for (int i = 1; i < 1000; i += 2) {
+        bplus_tree_insert(tree, i);
+    }
+    BPlusSnapshot* mixed = bplus_tree_snapshot(tree);
+    for (int i = 0; i < 4000; i += 3) {
+        bplus_tree_delete(tree, i);
+    }
+    int extra[] = { -5, 5000, 5001, 7777 };
+    bplus_tree_insert_batch(tree, extra, 4);
+    assert(bplus_tree_validate(tree));
+    
+    int* buf = malloc(sizeof(int) * 5000);
+    KeyList list = { buf, 0 };
+    size_t visited = bplus_snapshot_scan(even, 0, 4000, collect_key, &list);
+    assert(visited == 2000);
+    for (int i = 0; i < 2000; i++) {
+        assert(buf[i] == i * 2);
+    }
+    list.count = 0;
+    visited = bplus_snapshot_scan(mixed, 500, 1500, collect_key, &list);
+    assert(visited == 751);
+    assert(buf[0] == 500 && buf[1] == 501 && buf[499] == 999 && buf[500] == 1000 && buf[750] == 1500);
+    
+    int seen = 0;
+    visited = bplus_snapshot_scan(mixed, 0, 4000, stop_after_ten, &seen);
+    assert(visited == 10);
+    visited = bplus_snapshot_scan(even, 10, 5, collect_key, &list);
+    assert(visited == 0);
+    
+    for (int i = -10; i < 5010; i++) {
+        bool in_even = i >= 0 && i < 4000 && i % 2 == 0;
+        bool in_mixed = in_even || (i > 0 && i < 1000 && i % 2 == 1);
+        bool in_live = (in_mixed && i % 3 != 0) || i == -5 || i == 5000 || i == 5001;
+        assert(bplus_snapshot_search(even, i) == in_even);
+        assert(bplus_snapshot_search(mixed, i) == in_mixed);
+        assert(bplus_tree_search(tree, i) == in_live);
+    }
+    
+    // The live leaf chain is intact in both directions
+    BPlusCursor cursor;
+    int key, count = 0, last = -100;
+    bplus_cursor_first(&cursor, tree);
+    while (bplus_cursor_next(&cursor, &key)) {
+        assert(key > last);
+        last = key;
+        count++;
+    }
+    while (bplus_cursor_prev(&cursor, &key)) {
+        count--;
+    }
+    assert(count == 0);
+    
+    // Once every snapshot is released, later writes reclaim the old nodes
+    bplus_snapshot_retain(even);
+    bplus_snapshot_release(even);
+    assert(bplus_snapshot_search(even, 2));
+    bplus_snapshot_release(even);
+    bplus_snapshot_release(mixed);
+    for (int i = 0; i < 1000; i++) {
+        bplus_tree_delete(tree, -1);
+    }
+    assert(live_nodes(tree) == count_nodes(tree->root));
+    
+    free(buf);
+    bplus_tree_destroy(tree);
+    printf("Snapshot isolation tests passed!\n");
+}
+
+typedef struct {
+    BPlusSnapshot* snapshot;
+    int failures;
+} ReaderArgs;
+
+static bool count_key(int key, void* ctx) {
+    (void)key;
+    (*(size_t*)ctx)++;
+    return true;
+}
+
+// Scans the snapshot repeatedly while the main thread keeps writing
+static void* snapshot_reader(void* arg) {
+    ReaderArgs* args = arg;
+    for (int round = 0; round < 50; round++) {
+        size_t count = 0;
+        if (bplus_snapshot_scan(args->snapshot, 0, 1 << 30, count_key, &count) != 5000) args->failures++;
+        if (!bplus_snapshot_search(args->snapshot, 4999)) args->failures++;
+    }
+    bplus_snapshot_release(args->snapshot);
+    return NULL;
+}
+
+void test_snapshot_concurrent_readers() {
+    printf("Running snapshot reader tests...\n");
+    
+    BPlusTree* tree = bplus_tree_create(8);
+    for (int i = 0; i < 5000; i++) {
+        bplus_tree_insert(tree, i);
+    }
+    
+    BPlusSnapshot* snapshot = bplus_tree_snapshot(tree);
+    ReaderArgs args[2];
+    pthread_t threads[2];
+    for (int t = 0; t < 2; t++) {
+        args[t].snapshot = bplus_snapshot_retain(snapshot);
+        args[t].failures = 0;
+        pthread_create(&threads[t], NULL, snapshot_reader, &args[t]);
+    }
+    bplus_snapshot_release(snapshot);
+    
+    for (int i = 0; i < 5000; i++) {
+        bplus_tree_delete(tree, i);
+        bplus_tree_insert(tree, 10000 + i);
+    }
+    for (int t = 0; t < 2; t++) {
+        pthread_join(threads[t], NULL);
+        assert(args[t].failures == 0);
+    }
+    assert(bplus_tree_validate(tree));
+    
+    bplus_tree_destroy(tree);
+    printf("Snapshot reader tests passed!\n");
+}
+
+// Rebalancing copies the nodes it repairs like any other write
+void test_snapshot_lazy_delete() {
+    printf("Running snapshot lazy delete tests...\n");
+    
+    BPlusTreeOptions options = { .order = 8, .flags = BPLUS_TREE_LAZY_DELETE };
+    BPlusTree* tree = bplus_tree_create_with_options(&options);
+    for (int i = 0; i < 4000; i++) {
+        bplus_tree_insert(tree, i);
+    }
+    BPlusSnapshot* full = bplus_tree_snapshot(tree);
+    for (int i = 0; i < 4000; i++) {
+        if (i % 8) bplus_tree_delete(tree, i);
+    }
+    BPlusSnapshot* sparse = bplus_tree_snapshot(tree);
+    while (bplus_tree_rebalance(tree, 32) == 32) {
+    }
+    assert(bplus_tree_validate(tree));
+    
+    size_t count = 0;
+    size_t visited = bplus_snapshot_scan(full, 0, 4000, count_key, &count);
+    assert(visited == 4000);
+    count = 0;
+    visited = bplus_snapshot_scan(sparse, 0, 4000, count_key, &count);
+    assert(visited == 500);
+    for (int i = 0; i < 4000; i++) {
+        assert(bplus_tree_search(tree, i) == (i % 8 == 0));
+        assert(bplus_snapshot_search(sparse, i) == (i % 8 == 0));
+    }
+    bplus_snapshot_release(full);
+    bplus_snapshot_release(sparse);
+    bplus_tree_destroy(tree);
+    printf("Snapshot lazy delete tests passed!\n");
+}
+
+void test_snapshot_suite() {
+    printf("Starting snapshot tests...\n\n");
+    
+    test_snapshot_isolation();
+    test_snapshot_concurrent_readers();
+    test_snapshot_lazy_delete();
+    
+    printf("All snapshot tests passed!\n");
+}
@@ -0,0 +1,243 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include "bplus/checkpoint.h"
+#include "bplus/concurrent.h"
+#include "bplus/stats.h"
+#include "bplus/tree.h"
+#include "bplus/utils.h"
+
+#define STATS_TEST_FILE "test_stats.img"
+#define STATS_THREADS 4
+#define STATS_KEYS 40000
+
+// The figures bplus_tree_stats keeps incrementally, counted the slow way
+static void assert_matches_walk(BPlusTree* tree) {
+    BPlusTreeStats stats;
+    bool collected = bplus_tree_stats(tree, &stats);
+    assert(collected);
+
+    int height = 1;
+    BPlusNode* leaf = tree->root;
+    while (!leaf->is_leaf) {
+        leaf = leaf->children[0];
+        height++;
+    }
+    size_t keys = 0;
+    size_t leaves = 0;
+    for (; leaf; leaf = leaf->next) {
+        keys += (size_t)leaf->num_keys;
+        leaves++;
+    }
+    assert(stats.keys == keys);
+    assert(stats.height == height);
+    assert(stats.leaves == leaves);
+    assert(stats.memory_bytes == bplus_tree_memory_usage(tree));
+    assert(stats.fill > 0 && stats.fill <= 1.0);
+}
+
+void test_stats_structure() {
+    printf("Running structural statistics tests...\n");
+
+    bool collected = bplus_tree_stats(NULL, NULL);
+    assert(!collected);
+    BPlusTree* tree = bplus_tree_create(8);
+    BPlusTreeStats stats;
+    collected = bplus_tree_stats(tree, &stats);
+    assert(collected);
+    assert(stats.keys == 0 && stats.height == 1 && stats.leaves == 1 && stats.internal_nodes == 0);
+
+    // Single inserts, duplicates, appends, deletes and batches
+    for (int i = 0; i < 5000; i++) {
+        bplus_tree_insert(tree, (i * 7919) % 5000);
+        bplus_tree_insert(tree, (i * 7919) % 5000);
+    }
+    for (int i = 5000; i < 8000; i++) {
+        bplus_tree_insert(tree, i);
+    }
+    assert_matches_walk(tree);
+    for (int i = 0; i < 8000; i += 3) {
+        bplus_tree_delete(tree, i);
+        bplus_tree_delete(tree, i);
+    }
+    assert_matches_walk(tree);
+    int batch[3000];
+    for (int i = 0; i < 3000; i++) {
+        batch[i] = i * 4;
+    }
+    bplus_tree_insert_batch(tree, batch, 3000);
+    assert_matches_walk(tree);
+
+    // Trees that are built rather than grown
+    bool saved = save_tree_state(tree, STATS_TEST_FILE);
+    assert(saved);
+    BPlusTree* loaded = load_tree_state(STATS_TEST_FILE);
+    assert_matches_walk(loaded);
+    bplus_tree_destroy(loaded);
+    remove(STATS_TEST_FILE);
+    saved = bplus_tree_checkpoint(tree, STATS_TEST_FILE, NULL);
+    assert(saved);
+    loaded = bplus_checkpoint_load(STATS_TEST_FILE);
+    assert_matches_walk(loaded);
+    bplus_tree_destroy(loaded);
+    remove(STATS_TEST_FILE);
+    bplus_tree_destroy(tree);
+
+    tree = bplus_tree_bulk_load(16, batch, 3000, 0.5);
+    assert_matches_walk(tree);
+    bplus_tree_stats(tree, &stats);
+    assert(stats.fill > 0.45 && stats.fill < 0.6);
+    bplus_tree_destroy(tree);
+
+    printf("Structural statistics tests passed!\n");
+}
+
+void test_stats_counters() {
+    printf("Running operation counter tests...\n");
+
+    BPlusTree* tree = bplus_tree_create(8);
+    BPlusTreeStats stats;
+    bplus_tree_stats(tree, &stats);
+    if (!stats.counters_enabled) {
+        printf("Operation counters are compiled out; skipped\n");
+        bplus_tree_destroy(tree);
+        return;
+    }
+
+    for (int i = 0; i < 4000; i++) {
+        bplus_tree_insert(tree, (i * 7919) % 4000);
+    }
+    bplus_tree_stats(tree, &stats);
+    assert(stats.counters.inserts == 4000 && stats.counters.splits > 0);
+    // Each split adds a node, and so does each new root
+    assert(stats.counters.splits == stats.leaves + stats.internal_nodes - (size_t)stats.height);
+
+    // Every lookup reads one node per level
+    bplus_tree_reset_counters(tree);
+    for (int i = 0; i < 1000; i++) {
+        bplus_tree_search(tree, i);
+    }
+    bool found[100];
+    int probes[100];
+    for (int i = 0; i < 100; i++) {
+        probes[i] = i * 40;
+    }
+    bplus_tree_search_batch(tree, probes, 100, found);
+    bplus_tree_stats(tree, &stats);
+    assert(stats.counters.searches == 1100 && stats.counters.inserts == 0);
+    assert(stats.counters.node_visits == 1100 * (uint64_t)stats.height);
+
+    for (int i = 0; i < 4000; i += 2) {
+        bplus_tree_delete(tree, i);
+    }
+    bplus_tree_stats(tree, &stats);
+    assert(stats.counters.deletes == 2000);
+    assert(stats.counters.merges + stats.counters.redistributions > 0);
+    bplus_tree_destroy(tree);
+
+    printf("Operation counter tests passed!\n");
+}
+
+typedef struct {
+    BPlusTree* tree;
+    int id;
+} StatsWorker;
+
+static void* stats_worker(void* arg) {
+    StatsWorker* w = arg;
+    for (int k = w->id; k < STATS_KEYS; k += STATS_THREADS) {
+        bplus_tree_insert(w->tree, k);
+    }
+    for (int k = w->id; k < STATS_KEYS; k += 2 * STATS_THREADS) {
+        bplus_tree_delete(w->tree, k);
+        bplus_tree_search(w->tree, k);
+    }
+    return NULL;
+}
+
+// Concurrent trees keep their tallies per thread slot
+void test_stats_concurrent() {
+    printf("Running concurrent statistics tests...\n");
+
+    BPlusTree* tree = bplus_tree_create_concurrent(16);
+    pthread_t threads[STATS_THREADS];
+    StatsWorker workers[STATS_THREADS];
+    for (int t = 0; t < STATS_THREADS; t++) {
+        workers[t] = (StatsWorker){ tree, t };
+        pthread_create(&threads[t], NULL, stats_worker, &workers[t]);
+    }
+    for (int t = 0; t < STATS_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    BPlusTreeStats stats;
+    bool collected = bplus_tree_stats(tree, &stats);
+    assert(collected);
+    assert(stats.keys == STATS_KEYS / 2);
+    if (stats.counters_enabled) {
+        assert(stats.counters.inserts == STATS_KEYS);
+        assert(stats.counters.deletes == STATS_KEYS / 2);
+        assert(stats.counters.searches == STATS_KEYS / 2);
+        assert(stats.counters.splits > 0);
+        assert(stats.counters.node_visits >= 2 * STATS_KEYS);
+        bplus_tree_reset_counters(tree);
+        bplus_tree_stats(tree, &stats);
+        assert(stats.counters.inserts == 0 && stats.counters.node_visits == 0);
+        assert(stats.keys == STATS_KEYS / 2);
+    }
+    bplus_tree_destroy(tree);
+
+    printf("Concurrent statistics tests passed!\n");
+}
+
+static void* stats_reader(void* arg) {
+    BPlusTree* tree = arg;
+    for (int k = 0; k < STATS_KEYS; k++) {
+        bplus_tree_search(tree, k);
+    }
+    return NULL;
+}
+
+// Lookups on a plain tree shared by readers count without a data race
+void test_stats_shared_readers() {
+    printf("Running shared reader statistics tests...\n");
+
+    BPlusTree* tree = bplus_tree_create(16);
+    for (int k = 0; k < STATS_KEYS; k++) {
+        bplus_tree_insert(tree, k);
+    }
+    bplus_tree_reset_counters(tree);
+    pthread_t threads[STATS_THREADS];
+    for (int t = 0; t < STATS_THREADS; t++) {
+        pthread_create(&threads[t], NULL, stats_reader, tree);
+    }
+    for (int t = 0; t < STATS_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    BPlusTreeStats stats;
+    bool ok = bplus_tree_stats(tree, &stats);
+    assert(ok);
+    if (stats.counters_enabled) {
+        assert(stats.counters.searches == (uint64_t)STATS_THREADS * STATS_KEYS);
+        assert(stats.counters.node_visits == stats.counters.searches * (uint64_t)stats.height);
+        bplus_tree_reset_counters(tree);
+        bplus_tree_stats(tree, &stats);
+        assert(stats.counters.searches == 0 && stats.counters.node_visits == 0);
+    }
+    bplus_tree_destroy(tree);
+
+    printf("Shared reader statistics tests passed!\n");
+}
+
+void test_stats_suite() {
+    printf("Starting statistics tests...\n\n");
+
+    test_stats_structure();
+    test_stats_counters();
+    test_stats_concurrent();
+    test_stats_shared_readers();
+
+    printf("All statistics tests passed!\n");
+}
@@ -0,0 +1,283 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "bplus/buffer_pool.h"
+#include "bplus/disk_tree.h"
+#include "bplus/pager.h"
+
+#define STORAGE_TEST_FILE "test_storage.db"
+
+static bool sum_key(int key, void* ctx) {
+    *(long long*)ctx += key;
+    return true;
+}
+
+void test_pager() {
+    printf("Running pager tests...\n");
+    remove(STORAGE_TEST_FILE);
+    
+    BPlusPager* opened = bplus_pager_open(STORAGE_TEST_FILE, 1000);
+    assert(opened == NULL);
+    opened = bplus_pager_open(STORAGE_TEST_FILE, 64);
+    assert(opened == NULL);
+    
+    BPlusPager* pager = bplus_pager_open(STORAGE_TEST_FILE, 512);
+    assert(pager && pager->header.page_size == 512 && pager->header.page_count == 1);
+    
+    char page[512] = "hello";
+    BPlusPageId a = bplus_pager_alloc(pager);
+    BPlusPageId b = bplus_pager_alloc(pager);
+    assert(a == 1 && b == 2);
+    bool written = bplus_pager_write(pager, a, page);
+    assert(written);
+    written = bplus_pager_write(pager, BPLUS_NO_PAGE, page);
+    assert(!written);
+    bool read_back = bplus_pager_read(pager, 7, page);
+    assert(!read_back);
+    
+    // Freed pages come back before the file grows
+    bool freed = bplus_pager_free(pager, a);
+    assert(freed);
+    BPlusPageId next = bplus_pager_alloc(pager);
+    assert(next == a);
+    next = bplus_pager_alloc(pager);
+    assert(next == 3);
+    bool closed = bplus_pager_close(pager);
+    assert(closed);
+    
+    // The page size of an existing file wins over the requested one
+    pager = bplus_pager_open(STORAGE_TEST_FILE, 4096);
+    assert(pager && pager->header.page_size == 512 && pager->header.page_count == 4);
+    closed = bplus_pager_close(pager);
+    assert(closed);
+    
+    FILE* fp = fopen(STORAGE_TEST_FILE, "wb");
+    fputs("not a page file", fp);
+    fclose(fp);
+    opened = bplus_pager_open(STORAGE_TEST_FILE, 0);
+    assert(opened == NULL);
+    
+    remove(STORAGE_TEST_FILE);
+    printf("Pager tests passed!\n");
+}
+
+void test_disk_tree() {
+    printf("Running disk tree tests...\n");
+    remove(STORAGE_TEST_FILE);
+    
+    // Small pages give a deep tree from few keys
+    BPlusDiskTree* tree = bplus_disk_tree_open(STORAGE_TEST_FILE, 128, 0);
+    assert(tree && tree->leaf_capacity == 30 && tree->internal_capacity == 14);
+    for (int i = 0; i < 20000; i++) {
+        bool inserted = bplus_disk_tree_insert(tree, (int)(((unsigned)i * 7919u) % 20000u));
+        assert(inserted);
+    }
+    bool inserted = bplus_disk_tree_insert(tree, 42);
+    assert(!inserted);
+    assert(bplus_disk_tree_count(tree) == 20000);
+    assert(bplus_disk_tree_validate(tree));
+    
+    // A lookup touches exactly the pages on its path and writes nothing
+    uint32_t height = tree->pager->header.height;
+    assert(height >= 3);
+    uint64_t touched = tree->pool->hits + tree->pool->misses;
+    uint64_t writes = tree->pager->writes;
+    bool found = bplus_disk_tree_search(tree, 12345);
+    assert(found);
+    found = bplus_disk_tree_search(tree, 20000);
+    assert(!found);
+    assert(tree->pool->hits + tree->pool->misses - touched == 2 * (height + 1));
+    assert(tree->pager->writes == writes);
+    bool closed = bplus_disk_tree_close(tree);
+    assert(closed);
+    
+    // Everything survives a reopen
+    tree = bplus_disk_tree_open(STORAGE_TEST_FILE, 0, 0);
+    assert(tree && bplus_disk_tree_count(tree) == 20000);
+    assert(bplus_disk_tree_validate(tree));
+    for (int i = -5; i < 20005; i++) {
+        found = bplus_disk_tree_search(tree, i);
+        assert(found == (i >= 0 && i < 20000));
+    }
+    long long sum = 0;
+    size_t visited = bplus_disk_tree_scan(tree, 100, 199, sum_key, &sum);
+    assert(visited == 100);
+    assert(sum == 14950);
+    
+    // Deleting frees emptied leaves, and later inserts reuse those pages
+    for (int i = 0; i < 20000; i++) {
+        if (i % 4 == 0) continue;
+        bool deleted = bplus_disk_tree_delete(tree, i);
+        assert(deleted);
+    }
+    bool deleted = bplus_disk_tree_delete(tree, 1);
+    assert(!deleted);
+    assert(bplus_disk_tree_validate(tree));
+    for (int i = 0; i < 20000; i += 4) {
+        deleted = bplus_disk_tree_delete(tree, i);
+        assert(deleted);
+    }
+    assert(bplus_disk_tree_count(tree) == 0);
+    assert(tree->pager->header.height == 0);
+    assert(bplus_disk_tree_validate(tree));
+    
+    uint32_t pages = tree->pager->header.page_count;
+    for (int i = 0; i < 5000; i++) {
+        inserted = bplus_disk_tree_insert(tree, i);
+        assert(inserted);
+    }
+    assert(bplus_disk_tree_validate(tree));
+    assert(tree->pager->header.page_count == pages);
+    sum = 0;
+    visited = bplus_disk_tree_scan(tree, 4990, 30000, sum_key, &sum);
+    assert(visited == 10);
+    closed = bplus_disk_tree_close(tree);
+    assert(closed);
+    
+    remove(STORAGE_TEST_FILE);
+    printf("Disk tree tests passed!\n");
+}
+
+static void check_buffer_pool(BPlusEvictionPolicy policy) {
+    remove(STORAGE_TEST_FILE);
+    
+    BPlusPager* pager = bplus_pager_open(STORAGE_TEST_FILE, 128);
+    for (int i = 0; i < 64; i++) {
+        BPlusPageId id = bplus_pager_alloc(pager);
+        assert(id == (BPlusPageId)(i + 1));
+    }
+    BPlusBufferPool* pool = bplus_buffer_pool_create(pager, 4, policy);
+    
+    // Fresh pages are written back when evicted
+    for (BPlusPageId id = 1; id <= 64; id++) {
+        uint8_t* data = bplus_buffer_pool_pin_new(pool, id);
+        assert(data && data[0] == 0);
+        data[0] = (uint8_t)id;
+        bplus_buffer_pool_unpin(pool, id, true);
+    }
+    assert(pool->misses == 64 && pool->evictions == 60);
+    
+    // Hits do no I/O; misses read back what was written
+    uint64_t reads = pager->reads;
+    uint8_t* data = bplus_buffer_pool_pin(pool, 64);
+    assert(data && data[0] == 64 && pager->reads == reads);
+    bplus_buffer_pool_unpin(pool, 64, false);
+    for (BPlusPageId id = 1; id <= 64; id++) {
+        data = bplus_buffer_pool_pin(pool, id);
+        assert(data && data[0] == (uint8_t)id);
+        bplus_buffer_pool_unpin(pool, id, false);
+    }
+    assert(pool->hits >= 1 && pager->reads > reads);
+    
+    // With every frame pinned nothing can be evicted
+    for (BPlusPageId id = 1; id <= 4; id++) {
+        uint8_t* pinned = bplus_buffer_pool_pin(pool, id);
+        assert(pinned);
+    }
+    uint8_t* pinned = bplus_buffer_pool_pin(pool, 5);
+    assert(pinned == NULL);
+    bplus_buffer_pool_unpin(pool, 2, false);
+    pinned = bplus_buffer_pool_pin(pool, 5);
+    assert(pinned);
+    
+    // A discarded page is dropped without being written back
+    data = bplus_buffer_pool_pin(pool, 1);
+    data[0] = 99;
+    bplus_buffer_pool_unpin(pool, 1, true);
+    bplus_buffer_pool_unpin(pool, 1, false);
+    bplus_buffer_pool_discard(pool, 1);
+    bool flushed = bplus_buffer_pool_flush(pool);
+    assert(flushed);
+    uint8_t page[128];
+    bool read_back = bplus_pager_read(pager, 1, page);
+    assert(read_back && page[0] == 1);
+    
+    flushed = bplus_buffer_pool_destroy(pool);
+    assert(flushed);
+    bool closed = bplus_pager_close(pager);
+    assert(closed);
+    remove(STORAGE_TEST_FILE);
+}
+
+void test_buffer_pool() {
+    printf("Running buffer pool tests...\n");
+    
+    check_buffer_pool(BPLUS_EVICT_CLOCK);
+    check_buffer_pool(BPLUS_EVICT_LRU2);
+    
+    // LRU-2 evicts pages seen once before pages seen twice
+    remove(STORAGE_TEST_FILE);
+    BPlusPager* pager = bplus_pager_open(STORAGE_TEST_FILE, 128);
+    for (int i = 0; i < 8; i++) {
+        bplus_pager_alloc(pager);
+    }
+    BPlusBufferPool* pool = bplus_buffer_pool_create(pager, 3, BPLUS_EVICT_LRU2);
+    BPlusPageId order[] = { 1, 1, 2, 3, 4, 5, 6, 1 };
+    for (int i = 0; i < 8; i++) {
+        uint8_t* pinned = bplus_buffer_pool_pin_new(pool, order[i]);
+        assert(pinned);
+        bplus_buffer_pool_unpin(pool, order[i], true);
+    }
+    assert(pool->hits == 2);
+    bool flushed = bplus_buffer_pool_destroy(pool);
+    assert(flushed);
+    bool closed = bplus_pager_close(pager);
+    assert(closed);
+    remove(STORAGE_TEST_FILE);
+    
+    printf("Buffer pool tests passed!\n");
+}
+
+void test_disk_tree_cache() {
+    printf("Running disk tree cache tests...\n");
+    remove(STORAGE_TEST_FILE);
+    
+    // Far more pages than frames: random lookups still find the top two
+    // levels resident, so at most the bottom two levels miss
+    BPlusDiskTree* tree = bplus_disk_tree_open(STORAGE_TEST_FILE, 128, 32);
+    for (int i = 0; i < 20000; i++) {
+        bool inserted = bplus_disk_tree_insert(tree, (int)(((unsigned)i * 7919u) % 20000u));
+        assert(inserted);
+    }
+    assert(tree->pager->header.page_count > 500 && tree->pager->header.height == 3);
+    
+    unsigned seed = 7;
+    for (int i = 0; i < 1000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        bplus_disk_tree_search(tree, (int)((seed >> 8) % 20000));
+    }
+    uint64_t misses = tree->pool->misses;
+    uint64_t hits = tree->pool->hits;
+    for (int i = 0; i < 1000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        bool found = bplus_disk_tree_search(tree, (int)((seed >> 8) % 20000));
+        assert(found);
+    }
+    assert(tree->pool->misses - misses <= 2000);
+    assert(tree->pool->hits - hits >= 2000);
+    
+    assert(bplus_disk_tree_validate(tree));
+    bool closed = bplus_disk_tree_close(tree);
+    assert(closed);
+    
+    // Evicted and flushed pages add up to the same tree
+    tree = bplus_disk_tree_open(STORAGE_TEST_FILE, 0, 0);
+    assert(bplus_disk_tree_count(tree) == 20000);
+    assert(bplus_disk_tree_validate(tree));
+    closed = bplus_disk_tree_close(tree);
+    assert(closed);
+    
+    remove(STORAGE_TEST_FILE);
+    printf("Disk tree cache tests passed!\n");
+}
+
+void test_storage_suite() {
+    printf("Starting storage tests...\n\n");
+    
+    test_pager();
+    test_buffer_pool();
+    test_disk_tree();
+    test_disk_tree_cache();
+    
+    printf("All storage tests passed!\n");
+}
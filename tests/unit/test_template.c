@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <assert.h>
+#include "bplus/tree_template.h"
+
+BPLUS_DEFINE_TREE(tree_i32_o3, int, 3)
+BPLUS_DEFINE_TREE(tree_u32_o4, uint32_t, 4)
+BPLUS_DEFINE_TREE(tree_i64_o64, int64_t, 64)
+BPLUS_DEFINE_TREE(tree_u64_o256, uint64_t, 256)
+
+// Exercises one instance against a presence table: random inserts, a
+// duplicate pass, deletes of every other key, and a check that the leaf
+// chain is sorted and holds exactly `count` keys.
+#define CHECK_TEMPLATE_TREE(name, KEY, BASE, N)                                  \
+    do {                                                                         \
+        name##_tree* tree = name##_create();                                     \
+        assert(tree != NULL);                                                    \
+        bool* present = calloc((N), sizeof(bool));                               \
+        for (int i = 0; i < (N); i++) {                                          \
+            int k = (int)(((long)i * 7919) % (N));                               \
+            bool inserted = name##_insert(tree, (KEY)(BASE) + (KEY)k);           \
+            assert(inserted);                                                    \
+            present[k] = true;                                                   \
+        }                                                                        \
+        assert(tree->count == (size_t)(N));                                      \
+        bool inserted = name##_insert(tree, (KEY)(BASE));                        \
+        assert(!inserted);                                                       \
+        for (int k = 0; k < (N); k += 2) {                                       \
+            bool deleted = name##_delete(tree, (KEY)(BASE) + (KEY)k);            \
+            assert(deleted);                                                     \
+            present[k] = false;                                                  \
+        }                                                                        \
+        bool deleted = name##_delete(tree, (KEY)(BASE));                         \
+        assert(!deleted);                                                        \
+        for (int k = 0; k < (N); k++) {                                          \
+            assert(name##_search(tree, (KEY)(BASE) + (KEY)k) == present[k]);     \
+        }                                                                        \
+        name##_node* leaf = tree->root;                                          \
+        while (!leaf->is_leaf) leaf = leaf->children[0];                         \
+        size_t seen = 0;                                                         \
+        KEY last = 0;                                                            \
+        for (; leaf; leaf = leaf->next) {                                        \
+            for (int i = 0; i < leaf->num_keys; i++, seen++) {                   \
+                assert(seen == 0 || leaf->keys[i] > last);                       \
+                last = leaf->keys[i];                                            \
+            }                                                                    \
+        }                                                                        \
+        assert(seen == tree->count);                                             \
+        for (int k = 1; k < (N); k += 2) {                                       \
+            deleted = name##_delete(tree, (KEY)(BASE) + (KEY)k);                 \
+            assert(deleted);                                                     \
+        }                                                                        \
+        assert(tree->count == 0 && tree->root->is_leaf);                         \
+        assert(tree->leaf_pool.in_use == 1 && tree->internal_pool.in_use == 0);  \
+        free(present);                                                           \
+        name##_destroy(tree);                                                    \
+    } while (0)
+
+void test_template_instances() {
+    printf("Running template tree tests...\n");
+    
+    CHECK_TEMPLATE_TREE(tree_i32_o3, int, -5000, 10000);
+    CHECK_TEMPLATE_TREE(tree_u32_o4, uint32_t, 4000000000u, 10000);
+    CHECK_TEMPLATE_TREE(tree_i64_o64, int64_t, -(INT64_C(1) << 40), 50000);
+    CHECK_TEMPLATE_TREE(tree_u64_o256, uint64_t, UINT64_C(1) << 63, 50000);
+    
+    printf("Template tree tests passed!\n");
+}
+
+void test_template_node_layout() {
+    printf("Running template node layout tests...\n");
+    
+    // Leaves leave out the children array; every block is whole cache lines
+    assert(tree_i64_o64_node_size(true) < tree_i64_o64_node_size(false));
+    assert(tree_i64_o64_node_size(true) % BPLUS_CACHE_LINE == 0);
+    assert(tree_u32_o4_node_size(false) % BPLUS_CACHE_LINE == 0);
+    assert(sizeof(((tree_u64_o256_node*)0)->keys) == 255 * sizeof(uint64_t));
+    
+    printf("Template node layout tests passed!\n");
+}
+
+void test_template_suite() {
+    printf("Starting template tree tests...\n\n");
+    
+    test_template_node_layout();
+    test_template_instances();
+    
+    printf("All template tree tests passed!\n");
+}
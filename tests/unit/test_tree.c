@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <assert.h>
 #include "bplus/tree.h"
+#include "bplus/utils.h"
 
 // Helper function to print tree state
 void print_tree_state(BPlusTree* tree) {
@@ -56,8 +57,10 @@ void test_basic_insertion() {
     
     // Test multiple insertions
     printf("Inserting values 20 and 5...\n");
-    assert(bplus_tree_insert(tree, 20) && "Failed to insert value 20");
-    assert(bplus_tree_insert(tree, 5) && "Failed to insert value 5");
+    bool inserted = bplus_tree_insert(tree, 20);
+    assert(inserted && "Failed to insert value 20");
+    inserted = bplus_tree_insert(tree, 5);
+    assert(inserted && "Failed to insert value 5");
     
     // Verify all values are searchable
     printf("Verifying searches...\n");
@@ -130,17 +133,21 @@ void test_deletion() {
     
     // Test basic deletion
     printf("Testing deletion of value 30...\n");
-    assert(bplus_tree_delete(tree, 30) && "Failed to delete value 30");
+    bool deleted = bplus_tree_delete(tree, 30);
+    assert(deleted && "Failed to delete value 30");
     assert(!bplus_tree_search(tree, 30) && "Value 30 still present after deletion");
     
     // Test deleting non-existent value
     printf("Testing deletion of non-existent value 35...\n");
-    assert(!bplus_tree_delete(tree, 35) && "Deletion of non-existent value returned true");
+    deleted = bplus_tree_delete(tree, 35);
+    assert(!deleted && "Deletion of non-existent value returned true");
     
     // Test deleting first and last values
     printf("Testing deletion of first and last values (10, 50)...\n");
-    assert(bplus_tree_delete(tree, 10) && "Failed to delete value 10");
-    assert(bplus_tree_delete(tree, 50) && "Failed to delete value 50");
+    deleted = bplus_tree_delete(tree, 10);
+    assert(deleted && "Failed to delete value 10");
+    deleted = bplus_tree_delete(tree, 50);
+    assert(deleted && "Failed to delete value 50");
     
     // Verify remaining values
     printf("Verifying remaining values...\n");
@@ -151,6 +158,379 @@ void test_deletion() {
     printf("Deletion tests passed!\n");
 }
 
+// Counts the leaves and the keys they hold
+static size_t count_leaves(BPlusTree* tree, size_t* keys) {
+    BPlusNode* leaf = tree->root;
+    while (!leaf->is_leaf) {
+        leaf = leaf->children[0];
+    }
+    size_t leaves = 0;
+    *keys = 0;
+    for (; leaf; leaf = leaf->next) {
+        leaves++;
+        *keys += (size_t)leaf->num_keys;
+    }
+    return leaves;
+}
+
+void test_odd_orders() {
+    printf("\nRunning odd order tests...\n");
+    
+    // Splitting an overfull node leaves both halves at the minimum or more,
+    // whatever the parity of the order
+    int orders[] = {3, 5, 7, 9, 4};
+    for (int o = 0; o < 5; o++) {
+        BPlusTree* tree = bplus_tree_create(orders[o]);
+        for (int i = 0; i < 3000; i++) {
+            bool inserted = bplus_tree_insert(tree, (i * 7919) % 3000);
+            assert(inserted);
+            if (i % 250 == 0) assert(bplus_tree_validate(tree));
+        }
+        assert(bplus_tree_validate(tree));
+        for (int i = 0; i < 3000; i += 2) {
+            bool deleted = bplus_tree_delete(tree, (i * 4327) % 3000);
+            assert(deleted);
+            if (i % 250 == 0) assert(bplus_tree_validate(tree));
+        }
+        assert(bplus_tree_validate(tree));
+        size_t keys;
+        count_leaves(tree, &keys);
+        assert(keys == 1500);
+        bplus_tree_destroy(tree);
+    }
+    
+    printf("Odd order tests passed!\n");
+}
+
+void test_set_semantics() {
+    printf("\nRunning set semantics tests...\n");
+    
+    BPlusTree* tree = bplus_tree_create(4);
+    for (int i = 0; i < 100; i++) {
+        bool inserted = bplus_tree_insert(tree, i);
+        assert(inserted);
+    }
+    for (int i = 0; i < 100; i++) {
+        bool inserted = bplus_tree_insert(tree, i);
+        assert(!inserted);
+    }
+    size_t keys;
+    count_leaves(tree, &keys);
+    assert(keys == 100);
+    
+    // Deleted keys can stay behind as separators; re-inserting one must
+    // route it right of the separator, where searches look for it
+    for (int i = 0; i < 100; i += 3) {
+        bool deleted = bplus_tree_delete(tree, i);
+        assert(deleted);
+    }
+    for (int i = 0; i < 100; i += 3) {
+        bool inserted = bplus_tree_insert(tree, i);
+        assert(inserted);
+        assert(bplus_tree_search(tree, i));
+    }
+    assert(bplus_tree_validate(tree));
+    count_leaves(tree, &keys);
+    assert(keys == 100);
+    bplus_tree_destroy(tree);
+    
+    printf("Set semantics tests passed!\n");
+}
+
+void test_split_policy() {
+    printf("\nRunning split policy tests...\n");
+    
+    BPlusTreeOptions bad = { .order = 8, .split = (BPlusSplitPolicy)7 };
+    BPlusTree* created = bplus_tree_create_with_options(&bad);
+    assert(created == NULL);
+    
+    // Ascending keys fill leaves to about half with even splits and to
+    // about 90% with sequential ones
+    BPlusTreeOptions options = { .order = 64, .split = BPLUS_SPLIT_SEQUENTIAL };
+    BPlusTree* even = bplus_tree_create(64);
+    BPlusTree* sequential = bplus_tree_create_with_options(&options);
+    for (int i = 0; i < 100000; i++) {
+        bplus_tree_insert(even, i);
+        bplus_tree_insert(sequential, i);
+    }
+    assert(bplus_tree_validate(even) && bplus_tree_validate(sequential));
+    size_t keys;
+    double even_fill = 100000.0 / (count_leaves(even, &keys) * 63.0);
+    double sequential_fill = 100000.0 / (count_leaves(sequential, &keys) * 63.0);
+    assert(even_fill < 0.6);
+    assert(sequential_fill > 0.85);
+    bplus_tree_destroy(even);
+    
+    // Short rightmost nodes are repaired like any other by deletes, and
+    // splits away from the right edge stay even
+    for (int i = 99999; i >= 0; i -= 3) {
+        bool deleted = bplus_tree_delete(sequential, i);
+        assert(deleted);
+    }
+    assert(bplus_tree_validate(sequential));
+    for (int i = 0; i < 100000; i++) {
+        bplus_tree_insert(sequential, (int)((i * 7919u) % 200000));
+    }
+    assert(bplus_tree_validate(sequential));
+    for (int i = 0; i < 200000; i++) {
+        bplus_tree_delete(sequential, i);
+    }
+    assert(bplus_tree_validate(sequential));
+    size_t leaves = count_leaves(sequential, &keys);
+    assert(leaves == 1 && keys == 0);
+    bplus_tree_destroy(sequential);
+    
+    // Small orders clamp the biased split so the right node is never empty
+    options.order = 3;
+    BPlusTree* small = bplus_tree_create_with_options(&options);
+    for (int i = 0; i < 2000; i++) {
+        bplus_tree_insert(small, i);
+    }
+    assert(bplus_tree_validate(small));
+    for (int i = 0; i < 2000; i++) {
+        assert(bplus_tree_search(small, i));
+    }
+    bplus_tree_destroy(small);
+    
+    printf("Split policy tests passed!\n");
+}
+
+// The last leaf reached through next pointers
+static BPlusNode* last_leaf(BPlusTree* tree) {
+    BPlusNode* leaf = tree->root;
+    while (!leaf->is_leaf) {
+        leaf = leaf->children[leaf->num_keys];
+    }
+    return leaf;
+}
+
+void test_append_path() {
+    printf("\nRunning append path tests...\n");
+    
+    BPlusTreeOptions variants[] = {
+        { .order = 4 },
+        { .order = 5, .split = BPLUS_SPLIT_SEQUENTIAL },
+        { .order = 32, .flags = BPLUS_TREE_PACKED_LEAVES },
+    };
+    for (int v = 0; v < 3; v++) {
+        BPlusTree* tree = bplus_tree_create_with_options(&variants[v]);
+        
+        // Ascending keys switch to appends, which keep the hint on the
+        // rightmost leaf through its splits
+        for (int i = 0; i < 5000; i++) {
+            bool inserted = bplus_tree_insert(tree, i * 2);
+            assert(inserted);
+        }
+        assert(tree->tail == last_leaf(tree));
+        bool inserted = bplus_tree_insert(tree, 9998);
+        assert(!inserted);
+        assert(bplus_tree_validate(tree));
+        
+        // Keys out of order fall back to the descent, and appends resume
+        for (int i = 0; i < 5000; i++) {
+            inserted = bplus_tree_insert(tree, i * 2 + 1);
+            assert(inserted);
+            inserted = bplus_tree_insert(tree, 10000 + i);
+            assert(inserted);
+        }
+        assert(bplus_tree_validate(tree));
+        
+        // Deletes at the right edge merge the tail away; the next appends
+        // find the new one
+        for (int i = 14999; i >= 9000; i--) {
+            bool deleted = bplus_tree_delete(tree, i);
+            assert(deleted);
+        }
+        for (int i = 9000; i < 12000; i++) {
+            inserted = bplus_tree_insert(tree, i);
+            assert(inserted);
+        }
+        assert(tree->tail == last_leaf(tree));
+        assert(bplus_tree_validate(tree));
+        size_t keys;
+        count_leaves(tree, &keys);
+        assert(keys == 12000);
+        for (int i = 0; i < 12000; i++) {
+            assert(bplus_tree_search(tree, i));
+        }
+        bplus_tree_destroy(tree);
+    }
+    
+    printf("Append path tests passed!\n");
+}
+
+// Whether every node below the root holds the minimum number of keys
+static bool at_minimum(BPlusTree* tree, BPlusNode* node, bool is_root) {
+    if (!is_root && node->num_keys < (tree->order - 1) / 2) return false;
+    if (node->is_leaf) return true;
+    for (int i = 0; i <= node->num_keys; i++) {
+        if (!at_minimum(tree, node->children[i], false)) return false;
+    }
+    return true;
+}
+
+void test_lazy_delete() {
+    printf("\nRunning lazy delete tests...\n");
+    
+    BPlusTreeOptions variants[] = {
+        { .order = 8, .flags = BPLUS_TREE_LAZY_DELETE },
+        { .order = 3, .flags = BPLUS_TREE_LAZY_DELETE },
+        { .order = 32, .flags = BPLUS_TREE_LAZY_DELETE | BPLUS_TREE_PACKED_LEAVES },
+    };
+    for (int v = 0; v < 3; v++) {
+        BPlusTree* tree = bplus_tree_create_with_options(&variants[v]);
+        for (int i = 0; i < 20000; i++) {
+            bplus_tree_insert(tree, (i * 7919) % 20000);
+        }
+        
+        // Deleting 90% of the keys frees and moves nothing
+        size_t leaves = tree->leaf_pool.in_use;
+        size_t internals = tree->internal_pool.in_use;
+        for (int i = 0; i < 20000; i++) {
+            if (i % 10 == 0) continue;
+            bool deleted = bplus_tree_delete(tree, (i * 4327) % 20000);
+            assert(deleted);
+        }
+        assert(tree->leaf_pool.in_use == leaves && tree->internal_pool.in_use == internals);
+        assert(bplus_tree_validate(tree));
+        assert(!at_minimum(tree, tree->root, true));
+        for (int i = 0; i < 20000; i++) {
+            assert(bplus_tree_search(tree, (i * 4327) % 20000) == (i % 10 == 0));
+        }
+        
+        // Inserts keep working between small rebalancing steps
+        size_t steps;
+        int added = 0;
+        do {
+            steps = bplus_tree_rebalance(tree, 16);
+            assert(steps <= 16);
+            assert(bplus_tree_validate(tree));
+            bool inserted = bplus_tree_insert(tree, 20000 + added++);
+            assert(inserted);
+        } while (steps == 16);
+        assert(at_minimum(tree, tree->root, true));
+        size_t moved = bplus_tree_rebalance(tree, 16);
+        assert(moved == 0);
+        assert(tree->leaf_pool.in_use < leaves / 2);
+        size_t keys;
+        count_leaves(tree, &keys);
+        assert(keys == 2000 + (size_t)added);
+        for (int i = 0; i < 20000; i += 10) {
+            assert(bplus_tree_search(tree, (i * 4327) % 20000));
+        }
+        
+        // Emptied lazily and rebalanced, the tree is a single leaf again
+        for (int i = 0; i < 20000 + added; i++) {
+            bplus_tree_delete(tree, i);
+        }
+        while (bplus_tree_rebalance(tree, 100) == 100) {
+        }
+        assert(tree->root->is_leaf && tree->root->num_keys == 0);
+        assert(tree->leaf_pool.in_use == 1 && tree->internal_pool.in_use == 0);
+        bplus_tree_destroy(tree);
+    }
+    
+    printf("Lazy delete tests passed!\n");
+}
+
+// Every node within its own kind's capacity and, below the root, minimum
+static void assert_node_bounds(BPlusTree* tree, BPlusNode* node, bool is_root) {
+    int order = node->is_leaf ? tree->leaf_order : tree->order;
+    assert(node->num_keys <= order - 1);
+    assert(is_root || node->num_keys >= (order - 1) / 2);
+    if (node->is_leaf) return;
+    for (int i = 0; i <= node->num_keys; i++) {
+        assert_node_bounds(tree, node->children[i], false);
+    }
+}
+
+void test_node_sizes() {
+    printf("\nRunning node size tests...\n");
+    
+    // The largest order that fits, for either kind of node
+    size_t sizes[] = { 128, 256, 1000, 4096, 65536 };
+    for (int s = 0; s < 5; s++) {
+        for (int leaf = 0; leaf < 2; leaf++) {
+            int order = bplus_order_for_bytes(sizes[s], leaf);
+            assert(bplus_node_size(order, leaf) <= sizes[s]);
+            assert(bplus_node_size(order + 1, leaf) > sizes[s]);
+        }
+    }
+    assert(bplus_order_for_bytes(256, true) == 53 && bplus_order_for_bytes(256, false) == 17);
+    assert(bplus_order_for_bytes(1, true) == 3 && bplus_order_for_bytes(64, false) == 3);
+    size_t auto_bytes = bplus_node_bytes_auto();
+    assert(auto_bytes >= BPLUS_CACHE_LINE);
+    
+    BPlusTreeOptions bad = { .order = 8, .leaf_order = 2 };
+    BPlusTree* created = bplus_tree_create_with_options(&bad);
+    assert(created == NULL);
+    
+    BPlusTreeOptions variants[] = {
+        { .node_bytes = 256 },
+        { .node_bytes = BPLUS_NODE_BYTES_AUTO },
+        { .order = 4, .leaf_order = 16 },
+        { .order = 16, .leaf_order = 4 },
+        { .node_bytes = 512, .flags = BPLUS_TREE_PACKED_LEAVES },
+        { .node_bytes = 256, .flags = BPLUS_TREE_LAZY_DELETE },
+    };
+    for (int v = 0; v < 6; v++) {
+        BPlusTree* tree = bplus_tree_create_with_options(&variants[v]);
+        if (variants[v].node_bytes == BPLUS_NODE_BYTES_AUTO) {
+            assert(tree->leaf_order > tree->order);
+            assert(bplus_node_size(tree->leaf_order, true) <= auto_bytes);
+        }
+        for (int i = 0; i < 20000; i++) {
+            bplus_tree_insert(tree, (i * 7919) % 20000);
+        }
+        int batch[5000];
+        for (int i = 0; i < 5000; i++) {
+            batch[i] = 20000 + i * 3;
+        }
+        size_t added = bplus_tree_insert_batch(tree, batch, 5000);
+        assert(added == 5000);
+        assert(bplus_tree_validate(tree));
+        assert_node_bounds(tree, tree->root, true);
+        
+        for (int i = 0; i < 20000; i += 3) {
+            bool deleted = bplus_tree_delete(tree, (i * 4327) % 20000);
+            assert(deleted);
+        }
+        while (bplus_tree_rebalance(tree, 64) == 64) {
+        }
+        assert(bplus_tree_validate(tree));
+        assert_node_bounds(tree, tree->root, true);
+        bool found[5000];
+        size_t counted = bplus_tree_search_batch(tree, batch, 5000, found);
+        assert(counted == 5000);
+        
+        // Files keep both orders
+        bool saved = save_tree_state(tree, "test_node_sizes.bin");
+        assert(saved);
+        BPlusTree* loaded = load_tree_state("test_node_sizes.bin");
+        assert(loaded->order == tree->order && loaded->leaf_order == tree->leaf_order);
+        assert(bplus_tree_validate(loaded));
+        for (int i = 0; i < 20000; i++) {
+            assert(bplus_tree_search(loaded, i) == bplus_tree_search(tree, i));
+        }
+        bplus_tree_destroy(loaded);
+        remove("test_node_sizes.bin");
+        bplus_tree_destroy(tree);
+    }
+    
+    // Bulk loading fills each kind of node to its own order
+    int sorted[10000];
+    for (int i = 0; i < 10000; i++) {
+        sorted[i] = i;
+    }
+    BPlusTreeOptions sized = { .node_bytes = 256 };
+    BPlusTree* tree = bplus_tree_bulk_load_with_options(&sized, sorted, 10000, 1.0);
+    assert(tree && bplus_tree_validate(tree));
+    assert(tree->leaf_pool.in_use == (10000 + 51) / 52);
+    bplus_tree_destroy(tree);
+    
+    printf("Node size tests passed!\n");
+}
+
 void test_tree_suite() {
     printf("Starting B+ Tree unit tests...\n\n");
     
@@ -158,6 +538,12 @@ void test_tree_suite() {
     test_basic_insertion();
     test_complex_insertion();
     test_deletion();
+    test_odd_orders();
+    test_set_semantics();
+    test_split_policy();
+    test_append_path();
+    test_lazy_delete();
+    test_node_sizes();
     
     printf("\nAll B+ Tree unit tests passed!\n");
 }
\ No newline at end of file
@@ -0,0 +1,340 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "bplus/checkpoint.h"
+#include "bplus/checksum.h"
+#include "bplus/tree.h"
+#include "bplus/wal.h"
+
+#define WAL_TEST_FILE "test_wal.log"
+#define WAL_TEST_SNAPSHOT "test_wal.snap"
+
+typedef struct {
+    int ops[64];
+    int keys[64];
+    int count;
+} Recorded;
+
+static void record_op(BPlusWalOp op, int key, void* ctx) {
+    Recorded* rec = ctx;
+    rec->ops[rec->count] = op;
+    rec->keys[rec->count] = key;
+    rec->count++;
+}
+
+static long file_size(const char* path) {
+    FILE* fp = fopen(path, "rb");
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fclose(fp);
+    return size;
+}
+
+// Makes writes past `size` bytes fail, as on a full disk; returns the
+// limit to restore
+static struct rlimit limit_writes(long size) {
+    struct rlimit old;
+    getrlimit(RLIMIT_FSIZE, &old);
+    struct rlimit limited = { (rlim_t)size, old.rlim_max };
+    setrlimit(RLIMIT_FSIZE, &limited);
+    return old;
+}
+
+void test_crc32c() {
+    printf("Running CRC-32C tests...\n");
+    
+    // Standard check value
+    assert(bplus_crc32c(0, "123456789", 9) == 0xE3069283u);
+    assert(bplus_crc32c(0, "", 0) == 0);
+    
+    // Extending a checksum equals checksumming the concatenation
+    char data[100];
+    for (int i = 0; i < 100; i++) data[i] = (char)(i * 7);
+    assert(bplus_crc32c(bplus_crc32c(0, data, 37), data + 37, 63) == bplus_crc32c(0, data, 100));
+    
+    printf("CRC-32C tests passed!\n");
+}
+
+void test_wal_replay() {
+    printf("Running WAL replay tests...\n");
+    remove(WAL_TEST_FILE);
+    
+    BPlusWal* wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    assert(wal);
+    for (int i = 0; i < 10; i++) {
+        bool appended = bplus_wal_append(wal, i % 3 ? BPLUS_WAL_INSERT : BPLUS_WAL_DELETE, i * 10);
+        assert(appended);
+    }
+    assert(wal->syncs == 10);
+    bool closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    Recorded rec = {0};
+    uint64_t replayed;
+    wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    bool replayed_all = bplus_wal_replay(wal, record_op, &rec, &replayed);
+    assert(replayed_all);
+    assert(replayed == 10 && rec.count == 10);
+    for (int i = 0; i < 10; i++) {
+        assert(rec.ops[i] == (i % 3 ? BPLUS_WAL_INSERT : BPLUS_WAL_DELETE));
+        assert(rec.keys[i] == i * 10);
+    }
+    
+    // Appends continue after the replayed records
+    bool appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 999);
+    assert(appended);
+    closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    // Tear the last record and corrupt the one before it
+    long size = file_size(WAL_TEST_FILE);
+    int truncated = truncate(WAL_TEST_FILE, size - 5);
+    assert(truncated == 0);
+    int fd = open(WAL_TEST_FILE, O_RDWR);
+    char byte = 0x5A;
+    ssize_t patched = pwrite(fd, &byte, 1, size - (long)sizeof(BPlusWalRecord) - 2);
+    assert(patched == 1);
+    close(fd);
+    
+    // Replay keeps the intact prefix and the torn tail is cut off
+    memset(&rec, 0, sizeof(rec));
+    wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    replayed_all = bplus_wal_replay(wal, record_op, &rec, &replayed);
+    assert(replayed_all);
+    assert(replayed == 9 && rec.keys[8] == 80);
+    assert(file_size(WAL_TEST_FILE) == size - 2 * (long)sizeof(BPlusWalRecord));
+    appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 1000);
+    assert(appended);
+    closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    memset(&rec, 0, sizeof(rec));
+    wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    replayed_all = bplus_wal_replay(wal, record_op, &rec, &replayed);
+    assert(replayed_all);
+    assert(replayed == 10 && rec.keys[9] == 1000);
+    closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    // A file that is not a log is refused
+    FILE* fp = fopen(WAL_TEST_FILE, "wb");
+    fputs("definitely not a log file", fp);
+    fclose(fp);
+    BPlusWal* opened = bplus_wal_open(WAL_TEST_FILE, NULL);
+    assert(opened == NULL);
+    
+    remove(WAL_TEST_FILE);
+    printf("WAL replay tests passed!\n");
+}
+
+void test_wal_group_commit() {
+    printf("Running WAL group commit tests...\n");
+    remove(WAL_TEST_FILE);
+    
+    // By count: one sync per eight records, the rest on close
+    BPlusWalOptions options = { .group_records = 8 };
+    BPlusWal* wal = bplus_wal_open(WAL_TEST_FILE, &options);
+    for (int i = 0; i < 20; i++) {
+        bool appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, i);
+        assert(appended);
+    }
+    assert(wal->syncs == 2 && wal->pending_count == 4);
+    
+    // Unsynced records are not in the log yet
+    Recorded rec = {0};
+    uint64_t replayed;
+    bool replayed_all = bplus_wal_replay(wal, record_op, &rec, &replayed);
+    assert(replayed_all && replayed == 16);
+    bool synced = bplus_wal_sync(wal);
+    assert(synced && wal->pending_count == 0 && wal->syncs == 3);
+    bool closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    // By time: the group is synced once the window passes, with no
+    // further append to notice it
+    options = (BPlusWalOptions){ .group_records = 1000, .group_window_ms = 20 };
+    wal = bplus_wal_open(WAL_TEST_FILE, &options);
+    bool appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 100);
+    appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 101) && appended;
+    assert(appended);
+    uint64_t syncs = 0;
+    size_t pending = 0;
+    for (int wait = 0; wait < 200 && syncs == 0; wait++) {
+        nanosleep(&(struct timespec){ .tv_nsec = 10 * 1000000 }, NULL);
+        pthread_mutex_lock(&wal->lock);
+        syncs = wal->syncs;
+        pending = wal->pending_count;
+        pthread_mutex_unlock(&wal->lock);
+    }
+    assert(syncs == 1 && pending == 0);
+    appended = bplus_wal_append(wal, BPLUS_WAL_DELETE, 100);
+    assert(appended);
+    closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    replayed_all = bplus_wal_replay(wal, record_op, &(Recorded){0}, &replayed);
+    assert(replayed_all);
+    assert(replayed == 23);
+    closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    remove(WAL_TEST_FILE);
+    printf("WAL group commit tests passed!\n");
+}
+
+void test_wal_failure() {
+    printf("Running WAL failure tests...\n");
+    remove(WAL_TEST_FILE);
+    remove(WAL_TEST_SNAPSHOT);
+    signal(SIGXFSZ, SIG_IGN);
+    
+    // A refused append is not written by the next commit
+    BPlusWal* wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    bool appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 1);
+    assert(appended);
+    struct rlimit unlimited = limit_writes(file_size(WAL_TEST_FILE));
+    appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 2);
+    setrlimit(RLIMIT_FSIZE, &unlimited);
+    assert(!appended && wal->pending_count == 0 && !wal->failed);
+    appended = bplus_wal_append(wal, BPLUS_WAL_DELETE, 3);
+    assert(appended);
+    bool closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    Recorded rec = {0};
+    uint64_t replayed;
+    wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    bool replayed_all = bplus_wal_replay(wal, record_op, &rec, &replayed);
+    assert(replayed_all && replayed == 2);
+    assert(rec.keys[0] == 1 && rec.keys[1] == 3 && rec.ops[1] == BPLUS_WAL_DELETE);
+    closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    // A group of accepted records that fails to sync fails the log
+    BPlusWalOptions options = { .group_records = 4 };
+    wal = bplus_wal_open(WAL_TEST_FILE, &options);
+    appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 10);
+    appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 11) && appended;
+    assert(appended);
+    unlimited = limit_writes(file_size(WAL_TEST_FILE));
+    bool synced = bplus_wal_sync(wal);
+    setrlimit(RLIMIT_FSIZE, &unlimited);
+    assert(!synced && wal->failed);
+    appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 12);
+    assert(!appended);
+    synced = bplus_wal_sync(wal);
+    assert(!synced);
+    
+    memset(&rec, 0, sizeof(rec));
+    replayed_all = bplus_wal_replay(wal, record_op, &rec, &replayed);
+    assert(replayed_all && replayed == 2);
+    
+    // A checkpoint holds the tree's changes, so the log works again after it
+    BPlusTree* tree = bplus_tree_create(4);
+    bool checkpointed = bplus_wal_checkpoint(wal, tree, WAL_TEST_SNAPSHOT);
+    assert(checkpointed && !wal->failed);
+    appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 13);
+    assert(appended);
+    closed = bplus_wal_close(wal);
+    assert(closed);
+    bplus_tree_destroy(tree);
+    
+    memset(&rec, 0, sizeof(rec));
+    wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    replayed_all = bplus_wal_replay(wal, record_op, &rec, &replayed);
+    assert(replayed_all && replayed == 1 && rec.keys[0] == 13);
+    closed = bplus_wal_close(wal);
+    assert(closed);
+    
+    remove(WAL_TEST_FILE);
+    remove(WAL_TEST_SNAPSHOT);
+    printf("WAL failure tests passed!\n");
+}
+
+void test_wal_checkpoint() {
+    printf("Running WAL checkpoint tests...\n");
+    remove(WAL_TEST_FILE);
+    remove(WAL_TEST_SNAPSHOT);
+    
+    BPlusTree* tree = bplus_tree_create(4);
+    BPlusWal* wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    for (int i = 0; i < 200; i++) {
+        bool inserted = bplus_tree_insert(tree, i);
+        assert(inserted);
+        bool appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, i);
+        assert(appended);
+    }
+    bool checkpointed = bplus_wal_checkpoint(wal, tree, WAL_TEST_SNAPSHOT);
+    assert(checkpointed);
+    long empty_size = file_size(WAL_TEST_FILE);
+    
+    // Changes after the checkpoint live only in the log
+    for (int i = 0; i < 200; i += 2) {
+        bool deleted = bplus_tree_delete(tree, i);
+        assert(deleted);
+        bool appended = bplus_wal_append(wal, BPLUS_WAL_DELETE, i);
+        assert(appended);
+    }
+    bool inserted = bplus_tree_insert(tree, 500);
+    assert(inserted);
+    bool appended = bplus_wal_append(wal, BPLUS_WAL_INSERT, 500);
+    assert(appended);
+    bool closed = bplus_wal_close(wal);
+    assert(closed);
+    bplus_tree_destroy(tree);
+    
+    // Recovery: the checkpoint plus the log
+    tree = bplus_checkpoint_load(WAL_TEST_SNAPSHOT);
+    assert(tree && tree->order == 4);
+    wal = bplus_wal_open(WAL_TEST_FILE, NULL);
+    bool recovered = bplus_wal_recover(wal, tree);
+    assert(recovered);
+    for (int i = 0; i < 200; i++) {
+        assert(bplus_tree_search(tree, i) == (i % 2 == 1));
+    }
+    assert(bplus_tree_search(tree, 500));
+    
+    // Replaying the log a second time changes nothing
+    recovered = bplus_wal_recover(wal, tree);
+    assert(recovered);
+    assert(bplus_tree_search(tree, 500) && !bplus_tree_search(tree, 0));
+    
+    // A second checkpoint empties the log and keeps the LSNs going
+    uint64_t next_lsn = wal->next_lsn;
+    checkpointed = bplus_wal_checkpoint(wal, tree, WAL_TEST_SNAPSHOT);
+    assert(checkpointed);
+    assert(file_size(WAL_TEST_FILE) == empty_size && wal->next_lsn == next_lsn);
+    closed = bplus_wal_close(wal);
+    assert(closed);
+    bplus_tree_destroy(tree);
+    
+    tree = bplus_checkpoint_load(WAL_TEST_SNAPSHOT);
+    for (int i = 0; i < 200; i++) {
+        assert(bplus_tree_search(tree, i) == (i % 2 == 1));
+    }
+    assert(bplus_tree_search(tree, 500));
+    bplus_tree_destroy(tree);
+    
+    remove(WAL_TEST_FILE);
+    remove(WAL_TEST_SNAPSHOT);
+    printf("WAL checkpoint tests passed!\n");
+}
+
+void test_wal_suite() {
+    printf("Starting WAL tests...\n\n");
+    
+    test_crc32c();
+    test_wal_replay();
+    test_wal_group_commit();
+    test_wal_failure();
+    test_wal_checkpoint();
+    
+    printf("All WAL tests passed!\n");
+}